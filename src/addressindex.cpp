@@ -0,0 +1,74 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "addressindex.h"
+
+#include <algorithm>
+
+void CMempoolAddressIndex::Add(const CMempoolAddressDeltaKey& key, const CMempoolAddressDelta& delta)
+{
+    auto& bucket = *mapBuckets.emplace(AddressKey(key.addressBytes, key.type), Bucket()).first;
+    bucket.second.push_back(Entry{key.txhash, key.index, key.spending, delta});
+    mapTxRefs[key.txhash].push_back(BucketRef{&bucket, (uint32_t)(bucket.second.size() - 1)});
+    nEntries++;
+}
+
+void CMempoolAddressIndex::Remove(const uint256& txhash)
+{
+    auto it = mapTxRefs.find(txhash);
+    if (it == mapTxRefs.end()) {
+        return;
+    }
+
+    // it->second is not changed while iterating, only the positions of its entries are
+    for (size_t i = 0; i < it->second.size(); i++) {
+        const BucketRef ref = it->second[i];
+        Bucket& bucket = ref.bucket->second;
+        uint32_t nLast = bucket.size() - 1;
+        if (ref.pos != nLast) {
+            // move the last entry into the free slot and fix its back-reference, which might be one of ours
+            bucket[ref.pos] = bucket[nLast];
+            auto& movedRefs = mapTxRefs.at(bucket[ref.pos].txhash);
+            for (auto& movedRef : movedRefs) {
+                if (movedRef.bucket == ref.bucket && movedRef.pos == nLast) {
+                    movedRef.pos = ref.pos;
+                    break;
+                }
+            }
+        }
+        bucket.pop_back();
+        nEntries--;
+        if (bucket.empty()) {
+            // there can't be any other references to an empty bucket
+            AddressKey addressKey = ref.bucket->first;
+            mapBuckets.erase(addressKey);
+        }
+    }
+    mapTxRefs.erase(it);
+}
+
+void CMempoolAddressIndex::Clear()
+{
+    mapBuckets.clear();
+    mapTxRefs.clear();
+    nEntries = 0;
+}
+
+void CMempoolAddressIndex::Get(const std::vector<AddressKey>& addresses, std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> >& results) const
+{
+    for (const auto& address : addresses) {
+        auto it = mapBuckets.find(address);
+        if (it == mapBuckets.end()) {
+            continue;
+        }
+        size_t nBegin = results.size();
+        for (const Entry& e : it->second) {
+            results.emplace_back(CMempoolAddressDeltaKey(address.second, address.first, e.txhash, e.index, e.spending), e.delta);
+        }
+        // buckets are unordered, keep the ordering of the old map based index
+        std::sort(results.begin() + nBegin, results.end(), [](const std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>& a, const std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta>& b) {
+            return CMempoolAddressDeltaKeyCompare()(a.first, b.first);
+        });
+    }
+}
@@ -8,6 +8,11 @@
 
 #include "uint256.h"
 #include "amount.h"
+#include "saltedhasher.h"
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 struct CMempoolAddressDelta
 {
@@ -79,4 +84,51 @@ struct CMempoolAddressDeltaKeyCompare
     }
 };
 
+/**
+ * Mempool address index, bucketed per (address hash, address type).
+ *
+ * Each bucket is a small unordered vector of the deltas of one address. Every transaction keeps
+ * back-references (bucket and position) to its entries, so removal is a swap with the last entry of
+ * the bucket instead of several tree operations on the full 60 byte keys.
+ * Not thread-safe, CTxMemPool guards it with cs.
+ */
+class CMempoolAddressIndex
+{
+public:
+    typedef std::pair<uint160, int> AddressKey; // (address hash, address type), as used by the address RPCs
+
+private:
+    struct Entry
+    {
+        uint256 txhash;
+        unsigned int index;
+        int spending;
+        CMempoolAddressDelta delta;
+    };
+    typedef std::vector<Entry> Bucket;
+    typedef std::unordered_map<AddressKey, Bucket, StaticSaltedHasher> BucketMap;
+
+    struct BucketRef
+    {
+        // node pointers of unordered_map stay valid on rehash, unlike its iterators
+        BucketMap::value_type* bucket;
+        uint32_t pos;
+    };
+
+    BucketMap mapBuckets;
+    std::unordered_map<uint256, std::vector<BucketRef>, StaticSaltedHasher> mapTxRefs;
+    size_t nEntries{0};
+
+public:
+    void Add(const CMempoolAddressDeltaKey& key, const CMempoolAddressDelta& delta);
+    void Remove(const uint256& txhash);
+    void Clear();
+
+    /** Appends the deltas of all given addresses to results, in the order of CMempoolAddressDeltaKeyCompare per address */
+    void Get(const std::vector<AddressKey>& addresses, std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> >& results) const;
+
+    size_t Size() const { return nEntries; }
+    size_t AddressCount() const { return mapBuckets.size(); }
+};
+
 #endif // BITCOIN_ADDRESSINDEX_H
@@ -4,6 +4,7 @@
 
 #include "bench.h"
 
+#include "chainparams.h"
 #include "crypto/sha256.h"
 #include "key.h"
 #include "stacktraces.h"
@@ -33,6 +34,8 @@ main(int argc, char** argv)
     InitBLSTests();
     SetupEnvironment();
     fPrintToDebugLog = false; // don't want to write to debug.log file
+    // e.g. the JSON benchmarks encode addresses
+    SelectParams(CBaseChainParams::MAIN);
 
     benchmark::BenchRunner::RunAll();
 
@@ -0,0 +1,84 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "core_io.h"
+#include "jsonwriter.h"
+#include "key.h"
+#include "primitives/block.h"
+#include "random.h"
+#include "script/standard.h"
+#include "streams.h"
+
+#include <univalue.h>
+
+// About 2 MB of 2-input 2-output P2PKH transactions, the transaction part of getblock with verbosity 2
+// and of /rest/block/
+static const size_t BLOCK_SIZE = 2 * 1000 * 1000;
+
+static void CreateBlock(CBlock& block)
+{
+    FastRandomContext rand(true);
+    CKey key;
+    key.MakeNewKey(true);
+    CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+
+    size_t nSize = 0;
+    while (nSize < BLOCK_SIZE) {
+        CMutableTransaction tx;
+        tx.vin.resize(2);
+        for (auto& txin : tx.vin) {
+            txin.prevout = COutPoint(rand.rand256(), rand.randrange(4));
+            txin.scriptSig = CScript() << rand.randbytes(71) << ToByteVector(key.GetPubKey());
+        }
+        tx.vout.resize(2);
+        for (auto& txout : tx.vout) {
+            txout.nValue = rand.randrange(100 * COIN);
+            txout.scriptPubKey = scriptPubKey;
+        }
+        block.vtx.emplace_back(MakeTransactionRef(tx));
+        nSize += ::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION);
+    }
+}
+
+static void BlockToJsonUniValue(benchmark::State& state)
+{
+    CBlock block;
+    CreateBlock(block);
+
+    while (state.KeepRunning()) {
+        UniValue txs(UniValue::VARR);
+        for (const auto& tx : block.vtx) {
+            UniValue objTx(UniValue::VOBJ);
+            TxToUniv(*tx, uint256(), objTx);
+            txs.push_back(objTx);
+        }
+        std::string strJSON = txs.write() + "\n";
+        assert(!strJSON.empty());
+    }
+}
+
+static void BlockToJsonStream(benchmark::State& state)
+{
+    CBlock block;
+    CreateBlock(block);
+
+    // stands in for the evbuffer of the HTTP reply
+    std::string strReply;
+    while (state.KeepRunning()) {
+        strReply.clear();
+        CJSONWriter writer([&](const char* data, size_t len) { strReply.append(data, len); });
+        writer.BeginArray();
+        for (const auto& tx : block.vtx) {
+            writer.BeginObject();
+            TxToJSON(*tx, uint256(), writer);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        strReply += writer.str() + "\n";
+    }
+}
+
+BENCHMARK(BlockToJsonUniValue);
+BENCHMARK(BlockToJsonStream);
@@ -5,6 +5,8 @@
 #include "bench.h"
 #include "random.h"
 #include "bls/bls_worker.h"
+#include "executor.h"
+#include "util.h"
 #include "utiltime.h"
 
 #include <iostream>
@@ -13,12 +15,14 @@ CBLSWorker blsWorker;
 
 void InitBLSTests()
 {
+    g_executor.Start(GetNumCores());
     blsWorker.Start();
 }
 
 void CleanupBLSTests()
 {
     blsWorker.Stop();
+    g_executor.Stop();
 }
 
 static void BuildTestVectors(size_t count, size_t invalidCount,
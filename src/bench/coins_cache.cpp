@@ -0,0 +1,54 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "coins.h"
+#include "pubkey.h"
+#include "random.h"
+#include "script/standard.h"
+
+#include <vector>
+
+// Roughly the number of coins created and spent by a few full blocks
+static const int NUM_COINS = 100000;
+
+static void CoinsCache(benchmark::State& state, bool fPool)
+{
+    FastRandomContext rand(true);
+    std::vector<COutPoint> vOutpoints;
+    for (int i = 0; i < NUM_COINS; i++) {
+        vOutpoints.emplace_back(rand.rand256(), rand.randrange(4));
+    }
+    CTxOut txout(50 * CENT, GetScriptForDestination(CKeyID(uint160(rand.randbytes(20)))));
+
+    CCoinsView viewDummy;
+    fCoinsCachePool = fPool;
+    while (state.KeepRunning()) {
+        CCoinsViewCache cache(&viewDummy);
+        for (const auto& outpoint : vOutpoints) {
+            cache.AddCoin(outpoint, Coin(txout, 1, false), false);
+        }
+        for (size_t i = 0; i < vOutpoints.size(); i += 2) {
+            cache.SpendCoin(vOutpoints[i]);
+        }
+        for (const auto& outpoint : vOutpoints) {
+            cache.AccessCoin(outpoint);
+        }
+        assert(cache.GetCacheSize() == vOutpoints.size() / 2);
+    }
+    fCoinsCachePool = DEFAULT_COINS_CACHE_POOL;
+}
+
+static void CoinsCacheStd(benchmark::State& state)
+{
+    CoinsCache(state, false);
+}
+
+static void CoinsCachePool(benchmark::State& state)
+{
+    CoinsCache(state, true);
+}
+
+BENCHMARK(CoinsCacheStd);
+BENCHMARK(CoinsCachePool);
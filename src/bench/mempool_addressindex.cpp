@@ -0,0 +1,141 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "addressindex.h"
+#include "random.h"
+
+#include <map>
+
+// Mempool of 20000 txs with 2 inputs and 2 outputs each, spread over 5000 addresses plus a few hot
+// (exchange like) addresses which are involved in every 10th transaction
+static const size_t MEMPOOL_TXS = 20000;
+static const size_t ADDRESSES = 5000;
+static const size_t HOT_ADDRESSES = 5;
+static const size_t DELTAS_PER_TX = 4;
+
+// The map based index which CTxMemPool used before CMempoolAddressIndex
+class CMempoolAddressMapIndex
+{
+    typedef std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> addressDeltaMap;
+    addressDeltaMap mapAddress;
+
+    typedef std::map<uint256, std::vector<CMempoolAddressDeltaKey> > addressDeltaMapInserted;
+    addressDeltaMapInserted mapAddressInserted;
+
+public:
+    void Add(const std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> >& deltas)
+    {
+        std::vector<CMempoolAddressDeltaKey> inserted;
+        for (const auto& p : deltas) {
+            mapAddress.insert(p);
+            inserted.push_back(p.first);
+        }
+        mapAddressInserted.insert(std::make_pair(deltas[0].first.txhash, inserted));
+    }
+
+    void Remove(const uint256& txhash)
+    {
+        auto it = mapAddressInserted.find(txhash);
+        if (it != mapAddressInserted.end()) {
+            for (const auto& key : it->second) {
+                mapAddress.erase(key);
+            }
+            mapAddressInserted.erase(it);
+        }
+    }
+
+    void Get(const std::vector<std::pair<uint160, int> >& addresses, std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> >& results) const
+    {
+        for (const auto& address : addresses) {
+            auto ait = mapAddress.lower_bound(CMempoolAddressDeltaKey(address.second, address.first));
+            while (ait != mapAddress.end() && ait->first.addressBytes == address.first && ait->first.type == address.second) {
+                results.push_back(*ait);
+                ait++;
+            }
+        }
+    }
+};
+
+class CMempoolAddressBucketIndex : public CMempoolAddressIndex
+{
+public:
+    using CMempoolAddressIndex::Add;
+    void Add(const std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> >& deltas)
+    {
+        for (const auto& p : deltas) {
+            CMempoolAddressIndex::Add(p.first, p.second);
+        }
+    }
+};
+
+typedef std::vector<std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > > TxDeltas;
+
+static void CreateDeltas(TxDeltas& txDeltas, std::vector<uint160>& addresses)
+{
+    FastRandomContext rand(true);
+    addresses.resize(ADDRESSES + HOT_ADDRESSES);
+    for (auto& address : addresses) {
+        std::vector<unsigned char> vch = rand.randbytes(20);
+        address = uint160(vch);
+    }
+    txDeltas.resize(MEMPOOL_TXS);
+    for (size_t i = 0; i < MEMPOOL_TXS; i++) {
+        uint256 txhash = rand.rand256();
+        for (size_t j = 0; j < DELTAS_PER_TX; j++) {
+            size_t nAddress = (i % 10 == 0 && j == 0) ? ADDRESSES + rand.randrange(HOT_ADDRESSES) : rand.randrange(ADDRESSES);
+            int spending = j < DELTAS_PER_TX / 2;
+            CMempoolAddressDeltaKey key(1, addresses[nAddress], txhash, j, spending);
+            txDeltas[i].emplace_back(key, spending ? CMempoolAddressDelta(i, -1000, rand.rand256(), 0) : CMempoolAddressDelta(i, 1000));
+        }
+    }
+}
+
+// Adds and removes the whole mempool, the way ATMP and block connection do it with -addressindex
+template <typename T>
+static void AddRemove(benchmark::State& state)
+{
+    TxDeltas txDeltas;
+    std::vector<uint160> addresses;
+    CreateDeltas(txDeltas, addresses);
+
+    while (state.KeepRunning()) {
+        T index;
+        for (const auto& deltas : txDeltas) {
+            index.Add(deltas);
+        }
+        for (const auto& deltas : txDeltas) {
+            index.Remove(deltas[0].first.txhash);
+        }
+    }
+}
+
+// getaddressmempool for single addresses of a full mempool, including the hot ones
+template <typename T>
+static void Query(benchmark::State& state)
+{
+    TxDeltas txDeltas;
+    std::vector<uint160> addresses;
+    CreateDeltas(txDeltas, addresses);
+
+    T index;
+    for (const auto& deltas : txDeltas) {
+        index.Add(deltas);
+    }
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > results;
+        index.Get({{addresses[i++ % addresses.size()], 1}}, results);
+    }
+}
+
+static void MempoolAddressIndexMapAddRemove(benchmark::State& state) { AddRemove<CMempoolAddressMapIndex>(state); }
+static void MempoolAddressIndexBucketAddRemove(benchmark::State& state) { AddRemove<CMempoolAddressBucketIndex>(state); }
+static void MempoolAddressIndexMapQuery(benchmark::State& state) { Query<CMempoolAddressMapIndex>(state); }
+static void MempoolAddressIndexBucketQuery(benchmark::State& state) { Query<CMempoolAddressBucketIndex>(state); }
+
+BENCHMARK(MempoolAddressIndexMapAddRemove);
+BENCHMARK(MempoolAddressIndexBucketAddRemove);
+BENCHMARK(MempoolAddressIndexMapQuery);
+BENCHMARK(MempoolAddressIndexBucketQuery);
@@ -0,0 +1,122 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "arith_uint256.h"
+#include "txmempool.h"
+#include "utiltime.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static const size_t MEMPOOL_BASE_TXS = 5000;
+static const size_t BATCH_TXS = 100;
+
+static std::vector<CTransactionRef> CreateTxs(size_t nCount, uint32_t nSeed)
+{
+    std::vector<CTransactionRef> vtx;
+    vtx.reserve(nCount);
+    for (size_t i = 0; i < nCount; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(ArithToUint256(arith_uint256((uint64_t)nSeed << 32 | i)), 0);
+        tx.vin[0].scriptSig = CScript() << OP_1;
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[0].nValue = 10 * COIN;
+        vtx.emplace_back(MakeTransactionRef(tx));
+    }
+    return vtx;
+}
+
+static void AddTx(const CTransactionRef& tx, CTxMemPool& pool)
+{
+    LockPoints lp;
+    pool.addUnchecked(tx->GetHash(), CTxMemPoolEntry(tx, 1000, 0, 1, false, 1, lp));
+}
+
+// Roughly what AcceptToMemoryPool and block connection do to the mempool: add a batch of
+// transactions while holding pool.cs and then remove them again
+static void AddAndRemoveBatch(const std::vector<CTransactionRef>& vtx, CTxMemPool& pool)
+{
+    LOCK(pool.cs);
+    for (const auto& tx : vtx) {
+        AddTx(tx, pool);
+    }
+    for (const auto& tx : vtx) {
+        pool.removeRecursive(*tx);
+    }
+}
+
+// The mix of queries issued by RPC and P2P code: AlreadyHave style existence checks (hits and misses),
+// getrawtransaction style lookups, InstantSend conflict checks and occasionally a full listing
+static void ReadMix(const CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, size_t i)
+{
+    const CTransactionRef& tx = vtx[i % vtx.size()];
+    pool.exists(tx->GetHash());
+    pool.exists(tx->vin[0].prevout.hash);
+    pool.info(tx->GetHash());
+    uint256 spenderHash;
+    pool.GetSpender(tx->vin[0].prevout, spenderHash);
+    if (i % 100 == 0) {
+        std::vector<uint256> vtxid;
+        pool.queryHashesUnsorted(vtxid);
+    }
+}
+
+// Measures batches of mempool additions/removals while another thread performs 1000 reads per second
+static void MempoolAddUnderReadLoad(benchmark::State& state)
+{
+    CTxMemPool pool;
+    std::vector<CTransactionRef> vtxBase = CreateTxs(MEMPOOL_BASE_TXS, 1);
+    std::vector<CTransactionRef> vtxBatch = CreateTxs(BATCH_TXS, 2);
+    for (const auto& tx : vtxBase) {
+        AddTx(tx, pool);
+    }
+
+    std::atomic<bool> fStop{false};
+    std::thread reader([&] {
+        for (size_t i = 0; !fStop; i++) {
+            ReadMix(pool, vtxBase, i);
+            MilliSleep(1);
+        }
+    });
+
+    while (state.KeepRunning()) {
+        AddAndRemoveBatch(vtxBatch, pool);
+    }
+
+    fStop = true;
+    reader.join();
+}
+
+// Measures the read mix while another thread keeps adding and removing transactions
+static void MempoolReadUnderAddLoad(benchmark::State& state)
+{
+    CTxMemPool pool;
+    std::vector<CTransactionRef> vtxBase = CreateTxs(MEMPOOL_BASE_TXS, 1);
+    std::vector<CTransactionRef> vtxBatch = CreateTxs(BATCH_TXS, 2);
+    for (const auto& tx : vtxBase) {
+        AddTx(tx, pool);
+    }
+
+    std::atomic<bool> fStop{false};
+    std::thread writer([&] {
+        while (!fStop) {
+            AddAndRemoveBatch(vtxBatch, pool);
+        }
+    });
+
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        ReadMix(pool, vtxBase, i++);
+    }
+
+    fStop = true;
+    writer.join();
+}
+
+BENCHMARK(MempoolAddUnderReadLoad);
+BENCHMARK(MempoolReadUnderAddLoad);
@@ -0,0 +1,75 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "core_io.h"
+#include "key.h"
+#include "random.h"
+#include "rpc/register.h"
+#include "rpc/server.h"
+#include "script/standard.h"
+#include "utilstrencodings.h"
+
+#include <univalue.h>
+
+// Batch of decoderawtransaction calls of 2-input 2-output P2PKH transactions. The bench binary has no
+// chainstate, this stands in for the getrawtransaction/getblockhash batches of block explorers and indexers.
+static const size_t BATCH_SIZE = 500;
+
+static UniValue CreateBatch()
+{
+    FastRandomContext rand(true);
+    CKey key;
+    key.MakeNewKey(true);
+    CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+
+    UniValue batch(UniValue::VARR);
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(2);
+        for (auto& txin : tx.vin) {
+            txin.prevout = COutPoint(rand.rand256(), rand.randrange(4));
+            txin.scriptSig = CScript() << rand.randbytes(71) << ToByteVector(key.GetPubKey());
+        }
+        tx.vout.resize(2);
+        for (auto& txout : tx.vout) {
+            txout.nValue = rand.randrange(100 * COIN);
+            txout.scriptPubKey = scriptPubKey;
+        }
+        UniValue params(UniValue::VARR);
+        params.push_back(EncodeHexTx(tx));
+        UniValue req(UniValue::VOBJ);
+        req.pushKV("method", "decoderawtransaction");
+        req.pushKV("params", params);
+        req.pushKV("id", (int)i);
+        batch.push_back(req);
+    }
+    return batch;
+}
+
+static void RPCBatch(benchmark::State& state, int nThreads)
+{
+    RegisterRawTransactionRPCCommands(tableRPC);
+    SetRPCWarmupFinished();
+    UniValue batch = CreateBatch();
+    JSONRPCRequest jreq;
+
+    // the thread executing the batch helps the workers
+    std::unique_ptr<CRPCBatchExecutor> executor;
+    if (nThreads > 1) {
+        executor.reset(new CRPCBatchExecutor(nThreads - 1));
+    }
+    while (state.KeepRunning()) {
+        std::string strReply = JSONRPCExecBatch(jreq, batch, executor.get());
+        assert(strReply.find("\"error\":null") != std::string::npos);
+    }
+}
+
+static void RPCBatch1Thread(benchmark::State& state) { RPCBatch(state, 1); }
+static void RPCBatch4Threads(benchmark::State& state) { RPCBatch(state, 4); }
+static void RPCBatch16Threads(benchmark::State& state) { RPCBatch(state, 16); }
+
+BENCHMARK(RPCBatch1Thread);
+BENCHMARK(RPCBatch4Threads);
+BENCHMARK(RPCBatch16Threads);
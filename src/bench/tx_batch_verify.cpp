@@ -0,0 +1,101 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "arith_uint256.h"
+#include "coins.h"
+#include "key.h"
+#include "policy/policy.h"
+#include "script/sigcache.h"
+#include "script/standard.h"
+#include "util.h"
+#include "validation.h"
+
+#include <boost/thread/thread.hpp>
+
+// A burst of independent 2-input P2PKH transactions, about the size of a PrivateSend denomination round
+// relayed by a couple of mixing masternodes
+static const size_t BURST_TXS = 200;
+static const size_t BURST_TX_INPUTS = 2;
+
+static void CreateBurst(CCoinsViewCache& view, std::vector<CTransactionRef>& vtx)
+{
+    static bool fSigCacheInitialized = false;
+    if (!fSigCacheInitialized) {
+        InitSignatureCache();
+        fSigCacheInitialized = true;
+    }
+
+    CKey key;
+    key.MakeNewKey(true);
+    CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+
+    for (size_t i = 0; i < BURST_TXS; i++) {
+        CMutableTransaction tx;
+        tx.vin.resize(BURST_TX_INPUTS);
+        for (size_t j = 0; j < BURST_TX_INPUTS; j++) {
+            tx.vin[j].prevout = COutPoint(ArithToUint256(arith_uint256(i * BURST_TX_INPUTS + j + 1)), 0);
+            view.AddCoin(tx.vin[j].prevout, Coin(CTxOut(COIN, scriptPubKey), 1, false), false);
+        }
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = scriptPubKey;
+        tx.vout[0].nValue = BURST_TX_INPUTS * COIN - 1000;
+
+        for (size_t j = 0; j < BURST_TX_INPUTS; j++) {
+            uint256 hash = SignatureHash(scriptPubKey, tx, j, SIGHASH_ALL, COIN, SIGVERSION_BASE);
+            std::vector<unsigned char> vchSig;
+            key.Sign(hash, vchSig);
+            vchSig.push_back((unsigned char)SIGHASH_ALL);
+            tx.vin[j].scriptSig = CScript() << vchSig << ToByteVector(key.GetPubKey());
+        }
+        vtx.emplace_back(MakeTransactionRef(tx));
+    }
+}
+
+// Script verification of a transaction burst, one tx after another as AcceptToMemoryPool does it while
+// holding cs_main. Each iteration verifies BURST_TXS transactions, so txs/s = BURST_TXS / time per iteration.
+static void TxBurstVerifySequential(benchmark::State& state)
+{
+    CCoinsView dummy;
+    CCoinsViewCache view(&dummy);
+    std::vector<CTransactionRef> vtx;
+    CreateBurst(view, vtx);
+
+    int nScriptCheckThreadsOld = nScriptCheckThreads;
+    nScriptCheckThreads = 0;
+    while (state.KeepRunning()) {
+        // don't store in the signature cache, otherwise all but the first iteration would only measure cache hits
+        bool fOk = CheckInputsParallel(vtx, view, STANDARD_SCRIPT_VERIFY_FLAGS, false);
+        assert(fOk);
+    }
+    nScriptCheckThreads = nScriptCheckThreadsOld;
+}
+
+// Same burst, verified as a batch on the script check threads (see PrevalidateTransactionScripts)
+static void TxBurstVerifyParallel(benchmark::State& state)
+{
+    CCoinsView dummy;
+    CCoinsViewCache view(&dummy);
+    std::vector<CTransactionRef> vtx;
+    CreateBurst(view, vtx);
+
+    int nScriptCheckThreadsOld = nScriptCheckThreads;
+    nScriptCheckThreads = std::max(2, std::min(GetNumCores(), MAX_SCRIPTCHECK_THREADS));
+    boost::thread_group threadGroup;
+    for (int i = 0; i < nScriptCheckThreads - 1; i++) {
+        threadGroup.create_thread(&ThreadScriptCheck);
+    }
+
+    while (state.KeepRunning()) {
+        bool fOk = CheckInputsParallel(vtx, view, STANDARD_SCRIPT_VERIFY_FLAGS, false);
+        assert(fOk);
+    }
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+    nScriptCheckThreads = nScriptCheckThreadsOld;
+}
+
+BENCHMARK(TxBurstVerifySequential);
+BENCHMARK(TxBurstVerifyParallel);
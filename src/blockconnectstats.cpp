@@ -0,0 +1,103 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockconnectstats.h"
+
+#include "utiltime.h"
+
+#include <univalue.h>
+
+CBlockConnectStats blockConnectStats;
+
+static const char* const BLOCK_STAGE_NAMES[BLOCK_STAGE_MAX] = {
+    "read_from_disk",
+    "prefetch_inputs",
+    "prefetch_inputs.reads",
+    "connect_total",
+    "check",
+    "forks",
+    "connect_txs",
+    "verify_scripts",
+    "xazab_specific",
+    "is_filter",
+    "subsidy",
+    "value_valid",
+    "payee_valid",
+    "special_txs",
+    "special_txs.loop",
+    "special_txs.quorums",
+    "special_txs.dmn",
+    "special_txs.merkle_roots",
+    "merkle_roots.payload",
+    "merkle_roots.mnlist",
+    "merkle_roots.quorums",
+    "mnlist.build",
+    "mnlist.sml",
+    "mnlist.merkle",
+    "quorums.mined_and_active",
+    "quorums.mined",
+    "quorums.loop",
+    "quorums.merkle",
+    "index_writes",
+    "callbacks",
+    "flush",
+    "write_chainstate",
+    "post_connect",
+    "total",
+};
+
+const char* BlockConnectStageName(BlockConnectStage stage)
+{
+    return stage < BLOCK_STAGE_MAX ? BLOCK_STAGE_NAMES[stage] : "unknown";
+}
+
+CBlockConnectStats::CBlockConnectStats() :
+    nStartTime(GetTime())
+{
+}
+
+int64_t CBlockConnectStats::Record(BlockConnectStage stage, int64_t nMicros, bool fRecord)
+{
+    LOCK(cs);
+    if (fRecord) {
+        stages[stage].Add(nMicros);
+    }
+    return stages[stage].GetTotalMicros();
+}
+
+CLatencyHistogram CBlockConnectStats::Get(BlockConnectStage stage) const
+{
+    LOCK(cs);
+    return stages[stage];
+}
+
+int64_t CBlockConnectStats::GetStartTime() const
+{
+    LOCK(cs);
+    return nStartTime;
+}
+
+void CBlockConnectStats::Reset()
+{
+    LOCK(cs);
+    for (auto& h : stages) {
+        h.Clear();
+    }
+    nStartTime = GetTime();
+}
+
+UniValue CBlockConnectStats::ToJson(bool fBuckets) const
+{
+    LOCK(cs);
+    UniValue objStages(UniValue::VOBJ);
+    for (int i = 0; i < BLOCK_STAGE_MAX; i++) {
+        objStages.push_back(Pair(BLOCK_STAGE_NAMES[i], stages[i].ToJson(fBuckets)));
+    }
+
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("since", nStartTime));
+    obj.push_back(Pair("blocks", (uint64_t)stages[BLOCK_STAGE_TOTAL].GetCount()));
+    obj.push_back(Pair("stages", objStages));
+    return obj;
+}
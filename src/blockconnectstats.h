@@ -0,0 +1,93 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_BLOCKCONNECTSTATS_H
+#define XAZAB_BLOCKCONNECTSTATS_H
+
+#include "histogram.h"
+#include "sync.h"
+
+class UniValue;
+
+/** The timed stages of connecting a block, nested stages follow their parent */
+enum BlockConnectStage {
+    // ConnectTip
+    BLOCK_STAGE_READ_FROM_DISK,
+    BLOCK_STAGE_PREFETCH_INPUTS,
+    // the read times of all prefetch threads added up, i.e. how long the reads would have taken one by one
+    BLOCK_STAGE_PREFETCH_INPUTS_READS,
+    BLOCK_STAGE_CONNECT_TOTAL,
+    // ConnectBlock
+    BLOCK_STAGE_CHECK,
+    BLOCK_STAGE_FORKS,
+    BLOCK_STAGE_CONNECT_TXS,
+    BLOCK_STAGE_VERIFY_SCRIPTS,
+    BLOCK_STAGE_XAZAB_SPECIFIC,
+    BLOCK_STAGE_IS_FILTER,
+    BLOCK_STAGE_SUBSIDY,
+    BLOCK_STAGE_VALUE_VALID,
+    BLOCK_STAGE_PAYEE_VALID,
+    BLOCK_STAGE_SPECIAL_TXS,
+    // ProcessSpecialTxsInBlock
+    BLOCK_STAGE_SPECIAL_TXS_LOOP,
+    BLOCK_STAGE_SPECIAL_TXS_QUORUMS,
+    BLOCK_STAGE_SPECIAL_TXS_DMN,
+    BLOCK_STAGE_SPECIAL_TXS_MERKLE_ROOTS,
+    // CheckCbTxMerkleRoots
+    BLOCK_STAGE_MERKLE_ROOTS_PAYLOAD,
+    BLOCK_STAGE_MERKLE_ROOTS_MNLIST,
+    BLOCK_STAGE_MERKLE_ROOTS_QUORUMS,
+    // CalcCbTxMerkleRootMNList
+    BLOCK_STAGE_MNLIST_BUILD,
+    BLOCK_STAGE_MNLIST_SML,
+    BLOCK_STAGE_MNLIST_MERKLE,
+    // CalcCbTxMerkleRootQuorums
+    BLOCK_STAGE_QUORUMS_MINED_AND_ACTIVE,
+    BLOCK_STAGE_QUORUMS_MINED,
+    BLOCK_STAGE_QUORUMS_LOOP,
+    BLOCK_STAGE_QUORUMS_MERKLE,
+    // ConnectBlock
+    BLOCK_STAGE_INDEX_WRITES,
+    BLOCK_STAGE_CALLBACKS,
+    // ConnectTip
+    BLOCK_STAGE_FLUSH,
+    BLOCK_STAGE_WRITE_CHAINSTATE,
+    BLOCK_STAGE_POST_CONNECT,
+    BLOCK_STAGE_TOTAL,
+    BLOCK_STAGE_MAX
+};
+
+const char* BlockConnectStageName(BlockConnectStage stage);
+
+/**
+ * Timings of the stages of block connection, which were previously only accumulated for the
+ * -debug=bench log lines. Each stage keeps its cumulative total, the value of the last block and
+ * a histogram.
+ */
+class CBlockConnectStats
+{
+private:
+    mutable CCriticalSection cs;
+    CLatencyHistogram stages[BLOCK_STAGE_MAX];
+    int64_t nStartTime;
+
+public:
+    CBlockConnectStats();
+
+    /**
+     * Adds a timing of stage and returns its cumulative total in microseconds. With fRecord unset
+     * (e.g. for blocks which are only checked by TestBlockValidity) nothing is added and only the
+     * total is returned.
+     */
+    int64_t Record(BlockConnectStage stage, int64_t nMicros, bool fRecord = true);
+    CLatencyHistogram Get(BlockConnectStage stage) const;
+    int64_t GetStartTime() const;
+    void Reset();
+
+    UniValue ToJson(bool fBuckets) const;
+};
+
+extern CBlockConnectStats blockConnectStats;
+
+#endif // XAZAB_BLOCKCONNECTSTATS_H
@@ -9,6 +9,7 @@
 #include "hash.h"
 #include "random.h"
 #include "streams.h"
+#include "recenttxpool.h"
 #include "txmempool.h"
 #include "validation.h"
 #include "util.h"
@@ -164,6 +165,34 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
             break;
     }
 
+    if (recentPool && mempool_count != shorttxids.size()) {
+        // Same as above, but for transactions which we've seen recently but which are not in
+        // the mempool (anymore), e.g. evicted or conflicted InstantSend locked transactions
+        std::vector<bool> have_recent_txn(txn_available.size());
+        recentPool->ForEach([&](const uint256& hash, const CTransactionRef& tx) {
+            if (mempool_count == shorttxids.size())
+                return;
+            uint64_t shortid = cmpctblock.GetShortID(hash);
+            std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
+            if (idit == shorttxids.end())
+                return;
+            if (!have_txn[idit->second]) {
+                txn_available[idit->second] = tx;
+                have_txn[idit->second]  = true;
+                have_recent_txn[idit->second] = true;
+                mempool_count++;
+                recent_count++;
+            } else if (txn_available[idit->second] && txn_available[idit->second]->GetHash() != hash) {
+                // Short ID collision with a different tx, just request it
+                txn_available[idit->second].reset();
+                mempool_count--;
+                if (have_recent_txn[idit->second]) {
+                    recent_count--;
+                }
+            }
+        });
+    }
+
     LogPrint(BCLog::CMPCTBLOCK, "Initialized PartiallyDownloadedBlock for block %s using a cmpctblock of size %lu\n", cmpctblock.header.GetHash().ToString(), GetSerializeSize(cmpctblock, SER_NETWORK, PROTOCOL_VERSION));
 
     return READ_STATUS_OK;
@@ -209,7 +238,7 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
         return READ_STATUS_CHECKBLOCK_FAILED;
     }
 
-    LogPrint(BCLog::CMPCTBLOCK, "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, vtx_missing.size());
+    LogPrint(BCLog::CMPCTBLOCK, "Successfully reconstructed block %s with %lu txn prefilled, %lu txn from mempool (incl at least %lu from extra pool and %lu from recent pool) and %lu txn requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, recent_count, vtx_missing.size());
     if (vtx_missing.size() < 5) {
         for (const auto& tx : vtx_missing) {
             LogPrint(BCLog::CMPCTBLOCK, "Reconstructed block %s required tx %s\n", hash.ToString(), tx->GetHash().ToString());
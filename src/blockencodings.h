@@ -10,6 +10,7 @@
 #include <memory>
 
 class CTxMemPool;
+class CRecentTxPool;
 
 // Dumb helper to handle CTransaction compression at serialize-time
 struct TransactionCompressor {
@@ -194,15 +195,18 @@ public:
 class PartiallyDownloadedBlock {
 protected:
     std::vector<CTransactionRef> txn_available;
-    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
+    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0, recent_count = 0;
     CTxMemPool* pool;
+    const CRecentTxPool* recentPool;
 public:
     CBlockHeader header;
-    PartiallyDownloadedBlock(CTxMemPool* poolIn) : pool(poolIn) {}
+    PartiallyDownloadedBlock(CTxMemPool* poolIn, const CRecentTxPool* recentPoolIn = nullptr) : pool(poolIn), recentPool(recentPoolIn) {}
 
     // extra_txn is a list of extra transactions to look at, in <hash, reference> form
     ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn);
     bool IsTxAvailable(size_t index) const;
+    // number of transactions which were only found in the recent tx pool
+    size_t GetRecentTxCount() const { return recent_count; }
     ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing);
 };
 
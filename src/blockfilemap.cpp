@@ -0,0 +1,248 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockfilemap.h"
+
+#include "chain.h"
+#include "consensus/consensus.h"
+#include "core_memusage.h"
+#include "primitives/block.h"
+#include "streams.h"
+#include "txdb.h"
+#include "util.h"
+#include "validation.h"
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
+// 128 MiB block files, keep the address space usage small on 32 bit systems
+CBlockFileMap blockFileMap("blk", sizeof(void*) == 4 ? 4 : 64);
+CBlockFileMap undoFileMap("rev", sizeof(void*) == 4 ? 2 : 16);
+CBlockReadCache blockReadCache(DEFAULT_BLOCK_READ_CACHE_SIZE);
+
+CMappedBlockFile::~CMappedBlockFile()
+{
+#ifndef WIN32
+    munmap((void*)data, size);
+#endif
+}
+
+std::shared_ptr<const CMappedBlockFile> CBlockFileMap::MapFile(int nFile) const
+{
+#ifndef WIN32
+    fs::path path = GetBlockPosFilename(CDiskBlockPos(nFile, 0), prefix);
+    int fd = open(path.string().c_str(), O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping stays valid after closing the file
+    close(fd);
+    if (data == MAP_FAILED) {
+        LogPrintf("%s: mmap of %s failed: %s\n", __func__, path.string(), strerror(errno));
+        return nullptr;
+    }
+    return std::make_shared<const CMappedBlockFile>((const char*)data, (size_t)st.st_size);
+#else
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<const CMappedBlockFile> CBlockFileMap::Get(int nFile, size_t nMinSize)
+{
+    std::lock_guard<std::mutex> lock(cs);
+
+    auto it = mapFiles.find(nFile);
+    if (it != mapFiles.end()) {
+        lruFiles.splice(lruFiles.end(), lruFiles, it->second.second);
+        if (it->second.first->Size() >= nMinSize) {
+            return it->second.first;
+        }
+        // the file grew since it was mapped
+        lruFiles.erase(it->second.second);
+        mapFiles.erase(it);
+    }
+
+    std::shared_ptr<const CMappedBlockFile> file = MapFile(nFile);
+    if (!file || file->Size() < nMinSize) {
+        return nullptr;
+    }
+
+    if (mapFiles.size() >= nMaxFiles) {
+        mapFiles.erase(lruFiles.front());
+        lruFiles.pop_front();
+    }
+    lruFiles.push_back(nFile);
+    mapFiles.emplace(nFile, std::make_pair(file, std::prev(lruFiles.end())));
+    return file;
+}
+
+std::shared_ptr<const CMappedBlockFile> CBlockFileMap::GetRecord(const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart,
+                                                                 unsigned int nMaxSize, unsigned int nTrailerSize, unsigned int& nSizeRet)
+{
+    if (pos.IsNull() || pos.nPos < 8) {
+        return nullptr;
+    }
+    auto file = Get(pos.nFile, pos.nPos);
+    if (!file) {
+        return nullptr;
+    }
+
+    CMessageHeader::MessageStartChars recMessageStart;
+    unsigned int nSize;
+    CMemoryReader reader(file->Data() + pos.nPos - 8, file->Data() + pos.nPos, SER_DISK, CLIENT_VERSION);
+    reader >> FLATDATA(recMessageStart) >> nSize;
+    if (memcmp(recMessageStart, messageStart, CMessageHeader::MESSAGE_START_SIZE) || nSize > nMaxSize) {
+        return nullptr;
+    }
+    if ((size_t)pos.nPos + nSize + nTrailerSize > file->Size()) {
+        // the record was appended after the file was mapped
+        file = Get(pos.nFile, (size_t)pos.nPos + nSize + nTrailerSize);
+    }
+    nSizeRet = nSize;
+    return file;
+}
+
+void CBlockFileMap::Remove(int nFile)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = mapFiles.find(nFile);
+    if (it != mapFiles.end()) {
+        lruFiles.erase(it->second.second);
+        mapFiles.erase(it);
+    }
+}
+
+void CBlockFileMap::Clear()
+{
+    std::lock_guard<std::mutex> lock(cs);
+    mapFiles.clear();
+    lruFiles.clear();
+}
+
+std::shared_ptr<const CBlock> CBlockReadCache::Get(const uint256& hash)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = mapBlocks.find(hash);
+    if (it == mapBlocks.end()) {
+        return nullptr;
+    }
+    lruBlocks.splice(lruBlocks.end(), lruBlocks, it->second);
+    return it->second->first;
+}
+
+void CBlockReadCache::Add(const std::shared_ptr<const CBlock>& pblock)
+{
+    size_t nBlockUsage = RecursiveDynamicUsage(*pblock) + sizeof(CBlock);
+    if (nBlockUsage > nMaxUsage) {
+        return;
+    }
+    uint256 hash = pblock->GetHash();
+
+    std::lock_guard<std::mutex> lock(cs);
+    if (mapBlocks.count(hash)) {
+        return;
+    }
+    while (nUsage + nBlockUsage > nMaxUsage) {
+        nUsage -= lruBlocks.front().second;
+        mapBlocks.erase(lruBlocks.front().first->GetHash());
+        lruBlocks.pop_front();
+    }
+    lruBlocks.emplace_back(pblock, nBlockUsage);
+    mapBlocks.emplace(hash, std::prev(lruBlocks.end()));
+    nUsage += nBlockUsage;
+}
+
+void CBlockReadCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(cs);
+    mapBlocks.clear();
+    lruBlocks.clear();
+    nUsage = 0;
+}
+
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& vch, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart)
+{
+    // every block is preceded by the network magic and its size
+    if (pos.IsNull() || pos.nPos < 8) {
+        return error("%s: invalid position %s", __func__, pos.ToString());
+    }
+
+    CMessageHeader::MessageStartChars blkMessageStart;
+    unsigned int nSize;
+    auto file = blockFileMap.GetRecord(pos, messageStart, MaxBlockSize(true), 0, nSize);
+    if (file) {
+        vch.insert(vch.end(), file->Data() + pos.nPos, file->Data() + pos.nPos + nSize);
+        return true;
+    }
+
+    // no mapping available, read it the usual way (this also reports invalid headers)
+    CAutoFile filein(OpenBlockFile(CDiskBlockPos(pos.nFile, pos.nPos - 8), true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+    }
+    try {
+        filein >> FLATDATA(blkMessageStart) >> nSize;
+        if (memcmp(blkMessageStart, messageStart, CMessageHeader::MESSAGE_START_SIZE) || nSize > MaxBlockSize(true)) {
+            return error("%s: invalid block header at %s", __func__, pos.ToString());
+        }
+        size_t nOldSize = vch.size();
+        vch.resize(nOldSize + nSize);
+        filein.read((char*)vch.data() + nOldSize, nSize);
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+    }
+    return true;
+}
+
+bool ReadRawTxFromDisk(std::vector<unsigned char>& vch, const CDiskTxPos& postx, uint256& hashBlock)
+{
+    if (postx.IsNull()) {
+        return error("%s: invalid position", __func__);
+    }
+
+    CBlockHeader header;
+    CMutableTransaction tx;
+    auto file = blockFileMap.Get(postx.nFile, postx.nPos);
+    if (file) {
+        CMemoryReader reader(file->Data() + postx.nPos, file->Data() + file->Size(), SER_DISK, CLIENT_VERSION);
+        try {
+            reader >> header;
+            reader.ignore(postx.nTxOffset);
+            const char* pbegin = reader.GetPos();
+            reader >> tx;
+            vch.insert(vch.end(), pbegin, reader.GetPos());
+            hashBlock = header.GetHash();
+            return true;
+        } catch (const std::exception& e) {
+            // the block might have been appended after the file was mapped, try again without the mapping
+        }
+    }
+
+    CAutoFile filein(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__, postx.ToString());
+    }
+    try {
+        filein >> header;
+        fseek(filein.Get(), postx.nTxOffset, SEEK_CUR);
+        filein >> tx;
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), postx.ToString());
+    }
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, vch, vch.size()) << tx;
+    hashBlock = header.GetHash();
+    return true;
+}
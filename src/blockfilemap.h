@@ -0,0 +1,113 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_BLOCKFILEMAP_H
+#define XAZAB_BLOCKFILEMAP_H
+
+#include "protocol.h"
+#include "saltedhasher.h"
+#include "uint256.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+struct CDiskBlockPos;
+struct CDiskTxPos;
+
+//! Memory usage of the deserialized blocks kept by blockReadCache
+static const size_t DEFAULT_BLOCK_READ_CACHE_SIZE = 32 * 1024 * 1024;
+
+/** A read-only memory mapping of a whole blk?????.dat or rev?????.dat file */
+class CMappedBlockFile
+{
+private:
+    const char* data;
+    size_t size;
+
+public:
+    CMappedBlockFile(const char* dataIn, size_t sizeIn) : data(dataIn), size(sizeIn) {}
+    ~CMappedBlockFile();
+
+    CMappedBlockFile(const CMappedBlockFile&) = delete;
+    CMappedBlockFile& operator=(const CMappedBlockFile&) = delete;
+
+    const char* Data() const { return data; }
+    size_t Size() const { return size; }
+};
+
+/**
+ * Cache of memory mapped block (or undo) files, so that readers don't pay for fopen/fseek/fclose on every
+ * block or transaction. Mappings are shared, so they stay valid for the readers which use them even after
+ * they were evicted or their file was pruned.
+ */
+class CBlockFileMap
+{
+private:
+    std::mutex cs;
+    const char* const prefix;
+    const size_t nMaxFiles;
+    // least recently used files first
+    std::list<int> lruFiles;
+    std::map<int, std::pair<std::shared_ptr<const CMappedBlockFile>, std::list<int>::iterator> > mapFiles;
+
+    std::shared_ptr<const CMappedBlockFile> MapFile(int nFile) const;
+
+public:
+    CBlockFileMap(const char* prefixIn, size_t nMaxFilesIn) : prefix(prefixIn), nMaxFiles(nMaxFilesIn) {}
+
+    /**
+     * Returns a mapping of file nFile which covers at least nMinSize bytes. The file is mapped again
+     * if it grew since it was mapped. Returns nullptr if the file doesn't exist or can't be mapped.
+     */
+    std::shared_ptr<const CMappedBlockFile> Get(int nFile, size_t nMinSize);
+    /**
+     * Returns a mapping which covers the record (block or undo data) at pos plus nTrailerSize bytes after it,
+     * and sets nSizeRet to the size of the record. Every record is preceded by the network magic and its
+     * size, nullptr is returned if those don't match or the mapping isn't available.
+     */
+    std::shared_ptr<const CMappedBlockFile> GetRecord(const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart,
+                                                      unsigned int nMaxSize, unsigned int nTrailerSize, unsigned int& nSizeRet);
+    /** Drops the mapping of nFile, e.g. when it is pruned */
+    void Remove(int nFile);
+    void Clear();
+};
+
+/**
+ * LRU cache of recently read or connected blocks. The same recent blocks are read again and again by
+ * block relay, the validation interface listeners and RPC/REST, this saves deserializing them each time.
+ */
+class CBlockReadCache
+{
+private:
+    std::mutex cs;
+    const size_t nMaxUsage;
+    size_t nUsage{0};
+    // least recently used blocks first
+    std::list<std::pair<std::shared_ptr<const CBlock>, size_t> > lruBlocks;
+    std::unordered_map<uint256, decltype(lruBlocks)::iterator, StaticSaltedHasher> mapBlocks;
+
+public:
+    explicit CBlockReadCache(size_t nMaxUsageIn) : nMaxUsage(nMaxUsageIn) {}
+
+    std::shared_ptr<const CBlock> Get(const uint256& hash);
+    void Add(const std::shared_ptr<const CBlock>& pblock);
+    void Clear();
+};
+
+extern CBlockFileMap blockFileMap;
+extern CBlockFileMap undoFileMap;
+extern CBlockReadCache blockReadCache;
+
+/** Appends the serialized block at pos to vch. Reads from a memory mapping of its block file if possible. */
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& vch, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
+/** Appends the serialized transaction at postx to vch and sets hashBlock to the hash of its block */
+bool ReadRawTxFromDisk(std::vector<unsigned char>& vch, const CDiskTxPos& postx, uint256& hashBlock);
+
+#endif // XAZAB_BLOCKFILEMAP_H
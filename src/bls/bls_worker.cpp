@@ -56,20 +56,21 @@ CBLSWorker::CBLSWorker()
 CBLSWorker::~CBLSWorker()
 {
     Stop();
+    workerPool.reset();
 }
 
 void CBLSWorker::Start()
 {
-    int workerCount = std::thread::hardware_concurrency() / 2;
-    workerCount = std::max(std::min(1, workerCount), 4);
-    workerPool.resize(workerCount);
-    RenameThreadPool(workerPool, "xazab-bls-worker");
+    // the work runs on the shared executor, at most 4 tasks at once
+    workerPool.reset(new CTaskGroup(g_executor, "bls", 4));
 }
 
 void CBLSWorker::Stop()
 {
-    workerPool.clear_queue();
-    workerPool.stop(true);
+    // keep the group around, late pushes from other threads are dropped by it instead of hitting a null pointer
+    if (workerPool) {
+        workerPool->Stop();
+    }
 }
 
 bool CBLSWorker::GenerateContributions(int quorumThreshold, const BLSIdVector& ids, BLSVerificationVectorPtr& vvecRet, BLSSecretKeyVector& skShares)
@@ -93,7 +94,7 @@ bool CBLSWorker::GenerateContributions(int quorumThreshold, const BLSIdVector& i
             }
             return true;
         };
-        futures.emplace_back(workerPool.push(f));
+        futures.emplace_back(workerPool->Push(f));
     }
 
     for (size_t i = 0; i < ids.size(); i += batchSize) {
@@ -107,7 +108,7 @@ bool CBLSWorker::GenerateContributions(int quorumThreshold, const BLSIdVector& i
             }
             return true;
         };
-        futures.emplace_back(workerPool.push(f));
+        futures.emplace_back(workerPool->Push(f));
     }
     bool success = true;
     for (auto& f : futures) {
@@ -134,7 +135,7 @@ struct Aggregator {
     std::shared_ptr<std::vector<const T*> > inputVec;
 
     bool parallel;
-    ctpl::thread_pool& workerPool;
+    CTaskGroup& workerPool;
 
     std::mutex m;
     // items in the queue are all intermediate aggregation results of finished batches.
@@ -153,7 +154,7 @@ struct Aggregator {
     Aggregator(const std::vector<TP>& _inputVec,
                size_t start, size_t count,
                bool _parallel,
-               ctpl::thread_pool& _workerPool,
+               CTaskGroup& _workerPool,
                DoneCallback _doneCallback) :
             workerPool(_workerPool),
             parallel(_parallel),
@@ -314,7 +315,7 @@ struct Aggregator {
     template <typename Callable>
     void PushWork(Callable&& f)
     {
-        workerPool.push(f);
+        workerPool.Push(f);
     }
 };
 
@@ -342,7 +343,7 @@ struct VectorAggregator {
     size_t start;
     size_t count;
     bool parallel;
-    ctpl::thread_pool& workerPool;
+    CTaskGroup& workerPool;
 
     std::atomic<size_t> doneCount;
 
@@ -351,7 +352,7 @@ struct VectorAggregator {
 
     VectorAggregator(const VectorVectorType& _vecs,
                      size_t _start, size_t _count,
-                     bool _parallel, ctpl::thread_pool& _workerPool,
+                     bool _parallel, CTaskGroup& _workerPool,
                      DoneCallback _doneCallback) :
             vecs(_vecs),
             parallel(_parallel),
@@ -422,7 +423,7 @@ struct ContributionVerifier {
     bool parallel;
     bool aggregated;
 
-    ctpl::thread_pool& workerPool;
+    CTaskGroup& workerPool;
 
     size_t batchCount;
     size_t verifyCount;
@@ -433,7 +434,7 @@ struct ContributionVerifier {
 
     ContributionVerifier(const CBLSId& _forId, const std::vector<BLSVerificationVectorPtr>& _vvecs,
                          const BLSSecretKeyVector& _skShares, size_t _batchSize,
-                         bool _parallel, bool _aggregated, ctpl::thread_pool& _workerPool,
+                         bool _parallel, bool _aggregated, CTaskGroup& _workerPool,
                          std::function<void(const std::vector<bool>&)> _doneCallback) :
         forId(_forId),
         vvecs(_vvecs),
@@ -590,7 +591,7 @@ struct ContributionVerifier {
     void PushOrDoWork(Callable&& f)
     {
         if (parallel) {
-            workerPool.push(std::move(f));
+            workerPool.Push(std::move(f));
         } else {
             f(0);
         }
@@ -613,7 +614,7 @@ void CBLSWorker::AsyncBuildQuorumVerificationVector(const std::vector<BLSVerific
         return;
     }
 
-    auto agg = new VectorAggregator<CBLSPublicKey>(vvecs, start, count, parallel, workerPool, std::move(doneCallback));
+    auto agg = new VectorAggregator<CBLSPublicKey>(vvecs, start, count, parallel, *workerPool, std::move(doneCallback));
     agg->Start();
 }
 
@@ -632,7 +633,7 @@ BLSVerificationVectorPtr CBLSWorker::BuildQuorumVerificationVector(const std::ve
 }
 
 template <typename T>
-void AsyncAggregateHelper(ctpl::thread_pool& workerPool,
+void AsyncAggregateHelper(CTaskGroup& workerPool,
                           const std::vector<T>& vec, size_t start, size_t count, bool parallel,
                           std::function<void(const T&)> doneCallback)
 {
@@ -656,7 +657,7 @@ void CBLSWorker::AsyncAggregateSecretKeys(const BLSSecretKeyVector& secKeys,
                                           size_t start, size_t count, bool parallel,
                                           std::function<void(const CBLSSecretKey&)> doneCallback)
 {
-    AsyncAggregateHelper(workerPool, secKeys, start, count, parallel, doneCallback);
+    AsyncAggregateHelper(*workerPool, secKeys, start, count, parallel, doneCallback);
 }
 
 std::future<CBLSSecretKey> CBLSWorker::AsyncAggregateSecretKeys(const BLSSecretKeyVector& secKeys,
@@ -677,7 +678,7 @@ void CBLSWorker::AsyncAggregatePublicKeys(const BLSPublicKeyVector& pubKeys,
                                           size_t start, size_t count, bool parallel,
                                           std::function<void(const CBLSPublicKey&)> doneCallback)
 {
-    AsyncAggregateHelper(workerPool, pubKeys, start, count, parallel, doneCallback);
+    AsyncAggregateHelper(*workerPool, pubKeys, start, count, parallel, doneCallback);
 }
 
 std::future<CBLSPublicKey> CBLSWorker::AsyncAggregatePublicKeys(const BLSPublicKeyVector& pubKeys,
@@ -698,7 +699,7 @@ void CBLSWorker::AsyncAggregateSigs(const BLSSignatureVector& sigs,
                                     size_t start, size_t count, bool parallel,
                                     std::function<void(const CBLSSignature&)> doneCallback)
 {
-    AsyncAggregateHelper(workerPool, sigs, start, count, parallel, doneCallback);
+    AsyncAggregateHelper(*workerPool, sigs, start, count, parallel, doneCallback);
 }
 
 std::future<CBLSSignature> CBLSWorker::AsyncAggregateSigs(const BLSSignatureVector& sigs,
@@ -733,7 +734,7 @@ void CBLSWorker::AsyncVerifyContributionShares(const CBLSId& forId, const std::v
         return;
     }
 
-    auto verifier = new ContributionVerifier(forId, vvecs, skShares, 8, parallel, aggregated, workerPool, std::move(doneCallback));
+    auto verifier = new ContributionVerifier(forId, vvecs, skShares, 8, parallel, aggregated, *workerPool, std::move(doneCallback));
     verifier->Start();
 }
 
@@ -770,7 +771,7 @@ std::future<bool> CBLSWorker::AsyncVerifyContributionShare(const CBLSId& forId,
         CBLSPublicKey pk2 = skContribution.GetPublicKey();
         return pk1 == pk2;
     };
-    return workerPool.push(f);
+    return workerPool->Push(f);
 }
 
 bool CBLSWorker::VerifyContributionShare(const CBLSId& forId, const BLSVerificationVectorPtr& vvec,
@@ -832,7 +833,7 @@ bool CBLSWorker::VerifySignatureVector(const BLSSignatureVector& sigs, size_t st
 
 void CBLSWorker::AsyncSign(const CBLSSecretKey& secKey, const uint256& msgHash, CBLSWorker::SignDoneCallback doneCallback)
 {
-    workerPool.push([secKey, msgHash, doneCallback](int threadId) {
+    workerPool->Push([secKey, msgHash, doneCallback](int threadId) {
         doneCallback(secKey.Sign(msgHash));
     });
 }
@@ -956,5 +957,5 @@ void CBLSWorker::PushSigVerifyBatch()
     sigVerifyQueue.reserve(SIG_VERIFY_BATCH_SIZE);
 
     sigVerifyBatchesInProgress++;
-    workerPool.push(f, batch);
+    workerPool->Push(f, batch);
 }
@@ -6,8 +6,7 @@
 #define XAZAB_CRYPTO_BLS_WORKER_H
 
 #include "bls.h"
-
-#include "ctpl.h"
+#include "executor.h"
 
 #include <future>
 #include <mutex>
@@ -26,7 +25,7 @@ public:
     typedef std::function<bool()> CancelCond;
 
 private:
-    ctpl::thread_pool workerPool;
+    std::unique_ptr<CTaskGroup> workerPool;
 
     static const int SIG_VERIFY_BATCH_SIZE = 8;
     struct SigVerifyJob {
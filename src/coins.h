@@ -12,13 +12,19 @@
 #include "hash.h"
 #include "memusage.h"
 #include "serialize.h"
+#include "support/allocators/pool.h"
 #include "uint256.h"
 
 #include <assert.h>
+#include <memory>
 #include <stdint.h>
 
 #include <unordered_map>
 
+//! Allocate the entries of coins caches from a pool instead of one heap allocation per entry
+static const bool DEFAULT_COINS_CACHE_POOL = false;
+extern bool fCoinsCachePool;
+
 /**
  * A UTXO entry.
  *
@@ -119,7 +125,10 @@ struct CCoinsCacheEntry
     explicit CCoinsCacheEntry(Coin&& coin_) : coin(std::move(coin_)), flags(0) {}
 };
 
-typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher> CCoinsMap;
+// Large enough for the nodes of CCoinsMap, which hold the entry and a few pointers
+typedef CPoolResource<sizeof(std::pair<const COutPoint, CCoinsCacheEntry>) + sizeof(void*) * 4, alignof(void*)> CCoinsMapResource;
+typedef std::unordered_map<COutPoint, CCoinsCacheEntry, SaltedOutpointHasher, std::equal_to<COutPoint>,
+                           CPoolAllocator<std::pair<const COutPoint, CCoinsCacheEntry>, CCoinsMapResource> > CCoinsMap;
 
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor
@@ -206,6 +215,8 @@ protected:
      * declared as "const".  
      */
     mutable uint256 hashBlock;
+    //! Only set if fCoinsCachePool was set when the cache was created, cacheCoins allocates from it then
+    std::unique_ptr<CCoinsMapResource> cacheCoinsResource;
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
@@ -249,6 +260,12 @@ public:
      */
     void AddCoin(const COutPoint& outpoint, Coin&& coin, bool potential_overwrite);
 
+    /**
+     * Add a coin which was read from the base view ahead of time, exactly as if it had been fetched by
+     * a lookup of outpoint. Does nothing if outpoint is cached already.
+     */
+    void AddFetchedCoin(const COutPoint& outpoint, Coin&& coin);
+
     /**
      * Spend a coin. Pass moveto in order to get the deleted data.
      * If no unspent output exists for the passed outpoint, this call
@@ -291,6 +308,9 @@ public:
 private:
     CCoinsMap::iterator FetchCoin(const COutPoint &outpoint) const;
 
+    //! Replaces the (empty) cacheCoins and its pool, so the memory of the pool is given back
+    void ResetPool();
+
     /**
      * By making the copy constructor private, we prevent accidentally using it when one intends to create a cache on top of a base cache.
      */
@@ -11,6 +11,7 @@
 #include <vector>
 
 class CBlock;
+class CJSONWriter;
 class CScript;
 class CTransaction;
 struct CMutableTransaction;
@@ -34,5 +35,8 @@ std::string FormatScript(const CScript& script);
 std::string EncodeHexTx(const CTransaction& tx);
 void ScriptPubKeyToUniv(const CScript& scriptPubKey, UniValue& out, bool fIncludeHex);
 void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, const CSpentIndexTxInfo* ptxSpentInfo = nullptr);
+/** Same as ScriptPubKeyToUniv/TxToUniv, but writes the keys directly into the open object of a CJSONWriter */
+void ScriptPubKeyToJSON(const CScript& scriptPubKey, CJSONWriter& out, bool fIncludeHex);
+void TxToJSON(const CTransaction& tx, const uint256& hashBlock, CJSONWriter& entry, const CSpentIndexTxInfo* ptxSpentInfo = nullptr);
 
 #endif // BITCOIN_CORE_IO_H
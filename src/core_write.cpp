@@ -5,6 +5,7 @@
 #include "core_io.h"
 
 #include "base58.h"
+#include "jsonwriter.h"
 #include "primitives/transaction.h"
 #include "script/script.h"
 #include "script/standard.h"
@@ -159,6 +160,53 @@ void ScriptPubKeyToUniv(const CScript& scriptPubKey,
     out.pushKV("addresses", a);
 }
 
+static void TxPayloadToUniv(const CTransaction& tx, UniValue& entry)
+{
+    if (tx.nType == TRANSACTION_PROVIDER_REGISTER) {
+        CProRegTx proTx;
+        if (GetTxPayload(tx, proTx)) {
+            UniValue obj;
+            proTx.ToJson(obj);
+            entry.push_back(Pair("proRegTx", obj));
+        }
+    } else if (tx.nType == TRANSACTION_PROVIDER_UPDATE_SERVICE) {
+        CProUpServTx proTx;
+        if (GetTxPayload(tx, proTx)) {
+            UniValue obj;
+            proTx.ToJson(obj);
+            entry.push_back(Pair("proUpServTx", obj));
+        }
+    } else if (tx.nType == TRANSACTION_PROVIDER_UPDATE_REGISTRAR) {
+        CProUpRegTx proTx;
+        if (GetTxPayload(tx, proTx)) {
+            UniValue obj;
+            proTx.ToJson(obj);
+            entry.push_back(Pair("proUpRegTx", obj));
+        }
+    } else if (tx.nType == TRANSACTION_PROVIDER_UPDATE_REVOKE) {
+        CProUpRevTx proTx;
+        if (GetTxPayload(tx, proTx)) {
+            UniValue obj;
+            proTx.ToJson(obj);
+            entry.push_back(Pair("proUpRevTx", obj));
+        }
+    } else if (tx.nType == TRANSACTION_COINBASE) {
+        CCbTx cbTx;
+        if (GetTxPayload(tx, cbTx)) {
+            UniValue obj;
+            cbTx.ToJson(obj);
+            entry.push_back(Pair("cbTx", obj));
+        }
+    } else if (tx.nType == TRANSACTION_QUORUM_COMMITMENT) {
+        llmq::CFinalCommitmentTxPayload qcTx;
+        if (GetTxPayload(tx, qcTx)) {
+            UniValue obj;
+            qcTx.ToJson(obj);
+            entry.push_back(Pair("qcTx", obj));
+        }
+    }
+}
+
 void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, const CSpentIndexTxInfo* ptxSpentInfo)
 {
     uint256 txid = tx.GetHash();
@@ -236,47 +284,120 @@ void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry,
         entry.push_back(Pair("extraPayload", HexStr(tx.vExtraPayload)));
     }
 
-    if (tx.nType == TRANSACTION_PROVIDER_REGISTER) {
-        CProRegTx proTx;
-        if (GetTxPayload(tx, proTx)) {
-            UniValue obj;
-            proTx.ToJson(obj);
-            entry.push_back(Pair("proRegTx", obj));
-        }
-    } else if (tx.nType == TRANSACTION_PROVIDER_UPDATE_SERVICE) {
-        CProUpServTx proTx;
-        if (GetTxPayload(tx, proTx)) {
-            UniValue obj;
-            proTx.ToJson(obj);
-            entry.push_back(Pair("proUpServTx", obj));
-        }
-    } else if (tx.nType == TRANSACTION_PROVIDER_UPDATE_REGISTRAR) {
-        CProUpRegTx proTx;
-        if (GetTxPayload(tx, proTx)) {
-            UniValue obj;
-            proTx.ToJson(obj);
-            entry.push_back(Pair("proUpRegTx", obj));
-        }
-    } else if (tx.nType == TRANSACTION_PROVIDER_UPDATE_REVOKE) {
-        CProUpRevTx proTx;
-        if (GetTxPayload(tx, proTx)) {
-            UniValue obj;
-            proTx.ToJson(obj);
-            entry.push_back(Pair("proUpRevTx", obj));
+    TxPayloadToUniv(tx, entry);
+
+    if (!hashBlock.IsNull())
+        entry.pushKV("blockhash", hashBlock.GetHex());
+
+    entry.pushKV("hex", EncodeHexTx(tx)); // the hex-encoded transaction. used the name "hex" to be consistent with the verbose output of "getrawtransaction".
+}
+
+void ScriptPubKeyToJSON(const CScript& scriptPubKey, CJSONWriter& out, bool fIncludeHex)
+{
+    txnouttype type;
+    std::vector<CTxDestination> addresses;
+    int nRequired;
+
+    out.pushKV("asm", ScriptToAsmStr(scriptPubKey));
+    if (fIncludeHex)
+        out.pushKV("hex", HexStr(scriptPubKey.begin(), scriptPubKey.end()));
+
+    if (!ExtractDestinations(scriptPubKey, type, addresses, nRequired)) {
+        out.pushKV("type", GetTxnOutputType(type));
+        return;
+    }
+
+    out.pushKV("reqSigs", nRequired);
+    out.pushKV("type", GetTxnOutputType(type));
+
+    out.Key("addresses").BeginArray();
+    for (const CTxDestination& addr : addresses)
+        out.Value(CBitcoinAddress(addr).ToString());
+    out.EndArray();
+}
+
+void TxToJSON(const CTransaction& tx, const uint256& hashBlock, CJSONWriter& entry, const CSpentIndexTxInfo* ptxSpentInfo)
+{
+    uint256 txid = tx.GetHash();
+    entry.pushKV("txid", txid.GetHex());
+    entry.pushKV("version", tx.nVersion);
+    entry.pushKV("type", tx.nType);
+    entry.pushKV("size", (int)::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION));
+    entry.pushKV("locktime", (int64_t)tx.nLockTime);
+
+    entry.Key("vin").BeginArray();
+    for (const CTxIn& txin : tx.vin) {
+        entry.BeginObject();
+        if (tx.IsCoinBase())
+            entry.pushKV("coinbase", HexStr(txin.scriptSig.begin(), txin.scriptSig.end()));
+        else {
+            entry.pushKV("txid", txin.prevout.hash.GetHex());
+            entry.pushKV("vout", (int64_t)txin.prevout.n);
+            entry.Key("scriptSig").BeginObject();
+            entry.pushKV("asm", ScriptToAsmStr(txin.scriptSig, true));
+            entry.pushKV("hex", HexStr(txin.scriptSig.begin(), txin.scriptSig.end()));
+            entry.EndObject();
+
+            // Add address and value info if spentindex enabled
+            if (ptxSpentInfo != nullptr) {
+                CSpentIndexKey spentKey(txin.prevout.hash, txin.prevout.n);
+                auto it = ptxSpentInfo->mSpentInfo.find(spentKey);
+                if (it != ptxSpentInfo->mSpentInfo.end()) {
+                    auto spentInfo = it->second;
+                    entry.Key("value").ValueAmount(spentInfo.satoshis);
+                    entry.pushKV("valueSat", spentInfo.satoshis);
+                    if (spentInfo.addressType == 1) {
+                        entry.pushKV("address", CBitcoinAddress(CKeyID(spentInfo.addressHash)).ToString());
+                    } else if (spentInfo.addressType == 2) {
+                        entry.pushKV("address", CBitcoinAddress(CScriptID(spentInfo.addressHash)).ToString());
+                    }
+                }
+            }
         }
-    } else if (tx.nType == TRANSACTION_COINBASE) {
-        CCbTx cbTx;
-        if (GetTxPayload(tx, cbTx)) {
-            UniValue obj;
-            cbTx.ToJson(obj);
-            entry.push_back(Pair("cbTx", obj));
+        entry.pushKV("sequence", (int64_t)txin.nSequence);
+        entry.EndObject();
+    }
+    entry.EndArray();
+
+    entry.Key("vout").BeginArray();
+    for (unsigned int i = 0; i < tx.vout.size(); i++) {
+        const CTxOut& txout = tx.vout[i];
+
+        entry.BeginObject();
+        entry.Key("value").ValueAmount(txout.nValue);
+        entry.pushKV("valueSat", txout.nValue);
+        entry.pushKV("n", (int64_t)i);
+
+        entry.Key("scriptPubKey").BeginObject();
+        ScriptPubKeyToJSON(txout.scriptPubKey, entry, true);
+        entry.EndObject();
+
+        // Add spent information if spentindex is enabled
+        if (ptxSpentInfo != nullptr) {
+            CSpentIndexKey spentKey(txid, i);
+            auto it = ptxSpentInfo->mSpentInfo.find(spentKey);
+            if (it != ptxSpentInfo->mSpentInfo.end()) {
+                auto spentInfo = it->second;
+                entry.pushKV("spentTxId", spentInfo.txid.GetHex());
+                entry.pushKV("spentIndex", (int)spentInfo.inputIndex);
+                entry.pushKV("spentHeight", spentInfo.blockHeight);
+            }
         }
-    } else if (tx.nType == TRANSACTION_QUORUM_COMMITMENT) {
-        llmq::CFinalCommitmentTxPayload qcTx;
-        if (GetTxPayload(tx, qcTx)) {
-            UniValue obj;
-            qcTx.ToJson(obj);
-            entry.push_back(Pair("qcTx", obj));
+        entry.EndObject();
+    }
+    entry.EndArray();
+
+    if (!tx.vExtraPayload.empty()) {
+        entry.pushKV("extraPayloadSize", (int)tx.vExtraPayload.size());
+        entry.pushKV("extraPayload", HexStr(tx.vExtraPayload));
+    }
+
+    // special transactions are rare, write their payloads through their UniValue representation
+    if (tx.nType != TRANSACTION_NORMAL) {
+        UniValue obj(UniValue::VOBJ);
+        TxPayloadToUniv(tx, obj);
+        for (size_t i = 0; i < obj.size(); i++) {
+            entry.pushKV(obj.getKeys()[i], obj.getValues()[i]);
         }
     }
 
@@ -13,13 +13,38 @@
 #include <leveldb/filter_policy.h>
 #include <memenv.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <sstream>
 
 class CBitcoinLevelDBLogger : public leveldb::Logger {
 public:
+    // LevelDB doesn't expose these as properties, so count the messages it logs about them
+    std::atomic<uint64_t> nCompactions{0};
+    std::atomic<uint64_t> nTrivialMoves{0};
+    std::atomic<uint64_t> nMemtableFlushes{0};
+    std::atomic<uint64_t> nWriteStalls{0};
+
+    void CountEvent(const char* format)
+    {
+        if (strncmp(format, "Compacted ", 10) == 0) {
+            nCompactions++;
+        } else if (strncmp(format, "Moved #", 7) == 0) {
+            nTrivialMoves++;
+        } else if (strncmp(format, "Level-0 table #", 15) == 0 && strstr(format, ": started")) {
+            nMemtableFlushes++;
+        } else if (strstr(format, "; waiting...")) {
+            nWriteStalls++;
+        }
+    }
+
     // This code is adapted from posix_logger.h, which is why it is using vsprintf.
     // Please do not do this in normal code
     virtual void Logv(const char * format, va_list ap) override {
+            CountEvent(format);
             if (!LogAcceptCategory(BCLog::LEVELDB)) {
                 return;
             }
@@ -73,14 +98,131 @@ public:
     }
 };
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+static bool ApplyDBTuningProfile(const std::string& strProfile, CDBTuning& tuning)
+{
+    if (strProfile == "default") {
+        tuning = CDBTuning();
+    } else if (strProfile == "randomread") {
+        // point lookups of keys which often don't exist, spend more memory on bloom filters to avoid reading blocks
+        tuning = CDBTuning();
+        tuning.nBloomBits = 16;
+    } else if (strProfile == "scan") {
+        // mostly iteration over key ranges, larger and compressed blocks mean less blocks to read
+        tuning = CDBTuning();
+        tuning.nBlockSize = 64 * 1024;
+        tuning.nMaxFileSize = 8 * 1024 * 1024;
+        tuning.fCompression = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool ParseDBTuningSize(const std::string& strValue, size_t nMin, size_t nMax, size_t& nRet)
+{
+    int64_t n;
+    if (!ParseInt64(strValue, &n) || n < (int64_t)nMin || (uint64_t)n > nMax) {
+        return false;
+    }
+    nRet = (size_t)n;
+    return true;
+}
+
+static bool ApplyDBTuningOption(const std::string& strOption, const std::string& strValue, CDBTuning& tuning)
+{
+    size_t n;
+    if (strOption == "profile") {
+        return ApplyDBTuningProfile(strValue, tuning);
+    } else if (strOption == "blocksize") {
+        if (!ParseDBTuningSize(strValue, 1024, 4 * 1024 * 1024, n)) return false;
+        tuning.nBlockSize = n;
+    } else if (strOption == "bloombits") {
+        if (!ParseDBTuningSize(strValue, 0, 64, n)) return false;
+        tuning.nBloomBits = (int)n;
+    } else if (strOption == "writebuffer") {
+        if (strValue != "0" && !ParseDBTuningSize(strValue, 64 * 1024, 1024 * 1024 * 1024, n)) return false;
+        tuning.nWriteBufferSize = strValue == "0" ? 0 : n;
+    } else if (strOption == "maxfilesize") {
+        if (!ParseDBTuningSize(strValue, 1024 * 1024, 1024 * 1024 * 1024, n)) return false;
+        tuning.nMaxFileSize = n;
+    } else if (strOption == "compression") {
+        if (strValue != "0" && strValue != "1") return false;
+        tuning.fCompression = strValue == "1";
+    } else if (strOption == "maxopenfiles") {
+        if (!ParseDBTuningSize(strValue, 64, 50000, n)) return false;
+        tuning.nMaxOpenFiles = (int)n;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Splits "<name>:<option>=<value>"
+static bool SplitDBTuningArg(const std::string& strArg, std::string& strName, std::string& strOption, std::string& strValue)
+{
+    size_t nColon = strArg.find(':');
+    size_t nEquals = strArg.find('=', nColon == std::string::npos ? 0 : nColon);
+    if (nColon == std::string::npos || nColon == 0 || nEquals == std::string::npos) {
+        return false;
+    }
+    strName = strArg.substr(0, nColon);
+    strOption = strArg.substr(nColon + 1, nEquals - nColon - 1);
+    strValue = strArg.substr(nEquals + 1);
+    return true;
+}
+
+bool GetDBTuning(const std::string& strName, CDBTuning& tuningRet, std::string& strError)
+{
+    tuningRet = CDBTuning();
+    if (strName.empty()) {
+        return true;
+    }
+    for (const std::string& strArg : gArgs.GetArgs("-dbtuning")) {
+        std::string strArgName, strOption, strValue;
+        if (!SplitDBTuningArg(strArg, strArgName, strOption, strValue)) {
+            strError = strprintf("Invalid -dbtuning argument %s, expected <name>:<option>=<value>", strArg);
+            return false;
+        }
+        if (strArgName != strName) {
+            continue;
+        }
+        if (!ApplyDBTuningOption(strOption, strValue, tuningRet)) {
+            strError = strprintf("Invalid -dbtuning option or value %s", strArg);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CheckDBTuningArgs(const std::set<std::string>& setNames, std::string& strError)
+{
+    for (const std::string& strArg : gArgs.GetArgs("-dbtuning")) {
+        std::string strName, strOption, strValue;
+        if (SplitDBTuningArg(strArg, strName, strOption, strValue) && !setNames.count(strName)) {
+            strError = strprintf("Unknown database %s in -dbtuning argument %s", strName, strArg);
+            return false;
+        }
+    }
+    CDBTuning tuning;
+    for (const std::string& strName : setNames) {
+        if (!GetDBTuning(strName, tuning, strError)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static leveldb::Options GetOptions(size_t nCacheSize, const CDBTuning& tuning)
 {
     leveldb::Options options;
     options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
-    options.compression = leveldb::kNoCompression;
-    options.max_open_files = 64;
+    // up to two write buffers may be held in memory simultaneously
+    options.write_buffer_size = tuning.nWriteBufferSize ? tuning.nWriteBufferSize : nCacheSize / 4;
+    options.block_size = tuning.nBlockSize;
+    options.max_file_size = tuning.nMaxFileSize;
+    options.filter_policy = tuning.nBloomBits ? leveldb::NewBloomFilterPolicy(tuning.nBloomBits) : nullptr;
+    options.compression = tuning.fCompression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    options.max_open_files = tuning.nMaxOpenFiles;
     options.info_log = new CBitcoinLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
         // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
@@ -90,14 +232,23 @@ static leveldb::Options GetOptions(size_t nCacheSize)
     return options;
 }
 
-CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bool fWipe, bool obfuscate)
+// All open databases, for getdbstats
+static std::mutex csOpenDBs;
+static std::vector<const CDBWrapper*> vOpenDBs;
+
+CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSizeIn, bool fMemoryIn, bool fWipe, bool obfuscate, const std::string& strNameIn) :
+    strName(strNameIn), strPath(path.string()), fMemory(fMemoryIn), nCacheSize(nCacheSizeIn)
 {
     penv = nullptr;
     readoptions.verify_checksums = true;
     iteroptions.verify_checksums = true;
     iteroptions.fill_cache = false;
     syncoptions.sync = true;
-    options = GetOptions(nCacheSize);
+    std::string strError;
+    if (!GetDBTuning(strName, tuning, strError)) {
+        throw dbwrapper_error(strError);
+    }
+    options = GetOptions(nCacheSize, tuning);
     options.create_if_missing = true;
     if (fMemory) {
         penv = leveldb::NewMemEnv(leveldb::Env::Default());
@@ -139,10 +290,17 @@ CDBWrapper::CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory, bo
     }
 
     LogPrintf("Using obfuscation key for %s: %s\n", path.string(), HexStr(obfuscate_key));
+
+    std::lock_guard<std::mutex> lock(csOpenDBs);
+    vOpenDBs.push_back(this);
 }
 
 CDBWrapper::~CDBWrapper()
 {
+    {
+        std::lock_guard<std::mutex> lock(csOpenDBs);
+        vOpenDBs.erase(std::remove(vOpenDBs.begin(), vOpenDBs.end(), this), vOpenDBs.end());
+    }
     delete pdb;
     pdb = nullptr;
     delete options.filter_policy;
@@ -189,6 +347,67 @@ bool CDBWrapper::IsEmpty()
     return !(it->Valid());
 }
 
+CDBStats CDBWrapper::GetStats() const
+{
+    CDBStats stats;
+    stats.strName = strName;
+    stats.strPath = strPath;
+    stats.fMemory = fMemory;
+    stats.nCacheSize = nCacheSize;
+    stats.tuning = tuning;
+    stats.nWriteBufferSize = options.write_buffer_size;
+
+    const CBitcoinLevelDBLogger* logger = static_cast<const CBitcoinLevelDBLogger*>(options.info_log);
+    stats.nCompactions = logger->nCompactions;
+    stats.nTrivialMoves = logger->nTrivialMoves;
+    stats.nMemtableFlushes = logger->nMemtableFlushes;
+    stats.nWriteStalls = logger->nWriteStalls;
+
+    std::string strValue;
+    stats.nMemoryUsage = 0;
+    if (pdb->GetProperty("leveldb.approximate-memory-usage", &strValue)) {
+        int64_t n;
+        if (ParseInt64(strValue, &n)) {
+            stats.nMemoryUsage = (size_t)n;
+        }
+    }
+
+    // "leveldb.stats" is a table with 3 lines of headers followed by one row per level
+    strValue.clear();
+    pdb->GetProperty("leveldb.stats", &strValue);
+    std::istringstream ss(strValue);
+    std::string strLine;
+    for (int i = 0; i < 3 && std::getline(ss, strLine); i++) {}
+    while (std::getline(ss, strLine)) {
+        CDBStats::Level level;
+        if (sscanf(strLine.c_str(), "%d %d %lf %lf %lf %lf", &level.nLevel, &level.nFiles, &level.dSizeMiB,
+                &level.dCompactionSecs, &level.dReadMiB, &level.dWriteMiB) == 6) {
+            stats.vLevels.push_back(level);
+        }
+    }
+
+    stats.nReadAmplification = 0;
+    for (const auto& level : stats.vLevels) {
+        if (level.nLevel == 0) {
+            stats.nReadAmplification += level.nFiles;
+        } else if (level.nFiles > 0) {
+            stats.nReadAmplification++;
+        }
+    }
+    return stats;
+}
+
+std::vector<CDBStats> GetDBStats()
+{
+    std::lock_guard<std::mutex> lock(csOpenDBs);
+    std::vector<CDBStats> vStats;
+    vStats.reserve(vOpenDBs.size());
+    for (const CDBWrapper* db : vOpenDBs) {
+        vStats.push_back(db->GetStats());
+    }
+    return vStats;
+}
+
 CDBIterator::~CDBIterator() { delete piter; }
 bool CDBIterator::Valid() { return piter->Valid(); }
 void CDBIterator::SeekToFirst() { piter->SeekToFirst(); }
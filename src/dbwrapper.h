@@ -13,6 +13,7 @@
 #include "utilstrencodings.h"
 #include "version.h"
 
+#include <set>
 #include <typeindex>
 
 #include <leveldb/db.h>
@@ -29,6 +30,65 @@ public:
 
 class CDBWrapper;
 
+/** LevelDB options which can be tuned per database with -dbtuning */
+struct CDBTuning
+{
+    //! approximate size of the (uncompressed) data per table block
+    size_t nBlockSize{4 * 1024};
+    //! bits per key of the bloom filter, 0 to disable it
+    int nBloomBits{10};
+    //! size of a memtable, 0 for a quarter of the cache size
+    size_t nWriteBufferSize{0};
+    //! size at which table files are split during compactions
+    size_t nMaxFileSize{2 * 1024 * 1024};
+    //! snappy compression, only has an effect if LevelDB was built with snappy
+    bool fCompression{false};
+    int nMaxOpenFiles{64};
+};
+
+/**
+ * Returns the tuning of the database strName: its built-in defaults with all -dbtuning=<strName>:<option>=<value>
+ * arguments applied in order. Returns false and sets strError if one of them is invalid.
+ */
+bool GetDBTuning(const std::string& strName, CDBTuning& tuningRet, std::string& strError);
+/** Checks that all -dbtuning arguments refer to one of setNames and are valid */
+bool CheckDBTuningArgs(const std::set<std::string>& setNames, std::string& strError);
+
+/** Internal statistics of an open CDBWrapper, see GetDBStats */
+struct CDBStats
+{
+    struct Level
+    {
+        int nLevel;
+        int nFiles;
+        double dSizeMiB;
+        //! time spent in compactions which wrote to this level
+        double dCompactionSecs;
+        double dReadMiB;
+        double dWriteMiB;
+    };
+
+    std::string strName;
+    std::string strPath;
+    bool fMemory;
+    size_t nCacheSize;
+    CDBTuning tuning;
+    size_t nWriteBufferSize;
+
+    //! counted from LevelDB's info log since the database was opened
+    uint64_t nCompactions;
+    uint64_t nTrivialMoves;
+    uint64_t nMemtableFlushes;
+    uint64_t nWriteStalls;
+
+    //! block cache and memtables
+    size_t nMemoryUsage;
+    //! levels which have files or compaction stats
+    std::vector<Level> vLevels;
+    //! number of tables a read may have to look at: every level 0 file plus one per non-empty deeper level
+    int nReadAmplification;
+};
+
 /** These should be considered an implementation detail of the specific database.
  */
 namespace dbwrapper_private {
@@ -230,6 +290,13 @@ private:
 
     std::vector<unsigned char> CreateObfuscateKey() const;
 
+    //! name of the database in -dbtuning and getdbstats
+    std::string strName;
+    std::string strPath;
+    bool fMemory;
+    size_t nCacheSize;
+    CDBTuning tuning;
+
 public:
     /**
      * @param[in] path        Location in the filesystem where leveldb data will be stored.
@@ -238,8 +305,9 @@ public:
      * @param[in] fWipe       If true, remove all existing data.
      * @param[in] obfuscate   If true, store data obfuscated via simple XOR. If false, XOR
      *                        with a zero'd byte array.
+     * @param[in] strName     Name of the database, used to look up its -dbtuning arguments.
      */
-    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false);
+    CDBWrapper(const fs::path& path, size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool obfuscate = false, const std::string& strName = "");
     ~CDBWrapper();
 
     template <typename K>
@@ -358,6 +426,8 @@ public:
      */
     bool IsEmpty();
 
+    CDBStats GetStats() const;
+
     template<typename K>
     size_t EstimateSize(const K& key_begin, const K& key_end) const
     {
@@ -397,6 +467,9 @@ public:
 
 };
 
+/** Returns the statistics of all open databases */
+std::vector<CDBStats> GetDBStats();
+
 template<typename CDBTransaction>
 class CDBTransactionIterator
 {
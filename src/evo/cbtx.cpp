@@ -10,6 +10,7 @@
 #include "simplifiedmns.h"
 #include "specialtx.h"
 
+#include "blockconnectstats.h"
 #include "chainparams.h"
 #include "consensus/merkle.h"
 #include "univalue.h"
@@ -49,16 +50,12 @@ bool CheckCbTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidatio
 }
 
 // This can only be done after the block has been fully processed, as otherwise we won't have the finished MN list
-bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, CValidationState& state)
+bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck)
 {
     if (block.vtx[0]->nType != TRANSACTION_COINBASE) {
         return true;
     }
 
-    static int64_t nTimePayload = 0;
-    static int64_t nTimeMerkleMNL = 0;
-    static int64_t nTimeMerkleQuorum = 0;
-
     int64_t nTime1 = GetTimeMicros();
 
     CCbTx cbTx;
@@ -66,23 +63,23 @@ bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, CValid
         return state.DoS(100, false, REJECT_INVALID, "bad-cbtx-payload");
     }
 
-    int64_t nTime2 = GetTimeMicros(); nTimePayload += nTime2 - nTime1;
+    int64_t nTime2 = GetTimeMicros(); int64_t nTimePayload = blockConnectStats.Record(BLOCK_STAGE_MERKLE_ROOTS_PAYLOAD, nTime2 - nTime1, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "          - GetTxPayload: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimePayload * 0.000001);
 
     if (pindex) {
         uint256 calculatedMerkleRoot;
-        if (!CalcCbTxMerkleRootMNList(block, pindex->pprev, calculatedMerkleRoot, state)) {
+        if (!CalcCbTxMerkleRootMNList(block, pindex->pprev, calculatedMerkleRoot, state, fJustCheck)) {
             return state.DoS(100, false, REJECT_INVALID, "bad-cbtx-mnmerkleroot");
         }
         if (calculatedMerkleRoot != cbTx.merkleRootMNList) {
             return state.DoS(100, false, REJECT_INVALID, "bad-cbtx-mnmerkleroot");
         }
 
-        int64_t nTime3 = GetTimeMicros(); nTimeMerkleMNL += nTime3 - nTime2;
+        int64_t nTime3 = GetTimeMicros(); int64_t nTimeMerkleMNL = blockConnectStats.Record(BLOCK_STAGE_MERKLE_ROOTS_MNLIST, nTime3 - nTime2, !fJustCheck);
         LogPrint(BCLog::BENCHMARK, "          - CalcCbTxMerkleRootMNList: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeMerkleMNL * 0.000001);
 
         if (cbTx.nVersion >= 2) {
-            if (!CalcCbTxMerkleRootQuorums(block, pindex->pprev, calculatedMerkleRoot, state)) {
+            if (!CalcCbTxMerkleRootQuorums(block, pindex->pprev, calculatedMerkleRoot, state, fJustCheck)) {
                 return state.DoS(100, false, REJECT_INVALID, "bad-cbtx-quorummerkleroot");
             }
             if (calculatedMerkleRoot != cbTx.merkleRootQuorums) {
@@ -90,7 +87,7 @@ bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, CValid
             }
         }
 
-        int64_t nTime4 = GetTimeMicros(); nTimeMerkleQuorum += nTime4 - nTime3;
+        int64_t nTime4 = GetTimeMicros(); int64_t nTimeMerkleQuorum = blockConnectStats.Record(BLOCK_STAGE_MERKLE_ROOTS_QUORUMS, nTime4 - nTime3, !fJustCheck);
         LogPrint(BCLog::BENCHMARK, "          - CalcCbTxMerkleRootQuorums: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeMerkleQuorum * 0.000001);
 
     }
@@ -98,14 +95,10 @@ bool CheckCbTxMerkleRoots(const CBlock& block, const CBlockIndex* pindex, CValid
     return true;
 }
 
-bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev, uint256& merkleRootRet, CValidationState& state)
+bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev, uint256& merkleRootRet, CValidationState& state, bool fJustCheck)
 {
     LOCK(deterministicMNManager->cs);
 
-    static int64_t nTimeDMN = 0;
-    static int64_t nTimeSMNL = 0;
-    static int64_t nTimeMerkle = 0;
-
     int64_t nTime1 = GetTimeMicros();
 
     CDeterministicMNList tmpMNList;
@@ -113,12 +106,12 @@ bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev
         return false;
     }
 
-    int64_t nTime2 = GetTimeMicros(); nTimeDMN += nTime2 - nTime1;
+    int64_t nTime2 = GetTimeMicros(); int64_t nTimeDMN = blockConnectStats.Record(BLOCK_STAGE_MNLIST_BUILD, nTime2 - nTime1, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "            - BuildNewListFromBlock: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeDMN * 0.000001);
 
     CSimplifiedMNList sml(tmpMNList);
 
-    int64_t nTime3 = GetTimeMicros(); nTimeSMNL += nTime3 - nTime2;
+    int64_t nTime3 = GetTimeMicros(); int64_t nTimeSMNL = blockConnectStats.Record(BLOCK_STAGE_MNLIST_SML, nTime3 - nTime2, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "            - CSimplifiedMNList: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeSMNL * 0.000001);
 
     static CSimplifiedMNList smlCached;
@@ -133,7 +126,7 @@ bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev
     bool mutated = false;
     merkleRootRet = sml.CalcMerkleRoot(&mutated);
 
-    int64_t nTime4 = GetTimeMicros(); nTimeMerkle += nTime4 - nTime3;
+    int64_t nTime4 = GetTimeMicros(); int64_t nTimeMerkle = blockConnectStats.Record(BLOCK_STAGE_MNLIST_MERKLE, nTime4 - nTime3, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "            - CalcMerkleRoot: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeMerkle * 0.000001);
 
     smlCached = std::move(sml);
@@ -143,13 +136,8 @@ bool CalcCbTxMerkleRootMNList(const CBlock& block, const CBlockIndex* pindexPrev
     return !mutated;
 }
 
-bool CalcCbTxMerkleRootQuorums(const CBlock& block, const CBlockIndex* pindexPrev, uint256& merkleRootRet, CValidationState& state)
+bool CalcCbTxMerkleRootQuorums(const CBlock& block, const CBlockIndex* pindexPrev, uint256& merkleRootRet, CValidationState& state, bool fJustCheck)
 {
-    static int64_t nTimeMinedAndActive = 0;
-    static int64_t nTimeMined = 0;
-    static int64_t nTimeLoop = 0;
-    static int64_t nTimeMerkle = 0;
-
     int64_t nTime1 = GetTimeMicros();
 
     static std::map<Consensus::LLMQType, std::vector<const CBlockIndex*>> quorumsCached;
@@ -160,7 +148,7 @@ bool CalcCbTxMerkleRootQuorums(const CBlock& block, const CBlockIndex* pindexPre
     std::map<Consensus::LLMQType, std::vector<uint256>> qcHashes;
     size_t hashCount = 0;
 
-    int64_t nTime2 = GetTimeMicros(); nTimeMinedAndActive += nTime2 - nTime1;
+    int64_t nTime2 = GetTimeMicros(); int64_t nTimeMinedAndActive = blockConnectStats.Record(BLOCK_STAGE_QUORUMS_MINED_AND_ACTIVE, nTime2 - nTime1, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "            - GetMinedAndActiveCommitmentsUntilBlock: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeMinedAndActive * 0.000001);
 
     if (quorums == quorumsCached) {
@@ -182,7 +170,7 @@ bool CalcCbTxMerkleRootQuorums(const CBlock& block, const CBlockIndex* pindexPre
         qcHashesCached = qcHashes;
     }
 
-    int64_t nTime3 = GetTimeMicros(); nTimeMined += nTime3 - nTime2;
+    int64_t nTime3 = GetTimeMicros(); int64_t nTimeMined = blockConnectStats.Record(BLOCK_STAGE_QUORUMS_MINED, nTime3 - nTime2, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "            - GetMinedCommitment: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeMined * 0.000001);
 
     // now add the commitments from the current block, which are not returned by GetMinedAndActiveCommitmentsUntilBlock
@@ -223,13 +211,13 @@ bool CalcCbTxMerkleRootQuorums(const CBlock& block, const CBlockIndex* pindexPre
     }
     std::sort(qcHashesVec.begin(), qcHashesVec.end());
 
-    int64_t nTime4 = GetTimeMicros(); nTimeLoop += nTime4 - nTime3;
+    int64_t nTime4 = GetTimeMicros(); int64_t nTimeLoop = blockConnectStats.Record(BLOCK_STAGE_QUORUMS_LOOP, nTime4 - nTime3, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "            - Loop: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeLoop * 0.000001);
 
     bool mutated = false;
     merkleRootRet = ComputeMerkleRoot(qcHashesVec, &mutated);
 
-    int64_t nTime5 = GetTimeMicros(); nTimeMerkle += nTime5 - nTime4;
+    int64_t nTime5 = GetTimeMicros(); int64_t nTimeMerkle = blockConnectStats.Record(BLOCK_STAGE_QUORUMS_MERKLE, nTime5 - nTime4, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "            - ComputeMerkleRoot: %.2fms [%.2fs]\n", 0.001 * (nTime5 - nTime4), nTimeMerkle * 0.000001);
 
     return !mutated;
@@ -4,8 +4,134 @@
 
 #include "evodb.h"
 
+#include "util.h"
+#include "utiltime.h"
+
 CEvoDB* evoDb;
 
+void CEvoDBCommit::Set(const CDataStream& ssKey, std::unique_ptr<const CDataStream> ssValue)
+{
+    auto res = entries.emplace(ssKey, nullptr);
+    if (res.second) {
+        memoryUsage += ssKey.size();
+    } else if (res.first->second) {
+        memoryUsage -= res.first->second->size();
+    }
+    if (ssValue) {
+        memoryUsage += ssValue->size();
+    }
+    res.first->second = std::move(ssValue);
+}
+
+void CEvoDBCommit::Swap(CEvoDBCommit& other)
+{
+    entries.swap(other.entries);
+    std::swap(memoryUsage, other.memoryUsage);
+}
+
+CEvoDBCommittedIterator* CEvoDBCommittedView::NewIterator() const
+{
+    // the pending commits must be taken before the db snapshot, as a commit is only dropped from them after it
+    // was written to the db
+    auto pending = GetPending();
+    return new CEvoDBCommittedIterator(std::move(pending), db.NewIterator());
+}
+
+CEvoDBCommittedIterator::CEvoDBCommittedIterator(std::shared_ptr<const CEvoDBCommittedView::CommitList> _pending, CDBIterator* _dbIt) :
+    pending(std::move(_pending)),
+    dbIt(_dbIt),
+    dbKey(SER_DISK, CLIENT_VERSION)
+{
+    // newer commits overwrite the entries of older ones
+    for (const auto& commit : *pending) {
+        for (const auto& p : commit->GetEntries()) {
+            overlay[p.first] = p.second.get();
+        }
+    }
+    overlayIt = overlay.end();
+}
+
+void CEvoDBCommittedIterator::SeekToFirst()
+{
+    overlayIt = overlay.begin();
+    dbIt->SeekToFirst();
+    SkipErased();
+    SkipOverlaid();
+    DecideCur();
+}
+
+void CEvoDBCommittedIterator::Seek(const CDataStream& ssKey)
+{
+    overlayIt = overlay.lower_bound(ssKey);
+    dbIt->Seek(ssKey);
+    SkipErased();
+    SkipOverlaid();
+    DecideCur();
+}
+
+bool CEvoDBCommittedIterator::Valid()
+{
+    return overlayIt != overlay.end() || dbIt->Valid();
+}
+
+void CEvoDBCommittedIterator::Next()
+{
+    if (!Valid()) {
+        return;
+    }
+    if (curIsDb) {
+        dbIt->Next();
+        SkipOverlaid();
+    } else {
+        ++overlayIt;
+        SkipErased();
+    }
+    DecideCur();
+}
+
+CDataStream CEvoDBCommittedIterator::GetKey()
+{
+    if (!Valid()) {
+        return CDataStream(SER_DISK, CLIENT_VERSION);
+    }
+    return curIsDb ? dbKey : overlayIt->first;
+}
+
+unsigned int CEvoDBCommittedIterator::GetKeySize()
+{
+    return GetKey().size();
+}
+
+void CEvoDBCommittedIterator::SkipErased()
+{
+    while (overlayIt != overlay.end() && !overlayIt->second) {
+        ++overlayIt;
+    }
+}
+
+void CEvoDBCommittedIterator::SkipOverlaid()
+{
+    // keys which are pending (written or erased) are served by the overlay
+    while (dbIt->Valid()) {
+        dbKey = dbIt->GetKey();
+        if (!overlay.count(dbKey)) {
+            break;
+        }
+        dbIt->Next();
+    }
+}
+
+void CEvoDBCommittedIterator::DecideCur()
+{
+    if (overlayIt == overlay.end()) {
+        curIsDb = true;
+    } else if (!dbIt->Valid()) {
+        curIsDb = false;
+    } else {
+        curIsDb = CEvoDBCommit::DataStreamCmp()(dbKey, overlayIt->first);
+    }
+}
+
 CEvoDBScopedCommitter::CEvoDBScopedCommitter(CEvoDB &_evoDB) :
     evoDB(_evoDB)
 {
@@ -31,12 +157,27 @@ void CEvoDBScopedCommitter::Rollback()
     evoDB.RollbackCurTransaction();
 }
 
-CEvoDB::CEvoDB(size_t nCacheSize, bool fMemory, bool fWipe) :
-    db(fMemory ? "" : (GetDataDir() / "evodb"), nCacheSize, fMemory, fWipe),
-    rootBatch(db),
-    rootDBTransaction(db, rootBatch),
+CEvoDB::CEvoDB(size_t nCacheSize, bool fMemory, bool fWipe, bool fAsyncCommit) :
+    db(fMemory ? "" : (GetDataDir() / "evodb"), nCacheSize, fMemory, fWipe, false, "evodb"),
+    committedView(db),
+    rootDBTransaction(committedView, rootCommit),
     curDBTransaction(rootDBTransaction, rootDBTransaction)
 {
+    if (fAsyncCommit) {
+        writerThread = std::thread(&CEvoDB::ThreadWriteCommits, this);
+    }
+}
+
+CEvoDB::~CEvoDB()
+{
+    {
+        std::lock_guard<std::mutex> lock(csWriter);
+        fStopWriter = true;
+    }
+    condWriter.notify_all();
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
 }
 
 void CEvoDB::CommitCurTransaction()
@@ -51,13 +192,105 @@ void CEvoDB::RollbackCurTransaction()
     curDBTransaction.Clear();
 }
 
+size_t CEvoDB::GetMemoryUsage()
+{
+    size_t nUsage = rootDBTransaction.GetMemoryUsage();
+    for (const auto& commit : *committedView.GetPending()) {
+        nUsage += commit->GetMemoryUsage();
+    }
+    return nUsage;
+}
+
+bool CEvoDB::WriteCommit(const CEvoDBCommit& commit)
+{
+    int64_t nStart = GetTimeMillis();
+    try {
+        CDBBatch batch(db);
+        for (const auto& p : commit.GetEntries()) {
+            if (p.second) {
+                batch.Write(p.first, *p.second);
+            } else {
+                batch.Erase(p.first);
+            }
+        }
+        db.WriteBatch(batch);
+    } catch (const std::exception& e) {
+        LogPrintf("%s: Error writing to EvoDB: %s\n", __func__, e.what());
+        return false;
+    }
+    LogPrint(BCLog::COINDB, "Wrote %u EvoDB entries in %dms\n", commit.GetEntries().size(), GetTimeMillis() - nStart);
+    return true;
+}
+
+void CEvoDB::ThreadWriteCommits()
+{
+    RenameThread("xazab-evodbwrite");
+
+    std::unique_lock<std::mutex> lock(csWriter);
+    while (true) {
+        // the queued commits are written before stopping
+        condWriter.wait(lock, [this] { return fStopWriter || (!fWriteFailed && !committedView.GetPending()->empty()); });
+        std::shared_ptr<const CEvoDBCommittedView::CommitList> pending = committedView.GetPending();
+        if (fWriteFailed || pending->empty()) {
+            break;
+        }
+        lock.unlock();
+        bool fOk = WriteCommit(*pending->front());
+        lock.lock();
+        if (!fOk) {
+            // keep serving the commit, the node is going to be shut down by the next flush
+            fWriteFailed = true;
+        } else {
+            // the commit only goes away after it is written, so reads never miss it
+            committedView.SetPending(std::make_shared<const CEvoDBCommittedView::CommitList>(pending->begin() + 1, pending->end()));
+        }
+        condWriter.notify_all();
+    }
+}
+
 bool CEvoDB::CommitRootTransaction()
 {
-    assert(curDBTransaction.IsClean());
-    rootDBTransaction.Commit();
-    bool ret = db.WriteBatch(rootBatch);
-    rootBatch.Clear();
-    return ret;
+    // don't let the queue grow if the writer can't keep up
+    if (!WaitForCommits(MAX_PENDING_EVODB_COMMITS - 1)) {
+        return false;
+    }
+
+    std::shared_ptr<CEvoDBCommit> commit = std::make_shared<CEvoDBCommit>();
+    {
+        LOCK(cs);
+        assert(curDBTransaction.IsClean());
+        rootDBTransaction.Commit();
+        if (rootCommit.IsEmpty()) {
+            return true;
+        }
+        commit->Swap(rootCommit);
+        // publish the commit while holding cs, so that Read always finds the entries in one of both places
+        std::lock_guard<std::mutex> lock(csWriter);
+        std::shared_ptr<CEvoDBCommittedView::CommitList> pending = std::make_shared<CEvoDBCommittedView::CommitList>(*committedView.GetPending());
+        pending->push_back(commit);
+        committedView.SetPending(pending);
+    }
+    condWriter.notify_all();
+
+    if (writerThread.joinable()) {
+        return true;
+    }
+    // no writer thread, the queue only ever holds this commit
+    bool fOk = WriteCommit(*commit);
+    std::lock_guard<std::mutex> lock(csWriter);
+    if (fOk) {
+        committedView.SetPending(std::make_shared<const CEvoDBCommittedView::CommitList>());
+    } else {
+        fWriteFailed = true;
+    }
+    return fOk;
+}
+
+bool CEvoDB::WaitForCommits(size_t nMaxPending)
+{
+    std::unique_lock<std::mutex> lock(csWriter);
+    condWriter.wait(lock, [&] { return fWriteFailed || committedView.GetPending()->size() <= nMaxPending; });
+    return !fWriteFailed;
 }
 
 bool CEvoDB::VerifyBestBlock(const uint256& hash)
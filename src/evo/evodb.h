@@ -9,12 +9,205 @@
 #include "sync.h"
 #include "uint256.h"
 
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 // "b_b" was used in the initial version of deterministic MN storage
 // "b_b2" was used after compact diffs were introduced
 static const std::string EVODB_BEST_BLOCK = "b_b2";
 
+//! Maximum number of root transactions which are committed but not yet written to disk
+static const size_t MAX_PENDING_EVODB_COMMITS = 2;
+
 class CEvoDB;
 
+/**
+ * The serialized writes and erases of a committed root transaction. It is immutable once it was handed to the
+ * writer and answers reads until it is written to disk.
+ */
+class CEvoDBCommit
+{
+public:
+    struct DataStreamCmp {
+        bool operator()(const CDataStream& a, const CDataStream& b) const {
+            return std::lexicographical_compare(
+                    (const uint8_t*)a.data(), (const uint8_t*)a.data() + a.size(),
+                    (const uint8_t*)b.data(), (const uint8_t*)b.data() + b.size());
+        }
+    };
+    // serialized values, nullptr for erased keys
+    typedef std::map<CDataStream, std::unique_ptr<const CDataStream>, DataStreamCmp> EntriesMap;
+
+private:
+    EntriesMap entries;
+    size_t memoryUsage{0};
+
+    void Set(const CDataStream& ssKey, std::unique_ptr<const CDataStream> ssValue);
+
+public:
+    // CDBTransaction commits into this
+    template <typename V>
+    void Write(const CDataStream& ssKey, const V& v) {
+        std::unique_ptr<CDataStream> ssValue = std::make_unique<CDataStream>(SER_DISK, CLIENT_VERSION);
+        *ssValue << v;
+        Set(ssKey, std::move(ssValue));
+    }
+
+    void Erase(const CDataStream& ssKey) {
+        Set(ssKey, nullptr);
+    }
+
+    const EntriesMap& GetEntries() const { return entries; }
+    bool IsEmpty() const { return entries.empty(); }
+    size_t GetMemoryUsage() const { return memoryUsage; }
+    void Swap(CEvoDBCommit& other);
+};
+
+class CEvoDBCommittedIterator;
+
+/**
+ * The committed state of the EvoDB: the commits which are not yet written (oldest first) on top of the database.
+ * The list of commits is replaced as a whole when it changes, so reads work on an immutable snapshot of it and
+ * don't take any lock.
+ */
+class CEvoDBCommittedView
+{
+public:
+    typedef std::vector<std::shared_ptr<const CEvoDBCommit>> CommitList;
+
+private:
+    CDBWrapper& db;
+    // only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const CommitList> pending;
+
+    template<typename K>
+    static CDataStream KeyToDataStream(const K& key) {
+        CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+        ssKey.reserve(DBWRAPPER_PREALLOC_KEY_SIZE);
+        ssKey << key;
+        return ssKey;
+    }
+
+    // the newest pending entry of ssKey, nullptr if it isn't pending
+    static const CEvoDBCommit::EntriesMap::value_type* FindPending(const CommitList& pendingSnapshot, const CDataStream& ssKey) {
+        for (auto it = pendingSnapshot.rbegin(); it != pendingSnapshot.rend(); ++it) {
+            auto entryIt = (*it)->GetEntries().find(ssKey);
+            if (entryIt != (*it)->GetEntries().end()) {
+                return &*entryIt;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    explicit CEvoDBCommittedView(CDBWrapper& _db) : db(_db), pending(std::make_shared<const CommitList>()) {}
+
+    std::shared_ptr<const CommitList> GetPending() const { return std::atomic_load(&pending); }
+    void SetPending(std::shared_ptr<const CommitList> _pending) { std::atomic_store(&pending, std::move(_pending)); }
+
+    template <typename K, typename V>
+    bool Read(const K& key, V& value) const {
+        return Read(KeyToDataStream(key), value);
+    }
+
+    template <typename V>
+    bool Read(const CDataStream& ssKey, V& value) const {
+        std::shared_ptr<const CommitList> pendingSnapshot = GetPending();
+        auto entry = FindPending(*pendingSnapshot, ssKey);
+        if (!entry) {
+            return db.Read(ssKey, value);
+        }
+        if (!entry->second) {
+            return false;
+        }
+        try {
+            CDataStream ssValue(*entry->second);
+            ssValue >> value;
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    template <typename K>
+    bool Exists(const K& key) const {
+        return Exists(KeyToDataStream(key));
+    }
+
+    bool Exists(const CDataStream& ssKey) const {
+        std::shared_ptr<const CommitList> pendingSnapshot = GetPending();
+        auto entry = FindPending(*pendingSnapshot, ssKey);
+        if (!entry) {
+            return db.Exists(ssKey);
+        }
+        return entry->second != nullptr;
+    }
+
+    CEvoDBCommittedIterator* NewIterator() const;
+};
+
+/** Iterates over the keys of a snapshot of CEvoDBCommittedView, it can be the parent iterator of a CDBTransactionIterator */
+class CEvoDBCommittedIterator
+{
+private:
+    std::shared_ptr<const CEvoDBCommittedView::CommitList> pending;
+    // the newest pending entry of every key, values are owned by pending and nullptr for erased keys
+    std::map<CDataStream, const CDataStream*, CEvoDBCommit::DataStreamCmp> overlay;
+    decltype(overlay)::const_iterator overlayIt;
+    std::unique_ptr<CDBIterator> dbIt;
+    CDataStream dbKey;
+    bool curIsDb{false};
+
+    void SkipErased();
+    void SkipOverlaid();
+    void DecideCur();
+
+public:
+    CEvoDBCommittedIterator(std::shared_ptr<const CEvoDBCommittedView::CommitList> _pending, CDBIterator* _dbIt);
+
+    void SeekToFirst();
+    void Seek(const CDataStream& ssKey);
+    bool Valid();
+    void Next();
+    CDataStream GetKey();
+    unsigned int GetKeySize();
+
+    template<typename K>
+    bool GetKey(K& key) {
+        if (!Valid()) {
+            return false;
+        }
+        try {
+            CDataStream ssKey = GetKey();
+            ssKey >> key;
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+
+    template<typename V>
+    bool GetValue(V& value) {
+        if (!Valid()) {
+            return false;
+        }
+        if (curIsDb) {
+            return dbIt->GetValue(value);
+        }
+        try {
+            CDataStream ssValue(*overlayIt->second);
+            ssValue >> value;
+        } catch (const std::exception&) {
+            return false;
+        }
+        return true;
+    }
+};
+
 class CEvoDBScopedCommitter
 {
 private:
@@ -29,21 +222,38 @@ public:
     void Rollback();
 };
 
+/**
+ * Committing the root transaction turns it into a CEvoDBCommit which is queued for writing. With fAsyncCommit the
+ * commits are written in order by a background thread, so block processing can continue while they are written.
+ * Otherwise CommitRootTransaction writes them itself. Reads see the queued commits until they are written.
+ */
 class CEvoDB
 {
 private:
     CCriticalSection cs;
     CDBWrapper db;
+    CEvoDBCommittedView committedView;
 
-    typedef CDBTransaction<CDBWrapper, CDBBatch> RootTransaction;
+    typedef CDBTransaction<CEvoDBCommittedView, CEvoDBCommit> RootTransaction;
     typedef CDBTransaction<RootTransaction, RootTransaction> CurTransaction;
 
-    CDBBatch rootBatch;
+    CEvoDBCommit rootCommit;
     RootTransaction rootDBTransaction;
     CurTransaction curDBTransaction;
 
+    // protects the changes of the pending commits of committedView and the flags below
+    std::mutex csWriter;
+    std::condition_variable condWriter;
+    bool fWriteFailed{false};
+    bool fStopWriter{false};
+    std::thread writerThread;
+
+    bool WriteCommit(const CEvoDBCommit& commit);
+    void ThreadWriteCommits();
+
 public:
-    CEvoDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+    CEvoDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false, bool fAsyncCommit = false);
+    ~CEvoDB();
 
     std::unique_ptr<CEvoDBScopedCommitter> BeginTransaction()
     {
@@ -77,6 +287,23 @@ public:
         return curDBTransaction.Exists(key);
     }
 
+    /**
+     * Read and Exists of the committed state, without the changes of the current and root transactions. These don't
+     * take any lock, use them for data which is not written by block processing or if the last committed state is
+     * good enough.
+     */
+    template <typename K, typename V>
+    bool ReadCommitted(const K& key, V& value) const
+    {
+        return committedView.Read(key, value);
+    }
+
+    template <typename K>
+    bool ExistsCommitted(const K& key) const
+    {
+        return committedView.Exists(key);
+    }
+
     template <typename K>
     void Erase(const K& key)
     {
@@ -89,12 +316,13 @@ public:
         return db;
     }
 
-    size_t GetMemoryUsage()
-    {
-        return rootDBTransaction.GetMemoryUsage();
-    }
+    //! Memory used by the root transaction and the commits which are not written yet
+    size_t GetMemoryUsage();
 
+    //! Queues the root transaction for writing, returns false if writing a previous commit failed
     bool CommitRootTransaction();
+    //! Waits until at most nMaxPending commits are waiting to be written, returns false if writing one of them failed
+    bool WaitForCommits(size_t nMaxPending = 0);
 
     bool VerifyBestBlock(const uint256& hash);
     void WriteBestBlock(const uint256& hash);
@@ -2,10 +2,13 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "blockconnectstats.h"
 #include "chainparams.h"
+#include "checkqueue.h"
 #include "clientversion.h"
 #include "consensus/validation.h"
 #include "hash.h"
+#include "messagesigner.h"
 #include "primitives/block.h"
 #include "primitives/transaction.h"
 #include "validation.h"
@@ -17,7 +20,63 @@
 #include "llmq/quorums_commitment.h"
 #include "llmq/quorums_blockprocessor.h"
 
-bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state)
+static CCheckQueue<CSpecialTxSigCheck> specialtxcheckqueue(128);
+
+void ThreadSpecialTxCheck()
+{
+    RenameThread("xazab-spectxch");
+    specialtxcheckqueue.Thread();
+}
+
+bool CSpecialTxSigCheck::operator()()
+{
+    std::string strError;
+    switch (type) {
+    case ECDSA_HASH:
+        return CHashSigner::VerifyHash(hash, keyID, vchSig, strError);
+    case ECDSA_MESSAGE:
+        return CMessageSigner::VerifyMessage(keyID, vchSig, strMessage, strError);
+    case BLS_HASH:
+        return blsSig.VerifyInsecure(blsPubKey, hash);
+    case QUORUM_COMMITMENT:
+        return qc->VerifySigs(members);
+    }
+    return false;
+}
+
+void CSpecialTxSigCheck::swap(CSpecialTxSigCheck& check)
+{
+    std::swap(type, check.type);
+    std::swap(hash, check.hash);
+    strMessage.swap(check.strMessage);
+    std::swap(keyID, check.keyID);
+    vchSig.swap(check.vchSig);
+    std::swap(blsPubKey, check.blsPubKey);
+    std::swap(blsSig, check.blsSig);
+    qc.swap(check.qc);
+    members.swap(check.members);
+}
+
+static bool RunSpecialTxSigChecks(std::vector<CSpecialTxSigCheck>& vChecks)
+{
+    if (vChecks.empty()) {
+        return true;
+    }
+    if (!nScriptCheckThreads) {
+        // without a queue CCheckQueueControl would drop the checks, so run them right here
+        for (auto& check : vChecks) {
+            if (!check()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    CCheckQueueControl<CSpecialTxSigCheck> control(&specialtxcheckqueue);
+    control.Add(vChecks);
+    return control.Wait();
+}
+
+bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state, std::vector<CSpecialTxSigCheck>* pvChecks)
 {
     if (tx.nVersion != 3 || tx.nType == TRANSACTION_NORMAL)
         return true;
@@ -28,17 +87,17 @@ bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CVali
 
     switch (tx.nType) {
     case TRANSACTION_PROVIDER_REGISTER:
-        return CheckProRegTx(tx, pindexPrev, state);
+        return CheckProRegTx(tx, pindexPrev, state, pvChecks);
     case TRANSACTION_PROVIDER_UPDATE_SERVICE:
-        return CheckProUpServTx(tx, pindexPrev, state);
+        return CheckProUpServTx(tx, pindexPrev, state, pvChecks);
     case TRANSACTION_PROVIDER_UPDATE_REGISTRAR:
-        return CheckProUpRegTx(tx, pindexPrev, state);
+        return CheckProUpRegTx(tx, pindexPrev, state, pvChecks);
     case TRANSACTION_PROVIDER_UPDATE_REVOKE:
-        return CheckProUpRevTx(tx, pindexPrev, state);
+        return CheckProUpRevTx(tx, pindexPrev, state, pvChecks);
     case TRANSACTION_COINBASE:
         return CheckCbTx(tx, pindexPrev, state);
     case TRANSACTION_QUORUM_COMMITMENT:
-        return llmq::CheckLLMQCommitment(tx, pindexPrev, state);
+        return llmq::CheckLLMQCommitment(tx, pindexPrev, state, pvChecks);
     }
 
     return state.DoS(10, false, REJECT_INVALID, "bad-tx-type-check");
@@ -88,16 +147,14 @@ bool UndoSpecialTx(const CTransaction& tx, const CBlockIndex* pindex)
 
 bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck, bool fCheckCbTxMerleRoots)
 {
-    static int64_t nTimeLoop = 0;
-    static int64_t nTimeQuorum = 0;
-    static int64_t nTimeDMN = 0;
-    static int64_t nTimeMerkle = 0;
-
     int64_t nTime1 = GetTimeMicros();
 
+    // All special txs are checked against the state of the previous block, so their signatures don't depend on
+    // each other and are verified in parallel once all other checks passed
+    std::vector<CSpecialTxSigCheck> vChecks;
     for (int i = 0; i < (int)block.vtx.size(); i++) {
         const CTransaction& tx = *block.vtx[i];
-        if (!CheckSpecialTx(tx, pindex->pprev, state)) {
+        if (!CheckSpecialTx(tx, pindex->pprev, state, &vChecks)) {
             return false;
         }
         if (!ProcessSpecialTx(tx, pindex, state)) {
@@ -105,28 +162,41 @@ bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CV
         }
     }
 
-    int64_t nTime2 = GetTimeMicros(); nTimeLoop += nTime2 - nTime1;
+    auto itQcChecks = std::stable_partition(vChecks.begin(), vChecks.end(), [](const CSpecialTxSigCheck& check) {
+        return !check.IsQuorumCommitment();
+    });
+    std::vector<CSpecialTxSigCheck> vQcChecks(std::make_move_iterator(itQcChecks), std::make_move_iterator(vChecks.end()));
+    vChecks.erase(itQcChecks, vChecks.end());
+    if (!RunSpecialTxSigChecks(vChecks)) {
+        return state.DoS(100, false, REJECT_INVALID, "bad-protx-sig");
+    }
+    if (!RunSpecialTxSigChecks(vQcChecks)) {
+        return state.DoS(100, false, REJECT_INVALID, "bad-qc-invalid");
+    }
+
+    int64_t nTime2 = GetTimeMicros(); int64_t nTimeLoop = blockConnectStats.Record(BLOCK_STAGE_SPECIAL_TXS_LOOP, nTime2 - nTime1, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "        - Loop: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeLoop * 0.000001);
 
-    if (!llmq::quorumBlockProcessor->ProcessBlock(block, pindex, state)) {
+    // the signatures of the commitments were checked above
+    if (!llmq::quorumBlockProcessor->ProcessBlock(block, pindex, state, false)) {
         return false;
     }
 
-    int64_t nTime3 = GetTimeMicros(); nTimeQuorum += nTime3 - nTime2;
+    int64_t nTime3 = GetTimeMicros(); int64_t nTimeQuorum = blockConnectStats.Record(BLOCK_STAGE_SPECIAL_TXS_QUORUMS, nTime3 - nTime2, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "        - quorumBlockProcessor: %.2fms [%.2fs]\n", 0.001 * (nTime3 - nTime2), nTimeQuorum * 0.000001);
 
     if (!deterministicMNManager->ProcessBlock(block, pindex, state, fJustCheck)) {
         return false;
     }
 
-    int64_t nTime4 = GetTimeMicros(); nTimeDMN += nTime4 - nTime3;
+    int64_t nTime4 = GetTimeMicros(); int64_t nTimeDMN = blockConnectStats.Record(BLOCK_STAGE_SPECIAL_TXS_DMN, nTime4 - nTime3, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "        - deterministicMNManager: %.2fms [%.2fs]\n", 0.001 * (nTime4 - nTime3), nTimeDMN * 0.000001);
 
-    if (fCheckCbTxMerleRoots && !CheckCbTxMerkleRoots(block, pindex, state)) {
+    if (fCheckCbTxMerleRoots && !CheckCbTxMerkleRoots(block, pindex, state, fJustCheck)) {
         return false;
     }
 
-    int64_t nTime5 = GetTimeMicros(); nTimeMerkle += nTime5 - nTime4;
+    int64_t nTime5 = GetTimeMicros(); int64_t nTimeMerkle = blockConnectStats.Record(BLOCK_STAGE_SPECIAL_TXS_MERKLE_ROOTS, nTime5 - nTime4, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "        - CheckCbTxMerkleRoots: %.2fms [%.2fs]\n", 0.001 * (nTime5 - nTime4), nTimeMerkle * 0.000001);
 
     return true;
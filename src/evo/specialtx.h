@@ -5,15 +5,70 @@
 #ifndef XAZAB_SPECIALTX_H
 #define XAZAB_SPECIALTX_H
 
+#include "bls/bls.h"
 #include "primitives/transaction.h"
+#include "pubkey.h"
 #include "streams.h"
 #include "version.h"
 
+#include <memory>
+
 class CBlock;
 class CBlockIndex;
+class CDeterministicMN;
 class CValidationState;
 
-bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state);
+namespace llmq {
+    class CFinalCommitment;
+} // namespace llmq
+
+/**
+ * A signature check of a special transaction. ProcessSpecialTxsInBlock collects these while checking the special
+ * transactions of a block and verifies them in parallel afterwards, like the script checks of ConnectBlock.
+ */
+class CSpecialTxSigCheck
+{
+private:
+    enum Type {
+        ECDSA_HASH,
+        ECDSA_MESSAGE,
+        BLS_HASH,
+        QUORUM_COMMITMENT,
+    };
+
+    Type type{ECDSA_HASH};
+    uint256 hash;
+    std::string strMessage;
+    CKeyID keyID;
+    std::vector<unsigned char> vchSig;
+    CBLSPublicKey blsPubKey;
+    CBLSSignature blsSig;
+    std::shared_ptr<const llmq::CFinalCommitment> qc;
+    std::vector<std::shared_ptr<const CDeterministicMN> > members;
+
+public:
+    CSpecialTxSigCheck() {}
+    CSpecialTxSigCheck(const uint256& hashIn, const CKeyID& keyIDIn, const std::vector<unsigned char>& vchSigIn) :
+        type(ECDSA_HASH), hash(hashIn), keyID(keyIDIn), vchSig(vchSigIn) {}
+    CSpecialTxSigCheck(const std::string& strMessageIn, const CKeyID& keyIDIn, const std::vector<unsigned char>& vchSigIn) :
+        type(ECDSA_MESSAGE), strMessage(strMessageIn), keyID(keyIDIn), vchSig(vchSigIn) {}
+    CSpecialTxSigCheck(const uint256& hashIn, const CBLSPublicKey& pubKeyIn, const CBLSSignature& sigIn) :
+        type(BLS_HASH), hash(hashIn), blsPubKey(pubKeyIn), blsSig(sigIn) {}
+    CSpecialTxSigCheck(std::shared_ptr<const llmq::CFinalCommitment> qcIn, std::vector<std::shared_ptr<const CDeterministicMN> > membersIn) :
+        type(QUORUM_COMMITMENT), qc(std::move(qcIn)), members(std::move(membersIn)) {}
+
+    bool IsQuorumCommitment() const { return type == QUORUM_COMMITMENT; }
+
+    bool operator()();
+
+    void swap(CSpecialTxSigCheck& check);
+};
+
+/** Run a special tx signature check thread */
+void ThreadSpecialTxCheck();
+
+/** If pvChecks is given, the signature checks are appended to it instead of being done immediately */
+bool CheckSpecialTx(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state, std::vector<CSpecialTxSigCheck>* pvChecks = nullptr);
 bool ProcessSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex, CValidationState& state, bool fJustCheck, bool fCheckCbTxMerleRoots);
 bool UndoSpecialTxsInBlock(const CBlock& block, const CBlockIndex* pindex);
 
@@ -0,0 +1,291 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "executor.h"
+
+#include "tinyformat.h"
+#include "util.h"
+#include "utiltime.h"
+
+#include <assert.h>
+
+CExecutor g_executor;
+
+// the executor and the worker index of the calling thread
+static thread_local const CExecutor* currentExecutor{nullptr};
+static thread_local int nCurrentWorker{-1};
+
+std::string TaskPriorityToString(TaskPriority priority)
+{
+    switch (priority) {
+    case TASK_PRIORITY_HIGH: return "high";
+    case TASK_PRIORITY_NORMAL: return "normal";
+    case TASK_PRIORITY_LOW: return "low";
+    default: return "unknown";
+    }
+}
+
+CExecutor::~CExecutor()
+{
+    Stop();
+}
+
+void CExecutor::Start(int nThreads)
+{
+    assert(vThreads.empty());
+    nThreads = std::max(1, std::min(nThreads, MAX_EXECUTOR_THREADS));
+
+    fStopRequested = false;
+    for (int i = 0; i < nThreads; i++) {
+        vWorkerQueues.emplace_back(new WorkerQueue());
+    }
+    fRunning = true;
+    for (int i = 0; i < nThreads; i++) {
+        vThreads.emplace_back(&CExecutor::ThreadWorker, this, i);
+    }
+}
+
+void CExecutor::Stop()
+{
+    if (vThreads.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        fStopRequested = true;
+    }
+    cond.notify_all();
+    for (auto& thread : vThreads) {
+        thread.join();
+    }
+    vThreads.clear();
+    fRunning = false;
+
+    // tasks which were scheduled by the last running tasks
+    Task task;
+    for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+        for (auto& queue : vWorkerQueues) {
+            while (PopTask(*queue, i, false, task)) {
+                task();
+            }
+        }
+        while (PopTask(injectionQueue, i, false, task)) {
+            task();
+        }
+    }
+    vWorkerQueues.clear();
+}
+
+void CExecutor::Schedule(Task&& task, TaskPriority priority)
+{
+    if (!fRunning) {
+        task();
+        return;
+    }
+
+    WorkerQueue& queue = currentExecutor == this ? *vWorkerQueues[nCurrentWorker] : injectionQueue;
+    {
+        std::lock_guard<std::mutex> lock(queue.cs);
+        queue.tasks[priority].emplace_back(std::move(task));
+    }
+    {
+        // incrementing while holding cs makes sure that a worker which is about to sleep sees the new task
+        std::lock_guard<std::mutex> lock(cs);
+        nQueued++;
+    }
+    cond.notify_one();
+}
+
+int CExecutor::GetCurrentWorker()
+{
+    return nCurrentWorker;
+}
+
+bool CExecutor::PopTask(WorkerQueue& queue, int priority, bool fNewest, Task& taskRet)
+{
+    std::lock_guard<std::mutex> lock(queue.cs);
+    auto& tasks = queue.tasks[priority];
+    if (tasks.empty()) {
+        return false;
+    }
+    if (fNewest) {
+        taskRet = std::move(tasks.back());
+        tasks.pop_back();
+    } else {
+        taskRet = std::move(tasks.front());
+        tasks.pop_front();
+    }
+    nQueued--;
+    return true;
+}
+
+bool CExecutor::TakeTask(int nWorker, Task& taskRet)
+{
+    int nWorkers = (int)vWorkerQueues.size();
+    for (int i = 0; i < TASK_PRIORITY_COUNT; i++) {
+        if (PopTask(*vWorkerQueues[nWorker], i, true, taskRet)) {
+            return true;
+        }
+        if (PopTask(injectionQueue, i, false, taskRet)) {
+            return true;
+        }
+        for (int j = 1; j < nWorkers; j++) {
+            if (PopTask(*vWorkerQueues[(nWorker + j) % nWorkers], i, false, taskRet)) {
+                nStolen++;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CExecutor::ThreadWorker(int nWorker)
+{
+    RenameThread(strprintf("xazab-worker-%d", nWorker).c_str());
+    currentExecutor = this;
+    nCurrentWorker = nWorker;
+
+    Task task;
+    while (true) {
+        if (TakeTask(nWorker, task)) {
+            task();
+            // destroy the task's state before sleeping
+            task = nullptr;
+            nExecuted++;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(cs);
+        if (fStopRequested && nQueued <= 0) {
+            break;
+        }
+        cond.wait(lock, [this] { return nQueued > 0 || fStopRequested; });
+    }
+
+    currentExecutor = nullptr;
+    nCurrentWorker = -1;
+}
+
+void CExecutor::RegisterGroup(const CTaskGroup* group)
+{
+    std::lock_guard<std::mutex> lock(csGroups);
+    vGroups.emplace_back(group);
+}
+
+void CExecutor::UnregisterGroup(const CTaskGroup* group)
+{
+    std::lock_guard<std::mutex> lock(csGroups);
+    vGroups.erase(std::remove(vGroups.begin(), vGroups.end(), group), vGroups.end());
+}
+
+std::vector<CTaskGroupStats> CExecutor::GetGroupStats() const
+{
+    std::lock_guard<std::mutex> lock(csGroups);
+    std::vector<CTaskGroupStats> ret;
+    ret.reserve(vGroups.size());
+    for (const auto group : vGroups) {
+        ret.emplace_back(group->GetStats());
+    }
+    return ret;
+}
+
+CTaskGroup::CTaskGroup(CExecutor& _executor, const std::string& _strName, int _nMaxConcurrency, TaskPriority _priority) :
+    executor(_executor),
+    strName(_strName),
+    nMaxConcurrency(std::max(1, _nMaxConcurrency)),
+    priority(_priority)
+{
+    executor.RegisterGroup(this);
+}
+
+CTaskGroup::~CTaskGroup()
+{
+    Stop();
+    executor.UnregisterGroup(this);
+}
+
+void CTaskGroup::Submit(CExecutor::Task&& task)
+{
+    BacklogEntry entry{std::move(task), GetTimeMicros()};
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        if (fStopped) {
+            return;
+        }
+        nSubmitted++;
+        if (nActive >= nMaxConcurrency) {
+            backlog.emplace_back(std::move(entry));
+            return;
+        }
+        nActive++;
+    }
+    Dispatch(std::move(entry));
+}
+
+void CTaskGroup::Dispatch(BacklogEntry&& entry)
+{
+    auto sharedEntry = std::make_shared<BacklogEntry>(std::move(entry));
+    executor.Schedule([this, sharedEntry]() { Run(*sharedEntry); }, priority);
+}
+
+void CTaskGroup::Run(const BacklogEntry& entry)
+{
+    int64_t nStartTime = GetTimeMicros();
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        nRunning++;
+        int64_t nWaitMicros = nStartTime - entry.nSubmitTime;
+        nTotalWaitMicros += nWaitMicros;
+        nMaxWaitMicros = std::max(nMaxWaitMicros, nWaitMicros);
+    }
+
+    entry.task();
+
+    int64_t nRunMicros = GetTimeMicros() - nStartTime;
+    BacklogEntry next;
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        nRunning--;
+        nCompleted++;
+        nTotalRunMicros += nRunMicros;
+        nMaxRunMicros = std::max(nMaxRunMicros, nRunMicros);
+        if (backlog.empty()) {
+            // the slot is free now, Stop() might be waiting for it. Don't touch "this" after this point.
+            nActive--;
+            cond.notify_all();
+            return;
+        }
+        // pass our slot on to the oldest task of the backlog
+        next = std::move(backlog.front());
+        backlog.pop_front();
+    }
+    Dispatch(std::move(next));
+}
+
+void CTaskGroup::Stop()
+{
+    std::deque<BacklogEntry> dropped;
+    std::unique_lock<std::mutex> lock(cs);
+    fStopped = true;
+    dropped.swap(backlog);
+    cond.wait(lock, [this] { return nActive == 0; });
+}
+
+CTaskGroupStats CTaskGroup::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    CTaskGroupStats stats;
+    stats.strName = strName;
+    stats.priority = priority;
+    stats.nMaxConcurrency = nMaxConcurrency;
+    stats.nQueued = backlog.size() + (nActive - nRunning);
+    stats.nRunning = nRunning;
+    stats.nSubmitted = nSubmitted;
+    stats.nCompleted = nCompleted;
+    stats.nTotalWaitMicros = nTotalWaitMicros;
+    stats.nMaxWaitMicros = nMaxWaitMicros;
+    stats.nTotalRunMicros = nTotalRunMicros;
+    stats.nMaxRunMicros = nMaxRunMicros;
+    return stats;
+}
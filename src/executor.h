@@ -0,0 +1,192 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_EXECUTOR_H
+#define XAZAB_EXECUTOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! -executorthreads default, 0 means one thread per core
+static const int DEFAULT_EXECUTOR_THREADS = 0;
+static const int MAX_EXECUTOR_THREADS = 64;
+
+enum TaskPriority {
+    TASK_PRIORITY_HIGH = 0,
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_LOW,
+
+    TASK_PRIORITY_COUNT
+};
+
+std::string TaskPriorityToString(TaskPriority priority);
+
+class CTaskGroup;
+
+struct CTaskGroupStats {
+    std::string strName;
+    TaskPriority priority;
+    int nMaxConcurrency;
+    //! Tasks which wait for a free slot of the group or for a worker
+    size_t nQueued;
+    size_t nRunning;
+    uint64_t nSubmitted;
+    uint64_t nCompleted;
+    //! Time between submitting and starting a task
+    int64_t nTotalWaitMicros;
+    int64_t nMaxWaitMicros;
+    int64_t nTotalRunMicros;
+    int64_t nMaxRunMicros;
+};
+
+/**
+ * Thread pool which is shared by the subsystems with bursty, compute intensive work, so that one of them can use
+ * the cores the others leave idle. Every worker has its own task deques (one per priority). Tasks which are
+ * submitted by a worker go to its own deques, all others go to a shared injection queue. Workers take the newest
+ * task of their own deques first (its data is most likely still in the cache), then the oldest task of the
+ * injection queue and finally steal the oldest task of another worker. Higher priorities always come first.
+ *
+ * Subsystems don't submit to the executor directly but through a CTaskGroup.
+ */
+class CExecutor
+{
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct WorkerQueue {
+        std::mutex cs;
+        std::deque<Task> tasks[TASK_PRIORITY_COUNT];
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue> > vWorkerQueues;
+    WorkerQueue injectionQueue;
+    std::vector<std::thread> vThreads;
+    std::atomic<bool> fRunning{false};
+
+    // guards sleeping and waking up of the workers
+    std::mutex cs;
+    std::condition_variable cond;
+    bool fStopRequested{false};
+    // tasks in any of the queues, might be negative for a moment as it's decremented without holding cs
+    std::atomic<int64_t> nQueued{0};
+
+    std::atomic<uint64_t> nExecuted{0};
+    std::atomic<uint64_t> nStolen{0};
+
+    mutable std::mutex csGroups;
+    std::vector<const CTaskGroup*> vGroups;
+
+    bool PopTask(WorkerQueue& queue, int priority, bool fNewest, Task& taskRet);
+    bool TakeTask(int nWorker, Task& taskRet);
+    void ThreadWorker(int nWorker);
+
+public:
+    CExecutor() {}
+    ~CExecutor();
+
+    CExecutor(const CExecutor&) = delete;
+    CExecutor& operator=(const CExecutor&) = delete;
+
+    void Start(int nThreads);
+    //! Runs the tasks which are still queued and then joins the workers
+    void Stop();
+    bool IsRunning() const { return fRunning; }
+    int GetThreadCount() const { return (int)vThreads.size(); }
+
+    /** Queues a task. If the executor isn't running, the task is run right away on the calling thread. */
+    void Schedule(Task&& task, TaskPriority priority);
+
+    /** Index of the worker the calling thread is, -1 if it isn't a worker of any executor */
+    static int GetCurrentWorker();
+
+    int64_t GetQueuedCount() const { return std::max<int64_t>(0, nQueued); }
+    uint64_t GetExecutedCount() const { return nExecuted; }
+    uint64_t GetStolenCount() const { return nStolen; }
+
+    void RegisterGroup(const CTaskGroup* group);
+    void UnregisterGroup(const CTaskGroup* group);
+    std::vector<CTaskGroupStats> GetGroupStats() const;
+};
+
+/**
+ * A subsystem's share of an executor. At most nMaxConcurrency tasks of the group are handed to the executor at the
+ * same time, the others wait in the group's backlog. This keeps one subsystem from occupying all workers and keeps
+ * the order of its tasks. The group also keeps the queue depth and latency statistics of its tasks.
+ */
+class CTaskGroup
+{
+private:
+    struct BacklogEntry {
+        CExecutor::Task task;
+        int64_t nSubmitTime;
+    };
+
+    CExecutor& executor;
+    const std::string strName;
+    const int nMaxConcurrency;
+    const TaskPriority priority;
+
+    mutable std::mutex cs;
+    std::condition_variable cond;
+    std::deque<BacklogEntry> backlog;
+    // tasks which were handed to the executor and didn't finish yet
+    int nActive{0};
+    size_t nRunning{0};
+    bool fStopped{false};
+
+    uint64_t nSubmitted{0};
+    uint64_t nCompleted{0};
+    int64_t nTotalWaitMicros{0};
+    int64_t nMaxWaitMicros{0};
+    int64_t nTotalRunMicros{0};
+    int64_t nMaxRunMicros{0};
+
+    void Submit(CExecutor::Task&& task);
+    void Dispatch(BacklogEntry&& entry);
+    void Run(const BacklogEntry& entry);
+
+public:
+    CTaskGroup(CExecutor& _executor, const std::string& _strName, int _nMaxConcurrency, TaskPriority _priority = TASK_PRIORITY_NORMAL);
+    ~CTaskGroup();
+
+    CTaskGroup(const CTaskGroup&) = delete;
+    CTaskGroup& operator=(const CTaskGroup&) = delete;
+
+    /**
+     * Runs f(nWorker, args...) on the executor, nWorker being the index of the worker which runs it (or -1).
+     * The returned future holds the result or the exception thrown by f. If the group is stopped before the task
+     * runs, the future reports a broken promise.
+     */
+    template <typename F, typename... Args>
+    auto Push(F&& f, Args&&... args) -> std::future<decltype(f(0, args...))>
+    {
+        typedef decltype(f(0, args...)) R;
+        auto task = std::make_shared<std::packaged_task<R(int)> >(
+                std::bind(std::forward<F>(f), std::placeholders::_1, std::forward<Args>(args)...));
+        auto future = task->get_future();
+        Submit([task]() { (*task)(CExecutor::GetCurrentWorker()); });
+        return future;
+    }
+
+    /** Drops the tasks in the backlog and waits for the others. Tasks which are pushed afterwards are dropped. */
+    void Stop();
+
+    const std::string& GetName() const { return strName; }
+    CTaskGroupStats GetStats() const;
+};
+
+/** Executor for compute intensive work of the LLMQ subsystems, started by AppInitMain */
+extern CExecutor g_executor;
+
+#endif // XAZAB_EXECUTOR_H
@@ -0,0 +1,838 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "explorerindex.h"
+
+#include "chain.h"
+#include "chainparams.h"
+#include "coins.h"
+#include "hash.h"
+#include "undo.h"
+#include "util.h"
+#include "validation.h"
+
+#include <map>
+#include <set>
+
+#include <boost/thread.hpp>
+
+static const char DB_ADDRESSINDEX = 'a';
+static const char DB_ADDRESSUNSPENTINDEX = 'u';
+static const char DB_ADDRESSBALANCE = 'A';
+static const char DB_TIMESTAMPINDEX = 's';
+static const char DB_SPENTINDEX = 'p';
+
+static const char DB_BEST_BLOCK = 'B';
+static const char DB_INDEXED_TIP = 'T';
+static const char DB_JOURNAL = 'J';
+static const char DB_FLAG = 'F';
+
+//! Number of recently connected blocks kept for the indexing thread
+static const size_t MAX_RECENT_BLOCKS = 16;
+
+std::unique_ptr<CExplorerIndex> g_explorerindex;
+
+CExplorerIndexDB::CExplorerIndexDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "indexes" / "explorer", nCacheSize, fMemory, fWipe, false, "explorer") {
+}
+
+bool CExplorerIndexDB::ReadBestBlock(CBlockLocator &locator) {
+    return Read(DB_BEST_BLOCK, locator);
+}
+
+void CExplorerIndexDB::WriteBestBlock(CDBBatch &batch, const CBlockLocator &locator) {
+    batch.Write(DB_BEST_BLOCK, locator);
+}
+
+bool CExplorerIndexDB::ReadIndexedTip(uint256 &hash, uint64_t &nSeq) {
+    std::pair<uint256, uint64_t> tip;
+    if (!Read(DB_INDEXED_TIP, tip))
+        return false;
+    hash = tip.first;
+    nSeq = tip.second;
+    return true;
+}
+
+void CExplorerIndexDB::WriteIndexedTip(CDBBatch &batch, const uint256 &hash, uint64_t nSeq) {
+    batch.Write(DB_INDEXED_TIP, std::make_pair(hash, nSeq));
+}
+
+bool CExplorerIndexDB::ReadJournal(uint64_t nSeq, CExplorerIndexJournalEntry &entry) {
+    return Read(std::make_pair(DB_JOURNAL, nSeq), entry);
+}
+
+void CExplorerIndexDB::WriteJournal(CDBBatch &batch, uint64_t nSeq, const CExplorerIndexJournalEntry &entry) {
+    batch.Write(std::make_pair(DB_JOURNAL, nSeq), entry);
+}
+
+void CExplorerIndexDB::EraseJournal(CDBBatch &batch, uint64_t nSeq) {
+    batch.Erase(std::make_pair(DB_JOURNAL, nSeq));
+}
+
+bool CExplorerIndexDB::WriteFlag(const std::string &name, bool fValue) {
+    return Write(std::make_pair(DB_FLAG, name), fValue ? '1' : '0');
+}
+
+bool CExplorerIndexDB::ReadFlag(const std::string &name, bool &fValue) {
+    char ch;
+    if (!Read(std::make_pair(DB_FLAG, name), ch))
+        return false;
+    fValue = ch == '1';
+    return true;
+}
+
+bool CExplorerIndexDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) {
+    return Read(std::make_pair(DB_SPENTINDEX, key), value);
+}
+
+void CExplorerIndexDB::UpdateSpentIndex(CDBBatch &batch, const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect) {
+    for (std::vector<std::pair<CSpentIndexKey,CSpentIndexValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(std::make_pair(DB_SPENTINDEX, it->first));
+        } else {
+            batch.Write(std::make_pair(DB_SPENTINDEX, it->first), it->second);
+        }
+    }
+}
+
+void CExplorerIndexDB::UpdateAddressUnspentIndex(CDBBatch &batch, const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect) {
+    for (std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        if (it->second.IsNull()) {
+            batch.Erase(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first));
+        } else {
+            batch.Write(std::make_pair(DB_ADDRESSUNSPENTINDEX, it->first), it->second);
+        }
+    }
+}
+
+bool CExplorerIndexDB::ReadAddressUnspentIndex(uint160 addressHash, int type,
+                                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs) {
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressUnspentKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.hashBytes == addressHash) {
+            CAddressUnspentValue nValue;
+            if (pcursor->GetValue(nValue)) {
+                unspentOutputs.push_back(std::make_pair(key.second, nValue));
+                pcursor->Next();
+            } else {
+                return error("failed to get address unspent value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+void CExplorerIndexDB::UpdateAddressBalances(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect, bool fErase) {
+    typedef std::pair<unsigned int, uint160> AddressKey;
+    std::map<AddressKey, CAddressBalanceValue> mapDeltas;
+    std::set<std::pair<AddressKey, uint256> > setTxs;
+
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++) {
+        CAmount nValue = it->second;
+        AddressKey addressKey(it->first.type, it->first.hashBytes);
+        CAddressBalanceValue &delta = mapDeltas[addressKey];
+        delta.balance += nValue;
+        if (nValue > 0) {
+            delta.received += nValue;
+        } else {
+            delta.sent -= nValue;
+        }
+        if (setTxs.emplace(addressKey, it->first.txhash).second) {
+            delta.txCount++;
+        }
+    }
+
+    for (std::map<AddressKey, CAddressBalanceValue>::const_iterator it=mapDeltas.begin(); it!=mapDeltas.end(); it++) {
+        auto key = std::make_pair(DB_ADDRESSBALANCE, CAddressIndexIteratorKey(it->first.first, it->first.second));
+        CAddressBalanceValue value;
+        Read(key, value);
+        if (fErase) {
+            value.balance -= it->second.balance;
+            value.received -= it->second.received;
+            value.sent -= it->second.sent;
+            value.txCount -= std::min(value.txCount, it->second.txCount);
+        } else {
+            value.balance += it->second.balance;
+            value.received += it->second.received;
+            value.sent += it->second.sent;
+            value.txCount += it->second.txCount;
+        }
+        if (value.IsNull()) {
+            batch.Erase(key);
+        } else {
+            batch.Write(key, value);
+        }
+    }
+}
+
+bool CExplorerIndexDB::ReadAddressUnspentIndexPage(const CAddressUnspentKey &startKey, size_t nLimit,
+                                               std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                                               CAddressUnspentKey &nextKey, bool &fMore) {
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSUNSPENTINDEX, startKey));
+
+    fMore = false;
+    size_t nRead = 0;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressUnspentKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSUNSPENTINDEX || key.second.type != startKey.type || key.second.hashBytes != startKey.hashBytes) {
+            break;
+        }
+        if (nRead == nLimit) {
+            // the first entry which doesn't fit anymore is where the next page starts
+            nextKey = key.second;
+            fMore = true;
+            break;
+        }
+        CAddressUnspentValue nValue;
+        if (!pcursor->GetValue(nValue)) {
+            return error("failed to get address unspent value");
+        }
+        unspentOutputs.push_back(std::make_pair(key.second, nValue));
+        nRead++;
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+void CExplorerIndexDB::WriteAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+    UpdateAddressBalances(batch, vect, false);
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
+        batch.Write(std::make_pair(DB_ADDRESSINDEX, it->first), it->second);
+}
+
+void CExplorerIndexDB::EraseAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount > >&vect) {
+    UpdateAddressBalances(batch, vect, true);
+    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=vect.begin(); it!=vect.end(); it++)
+        batch.Erase(std::make_pair(DB_ADDRESSINDEX, it->first));
+}
+
+bool CExplorerIndexDB::ReadAddressBalance(uint160 addressHash, int type, CAddressBalanceValue &value) {
+    value.SetNull();
+    // A missing entry means that the address was never used
+    Read(std::make_pair(DB_ADDRESSBALANCE, CAddressIndexIteratorKey(type, addressHash)), value);
+    return true;
+}
+
+bool CExplorerIndexDB::ReadAddressIndex(uint160 addressHash, int type,
+                                    std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                    int start, int end) {
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    if (start > 0 && end > 0) {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
+    } else {
+        pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX && key.second.hashBytes == addressHash) {
+            if (end > 0 && key.second.blockHeight > end) {
+                break;
+            }
+            CAmount nValue;
+            if (pcursor->GetValue(nValue)) {
+                addressIndex.push_back(std::make_pair(key.second, nValue));
+                pcursor->Next();
+            } else {
+                return error("failed to get address index value");
+            }
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool CExplorerIndexDB::ReadAddressIndexPage(const CAddressIndexKey &startKey, int end, size_t nLimit,
+                                        std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                                        CAddressIndexKey &nextKey, bool &fMore) {
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_ADDRESSINDEX, startKey));
+
+    fMore = false;
+    size_t nRead = 0;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char,CAddressIndexKey> key;
+        if (!pcursor->GetKey(key) || key.first != DB_ADDRESSINDEX || key.second.type != startKey.type || key.second.hashBytes != startKey.hashBytes) {
+            break;
+        }
+        if (end > 0 && key.second.blockHeight > end) {
+            break;
+        }
+        if (nRead == nLimit) {
+            // the first entry which doesn't fit anymore is where the next page starts
+            nextKey = key.second;
+            fMore = true;
+            break;
+        }
+        CAmount nValue;
+        if (!pcursor->GetValue(nValue)) {
+            return error("failed to get address index value");
+        }
+        addressIndex.push_back(std::make_pair(key.second, nValue));
+        nRead++;
+        pcursor->Next();
+    }
+
+    return true;
+}
+
+void CExplorerIndexDB::WriteTimestampIndex(CDBBatch &batch, const CTimestampIndexKey &timestampIndex) {
+    batch.Write(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex), 0);
+}
+
+void CExplorerIndexDB::EraseTimestampIndex(CDBBatch &batch, const CTimestampIndexKey &timestampIndex) {
+    batch.Erase(std::make_pair(DB_TIMESTAMPINDEX, timestampIndex));
+}
+
+bool CExplorerIndexDB::ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes) {
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CTimestampIndexKey> key;
+        if (pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp <= high) {
+            hashes.push_back(key.second.blockHash);
+            pcursor->Next();
+        } else {
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+// Returns the address type and hash which the address index uses for script
+static bool GetIndexAddress(const CScript& script, uint160& hashBytes, int& addressType)
+{
+    if (script.IsPayToScriptHash()) {
+        hashBytes = uint160(std::vector<unsigned char>(script.begin()+2, script.begin()+22));
+        addressType = 2;
+    } else if (script.IsPayToPublicKeyHash()) {
+        hashBytes = uint160(std::vector<unsigned char>(script.begin()+3, script.begin()+23));
+        addressType = 1;
+    } else if (script.IsPayToPublicKey()) {
+        hashBytes = Hash160(script.begin()+1, script.end()-1);
+        addressType = 1;
+    } else {
+        hashBytes.SetNull();
+        addressType = 0;
+        return false;
+    }
+    return true;
+}
+
+CExplorerIndex::CExplorerIndex(size_t nCacheSizeIn, bool fAddressIndexIn, bool fSpentIndexIn, bool fTimestampIndexIn) :
+    nCacheSize(nCacheSizeIn),
+    fAddressIndex(fAddressIndexIn),
+    fSpentIndex(fSpentIndexIn),
+    fTimestampIndex(fTimestampIndexIn)
+{
+}
+
+CExplorerIndex::~CExplorerIndex()
+{
+    Interrupt();
+    Stop();
+}
+
+bool CExplorerIndex::Start(bool fWipe)
+{
+    const std::vector<std::pair<std::string, bool> > vFlags = {
+        {"addressindex", fAddressIndex},
+        {"spentindex", fSpentIndex},
+        {"timestampindex", fTimestampIndex},
+    };
+
+    db.reset(new CExplorerIndexDB(nCacheSize, false, fWipe));
+
+    // An existing database can only be continued if it contains the same indexes
+    bool fContinue = true;
+    for (const auto& p : vFlags) {
+        bool fValue = false;
+        db->ReadFlag(p.first, fValue);
+        fContinue &= fValue == p.second;
+    }
+
+    nJournalSeq = 0;
+    if (fContinue) {
+        CBlockLocator locator;
+        uint256 hashLocator;
+        if (db->ReadBestBlock(locator) && !locator.IsNull()) {
+            hashLocator = locator.vHave[0];
+        }
+        uint256 hashTip;
+        if (!db->ReadIndexedTip(hashTip, nJournalSeq)) {
+            // older versions wrote the locator together with every block
+            hashTip = hashLocator;
+        }
+
+        bool fTipKnown;
+        {
+            LOCK(cs_main);
+            fTipKnown = hashTip.IsNull() || mapBlockIndex.count(hashTip);
+        }
+        // After a crash the last indexed blocks might be missing from the block index, which is only written when
+        // the chainstate is flushed. Their entries are undone back to the flushed best block then.
+        if (!fTipKnown) {
+            LogPrintf("%s: reverting explorer indexes from unknown block %s to %s\n", __func__, hashTip.ToString(), hashLocator.ToString());
+            if (RevertJournal(hashTip, hashLocator)) {
+                hashTip = hashLocator;
+            } else {
+                fContinue = false;
+            }
+        }
+
+        if (fContinue && !hashTip.IsNull()) {
+            LOCK(cs_main);
+            BlockMap::iterator it = mapBlockIndex.find(hashTip);
+            if (it != mapBlockIndex.end()) {
+                SetBest(it->second);
+            } else {
+                // without the block we can't undo its entries if it's not part of the active chain anymore
+                fContinue = false;
+            }
+        }
+    }
+
+    if (!fContinue) {
+        LogPrintf("%s: building explorer indexes from scratch\n", __func__);
+        db.reset();
+        db.reset(new CExplorerIndexDB(nCacheSize, false, true));
+        SetBest(nullptr);
+        nJournalSeq = 0;
+        for (const auto& p : vFlags) {
+            if (!db->WriteFlag(p.first, p.second)) {
+                return error("%s: failed to write flags", __func__);
+            }
+        }
+    } else {
+        LogPrintf("%s: explorer indexes are at height %d\n", __func__, nBestHeight);
+    }
+
+    RegisterValidationInterface(this);
+
+    workThread = std::thread(&TraceThread<std::function<void()> >,
+        "explorerindex",
+        std::function<void()>(std::bind(&CExplorerIndex::WorkThreadMain, this)));
+
+    return true;
+}
+
+void CExplorerIndex::Interrupt()
+{
+    workInterrupt();
+    Wake();
+}
+
+void CExplorerIndex::Stop()
+{
+    if (workThread.joinable()) {
+        UnregisterValidationInterface(this);
+        workThread.join();
+        // the final flush of the shutdown usually comes after the thread's last round
+        CommitFlushedTip();
+    }
+}
+
+bool CExplorerIndex::BlockUntilSyncedToCurrentChain()
+{
+    if (!fSynced) {
+        return false;
+    }
+
+    const CBlockIndex* pindexTip;
+    {
+        LOCK(cs_main);
+        pindexTip = chainActive.Tip();
+    }
+
+    // Once synced, the thread is at most a few blocks behind
+    std::unique_lock<std::mutex> lock(cs);
+    return condBest.wait_for(lock, std::chrono::seconds(10), [&] {
+        return workInterrupt || (pindexBest && pindexBest->GetAncestor(pindexTip->nHeight) == pindexTip);
+    }) && !workInterrupt;
+}
+
+void CExplorerIndex::BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txnConflicted)
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        recentBlocks.emplace_back(block);
+        if (recentBlocks.size() > MAX_RECENT_BLOCKS) {
+            recentBlocks.pop_front();
+        }
+    }
+    Wake();
+}
+
+void CExplorerIndex::BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindexDisconnected)
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        recentBlocks.emplace_back(block);
+        if (recentBlocks.size() > MAX_RECENT_BLOCKS) {
+            recentBlocks.pop_front();
+        }
+    }
+    Wake();
+}
+
+void CExplorerIndex::SetBestChain(const CBlockLocator& locator)
+{
+    if (locator.IsNull()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        hashFlushedTip = locator.vHave[0];
+    }
+    Wake();
+}
+
+void CExplorerIndex::Wake()
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        fWake = true;
+    }
+    condWake.notify_one();
+}
+
+void CExplorerIndex::SetBest(const CBlockIndex* pindex)
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        pindexBest = pindex;
+        nBestHeight = pindex ? pindex->nHeight : -1;
+    }
+    condBest.notify_all();
+}
+
+void CExplorerIndex::WorkThreadMain()
+{
+    while (!workInterrupt) {
+        CommitFlushedTip();
+
+        const CBlockIndex* pindex;
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            pindex = pindexBest;
+        }
+
+        const CBlockIndex* pindexNext = nullptr;
+        const CBlockIndex* pindexDisconnect = nullptr;
+        {
+            LOCK(cs_main);
+            const CBlockIndex* pindexTip = chainActive.Tip();
+            if (pindex && !chainActive.Contains(pindex)) {
+                // Undo blocks which are not part of the active chain anymore, unless the active chain is just
+                // being rebuilt and didn't reach them yet (e.g. with -reindex-chainstate)
+                if ((pindex->nStatus & BLOCK_FAILED_MASK) || (pindexTip && pindexTip->nChainWork >= pindex->nChainWork)) {
+                    pindexDisconnect = pindex;
+                }
+            } else if (pindexTip) {
+                pindexNext = pindex ? chainActive.Next(pindex) : chainActive.Genesis();
+                if (!pindexNext && !fSynced) {
+                    LogPrintf("%s: explorer indexes are synced at height %d\n", __func__, pindexTip->nHeight);
+                    fSynced = true;
+                }
+            }
+        }
+
+        bool fOk = true;
+        if (pindexDisconnect) {
+            fOk = DisconnectBlock(pindexDisconnect);
+        } else if (pindexNext) {
+            fOk = ConnectBlock(pindexNext);
+            if (fOk && pindexNext->nHeight % 10000 == 0) {
+                LogPrintf("%s: explorer indexes are at height %d\n", __func__, pindexNext->nHeight);
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(cs);
+            condWake.wait_for(lock, std::chrono::seconds(1), [this] { return fWake; });
+            fWake = false;
+        }
+
+        if (!fOk) {
+            LogPrintf("%s: ERROR: failed to update explorer indexes at height %d, stopping\n", __func__, nBestHeight);
+            fSynced = false;
+            break;
+        }
+    }
+}
+
+void CExplorerIndex::IndexBlock(CExplorerIndexDelta& delta, const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex, bool fConnect)
+{
+    delta.fConnect = fConnect;
+    std::vector<std::pair<CAddressIndexKey, CAmount> >& addressIndex = delta.addressIndex;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >& addressUnspentIndex = delta.addressUnspentIndex;
+    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >& spentIndex = delta.spentIndex;
+
+    uint160 hashBytes;
+    int addressType;
+
+    auto indexInputs = [&](const CTransaction& tx, unsigned int i) {
+        if (tx.IsCoinBase()) {
+            return;
+        }
+        const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+        for (size_t j = 0; j < tx.vin.size(); j++) {
+            const CTxIn& input = tx.vin[j];
+            const Coin& coin = txundo.vprevout[j];
+            const CTxOut& prevout = coin.out;
+            bool fHasAddress = GetIndexAddress(prevout.scriptPubKey, hashBytes, addressType);
+
+            if (fAddressIndex && fHasAddress) {
+                // record spending activity
+                addressIndex.push_back(std::make_pair(CAddressIndexKey(addressType, hashBytes, pindex->nHeight, i, tx.GetHash(), j, true), prevout.nValue * -1));
+
+                // remove address from unspent index, or restore it when disconnecting
+                addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(addressType, hashBytes, input.prevout.hash, input.prevout.n),
+                    fConnect ? CAddressUnspentValue() : CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, coin.nHeight)));
+            }
+
+            if (fSpentIndex) {
+                // add the spent index to determine the txid and input that spent an output
+                // and to find the amount and address from an input
+                spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n),
+                    fConnect ? CSpentIndexValue(tx.GetHash(), j, pindex->nHeight, prevout.nValue, addressType, hashBytes) : CSpentIndexValue()));
+            }
+        }
+    };
+
+    auto indexOutputs = [&](const CTransaction& tx, unsigned int i) {
+        if (!fAddressIndex) {
+            return;
+        }
+        for (unsigned int k = 0; k < tx.vout.size(); k++) {
+            const CTxOut& out = tx.vout[k];
+            if (!GetIndexAddress(out.scriptPubKey, hashBytes, addressType)) {
+                continue;
+            }
+
+            // record receiving activity
+            addressIndex.push_back(std::make_pair(CAddressIndexKey(addressType, hashBytes, pindex->nHeight, i, tx.GetHash(), k, false), out.nValue));
+
+            // record unspent output, or remove it when disconnecting
+            addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(addressType, hashBytes, tx.GetHash(), k),
+                fConnect ? CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight) : CAddressUnspentValue()));
+        }
+    };
+
+    // Outputs can be spent in the same block, so the unspent index changes must be applied in the same order as
+    // ConnectBlock and DisconnectBlock apply the coin changes
+    if (fConnect) {
+        for (unsigned int i = 0; i < block.vtx.size(); i++) {
+            indexInputs(*block.vtx[i], i);
+            indexOutputs(*block.vtx[i], i);
+        }
+    } else {
+        for (unsigned int i = block.vtx.size(); i-- > 0;) {
+            indexOutputs(*block.vtx[i], i);
+            indexInputs(*block.vtx[i], i);
+        }
+    }
+
+    if (fTimestampIndex) {
+        delta.timestampIndex.emplace_back(pindex->nTime, pindex->GetBlockHash());
+    }
+}
+
+void CExplorerIndex::ApplyDelta(CDBBatch& batch, const CExplorerIndexDelta& delta)
+{
+    if (fAddressIndex) {
+        if (delta.fConnect) {
+            db->WriteAddressIndex(batch, delta.addressIndex);
+        } else {
+            db->EraseAddressIndex(batch, delta.addressIndex);
+        }
+        db->UpdateAddressUnspentIndex(batch, delta.addressUnspentIndex);
+    }
+
+    if (fSpentIndex) {
+        db->UpdateSpentIndex(batch, delta.spentIndex);
+    }
+
+    for (const auto& timestampIndex : delta.timestampIndex) {
+        if (delta.fConnect) {
+            db->WriteTimestampIndex(batch, timestampIndex);
+        } else {
+            db->EraseTimestampIndex(batch, timestampIndex);
+        }
+    }
+}
+
+bool CExplorerIndex::ReadBlockAndUndo(const CBlockIndex* pindex, std::shared_ptr<const CBlock>& pblock, CBlockUndo& blockundo)
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        for (const auto& pblockRecent : recentBlocks) {
+            if (pblockRecent->GetHash() == pindex->GetBlockHash()) {
+                pblock = pblockRecent;
+                break;
+            }
+        }
+    }
+    if (!pblock) {
+        std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
+        if (!ReadBlockFromDisk(*pblockRead, pindex, Params().GetConsensus())) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+        pblock = pblockRead;
+    }
+
+    CDiskBlockPos pos;
+    {
+        LOCK(cs_main);
+        pos = pindex->GetUndoPos();
+    }
+    if (pos.IsNull() || !UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash())) {
+        return error("%s: failed to read undo data of block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    if (blockundo.vtxundo.size() + 1 != pblock->vtx.size()) {
+        return error("%s: block and undo data of %s inconsistent", __func__, pindex->GetBlockHash().ToString());
+    }
+    return true;
+}
+
+bool CExplorerIndex::WriteBlock(const CBlockIndex* pindex, const CBlockIndex* pindexNewTip, bool fConnect)
+{
+    CDBBatch batch(*db);
+    CExplorerIndexDelta delta;
+    CExplorerIndexJournalEntry entry;
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        entry.hashPrevTip = pindexBest ? pindexBest->GetBlockHash() : uint256();
+    }
+
+    // Like ConnectBlock, don't index the genesis block
+    if (pindex->pprev) {
+        std::shared_ptr<const CBlock> pblock;
+        CBlockUndo blockundo;
+        if (!ReadBlockAndUndo(pindex, pblock, blockundo)) {
+            return false;
+        }
+        IndexBlock(delta, *pblock, blockundo, pindex, fConnect);
+        IndexBlock(entry.undo, *pblock, blockundo, pindex, !fConnect);
+    }
+    ApplyDelta(batch, delta);
+
+    // The best block locator is only updated by CommitFlushedTip, the journal covers the blocks after it
+    db->WriteJournal(batch, nJournalSeq + 1, entry);
+    db->WriteIndexedTip(batch, pindexNewTip ? pindexNewTip->GetBlockHash() : uint256(), nJournalSeq + 1);
+    if (!db->WriteBatch(batch)) {
+        return error("%s: failed to write block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    nJournalSeq++;
+
+    SetBest(pindexNewTip);
+    return true;
+}
+
+bool CExplorerIndex::ConnectBlock(const CBlockIndex* pindex)
+{
+    return WriteBlock(pindex, pindex, true);
+}
+
+bool CExplorerIndex::DisconnectBlock(const CBlockIndex* pindex)
+{
+    return WriteBlock(pindex, pindex->pprev, false);
+}
+
+bool CExplorerIndex::RevertJournal(uint256 hashTip, const uint256& hashTarget)
+{
+    // every batch only contains one entry, as UpdateAddressBalances reads the balances from the database
+    while (hashTip != hashTarget) {
+        CExplorerIndexJournalEntry entry;
+        if (nJournalSeq == 0 || !db->ReadJournal(nJournalSeq, entry)) {
+            return error("%s: journal entry %d of block %s missing", __func__, nJournalSeq, hashTip.ToString());
+        }
+        CDBBatch batch(*db);
+        ApplyDelta(batch, entry.undo);
+        db->EraseJournal(batch, nJournalSeq);
+        db->WriteIndexedTip(batch, entry.hashPrevTip, nJournalSeq - 1);
+        if (!db->WriteBatch(batch)) {
+            return error("%s: failed to revert block %s", __func__, hashTip.ToString());
+        }
+        hashTip = entry.hashPrevTip;
+        nJournalSeq--;
+    }
+    return true;
+}
+
+void CExplorerIndex::CommitFlushedTip()
+{
+    uint256 hashFlushed;
+    const CBlockIndex* pindex;
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        hashFlushed.SetNull();
+        std::swap(hashFlushed, hashFlushedTip);
+        pindex = pindexBest;
+    }
+    if (hashFlushed.IsNull() || !pindex) {
+        return;
+    }
+
+    // The indexed blocks which are also ancestors of the flushed tip are in the flushed block index
+    const CBlockIndex* pindexFork;
+    CBlockLocator locator;
+    {
+        LOCK(cs_main);
+        BlockMap::iterator it = mapBlockIndex.find(hashFlushed);
+        if (it == mapBlockIndex.end()) {
+            return;
+        }
+        pindexFork = LastCommonAncestor(it->second, pindex);
+        if (!pindexFork) {
+            return;
+        }
+        locator = chainActive.GetLocator(pindexFork);
+    }
+
+    // Find the last time the index entries were at the fork, the journal entries up to then aren't needed anymore
+    uint256 hashCur = pindex->GetBlockHash();
+    uint64_t nSeq = nJournalSeq;
+    while (hashCur != pindexFork->GetBlockHash()) {
+        CExplorerIndexJournalEntry entry;
+        if (nSeq == 0 || !db->ReadJournal(nSeq, entry)) {
+            // the fork is before the last committed locator
+            return;
+        }
+        hashCur = entry.hashPrevTip;
+        nSeq--;
+    }
+
+    CDBBatch batch(*db);
+    db->WriteBestBlock(batch, locator);
+    for (; nSeq > 0 && db->Exists(std::make_pair(DB_JOURNAL, nSeq)); nSeq--) {
+        db->EraseJournal(batch, nSeq);
+    }
+    if (!db->WriteBatch(batch)) {
+        LogPrintf("%s: ERROR: failed to write the best block locator\n", __func__);
+    }
+}
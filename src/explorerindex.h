@@ -0,0 +1,197 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_EXPLORERINDEX_H
+#define XAZAB_EXPLORERINDEX_H
+
+#include "dbwrapper.h"
+#include "spentindex.h"
+#include "threadinterrupt.h"
+#include "validationinterface.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class CBlock;
+class CBlockIndex;
+class CBlockUndo;
+struct CBlockLocator;
+
+//! -explorerindexcache default (MiB)
+static const int64_t nDefaultExplorerIndexCache = 100;
+
+/** The index entries which one block adds (fConnect) or removes */
+struct CExplorerIndexDelta {
+    bool fConnect{true};
+    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
+    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
+    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
+    std::vector<CTimestampIndexKey> timestampIndex;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(fConnect);
+        READWRITE(addressIndex);
+        READWRITE(addressUnspentIndex);
+        READWRITE(spentIndex);
+        READWRITE(timestampIndex);
+    }
+};
+
+/**
+ * Reverts one block batch. The batches after the last flushed best block are journaled, so that they can be undone
+ * when their blocks are gone from the block index after a crash.
+ */
+struct CExplorerIndexJournalEntry {
+    // the indexed tip before the batch
+    uint256 hashPrevTip;
+    CExplorerIndexDelta undo;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(hashPrevTip);
+        READWRITE(undo);
+    }
+};
+
+/** Access to the explorer index database (indexes/explorer/) */
+class CExplorerIndexDB : public CDBWrapper
+{
+public:
+    CExplorerIndexDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+
+    /** The best block locator is only written after a chainstate flush, so its block is in the block index */
+    bool ReadBestBlock(CBlockLocator &locator);
+    void WriteBestBlock(CDBBatch &batch, const CBlockLocator &locator);
+    /** The block the index entries were written up to and the sequence number of its journal entry */
+    bool ReadIndexedTip(uint256 &hash, uint64_t &nSeq);
+    void WriteIndexedTip(CDBBatch &batch, const uint256 &hash, uint64_t nSeq);
+    bool ReadJournal(uint64_t nSeq, CExplorerIndexJournalEntry &entry);
+    void WriteJournal(CDBBatch &batch, uint64_t nSeq, const CExplorerIndexJournalEntry &entry);
+    void EraseJournal(CDBBatch &batch, uint64_t nSeq);
+    bool WriteFlag(const std::string &name, bool fValue);
+    bool ReadFlag(const std::string &name, bool &fValue);
+
+    bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
+    void UpdateSpentIndex(CDBBatch &batch, const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > &vect);
+    void UpdateAddressUnspentIndex(CDBBatch &batch, const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
+    bool ReadAddressUnspentIndex(uint160 addressHash, int type,
+                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
+    /** Reads up to nLimit unspent outputs of the address of startKey, beginning at startKey. If there are
+     *  more, fMore is set and nextKey is the key to continue with. */
+    bool ReadAddressUnspentIndexPage(const CAddressUnspentKey &startKey, size_t nLimit,
+                                     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect,
+                                     CAddressUnspentKey &nextKey, bool &fMore);
+    void WriteAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
+    void EraseAddressIndex(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
+    bool ReadAddressIndex(uint160 addressHash, int type,
+                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                          int start = 0, int end = 0);
+    /** Reads up to nLimit address index entries of the address of startKey, beginning at startKey and up to
+     *  height end (if > 0). If there are more, fMore is set and nextKey is the key to continue with. */
+    bool ReadAddressIndexPage(const CAddressIndexKey &startKey, int end, size_t nLimit,
+                              std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                              CAddressIndexKey &nextKey, bool &fMore);
+    bool ReadAddressBalance(uint160 addressHash, int type, CAddressBalanceValue &value);
+    void WriteTimestampIndex(CDBBatch &batch, const CTimestampIndexKey &timestampIndex);
+    void EraseTimestampIndex(CDBBatch &batch, const CTimestampIndexKey &timestampIndex);
+    bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &vect);
+
+private:
+    /** Adds the changes of the address index entries in vect to the per-address balances in batch */
+    void UpdateAddressBalances(CDBBatch &batch, const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect, bool fErase);
+};
+
+/**
+ * Maintains the address, spent and timestamp indexes (-addressindex, -spentindex, -timestampindex) in their own
+ * database. A background thread follows chainActive and indexes one block after another from the block and undo
+ * files, so block connection is never slowed down by these indexes and they can be enabled at any time without
+ * -reindex. BlockConnected/BlockDisconnected only wake up the thread.
+ *
+ * Each block is written in one batch together with a journal entry which reverts it. The best block locator is only
+ * written after a chainstate flush (SetBestChain), so its block is always in the block index on disk. After a crash
+ * the entries of blocks which got lost from the block index are reverted with the journal back to the locator.
+ */
+class CExplorerIndex : public CValidationInterface
+{
+private:
+    std::unique_ptr<CExplorerIndexDB> db;
+    const size_t nCacheSize;
+    const bool fAddressIndex;
+    const bool fSpentIndex;
+    const bool fTimestampIndex;
+
+    std::thread workThread;
+    CThreadInterrupt workInterrupt;
+
+    std::mutex cs;
+    std::condition_variable condWake;
+    bool fWake{false};
+    // notified whenever pindexBest changes
+    std::condition_variable condBest;
+    const CBlockIndex* pindexBest{nullptr};
+    // the last few connected blocks, so that the thread doesn't need to read them from disk again
+    std::deque<std::shared_ptr<const CBlock> > recentBlocks;
+
+    // the tip of the last chainstate flush, to be turned into the best block locator by the thread
+    uint256 hashFlushedTip;
+    // sequence number of the last journal entry, only used by the thread
+    uint64_t nJournalSeq{0};
+
+    std::atomic<bool> fSynced{false};
+    std::atomic<int> nBestHeight{-1};
+
+public:
+    CExplorerIndex(size_t nCacheSizeIn, bool fAddressIndexIn, bool fSpentIndexIn, bool fTimestampIndexIn);
+    ~CExplorerIndex();
+
+    /** Opens the database (wiping it if fWipe is set or the enabled indexes changed) and starts the thread */
+    bool Start(bool fWipe);
+    void Interrupt();
+    void Stop();
+
+    CExplorerIndexDB& GetDB() { return *db; }
+
+    /** Whether the indexes caught up with the active chain at least once */
+    bool IsSynced() const { return fSynced; }
+    int GetBestHeight() const { return nBestHeight; }
+    /** Waits until the indexes include the current tip. Only waits if the indexes are synced already. */
+    bool BlockUntilSyncedToCurrentChain();
+
+protected:
+    void BlockConnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex, const std::vector<CTransactionRef>& txnConflicted) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindexDisconnected) override;
+    void SetBestChain(const CBlockLocator& locator) override;
+
+private:
+    void Wake();
+    void WorkThreadMain();
+    void SetBest(const CBlockIndex* pindex);
+
+    /** Reads a block and its undo data, preferring the recently connected blocks */
+    bool ReadBlockAndUndo(const CBlockIndex* pindex, std::shared_ptr<const CBlock>& pblock, CBlockUndo& blockundo);
+    /** Collects the index entries a block adds (fConnect) or removes */
+    void IndexBlock(CExplorerIndexDelta& delta, const CBlock& block, const CBlockUndo& blockundo, const CBlockIndex* pindex, bool fConnect);
+    void ApplyDelta(CDBBatch& batch, const CExplorerIndexDelta& delta);
+    /** Writes the index entries of a block together with the journal entry which reverts them */
+    bool WriteBlock(const CBlockIndex* pindex, const CBlockIndex* pindexNewTip, bool fConnect);
+    bool ConnectBlock(const CBlockIndex* pindex);
+    bool DisconnectBlock(const CBlockIndex* pindex);
+    /** Undoes journaled batches until the index entries are at hashTarget */
+    bool RevertJournal(uint256 hashTip, const uint256& hashTarget);
+    /** Writes the best block locator for the last flushed tip and drops the journal entries it doesn't need */
+    void CommitFlushedTip();
+};
+
+extern std::unique_ptr<CExplorerIndex> g_explorerindex;
+
+#endif // XAZAB_EXPLORERINDEX_H
@@ -0,0 +1,105 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "histogram.h"
+
+#include "tinyformat.h"
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <cmath>
+
+int CLatencyHistogram::BucketIndex(int64_t nMicros)
+{
+    int i = 0;
+    while (nMicros > 0 && i < BUCKETS - 1) {
+        nMicros >>= 1;
+        i++;
+    }
+    return i;
+}
+
+void CLatencyHistogram::Add(int64_t nMicros)
+{
+    if (nMicros < 0) {
+        nMicros = 0;
+    }
+    nCount++;
+    nTotalMicros += nMicros;
+    nLastMicros = nMicros;
+    nMaxMicros = std::max(nMaxMicros, nMicros);
+    buckets[BucketIndex(nMicros)]++;
+}
+
+void CLatencyHistogram::Merge(const CLatencyHistogram& other)
+{
+    nCount += other.nCount;
+    nTotalMicros += other.nTotalMicros;
+    nMaxMicros = std::max(nMaxMicros, other.nMaxMicros);
+    if (other.nCount) {
+        nLastMicros = other.nLastMicros;
+    }
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+void CLatencyHistogram::Clear()
+{
+    *this = CLatencyHistogram();
+}
+
+int64_t CLatencyHistogram::GetPercentileMicros(double percentile) const
+{
+    if (nCount == 0) {
+        return 0;
+    }
+    uint64_t nTarget = (uint64_t)std::ceil(nCount * std::min(std::max(percentile, 0.0), 100.0) / 100.0);
+    nTarget = std::max(nTarget, (uint64_t)1);
+    uint64_t nSeen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        nSeen += buckets[i];
+        if (nSeen >= nTarget) {
+            if (i == BUCKETS - 1) {
+                return nMaxMicros;
+            }
+            return std::min(i == 0 ? 0 : ((int64_t)1 << i), nMaxMicros);
+        }
+    }
+    return nMaxMicros;
+}
+
+std::string CLatencyHistogram::ToString() const
+{
+    return strprintf("count=%d, total=%.2fms, avg=%dus, p50=%dus, p90=%dus, p99=%dus, max=%dus",
+        nCount, nTotalMicros * 0.001, GetAverageMicros(),
+        GetPercentileMicros(50), GetPercentileMicros(90), GetPercentileMicros(99), nMaxMicros);
+}
+
+UniValue CLatencyHistogram::ToJson(bool fBuckets) const
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("count", nCount));
+    obj.push_back(Pair("total_us", nTotalMicros));
+    obj.push_back(Pair("last_us", nLastMicros));
+    obj.push_back(Pair("avg_us", GetAverageMicros()));
+    obj.push_back(Pair("p50_us", GetPercentileMicros(50)));
+    obj.push_back(Pair("p90_us", GetPercentileMicros(90)));
+    obj.push_back(Pair("p99_us", GetPercentileMicros(99)));
+    obj.push_back(Pair("max_us", nMaxMicros));
+    if (fBuckets) {
+        // only report non-empty buckets, keyed by their (exclusive) upper bound
+        UniValue bucketsObj(UniValue::VOBJ);
+        for (int i = 0; i < BUCKETS; i++) {
+            if (buckets[i] == 0) {
+                continue;
+            }
+            std::string strKey = i == BUCKETS - 1 ? "inf" : strprintf("%d", (int64_t)1 << i);
+            bucketsObj.push_back(Pair(strKey, buckets[i]));
+        }
+        obj.push_back(Pair("buckets", bucketsObj));
+    }
+    return obj;
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_HISTOGRAM_H
+#define XAZAB_HISTOGRAM_H
+
+#include <stdint.h>
+#include <string>
+
+class UniValue;
+
+/**
+ * Cheap fixed-size latency histogram with power-of-two buckets (in microseconds).
+ * Bucket i counts samples in [2^(i-1), 2^i), the last bucket is open ended.
+ * Not thread-safe, owners are expected to guard it with their own lock.
+ */
+class CLatencyHistogram
+{
+public:
+    static const int BUCKETS = 28; // up to ~67 seconds, everything above lands in the last bucket
+
+private:
+    uint64_t nCount{0};
+    uint64_t nTotalMicros{0};
+    int64_t nLastMicros{0};
+    int64_t nMaxMicros{0};
+    uint64_t buckets[BUCKETS] = {};
+
+    static int BucketIndex(int64_t nMicros);
+
+public:
+    void Add(int64_t nMicros);
+    void Merge(const CLatencyHistogram& other);
+    void Clear();
+
+    uint64_t GetCount() const { return nCount; }
+    uint64_t GetTotalMicros() const { return nTotalMicros; }
+    int64_t GetLastMicros() const { return nLastMicros; }
+    int64_t GetMaxMicros() const { return nMaxMicros; }
+    int64_t GetAverageMicros() const { return nCount ? (int64_t)(nTotalMicros / nCount) : 0; }
+
+    /** Upper bound estimate (bucket boundary) for the given percentile (0-100) */
+    int64_t GetPercentileMicros(double percentile) const;
+
+    std::string ToString() const;
+    UniValue ToJson(bool fBuckets = false) const;
+};
+
+#endif // XAZAB_HISTOGRAM_H
@@ -7,6 +7,7 @@
 #include "base58.h"
 #include "chainparams.h"
 #include "httpserver.h"
+#include "jsonwriter.h"
 #include "rpc/protocol.h"
 #include "rpc/server.h"
 #include "random.h"
@@ -22,6 +23,9 @@
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Part of the request body which is searched for the method name when classifying a request */
+static const size_t MAX_CLASSIFY_BODY_SIZE = 4096;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -142,6 +146,54 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return multiUserAuthorized(strUserPass);
 }
 
+std::string JSONRPCPeekMethod(const std::string& strRequest)
+{
+    size_t nDepth = 0;
+    bool fKeyMethod = false;
+    for (size_t i = 0; i < strRequest.size(); i++) {
+        char c = strRequest[i];
+        if (c == '{' || c == '[') {
+            if (nDepth == 0 && c == '[')
+                return "batch";
+            nDepth++;
+        } else if (c == '}' || c == ']') {
+            if (nDepth-- <= 1)
+                return "";
+        } else if (c == '"') {
+            size_t nEnd = i + 1;
+            while (nEnd < strRequest.size() && strRequest[nEnd] != '"') {
+                if (strRequest[nEnd] == '\\')
+                    nEnd++;
+                nEnd++;
+            }
+            if (nEnd >= strRequest.size())
+                return "";
+            std::string str = strRequest.substr(i + 1, nEnd - i - 1);
+            i = nEnd;
+            if (nDepth != 1)
+                continue;
+            if (fKeyMethod)
+                return str;
+            // a top level key is followed by a colon
+            size_t nNext = strRequest.find_first_not_of(" \t\r\n", i + 1);
+            fKeyMethod = str == "method" && nNext != std::string::npos && strRequest[nNext] == ':';
+        } else if (c == ',' && nDepth == 1) {
+            fKeyMethod = false;
+        }
+    }
+    return "";
+}
+
+/** Queue JSON-RPC requests by their method, so they end up in the lane configured for it */
+static std::string HTTPClassify_JSONRPC(HTTPRequest* req)
+{
+    std::string strMethod = JSONRPCPeekMethod(req->PeekBody(MAX_CLASSIFY_BODY_SIZE));
+    // don't let unknown methods pollute the statistics
+    if (strMethod != "batch" && !tableRPC[strMethod])
+        return "";
+    return strMethod;
+}
+
 static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
 {
     // JSONRPC handles only POST
@@ -185,6 +237,18 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
 
+            // Large results are written directly into the reply, without building a UniValue first
+            CJSONWriter writer([req](const char* data, size_t len) { req->WriteReplyPart(data, len); });
+            writer.BeginObject().Key("result");
+            if (tableRPC.executeStream(jreq, writer)) {
+                writer.pushKV("error", NullUniValue);
+                writer.pushKV("id", jreq.id);
+                writer.EndObject();
+                req->WriteHeader("Content-Type", "application/json");
+                req->WriteReply(HTTP_OK, writer.str() + "\n");
+                return true;
+            }
+
             UniValue result = tableRPC.execute(jreq);
 
             // Send reply
@@ -199,9 +263,12 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
+        // a streamed result might have been written partially
+        req->DiscardReplyParts();
         JSONErrorReply(req, objError, jreq.id);
         return false;
     } catch (const std::exception& e) {
+        req->DiscardReplyParts();
         JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
         return false;
     }
@@ -232,10 +299,10 @@ bool StartHTTPRPC()
     if (!InitRPCAuthentication())
         return false;
 
-    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC, HTTPClassify_JSONRPC);
 #ifdef ENABLE_WALLET
     // ifdef can be removed once we switch to better endpoint support and API versioning
-    RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
+    RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC, HTTPClassify_JSONRPC);
 #endif
     assert(EventBase());
     httpRPCTimerInterface = new HTTPRPCTimerInterface(EventBase());
@@ -20,6 +20,12 @@ void InterruptHTTPRPC();
  */
 void StopHTTPRPC();
 
+/**
+ * Finds the value of the top level "method" key of a JSON-RPC request without parsing the whole request.
+ * Returns "batch" for batch requests and an empty string if the method can't be found.
+ */
+std::string JSONRPCPeekMethod(const std::string& strRequest);
+
 /** Start HTTP REST subsystem.
  * Precondition; HTTP and RPC has been started.
  */
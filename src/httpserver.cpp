@@ -40,21 +40,30 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <deque>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+static void RecordHTTPWork(const std::string& strName, HTTPLane lane, int64_t nQueueWaitMicros, int64_t nExecutionMicros);
+
 /** HTTP request work item */
 class HTTPWorkItem : public HTTPClosure
 {
 public:
-    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func):
-        req(std::move(_req)), path(_path), func(_func)
+    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func,
+                 const std::string& _name, HTTPLane _lane):
+        req(std::move(_req)), path(_path), func(_func), name(_name), lane(_lane), nEnqueueTime(GetTimeMicros())
     {
     }
     void operator()() override
     {
+        int64_t nStartTime = GetTimeMicros();
         func(req.get(), path);
+        RecordHTTPWork(name, lane, nStartTime - nEnqueueTime, GetTimeMicros() - nStartTime);
     }
 
     std::unique_ptr<HTTPRequest> req;
@@ -62,6 +71,9 @@ public:
 private:
     std::string path;
     HTTPRequestHandler func;
+    std::string name;
+    HTTPLane lane;
+    int64_t nEnqueueTime;
 };
 
 /** Simple work queue for distributing work over multiple threads.
@@ -116,6 +128,16 @@ public:
             (*i)();
         }
     }
+    /** Number of queued work items */
+    size_t Depth()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        return queue.size();
+    }
+    size_t MaxDepth() const
+    {
+        return maxDepth;
+    }
     /** Interrupt and exit loops */
     void Interrupt()
     {
@@ -128,13 +150,39 @@ public:
 struct HTTPPathHandler
 {
     HTTPPathHandler() {}
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRequestClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
+};
+
+/** Default lanes of RPC methods and REST paths, everything else is served by the default lane */
+static const std::pair<const char*, HTTPLane> DEFAULT_WORK_LANES[] = {
+    // cheap and latency sensitive
+    {"getbestblockhash", HTTP_LANE_HIGH},
+    {"getblockcount", HTTP_LANE_HIGH},
+    {"getblockhash", HTTP_LANE_HIGH},
+    {"getblocktemplate", HTTP_LANE_HIGH},
+    {"submitblock", HTTP_LANE_HIGH},
+    {"sendrawtransaction", HTTP_LANE_HIGH},
+    {"getrpcinfo", HTTP_LANE_HIGH},
+    // potentially slow
+    {"getaddressbalance", HTTP_LANE_LOW},
+    {"getaddressdeltas", HTTP_LANE_LOW},
+    {"getaddressmempool", HTTP_LANE_LOW},
+    {"getaddresstxids", HTTP_LANE_LOW},
+    {"getaddressutxos", HTTP_LANE_LOW},
+    {"getblockhashes", HTTP_LANE_LOW},
+    {"gettxoutsetinfo", HTTP_LANE_LOW},
+    {"gobject", HTTP_LANE_LOW},
+    {"protx", HTTP_LANE_LOW},
+    {"/rest/blocks/", HTTP_LANE_LOW},
+    {"/rest/txs", HTTP_LANE_LOW},
+    {"/rest/getutxos", HTTP_LANE_LOW},
 };
 
 /** HTTP module state */
@@ -145,13 +193,158 @@ static struct event_base* eventBase = 0;
 struct evhttp* eventHTTP = 0;
 //! List of subnets to allow RPC connections from
 static std::vector<CSubNet> rpc_allow_subnets;
-//! Work queue for handling longer requests off the event loop thread
-static WorkQueue<HTTPClosure>* workQueue = 0;
+//! Work queues for handling longer requests off the event loop thread, one per lane
+static WorkQueue<HTTPClosure>* workQueues[HTTP_LANE_MAX] = {};
+//! Number of worker threads per lane
+static int laneThreads[HTTP_LANE_MAX] = {};
+//! Lanes of RPC methods and REST paths
+static std::map<std::string, HTTPLane> mapWorkLanes;
+
+static std::mutex csWorkStats;
+//! Timings per RPC method or REST path
+static std::map<std::string, HTTPWorkStats> mapWorkStats;
+//! Requests rejected per lane because its work queue was full
+static uint64_t laneRejected[HTTP_LANE_MAX] = {};
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
 std::vector<evhttp_bound_socket *> boundSockets;
 
+std::string HTTPLaneName(HTTPLane lane)
+{
+    switch (lane) {
+    case HTTP_LANE_HIGH: return "high";
+    case HTTP_LANE_DEFAULT: return "default";
+    case HTTP_LANE_LOW: return "low";
+    default: return "unknown";
+    }
+}
+
+static bool ParseHTTPLane(const std::string& strLane, HTTPLane& lane)
+{
+    for (int i = 0; i < HTTP_LANE_MAX; i++) {
+        if (strLane == HTTPLaneName((HTTPLane)i)) {
+            lane = (HTTPLane)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Initialize the lanes from -rpcthreads, -rpcworkqueue, -rpclane and -rpcmethodlane */
+static bool InitHTTPLanes()
+{
+    size_t laneDepth[HTTP_LANE_MAX];
+    laneThreads[HTTP_LANE_HIGH] = DEFAULT_HTTP_HIGH_THREADS;
+    laneDepth[HTTP_LANE_HIGH] = DEFAULT_HTTP_LANE_WORKQUEUE;
+    laneThreads[HTTP_LANE_DEFAULT] = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    laneDepth[HTTP_LANE_DEFAULT] = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
+    laneThreads[HTTP_LANE_LOW] = DEFAULT_HTTP_LOW_THREADS;
+    laneDepth[HTTP_LANE_LOW] = DEFAULT_HTTP_LANE_WORKQUEUE;
+
+    for (const std::string& strLaneConf : gArgs.GetArgs("-rpclane")) {
+        std::vector<std::string> vParts;
+        boost::split(vParts, strLaneConf, boost::is_any_of(":"));
+        HTTPLane lane;
+        int32_t nThreads, nDepth;
+        if (vParts.size() != 3 || !ParseHTTPLane(vParts[0], lane) || !ParseInt32(vParts[1], &nThreads) || !ParseInt32(vParts[2], &nDepth) ||
+            nThreads < (lane == HTTP_LANE_DEFAULT ? 1 : 0) || nDepth < 1) {
+            uiInterface.ThreadSafeMessageBox(
+                strprintf("Invalid -rpclane specification: %s. The format is <lane>:<threads>:<depth>, valid lanes are high, default and low.", strLaneConf),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        }
+        laneThreads[lane] = nThreads;
+        laneDepth[lane] = nDepth;
+    }
+
+    mapWorkLanes.clear();
+    for (const auto& p : DEFAULT_WORK_LANES) {
+        mapWorkLanes[p.first] = p.second;
+    }
+    for (const std::string& strMethodLane : gArgs.GetArgs("-rpcmethodlane")) {
+        size_t nPos = strMethodLane.rfind(':');
+        HTTPLane lane;
+        if (nPos == std::string::npos || nPos == 0 || !ParseHTTPLane(strMethodLane.substr(nPos + 1), lane)) {
+            uiInterface.ThreadSafeMessageBox(
+                strprintf("Invalid -rpcmethodlane specification: %s. The format is <method>:<lane>, valid lanes are high, default and low.", strMethodLane),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        }
+        mapWorkLanes[strMethodLane.substr(0, nPos)] = lane;
+    }
+
+    for (int i = 0; i < HTTP_LANE_MAX; i++) {
+        if (laneThreads[i] == 0) {
+            // disabled lane
+            continue;
+        }
+        LogPrintf("HTTP: creating %s work queue of depth %d\n", HTTPLaneName((HTTPLane)i), laneDepth[i]);
+        workQueues[i] = new WorkQueue<HTTPClosure>(laneDepth[i]);
+    }
+    return true;
+}
+
+/** Lane which serves the requests named strName, requests of disabled lanes are served by the default lane */
+static HTTPLane GetHTTPLane(const std::string& strName)
+{
+    auto it = mapWorkLanes.find(strName);
+    if (it == mapWorkLanes.end() || !workQueues[it->second]) {
+        return HTTP_LANE_DEFAULT;
+    }
+    return it->second;
+}
+
+static void RecordHTTPWork(const std::string& strName, HTTPLane lane, int64_t nQueueWaitMicros, int64_t nExecutionMicros)
+{
+    std::lock_guard<std::mutex> lock(csWorkStats);
+    HTTPWorkStats& stats = mapWorkStats[strName];
+    stats.lane = lane;
+    stats.queueWait.Add(nQueueWaitMicros);
+    stats.execution.Add(nExecutionMicros);
+}
+
+static void RecordHTTPReject(const std::string& strName, HTTPLane lane)
+{
+    std::lock_guard<std::mutex> lock(csWorkStats);
+    HTTPWorkStats& stats = mapWorkStats[strName];
+    stats.lane = lane;
+    stats.nRejected++;
+    laneRejected[lane]++;
+}
+
+std::vector<HTTPLaneStats> GetHTTPLaneStats()
+{
+    std::vector<HTTPLaneStats> vStats;
+    std::lock_guard<std::mutex> lock(csWorkStats);
+    for (int i = 0; i < HTTP_LANE_MAX; i++) {
+        if (!workQueues[i]) {
+            continue;
+        }
+        HTTPLaneStats stats;
+        stats.lane = (HTTPLane)i;
+        stats.nThreads = laneThreads[i];
+        stats.nMaxDepth = workQueues[i]->MaxDepth();
+        stats.nDepth = workQueues[i]->Depth();
+        stats.nRejected = laneRejected[i];
+        vStats.push_back(stats);
+    }
+    return vStats;
+}
+
+std::map<std::string, HTTPWorkStats> GetHTTPWorkStats(bool fReset)
+{
+    std::lock_guard<std::mutex> lock(csWorkStats);
+    std::map<std::string, HTTPWorkStats> mapRet = mapWorkStats;
+    if (fReset) {
+        mapWorkStats.clear();
+        for (int i = 0; i < HTTP_LANE_MAX; i++) {
+            laneRejected[i] = 0;
+        }
+    }
+    return mapRet;
+}
+
 /** Check if a network address is allowed to access the HTTP server */
 static bool ClientAllowed(const CNetAddr& netaddr)
 {
@@ -259,14 +452,22 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
         }
     }
 
-    // Dispatch to worker thread
+    // Dispatch to worker thread of its lane
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
-        assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        std::string name;
+        if (i->classifier)
+            name = i->classifier(hreq.get());
+        if (name.empty())
+            name = i->prefix;
+        HTTPLane lane = GetHTTPLane(name);
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler, name, lane));
+        assert(workQueues[lane]);
+        if (workQueues[lane]->Enqueue(item.get()))
             item.release(); /* if true, queue took ownership */
         else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
+            RecordHTTPReject(name, lane);
+            LogPrintf("WARNING: %s request rejected because the %s http work queue depth exceeded, it can be increased with the %s setting\n",
+                      name, HTTPLaneName(lane), lane == HTTP_LANE_DEFAULT ? "-rpcworkqueue=" : "-rpclane=");
             item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
         }
     } else {
@@ -399,10 +600,9 @@ bool InitHTTPServer()
     }
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
-    int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    if (!InitHTTPLanes())
+        return false;
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
     // tranfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -429,12 +629,15 @@ static std::vector<std::thread> g_thread_http_workers;
 bool StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
-    int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
     threadHTTP = std::thread(ThreadHTTP, eventBase, eventHTTP);
 
-    for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
+    for (int lane = 0; lane < HTTP_LANE_MAX; lane++) {
+        if (!workQueues[lane])
+            continue;
+        LogPrintf("HTTP: starting %d %s worker threads\n", laneThreads[lane], HTTPLaneName((HTTPLane)lane));
+        for (int i = 0; i < laneThreads[lane]; i++) {
+            g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueues[lane]);
+        }
     }
     return true;
 }
@@ -446,21 +649,23 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
-    if (workQueue)
-        workQueue->Interrupt();
+    for (auto& queue : workQueues) {
+        if (queue)
+            queue->Interrupt();
+    }
 }
 
 void StopHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Stopping HTTP server\n");
-    if (workQueue) {
-        LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
-        for (auto& thread: g_thread_http_workers) {
-            thread.join();
-        }
-        g_thread_http_workers.clear();
-        delete workQueue;
-        workQueue = nullptr;
+    LogPrint(BCLog::HTTP, "Waiting for HTTP worker threads to exit\n");
+    for (auto& thread: g_thread_http_workers) {
+        thread.join();
+    }
+    g_thread_http_workers.clear();
+    for (auto& queue : workQueues) {
+        delete queue;
+        queue = nullptr;
     }
     // Unlisten sockets, these are what make the event loop running, which means
     // that after this and all connections are closed the event loop will quit.
@@ -559,6 +764,17 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t nMaxSize)
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    std::string rv(std::min(evbuffer_get_length(buf), nMaxSize), '\0');
+    ev_ssize_t nCopied = evbuffer_copyout(buf, &rv[0], rv.size());
+    rv.resize(nCopied > 0 ? nCopied : 0);
+    return rv;
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -601,6 +817,22 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     req = 0; // transferred back to main thread
 }
 
+void HTTPRequest::WriteReplyPart(const char* data, size_t len)
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_add(evb, data, len);
+}
+
+void HTTPRequest::DiscardReplyParts()
+{
+    assert(!replySent && req);
+    struct evbuffer* evb = evhttp_request_get_output_buffer(req);
+    assert(evb);
+    evbuffer_drain(evb, evbuffer_get_length(evb));
+}
+
 CService HTTPRequest::GetPeer()
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
@@ -641,10 +873,10 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod()
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
@@ -5,13 +5,59 @@
 #ifndef BITCOIN_HTTPSERVER_H
 #define BITCOIN_HTTPSERVER_H
 
+#include "histogram.h"
+
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <map>
+#include <vector>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+static const int DEFAULT_HTTP_HIGH_THREADS=2;
+static const int DEFAULT_HTTP_LOW_THREADS=1;
+static const int DEFAULT_HTTP_LANE_WORKQUEUE=16;
+
+/**
+ * Requests are served by separate lanes, each with its own worker threads and work queue depth, so that a
+ * flood of slow calls can't starve cheap latency sensitive ones. Which lane serves a request is configured
+ * per RPC method or REST path (-rpcmethodlane), the default lane uses -rpcthreads and -rpcworkqueue.
+ */
+enum HTTPLane {
+    HTTP_LANE_HIGH,
+    HTTP_LANE_DEFAULT,
+    HTTP_LANE_LOW,
+    HTTP_LANE_MAX
+};
+
+std::string HTTPLaneName(HTTPLane lane);
+
+/** Configuration and state of a lane */
+struct HTTPLaneStats
+{
+    HTTPLane lane;
+    int nThreads;
+    size_t nMaxDepth;
+    size_t nDepth;
+    uint64_t nRejected;
+};
+
+/** Timings of the requests for one RPC method or REST path, in microseconds */
+struct HTTPWorkStats
+{
+    HTTPLane lane;
+    uint64_t nRejected{0};
+    // time between the receipt of the request and the start of its execution
+    CLatencyHistogram queueWait;
+    // time spent executing the request
+    CLatencyHistogram execution;
+};
+
+std::vector<HTTPLaneStats> GetHTTPLaneStats();
+/** Returns the timings per RPC method or REST path, and optionally resets them */
+std::map<std::string, HTTPWorkStats> GetHTTPWorkStats(bool fReset);
 
 struct evhttp_request;
 struct event_base;
@@ -38,11 +84,15 @@ bool UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Returns the name under which a request is queued and accounted (e.g. its RPC method), or an empty string
+ * to use the prefix of its handler. Called on the event loop thread, so it must be cheap.
+ */
+typedef std::function<std::string(HTTPRequest* req)> HTTPRequestClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
  * be invoked.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler, const HTTPRequestClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
@@ -98,6 +148,11 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Returns up to nMaxSize bytes of the request body without consuming them.
+     */
+    std::string PeekBody(size_t nMaxSize);
+
     /**
      * Write output header.
      *
@@ -114,6 +169,15 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Append data to the reply body without sending the reply yet, so large replies can be written while
+     * they are being generated. The reply is sent by WriteReply, which appends strReply to this data.
+     */
+    void WriteReplyPart(const char* data, size_t len);
+
+    /** Drop the data written by WriteReplyPart, e.g. to reply with an error instead */
+    void DiscardReplyParts();
 };
 
 /** Event handler closure.
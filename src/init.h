@@ -16,6 +16,9 @@ namespace boost
 class thread_group;
 } // namespace boost
 
+/** The scheduler which was passed to AppInitMain, nullptr before and after */
+extern CScheduler* g_scheduler;
+
 void StartShutdown();
 void StartRestart();
 bool ShutdownRequested();
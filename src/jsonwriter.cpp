@@ -0,0 +1,171 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "jsonwriter.h"
+
+#include "tinyformat.h"
+
+#include <univalue.h>
+
+#include <assert.h>
+
+CJSONWriter::CJSONWriter(Sink sinkIn, size_t nFlushSizeIn) :
+    sink(std::move(sinkIn)),
+    nFlushSize(nFlushSizeIn)
+{
+    buf.reserve(sink ? nFlushSize + nFlushSize / 4 : 1024);
+}
+
+void CJSONWriter::BeginValue()
+{
+    if (fAfterKey) {
+        fAfterKey = false;
+        return;
+    }
+    if (!vEmpty.empty()) {
+        if (!vEmpty.back()) {
+            buf += ',';
+        }
+        vEmpty.back() = false;
+    }
+}
+
+void CJSONWriter::WriteString(const std::string& str)
+{
+    // same escaping as UniValue (see univalue_escapes.h)
+    static const char* hex = "0123456789abcdef";
+    buf += '"';
+    for (unsigned char ch : str) {
+        switch (ch) {
+        case '"': buf += "\\\""; break;
+        case '\\': buf += "\\\\"; break;
+        case '\b': buf += "\\b"; break;
+        case '\t': buf += "\\t"; break;
+        case '\n': buf += "\\n"; break;
+        case '\f': buf += "\\f"; break;
+        case '\r': buf += "\\r"; break;
+        default:
+            if (ch < 0x20 || ch == 0x7f) {
+                buf += "\\u00";
+                buf += hex[ch >> 4];
+                buf += hex[ch & 0xf];
+            } else {
+                buf += (char)ch;
+            }
+        }
+    }
+    buf += '"';
+}
+
+CJSONWriter& CJSONWriter::BeginObject()
+{
+    BeginValue();
+    buf += '{';
+    vEmpty.push_back(true);
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::EndObject()
+{
+    assert(!vEmpty.empty() && !fAfterKey);
+    vEmpty.pop_back();
+    buf += '}';
+    MaybeFlush();
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::BeginArray()
+{
+    BeginValue();
+    buf += '[';
+    vEmpty.push_back(true);
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::EndArray()
+{
+    assert(!vEmpty.empty() && !fAfterKey);
+    vEmpty.pop_back();
+    buf += ']';
+    MaybeFlush();
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::Key(const std::string& key)
+{
+    assert(!vEmpty.empty() && !fAfterKey);
+    BeginValue();
+    WriteString(key);
+    buf += ':';
+    fAfterKey = true;
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::Null()
+{
+    BeginValue();
+    buf += "null";
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::Value(const std::string& str)
+{
+    BeginValue();
+    WriteString(str);
+    MaybeFlush();
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::Value(bool b)
+{
+    BeginValue();
+    buf += b ? "true" : "false";
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::Value(int64_t n)
+{
+    BeginValue();
+    buf += std::to_string(n);
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::Value(uint64_t n)
+{
+    BeginValue();
+    buf += std::to_string(n);
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::Value(double d)
+{
+    return Value(UniValue(d));
+}
+
+CJSONWriter& CJSONWriter::Value(const UniValue& val)
+{
+    BeginValue();
+    buf += val.write();
+    MaybeFlush();
+    return *this;
+}
+
+CJSONWriter& CJSONWriter::ValueAmount(const CAmount& amount)
+{
+    BeginValue();
+    bool sign = amount < 0;
+    int64_t n_abs = (sign ? -amount : amount);
+    int64_t quotient = n_abs / COIN;
+    int64_t remainder = n_abs % COIN;
+    buf += strprintf("%s%d.%08d", sign ? "-" : "", quotient, remainder);
+    return *this;
+}
+
+void CJSONWriter::Flush()
+{
+    if (sink && !buf.empty()) {
+        sink(buf.data(), buf.size());
+        buf.clear();
+    }
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_JSONWRITER_H
+#define XAZAB_JSONWRITER_H
+
+#include "amount.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class UniValue;
+
+/**
+ * Writes JSON directly into a buffer, without building a UniValue DOM first. The output is identical to
+ * UniValue::write() of the equivalent UniValue. If a sink is given, the buffer is handed to it whenever it
+ * grows beyond nFlushSize, so large documents (e.g. getblock with verbosity 2) can be streamed into an
+ * HTTP reply while they are being written.
+ */
+class CJSONWriter
+{
+public:
+    typedef std::function<void(const char* data, size_t len)> Sink;
+
+    static const size_t DEFAULT_FLUSH_SIZE = 64 * 1024;
+
+private:
+    std::string buf;
+    Sink sink;
+    size_t nFlushSize;
+    // one entry per open object/array, true as long as it is empty
+    std::vector<bool> vEmpty;
+    bool fAfterKey{false};
+
+    void BeginValue();
+    void WriteString(const std::string& str);
+    void MaybeFlush()
+    {
+        if (sink && buf.size() >= nFlushSize) {
+            Flush();
+        }
+    }
+
+public:
+    explicit CJSONWriter(Sink sinkIn = nullptr, size_t nFlushSizeIn = DEFAULT_FLUSH_SIZE);
+
+    CJSONWriter& BeginObject();
+    CJSONWriter& EndObject();
+    CJSONWriter& BeginArray();
+    CJSONWriter& EndArray();
+    CJSONWriter& Key(const std::string& key);
+
+    CJSONWriter& Null();
+    CJSONWriter& Value(const std::string& str);
+    CJSONWriter& Value(const char* str) { return Value(std::string(str)); }
+    CJSONWriter& Value(bool b);
+    CJSONWriter& Value(int n) { return Value((int64_t)n); }
+    CJSONWriter& Value(int64_t n);
+    CJSONWriter& Value(uint64_t n);
+    CJSONWriter& Value(double d);
+    /** Writes an already built UniValue, for the rare parts which only have a UniValue representation */
+    CJSONWriter& Value(const UniValue& val);
+    /** Same format as ValueFromAmount */
+    CJSONWriter& ValueAmount(const CAmount& amount);
+
+    template <typename T>
+    CJSONWriter& pushKV(const std::string& key, const T& val)
+    {
+        Key(key);
+        return Value(val);
+    }
+
+    /** Hands everything written so far to the sink */
+    void Flush();
+    /** Everything written since the last Flush(), or the whole document if there is no sink */
+    const std::string& str() const { return buf; }
+};
+
+#endif // XAZAB_JSONWRITER_H
@@ -119,8 +119,9 @@ bool CQuorum::ReadContributions(CEvoDB& evoDb)
 {
     uint256 dbKey = MakeQuorumKey(*this);
 
+    // the contributions are written directly to the database, so there is no need to wait for block processing
     BLSVerificationVector qv;
-    if (evoDb.Read(std::make_pair(DB_QUORUM_QUORUM_VVEC, dbKey), qv)) {
+    if (evoDb.ReadCommitted(std::make_pair(DB_QUORUM_QUORUM_VVEC, dbKey), qv)) {
         quorumVvec = std::make_shared<BLSVerificationVector>(std::move(qv));
     } else {
         return false;
@@ -128,7 +129,7 @@ bool CQuorum::ReadContributions(CEvoDB& evoDb)
 
     // We ignore the return value here as it is ok if this fails. If it fails, it usually means that we are not a
     // member of the quorum but observed the whole DKG process to have the quorum verification vector.
-    evoDb.Read(std::make_pair(DB_QUORUM_SK_SHARE, dbKey), skShare);
+    evoDb.ReadCommitted(std::make_pair(DB_QUORUM_SK_SHARE, dbKey), skShare);
 
     return true;
 }
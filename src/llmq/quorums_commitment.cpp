@@ -78,26 +78,34 @@ bool CFinalCommitment::Verify(const std::vector<CDeterministicMNCPtr>& members,
     }
 
     // sigs are only checked when the block is processed
-    if (checkSigs) {
-        uint256 commitmentHash = CLLMQUtils::BuildCommitmentHash(params.type, quorumHash, validMembers, quorumPublicKey, quorumVvecHash);
-
-        std::vector<CBLSPublicKey> memberPubKeys;
-        for (size_t i = 0; i < members.size(); i++) {
-            if (!signers[i]) {
-                continue;
-            }
-            memberPubKeys.emplace_back(members[i]->pdmnState->pubKeyOperator.Get());
-        }
+    if (checkSigs && !VerifySigs(members)) {
+        return false;
+    }
 
-        if (!membersSig.VerifySecureAggregated(memberPubKeys, commitmentHash)) {
-            LogPrintfFinalCommitment("invalid aggregated members signature\n");
-            return false;
-        }
+    return true;
+}
 
-        if (!quorumSig.VerifyInsecure(quorumPublicKey, commitmentHash)) {
-            LogPrintfFinalCommitment("invalid quorum signature\n");
-            return false;
+bool CFinalCommitment::VerifySigs(const std::vector<CDeterministicMNCPtr>& members) const
+{
+    const auto& params = Params().GetConsensus().llmqs.at((Consensus::LLMQType)llmqType);
+    uint256 commitmentHash = CLLMQUtils::BuildCommitmentHash(params.type, quorumHash, validMembers, quorumPublicKey, quorumVvecHash);
+
+    std::vector<CBLSPublicKey> memberPubKeys;
+    for (size_t i = 0; i < members.size(); i++) {
+        if (!signers[i]) {
+            continue;
         }
+        memberPubKeys.emplace_back(members[i]->pdmnState->pubKeyOperator.Get());
+    }
+
+    if (!membersSig.VerifySecureAggregated(memberPubKeys, commitmentHash)) {
+        LogPrintfFinalCommitment("invalid aggregated members signature\n");
+        return false;
+    }
+
+    if (!quorumSig.VerifyInsecure(quorumPublicKey, commitmentHash)) {
+        LogPrintfFinalCommitment("invalid quorum signature\n");
+        return false;
     }
 
     return true;
@@ -131,7 +139,7 @@ bool CFinalCommitment::VerifySizes(const Consensus::LLMQParams& params) const
     return true;
 }
 
-bool CheckLLMQCommitment(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state)
+bool CheckLLMQCommitment(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state, std::vector<CSpecialTxSigCheck>* pvChecks)
 {
     CFinalCommitmentTxPayload qcTx;
     if (!GetTxPayload(tx, qcTx)) {
@@ -174,6 +182,11 @@ bool CheckLLMQCommitment(const CTransaction& tx, const CBlockIndex* pindexPrev,
         return state.DoS(100, false, REJECT_INVALID, "bad-qc-invalid");
     }
 
+    // the signatures are checked by CQuorumBlockProcessor::ProcessCommitment, unless the caller collects them
+    if (pvChecks) {
+        pvChecks->emplace_back(std::make_shared<const CFinalCommitment>(qcTx.commitment), std::move(members));
+    }
+
     return true;
 }
 
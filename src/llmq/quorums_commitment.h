@@ -13,6 +13,8 @@
 
 #include "univalue.h"
 
+class CSpecialTxSigCheck;
+
 namespace llmq
 {
 
@@ -51,6 +53,7 @@ public:
     }
 
     bool Verify(const std::vector<CDeterministicMNCPtr>& members, bool checkSigs) const;
+    bool VerifySigs(const std::vector<CDeterministicMNCPtr>& members) const;
     bool VerifyNull() const;
     bool VerifySizes(const Consensus::LLMQParams& params) const;
 
@@ -132,7 +135,8 @@ public:
     }
 };
 
-bool CheckLLMQCommitment(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state);
+/** If pvChecks is given, the signature checks are appended to it instead of being done immediately */
+bool CheckLLMQCommitment(const CTransaction& tx, const CBlockIndex* pindexPrev, CValidationState& state, std::vector<CSpecialTxSigCheck>* pvChecks = nullptr);
 
 } // namespace llmq
 
@@ -31,21 +31,13 @@ CDKGSessionManager::~CDKGSessionManager()
 {
 }
 
-void CDKGSessionManager::StartMessageHandlerPool()
+void CDKGSessionManager::StartSessionHandlers()
 {
     for (const auto& qt : Params().GetConsensus().llmqs) {
         dkgSessionHandlers.emplace(std::piecewise_construct,
                 std::forward_as_tuple(qt.first),
-                std::forward_as_tuple(qt.second, messageHandlerPool, blsWorker, *this));
+                std::forward_as_tuple(qt.second, blsWorker, *this));
     }
-
-    messageHandlerPool.resize(2);
-    RenameThreadPool(messageHandlerPool, "xazab-q-msg");
-}
-
-void CDKGSessionManager::StopMessageHandlerPool()
-{
-    messageHandlerPool.stop(true);
 }
 
 void CDKGSessionManager::UpdatedBlockTip(const CBlockIndex* pindexNew, bool fInitialDownload)
@@ -12,6 +12,7 @@
 #include "txmempool.h"
 #include "masternode/masternode-sync.h"
 #include "net_processing.h"
+#include "recenttxpool.h"
 #include "spork.h"
 #include "validation.h"
 
@@ -894,6 +895,10 @@ void CInstantSendManager::ProcessInstantSendLock(NodeId from, const uint256& has
                          islock.txid.ToString(), hash.ToString(), hashBlock.ToString(), from);
                 return;
             }
+        } else {
+            // Locked TXs are very likely to be mined soon, make sure we can use it for compact block
+            // reconstruction even if it gets removed from the mempool (e.g. due to a conflict) in the meantime
+            recentTxPool.AddTransaction(tx, CRecentTxPool::SOURCE_INSTANTSEND);
         }
     }
 
@@ -1188,6 +1193,20 @@ void CInstantSendManager::HandleFullyConfirmedBlock(const CBlockIndex* pindex)
 
 void CInstantSendManager::RemoveMempoolConflictsForLock(const uint256& hash, const CInstantSendLock& islock)
 {
+    // Check the lock free spender index first, most ISLOCKs don't conflict with anything and we
+    // should not compete with AcceptToMemoryPool for mempool.cs in this case
+    bool fMaybeConflict = false;
+    for (auto& in : islock.inputs) {
+        uint256 spenderHash;
+        if (mempool.GetSpender(in, spenderHash) && spenderHash != islock.txid) {
+            fMaybeConflict = true;
+            break;
+        }
+    }
+    if (!fMaybeConflict) {
+        return;
+    }
+
     std::unordered_map<uint256, CTransactionRef> toDelete;
 
     {
@@ -14,7 +14,9 @@
 #include "hash.h"
 #include "limitedmap.h"
 #include "netaddress.h"
+#include "netprofiler.h"
 #include "policy/feerate.h"
+#include "primitives/transaction.h"
 #include "protocol.h"
 #include "random.h"
 #include "saltedhasher.h"
@@ -54,6 +56,7 @@
 
 class CScheduler;
 class CNode;
+class CPrivateSendBroadcastTx;
 
 namespace boost {
     class thread_group;
@@ -701,6 +704,14 @@ public:
 
 
 
+/** A TX or DSTX message which was deserialized (and, for most TX messages, had its scripts verified) ahead of time, see PrevalidateQueuedTxs */
+struct CPrevalidatedTxMsg {
+    CTransactionRef tx;
+    // only set for DSTX messages
+    std::shared_ptr<const CPrivateSendBroadcastTx> dstx;
+    // coins the script verification brought into pcoinsTip, uncached if tx doesn't make it into the mempool
+    std::vector<COutPoint> vCoinsToUncache;
+};
 
 class CNetMessage {
 private:
@@ -890,6 +901,12 @@ public:
     std::atomic<bool> qwatch{false};
 
     std::set<uint256> orphan_work_set;
+    // The first messages of vProcessMsg, if they were already deserialized and verified by PrevalidateQueuedTxs.
+    // Only accessed by the message handler thread.
+    std::deque<CPrevalidatedTxMsg> prevalidatedTxMsgs;
+
+    // Per message type timings of the message handler thread for this peer
+    CNetMsgProfiler msgProfiler;
 
     CNode(NodeId id, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn, SOCKET hSocketIn, const CAddress &addrIn, uint64_t nKeyedNetGroupIn, uint64_t nLocalHostNonceIn, const CAddress &addrBindIn, const std::string &addrNameIn = "", bool fInboundIn = false);
     ~CNode();
@@ -8,6 +8,7 @@
 #include "addrman.h"
 #include "arith_uint256.h"
 #include "blockencodings.h"
+#include "blockfilemap.h"
 #include "chainparams.h"
 #include "consensus/validation.h"
 #include "hash.h"
@@ -22,6 +23,7 @@
 #include "primitives/block.h"
 #include "primitives/transaction.h"
 #include "random.h"
+#include "recenttxpool.h"
 #include "reverse_iterator.h"
 #include "scheduler.h"
 #include "tinyformat.h"
@@ -841,7 +843,7 @@ PeerLogicValidation::PeerLogicValidation(CConnman* connmanIn, CScheduler &schedu
     // combine them in one function and schedule at the quicker (peer-eviction)
     // timer.
     static_assert(EXTRA_PEER_CHECK_INTERVAL < STALE_CHECK_INTERVAL, "peer eviction timer should be less than stale tip check timer");
-    scheduler.scheduleEvery(std::bind(&PeerLogicValidation::CheckForStaleTipAndEvictPeers, this, consensusParams), EXTRA_PEER_CHECK_INTERVAL * 1000);
+    scheduler.scheduleEvery(std::bind(&PeerLogicValidation::CheckForStaleTipAndEvictPeers, this, consensusParams), EXTRA_PEER_CHECK_INTERVAL * 1000, "staletipcheck");
 }
 
 void PeerLogicValidation::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindex, const std::vector<CTransactionRef>& vtxConflicted) {
@@ -1189,15 +1191,25 @@ void static ProcessGetBlockData(CNode* pfrom, const Consensus::Params& consensus
         std::shared_ptr<const CBlock> pblock;
         if (a_recent_block && a_recent_block->GetHash() == (*mi).second->GetBlockHash()) {
             pblock = a_recent_block;
-        } else {
+        } else if (inv.type != MSG_BLOCK) {
             // Send block from disk
             std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
             if (!ReadBlockFromDisk(*pblockRead, (*mi).second, consensusParams))
                 assert(!"cannot load block from disk");
             pblock = pblockRead;
         }
-        if (inv.type == MSG_BLOCK)
-            connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
+        if (inv.type == MSG_BLOCK) {
+            if (pblock) {
+                connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::BLOCK, *pblock));
+            } else {
+                // Send the block as it is stored on disk, without deserializing and serializing it again
+                CSerializedNetMsg msg;
+                msg.command = NetMsgType::BLOCK;
+                if (!ReadRawBlockFromDisk(msg.data, (*mi).second->GetBlockPos(), Params().MessageStart()))
+                    assert(!"cannot load block from disk");
+                connman->PushMessage(pfrom, std::move(msg));
+            }
+        }
         else if (inv.type == MSG_FILTERED_BLOCK)
         {
             bool sendMerkleBlock = false;
@@ -1736,7 +1748,102 @@ void static ProcessOrphanTx(CConnman* connman, std::set<uint256>& orphan_work_se
     }
 }
 
-bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman* connman, const std::atomic<bool>& interruptMsgProc)
+template <typename Stream>
+static CPrevalidatedTxMsg ReadTxMessage(const std::string& strCommand, Stream& s)
+{
+    CPrevalidatedTxMsg msg;
+    if (strCommand == NetMsgType::DSTX) {
+        auto dstx = std::make_shared<CPrivateSendBroadcastTx>();
+        s >> *dstx;
+        msg.tx = dstx->tx;
+        msg.dstx = std::move(dstx);
+    } else {
+        s >> msg.tx;
+    }
+    return msg;
+}
+
+// Bursts of transactions (e.g. PrivateSend mixing rounds) usually arrive as many consecutive TX/DSTX messages from
+// the same peer. Verify the scripts of all queued transactions in parallel before handling them one by one, so
+// that the AcceptToMemoryPool calls in ProcessMessage mostly hit the signature cache while holding cs_main.
+// The deserialized transactions are handed to ProcessMessage (current for this message, prevalidatedTxMsgs for
+// the queued ones), so that they aren't deserialized again.
+static void PrevalidateQueuedTxs(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, std::unique_ptr<CPrevalidatedTxMsg>& current)
+{
+    if (strCommand != NetMsgType::TX && strCommand != NetMsgType::DSTX) {
+        return;
+    }
+    if (current) {
+        // already covered by an earlier batch
+        return;
+    }
+    if (!fRelayTxes || !pfrom->fSuccessfullyConnected) {
+        return;
+    }
+    size_t nMaxBatchSize = (size_t)std::max((int64_t)0, gArgs.GetArg("-txbatchsize", DEFAULT_TX_BATCH_SIZE));
+    if (nMaxBatchSize < 2) {
+        return;
+    }
+
+    // Only this thread removes messages from vProcessMsg, so these stay valid after releasing cs_vProcessMsg
+    std::vector<const CNetMessage*> vQueued;
+    {
+        LOCK(pfrom->cs_vProcessMsg);
+        for (const CNetMessage& msg : pfrom->vProcessMsg) {
+            std::string strQueuedCommand = msg.hdr.GetCommand();
+            if (vQueued.size() + 1 >= nMaxBatchSize || (strQueuedCommand != NetMsgType::TX && strQueuedCommand != NetMsgType::DSTX)) {
+                break;
+            }
+            vQueued.emplace_back(&msg);
+        }
+    }
+    if (vQueued.empty()) {
+        // a single transaction is verified inline as usual
+        return;
+    }
+
+    std::vector<CPrevalidatedTxMsg> vMsgs;
+    vMsgs.reserve(vQueued.size() + 1);
+    // a malformed current message is reported by ProcessMessages just like when ProcessMessage reads it
+    vMsgs.emplace_back(ReadTxMessage(strCommand, vRecv));
+    try {
+        for (const CNetMessage* msg : vQueued) {
+            CMemoryReader reader((const char*)msg->vRecv.data(), (const char*)msg->vRecv.data() + msg->vRecv.size(), SER_NETWORK, pfrom->GetRecvVersion());
+            vMsgs.emplace_back(ReadTxMessage(msg->hdr.GetCommand(), reader));
+        }
+    } catch (const std::exception&) {
+        // ProcessMessage will deal with the malformed message, just verify what we got so far
+    }
+
+    // Only verify transactions which ProcessMessage passes to AcceptToMemoryPool right away. Transactions we
+    // already have or rejected recently never get there. DSTX messages are handed over deserialized but not
+    // verified, ProcessMessage has to check the masternode signature and rate limit before their scripts.
+    std::vector<CTransactionRef> vtx;
+    std::vector<size_t> vMsgIndex;
+    {
+        LOCK(cs_main);
+        for (size_t i = 0; i < vMsgs.size(); i++) {
+            if (vMsgs[i].dstx || AlreadyHave(CInv(MSG_TX, vMsgs[i].tx->GetHash()))) {
+                continue;
+            }
+            vtx.emplace_back(vMsgs[i].tx);
+            vMsgIndex.emplace_back(i);
+        }
+    }
+    std::vector<std::vector<COutPoint> > vCoinsToUncache;
+    size_t nPrevalidated = PrevalidateTransactionScripts(mempool, vtx, &vCoinsToUncache);
+    for (size_t i = 0; i < vtx.size(); i++) {
+        vMsgs[vMsgIndex[i]].vCoinsToUncache = std::move(vCoinsToUncache[i]);
+    }
+
+    current.reset(new CPrevalidatedTxMsg(std::move(vMsgs[0])));
+    for (size_t i = 1; i < vMsgs.size(); i++) {
+        pfrom->prevalidatedTxMsgs.emplace_back(std::move(vMsgs[i]));
+    }
+    LogPrint(BCLog::MEMPOOL, "%s: prevalidated %d/%d queued txs from peer=%d\n", __func__, nPrevalidated, vMsgs.size(), pfrom->GetId());
+}
+
+bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStream& vRecv, int64_t nTimeReceived, const CChainParams& chainparams, CConnman* connman, const std::atomic<bool>& interruptMsgProc, const CPrevalidatedTxMsg* pprevalidated = nullptr)
 {
     LogPrint(BCLog::NET, "received: %s (%u bytes) peer=%d\n", SanitizeString(strCommand), vRecv.size(), pfrom->GetId());
     if (gArgs.IsArgSet("-dropmessagestest") && GetRand(gArgs.GetArg("-dropmessagestest", 0)) == 0)
@@ -2432,7 +2539,14 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         int nInvType = MSG_TX;
 
         // Read data and assign inv type
-        if(strCommand == NetMsgType::TX) {
+        if (pprevalidated && (strCommand == NetMsgType::DSTX) == (pprevalidated->dstx != nullptr)) {
+            // already deserialized by PrevalidateQueuedTxs
+            ptx = pprevalidated->tx;
+            if (pprevalidated->dstx) {
+                dstx = *pprevalidated->dstx;
+                nInvType = MSG_DSTX;
+            }
+        } else if(strCommand == NetMsgType::TX) {
             vRecv >> ptx;
         } else if(strCommand == NetMsgType::LEGACYTXLOCKREQUEST) {
             // we keep processing the legacy IX message here but revert to handling it as a regular TX
@@ -2573,6 +2687,10 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     AddToCompactExtraTransactions(ptx);
                 }
             }
+            if (nInvType == MSG_DSTX) {
+                // Masternodes might still mine it (or already did), keep it around for compact block reconstruction
+                recentTxPool.AddTransaction(ptx, CRecentTxPool::SOURCE_PRIVATESEND);
+            }
 
             if (pfrom->fWhitelisted && gArgs.GetBoolArg("-whitelistforcerelay", DEFAULT_WHITELISTFORCERELAY)) {
                 // Always relay transactions received from whitelisted peers, even
@@ -2705,7 +2823,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 std::list<QueuedBlock>::iterator *queuedBlockIt = nullptr;
                 if (!MarkBlockAsInFlight(pfrom->GetId(), pindex->GetBlockHash(), pindex, &queuedBlockIt)) {
                     if (!(*queuedBlockIt)->partialBlock)
-                        (*queuedBlockIt)->partialBlock.reset(new PartiallyDownloadedBlock(&mempool));
+                        (*queuedBlockIt)->partialBlock.reset(new PartiallyDownloadedBlock(&mempool, &recentTxPool));
                     else {
                         // The block was already in flight using compact blocks from the same peer
                         LogPrint(BCLog::NET, "Peer sent us compact block we were already syncing!\n");
@@ -2733,6 +2851,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                     if (!partialBlock.IsTxAvailable(i))
                         req.indexes.push_back(i);
                 }
+                recentTxPool.RecordBlockReconstruction(partialBlock.GetRecentTxCount(), req.indexes.empty());
                 if (req.indexes.empty()) {
                     // Dirty hack to jump to BLOCKTXN code (TODO: move message handling into their own functions)
                     BlockTransactions txn;
@@ -2749,7 +2868,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 // download from.
                 // Optimistically try to reconstruct anyway since we might be
                 // able to without any round trips.
-                PartiallyDownloadedBlock tempBlock(&mempool);
+                PartiallyDownloadedBlock tempBlock(&mempool, &recentTxPool);
                 ReadStatus status = tempBlock.InitData(cmpctblock, vExtraTxnForCompact);
                 if (status != READ_STATUS_OK) {
                     // TODO: don't ignore failures
@@ -2757,6 +2876,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
                 }
                 std::vector<CTransactionRef> dummy;
                 status = tempBlock.FillBlock(*pblock, dummy);
+                recentTxPool.RecordBlockReconstruction(tempBlock.GetRecentTxCount(), status == READ_STATUS_OK);
                 if (status == READ_STATUS_OK) {
                     fBlockReconstructed = true;
                 }
@@ -3278,6 +3398,13 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     }
     CNetMessage& msg(msgs.front());
 
+    // set if the message was deserialized and verified as part of an earlier batch
+    std::unique_ptr<CPrevalidatedTxMsg> prevalidated;
+    if (!pfrom->prevalidatedTxMsgs.empty()) {
+        prevalidated.reset(new CPrevalidatedTxMsg(std::move(pfrom->prevalidatedTxMsgs.front())));
+        pfrom->prevalidatedTxMsgs.pop_front();
+    }
+
     msg.SetVersion(pfrom->GetRecvVersion());
     // Scan for message start
     if (memcmp(msg.hdr.pchMessageStart, chainparams.MessageStart(), CMessageHeader::MESSAGE_START_SIZE) != 0) {
@@ -3312,9 +3439,12 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
 
     // Process message
     bool fRet = false;
+    const int64_t nProcessStart = GetTimeMicros();
+    const int64_t nCsMainStart = GetHoldTimedLockMicros();
     try
     {
-        fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, connman, interruptMsgProc);
+        PrevalidateQueuedTxs(pfrom, strCommand, vRecv, prevalidated);
+        fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, connman, interruptMsgProc, prevalidated.get());
         if (interruptMsgProc)
             return false;
         if (!pfrom->vRecvGetData.empty())
@@ -3346,11 +3476,22 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         PrintExceptionContinue(std::current_exception(), "ProcessMessages()");
     }
 
+    const int64_t nHandlingMicros = GetTimeMicros() - nProcessStart;
+    const int64_t nCsMainMicros = GetHoldTimedLockMicros() - nCsMainStart;
+    netMsgProfiler.Record(strCommand, nProcessStart - msg.nTime, nHandlingMicros, nCsMainMicros);
+    pfrom->msgProfiler.Record(strCommand, nProcessStart - msg.nTime, nHandlingMicros, nCsMainMicros);
+
     if (!fRet) {
         LogPrintf("%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize, pfrom->GetId());
     }
 
     LOCK(cs_main);
+    if (prevalidated && !prevalidated->vCoinsToUncache.empty() && !mempool.exists(prevalidated->tx->GetHash())) {
+        // don't let rejected transactions fill the coins cache
+        for (const COutPoint& outpoint : prevalidated->vCoinsToUncache) {
+            pcoinsTip->Uncache(outpoint);
+        }
+    }
     SendRejectsAndCheckIfBanned(pfrom, connman);
 
     return fMoreWork;
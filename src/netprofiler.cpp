@@ -0,0 +1,98 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "netprofiler.h"
+
+#include "batchedlogger.h"
+#include "protocol.h"
+#include "util.h"
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+CNetMsgProfiler netMsgProfiler;
+
+static const std::string NET_MESSAGE_PROFILE_OTHER = "*other*";
+
+void CNetMsgProfile::Merge(const CNetMsgProfile& other)
+{
+    queueWait.Merge(other.queueWait);
+    handling.Merge(other.handling);
+    csMain.Merge(other.csMain);
+}
+
+UniValue CNetMsgProfile::ToJson(bool fBuckets) const
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("queuewait", queueWait.ToJson(fBuckets)));
+    obj.push_back(Pair("handling", handling.ToJson(fBuckets)));
+    obj.push_back(Pair("cs_main", csMain.ToJson(fBuckets)));
+    return obj;
+}
+
+CNetMsgProfiler::CNetMsgProfiler() :
+    nStartTime(GetTime())
+{
+}
+
+void CNetMsgProfiler::Record(const std::string& strCommand, int64_t nQueueWaitMicros, int64_t nHandlingMicros, int64_t nCsMainMicros)
+{
+    // to prevent a memory DOS, only track valid commands individually
+    static const std::unordered_set<std::string> setValidCommands(getAllNetMessageTypes().begin(), getAllNetMessageTypes().end());
+    const std::string& strKey = setValidCommands.count(strCommand) ? strCommand : NET_MESSAGE_PROFILE_OTHER;
+
+    LOCK(cs);
+    CNetMsgProfile& profile = mapProfile[strKey];
+    profile.queueWait.Add(nQueueWaitMicros);
+    profile.handling.Add(nHandlingMicros);
+    profile.csMain.Add(nCsMainMicros);
+}
+
+mapMsgCmdProfile CNetMsgProfiler::GetProfiles() const
+{
+    LOCK(cs);
+    return mapProfile;
+}
+
+int64_t CNetMsgProfiler::GetStartTime() const
+{
+    LOCK(cs);
+    return nStartTime;
+}
+
+void CNetMsgProfiler::Reset()
+{
+    LOCK(cs);
+    mapProfile.clear();
+    nStartTime = GetTime();
+}
+
+void CNetMsgProfiler::Dump(const std::string& strHeader) const
+{
+    if (!LogAcceptCategory(BCLog::NETPROF)) {
+        return;
+    }
+
+    std::vector<std::pair<std::string, CNetMsgProfile>> vecProfiles;
+    int64_t nSince;
+    {
+        LOCK(cs);
+        vecProfiles.assign(mapProfile.begin(), mapProfile.end());
+        nSince = nStartTime;
+    }
+
+    // most expensive message types first
+    std::sort(vecProfiles.begin(), vecProfiles.end(), [](const std::pair<std::string, CNetMsgProfile>& a, const std::pair<std::string, CNetMsgProfile>& b) {
+        return a.second.handling.GetTotalMicros() > b.second.handling.GetTotalMicros();
+    });
+
+    CBatchedLogger batchedLogger(BCLog::NETPROF, strprintf("%s -- %s (since %d seconds)", __func__, strHeader, GetTime() - nSince));
+    for (const auto& p : vecProfiles) {
+        batchedLogger.Batch("%s: handling={%s}", p.first, p.second.handling.ToString());
+        batchedLogger.Batch("%s: queuewait={%s}", p.first, p.second.queueWait.ToString());
+        batchedLogger.Batch("%s: cs_main={%s}", p.first, p.second.csMain.ToString());
+    }
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_NETPROFILER_H
+#define XAZAB_NETPROFILER_H
+
+#include "histogram.h"
+#include "sync.h"
+
+#include <map>
+#include <string>
+
+class UniValue;
+
+/** Timing statistics for a single P2P message type */
+struct CNetMsgProfile
+{
+    // time between receipt of the message and the start of its processing
+    CLatencyHistogram queueWait;
+    // time spent in ProcessMessage
+    CLatencyHistogram handling;
+    // time spent holding cs_main while processing the message
+    CLatencyHistogram csMain;
+
+    void Merge(const CNetMsgProfile& other);
+    UniValue ToJson(bool fBuckets) const;
+};
+
+typedef std::map<std::string, CNetMsgProfile> mapMsgCmdProfile; //command, timings
+
+/**
+ * Collects per message type timings of the message handler thread.
+ * One instance aggregates node-wide, each CNode holds another one for per peer timings.
+ */
+class CNetMsgProfiler
+{
+private:
+    mutable CCriticalSection cs;
+    mapMsgCmdProfile mapProfile;
+    int64_t nStartTime;
+
+public:
+    CNetMsgProfiler();
+
+    void Record(const std::string& strCommand, int64_t nQueueWaitMicros, int64_t nHandlingMicros, int64_t nCsMainMicros);
+    mapMsgCmdProfile GetProfiles() const;
+    int64_t GetStartTime() const;
+    void Reset();
+
+    /** Write the current statistics to the debug log (-debug=netprof) */
+    void Dump(const std::string& strHeader) const;
+};
+
+extern CNetMsgProfiler netMsgProfiler;
+
+#endif // XAZAB_NETPROFILER_H
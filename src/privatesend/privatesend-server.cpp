@@ -12,6 +12,7 @@
 #include "masternode/masternode-sync.h"
 #include "net_processing.h"
 #include "netmessagemaker.h"
+#include "recenttxpool.h"
 #include "script/interpreter.h"
 #include "txmempool.h"
 #include "util.h"
@@ -295,6 +296,8 @@ void CPrivateSendServer::CommitFinalTransaction(CConnman& connman)
         mempool.PrioritiseTransaction(hashTx, 0.1 * COIN);
         if (!lockMain || !AcceptToMemoryPool(mempool, validationState, finalTransaction, false, nullptr, false, maxTxFee)) {
             LogPrint(BCLog::PRIVATESEND, "CPrivateSendServer::CommitFinalTransaction -- AcceptToMemoryPool() error: Transaction not valid\n");
+            // The participants signed it, so it might still get mined. Keep it for compact block reconstruction.
+            recentTxPool.AddTransaction(finalTransaction, CRecentTxPool::SOURCE_PRIVATESEND);
             SetNull();
             // not much we can do in this case, just notify clients
             RelayCompletedTransaction(ERR_INVALID_TX, connman);
@@ -0,0 +1,126 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "recenttxpool.h"
+
+#include "core_memusage.h"
+#include "memusage.h"
+#include "txmempool.h"
+#include "util.h"
+
+#include <univalue.h>
+
+CRecentTxPool recentTxPool;
+
+// Don't keep huge transactions around, same limit as for the compact block extra txn
+static const size_t MAX_RECENT_TX_USAGE = 100000;
+
+size_t CRecentTxPool::TxUsage(const CTransactionRef& tx)
+{
+    // shared_ptr control block + hash map node + deque entry
+    return RecursiveDynamicUsage(*tx) + memusage::MallocUsage(sizeof(CTransaction)) +
+           memusage::MallocUsage(sizeof(std::pair<const uint256, CTransactionRef>) + sizeof(void*)) + sizeof(uint256);
+}
+
+void CRecentTxPool::SetMaxUsage(size_t nMaxUsageIn)
+{
+    LOCK(cs);
+    nMaxUsage = nMaxUsageIn;
+    LimitSize();
+}
+
+void CRecentTxPool::LimitSize()
+{
+    AssertLockHeld(cs);
+
+    while (nUsage > nMaxUsage && !queueTxs.empty()) {
+        auto it = mapTxs.find(queueTxs.front());
+        queueTxs.pop_front();
+        if (it == mapTxs.end()) {
+            continue;
+        }
+        nUsage -= TxUsage(it->second);
+        mapTxs.erase(it);
+        nEvicted++;
+    }
+}
+
+void CRecentTxPool::AddTransaction(const CTransactionRef& tx, Source source)
+{
+    if (!tx || tx->IsCoinBase()) {
+        return;
+    }
+    size_t nTxUsage = TxUsage(tx);
+    if (nTxUsage > MAX_RECENT_TX_USAGE) {
+        return;
+    }
+
+    LOCK(cs);
+    if (nMaxUsage == 0) {
+        return;
+    }
+    if (!mapTxs.emplace(tx->GetHash(), tx).second) {
+        return;
+    }
+    queueTxs.emplace_back(tx->GetHash());
+    nUsage += nTxUsage;
+    nAdded[source]++;
+    LimitSize();
+}
+
+void CRecentTxPool::TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason)
+{
+    // transactions removed for block inclusion are not needed anymore for reconstruction
+    if (reason == MemPoolRemovalReason::BLOCK) {
+        return;
+    }
+    AddTransaction(tx, SOURCE_MEMPOOL_EVICTION);
+}
+
+void CRecentTxPool::ForEach(const std::function<void(const uint256& hash, const CTransactionRef& tx)>& func) const
+{
+    LOCK(cs);
+    for (const auto& p : mapTxs) {
+        func(p.first, p.second);
+    }
+}
+
+void CRecentTxPool::RecordBlockReconstruction(size_t nTxsUsedIn, bool fComplete)
+{
+    LOCK(cs);
+    nBlocks++;
+    nTxsUsed += nTxsUsedIn;
+    nLastBlockTxsUsed = nTxsUsedIn;
+    // without the transactions from this pool we'd have to ask the peer for the missing ones
+    if (fComplete && nTxsUsedIn != 0) {
+        nRoundTripsSaved++;
+    }
+}
+
+size_t CRecentTxPool::Size() const
+{
+    LOCK(cs);
+    return mapTxs.size();
+}
+
+UniValue CRecentTxPool::ToJson() const
+{
+    LOCK(cs);
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("size", (int64_t)mapTxs.size()));
+    obj.push_back(Pair("usage", (int64_t)nUsage));
+    obj.push_back(Pair("maxusage", (int64_t)nMaxUsage));
+    UniValue added(UniValue::VOBJ);
+    added.push_back(Pair("instantsend", nAdded[SOURCE_INSTANTSEND]));
+    added.push_back(Pair("privatesend", nAdded[SOURCE_PRIVATESEND]));
+    added.push_back(Pair("mempool_eviction", nAdded[SOURCE_MEMPOOL_EVICTION]));
+    obj.push_back(Pair("added", added));
+    obj.push_back(Pair("evicted", nEvicted));
+    obj.push_back(Pair("blocks", nBlocks));
+    obj.push_back(Pair("txs_used", nTxsUsed));
+    obj.push_back(Pair("last_block_txs_used", nLastBlockTxsUsed));
+    obj.push_back(Pair("roundtrips_saved", nRoundTripsSaved));
+    obj.push_back(Pair("roundtrips_saved_per_block", nBlocks ? (double)nRoundTripsSaved / nBlocks : 0.0));
+    return obj;
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_RECENTTXPOOL_H
+#define XAZAB_RECENTTXPOOL_H
+
+#include "primitives/transaction.h"
+#include "saltedhasher.h"
+#include "sync.h"
+
+#include <deque>
+#include <functional>
+#include <unordered_map>
+
+class UniValue;
+enum class MemPoolRemovalReason;
+
+/** Default for -blockreconstructionrecenttxsize, maximum memory usage of the recent tx pool in megabytes */
+static const unsigned int DEFAULT_BLOCK_RECONSTRUCTION_RECENT_TX_SIZE = 10;
+
+/**
+ * Memory bounded pool of recently seen transactions which are not (or not anymore) in the mempool.
+ * This is used as an additional source of transactions when reconstructing compact blocks and
+ * is fed with InstantSend locked transactions, PrivateSend transactions which did not make it
+ * into the mempool and transactions which got evicted from the mempool for any reason other
+ * than block inclusion.
+ * Oldest entries are evicted first once the memory limit is reached.
+ */
+class CRecentTxPool
+{
+public:
+    enum Source {
+        SOURCE_INSTANTSEND = 0,
+        SOURCE_PRIVATESEND,
+        SOURCE_MEMPOOL_EVICTION,
+        SOURCE_MAX,
+    };
+
+private:
+    mutable CCriticalSection cs;
+
+    std::unordered_map<uint256, CTransactionRef, StaticSaltedHasher> mapTxs;
+    std::deque<uint256> queueTxs; // insertion order, used for eviction
+    size_t nMaxUsage{DEFAULT_BLOCK_RECONSTRUCTION_RECENT_TX_SIZE * 1000000};
+    size_t nUsage{0};
+
+    // statistics
+    uint64_t nAdded[SOURCE_MAX] = {};
+    uint64_t nEvicted{0};
+    uint64_t nBlocks{0};
+    uint64_t nTxsUsed{0};
+    uint64_t nRoundTripsSaved{0};
+    uint64_t nLastBlockTxsUsed{0};
+
+    static size_t TxUsage(const CTransactionRef& tx);
+    void LimitSize();
+
+public:
+    void SetMaxUsage(size_t nMaxUsageIn);
+
+    void AddTransaction(const CTransactionRef& tx, Source source);
+    void TransactionRemovedFromMempool(CTransactionRef tx, MemPoolRemovalReason reason);
+
+    /** Call func for every transaction in the pool, while holding the pool lock */
+    void ForEach(const std::function<void(const uint256& hash, const CTransactionRef& tx)>& func) const;
+
+    /**
+     * Record the outcome of a compact block reconstruction.
+     * nTxsUsed is the number of block transactions which were only found in this pool,
+     * fComplete is true if the block could be reconstructed without requesting any transactions.
+     */
+    void RecordBlockReconstruction(size_t nTxsUsed, bool fComplete);
+
+    size_t Size() const;
+    UniValue ToJson() const;
+};
+
+extern CRecentTxPool recentTxPool;
+
+#endif // XAZAB_RECENTTXPOOL_H
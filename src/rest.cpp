@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "blockfilemap.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "core_io.h"
@@ -10,10 +11,12 @@
 #include "primitives/transaction.h"
 #include "validation.h"
 #include "httpserver.h"
+#include "jsonwriter.h"
 #include "rpc/blockchain.h"
 #include "rpc/server.h"
 #include "streams.h"
 #include "sync.h"
+#include "txdb.h"
 #include "txmempool.h"
 #include "utilstrencodings.h"
 #include "version.h"
@@ -23,6 +26,8 @@
 #include <univalue.h>
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const size_t MAX_REST_TXS = 10000; //allow a max of 10000 txs to be queried at once by /rest/txs
+static const long MAX_REST_BLOCKS = 100; //allow a max of 100 blocks to be queried at once by /rest/blocks/
 
 enum RetFormat {
     RF_UNDEF,
@@ -242,10 +247,11 @@ static bool rest_block(HTTPRequest* req,
     }
 
     case RF_JSON: {
-        UniValue objBlock = blockToJSON(block, pblockindex, showTxDetails);
-        std::string strJSON = objBlock.write() + "\n";
+        // write directly into the reply, blocks with tx details can be huge
+        CJSONWriter writer([req](const char* data, size_t len) { req->WriteReplyPart(data, len); });
+        blockToJSON(block, pblockindex, showTxDetails, writer);
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
+        req->WriteReply(HTTP_OK, writer.str() + "\n");
         return true;
     }
 
@@ -399,6 +405,131 @@ static bool rest_tx(HTTPRequest* req, const std::string& strURIPart)
     return true; // continue to process further HTTP reqs on this cxn
 }
 
+// Writes the serialized objects in vObjects one after another (bin) or one per line (hex)
+static bool RESTWriteRawObjects(HTTPRequest* req, const RetFormat rf, const std::vector<std::vector<unsigned char> >& vObjects)
+{
+    switch (rf) {
+    case RF_BINARY: {
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        for (const auto& vch : vObjects) {
+            req->WriteReplyPart((const char*)vch.data(), vch.size());
+        }
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
+    case RF_HEX: {
+        req->WriteHeader("Content-Type", "text/plain");
+        for (const auto& vch : vObjects) {
+            std::string strHex = HexStr(vch.begin(), vch.end()) + "\n";
+            req->WriteReplyPart(strHex.data(), strHex.size());
+        }
+        req->WriteReply(HTTP_OK);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex)");
+    }
+    }
+}
+
+static bool rest_txs(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf != RF_BINARY && rf != RF_HEX)
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex)");
+    if (req->GetRequestMethod() != HTTPRequest::POST)
+        return RESTERR(req, HTTP_BAD_METHOD, "Use POST with a JSON array of txids");
+
+    UniValue txids;
+    if (!txids.read(req->ReadBody()) || !txids.isArray())
+        return RESTERR(req, HTTP_BAD_REQUEST, "Body must be a JSON array of txids");
+    if (txids.size() > MAX_REST_TXS)
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Error: max txs exceeded (max %d, tried %d)", MAX_REST_TXS, txids.size()));
+
+    std::vector<uint256> vHashes(txids.size());
+    for (size_t i = 0; i < txids.size(); i++) {
+        if (!txids[i].isStr() || !ParseHashStr(txids[i].get_str(), vHashes[i]))
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + txids[i].write());
+    }
+
+    // look up everything first, so that missing txs can still be reported as an error
+    std::vector<std::vector<unsigned char> > vTxs(vHashes.size());
+    // Neither needs cs_main: mempool.get() takes mempool.cs for each lookup and LevelDB reads are thread safe
+    std::vector<std::pair<size_t, CDiskTxPos> > vPositions;
+    for (size_t i = 0; i < vHashes.size(); i++) {
+        CTransactionRef tx = mempool.get(vHashes[i]);
+        if (tx) {
+            CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, vTxs[i], 0) << tx;
+            continue;
+        }
+        CDiskTxPos postx;
+        if (!fTxIndex || !pblocktree->ReadTxIndex(vHashes[i], postx))
+            return RESTERR(req, HTTP_NOT_FOUND, vHashes[i].GetHex() + " not found");
+        vPositions.emplace_back(i, postx);
+    }
+
+    // read in file order from the mapped block files
+    std::sort(vPositions.begin(), vPositions.end(), [](const std::pair<size_t, CDiskTxPos>& a, const std::pair<size_t, CDiskTxPos>& b) {
+        return std::make_pair(a.second.nFile, std::make_pair(a.second.nPos, a.second.nTxOffset)) <
+               std::make_pair(b.second.nFile, std::make_pair(b.second.nPos, b.second.nTxOffset));
+    });
+    for (const auto& p : vPositions) {
+        uint256 hashBlock;
+        if (!ReadRawTxFromDisk(vTxs[p.first], p.second, hashBlock) || Hash(vTxs[p.first].begin(), vTxs[p.first].end()) != vHashes[p.first])
+            return RESTERR(req, HTTP_NOT_FOUND, vHashes[p.first].GetHex() + " not found");
+    }
+
+    return RESTWriteRawObjects(req, rf, vTxs);
+}
+
+static bool rest_blocks(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    if (rf != RF_BINARY && rf != RF_HEX)
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex)");
+
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No height range specified. Use /rest/blocks/<height>/<count>.<ext>.");
+
+    int32_t nHeight;
+    if (!ParseInt32(path[0], &nHeight) || nHeight < 0)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height: " + path[0]);
+    int32_t count;
+    if (!ParseInt32(path[1], &count) || count < 1 || count > MAX_REST_BLOCKS)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Block count out of range: " + path[1]);
+
+    std::vector<CDiskBlockPos> vPositions;
+    {
+        LOCK(cs_main);
+        if (nHeight > chainActive.Height())
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range");
+        // stop at the tip
+        for (const CBlockIndex* pindex = chainActive[nHeight]; pindex && vPositions.size() < (size_t)count; pindex = chainActive.Next(pindex)) {
+            if (!(pindex->nStatus & BLOCK_HAVE_DATA))
+                return RESTERR(req, HTTP_NOT_FOUND, pindex->GetBlockHash().GetHex() + " not available (pruned data)");
+            vPositions.push_back(pindex->GetBlockPos());
+        }
+    }
+
+    std::vector<std::vector<unsigned char> > vBlocks(vPositions.size());
+    for (size_t i = 0; i < vPositions.size(); i++) {
+        if (!ReadRawBlockFromDisk(vBlocks[i], vPositions[i], Params().MessageStart()))
+            return RESTERR(req, HTTP_NOT_FOUND, strprintf("Block at height %d not found", nHeight + i));
+    }
+
+    return RESTWriteRawObjects(req, rf, vBlocks);
+}
+
 static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
 {
     if (!CheckWarmup(req))
@@ -591,6 +722,8 @@ static const struct {
     bool (*handler)(HTTPRequest* req, const std::string& strReq);
 } uri_prefixes[] = {
       {"/rest/tx/", rest_tx},
+      {"/rest/txs", rest_txs},
+      {"/rest/blocks/", rest_blocks},
       {"/rest/block/notxdetails/", rest_block_notxdetails},
       {"/rest/block/", rest_block_extended},
       {"/rest/chaininfo", rest_chaininfo},
@@ -7,11 +7,13 @@
 #include "rpc/blockchain.h"
 
 #include "amount.h"
+#include "blockconnectstats.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "checkpoints.h"
 #include "coins.h"
 #include "core_io.h"
+#include "jsonwriter.h"
 #include "consensus/validation.h"
 #include "validation.h"
 #include "core_io.h"
@@ -19,6 +21,7 @@
 #include "policy/feerate.h"
 #include "policy/policy.h"
 #include "primitives/transaction.h"
+#include "recenttxpool.h"
 #include "rpc/server.h"
 #include "streams.h"
 #include "sync.h"
@@ -28,6 +31,8 @@
 #include "utilstrencodings.h"
 #include "hash.h"
 
+#include "explorerindex.h"
+
 #include "evo/specialtx.h"
 #include "evo/cbtx.h"
 
@@ -195,6 +200,65 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
     return result;
 }
 
+void blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails, CJSONWriter& result)
+{
+    result.BeginObject();
+    result.pushKV("hash", blockindex->GetBlockHash().GetHex());
+    result.pushKV("pow_hash", block.GetPOWHash(block.GetAlgo()).GetHex());
+    result.pushKV("algo", GetAlgoName(block.GetAlgo()));
+
+    int confirmations = -1;
+    // Only report confirmations if the block is on the main chain
+    if (chainActive.Contains(blockindex))
+        confirmations = chainActive.Height() - blockindex->nHeight + 1;
+    result.pushKV("confirmations", confirmations);
+    result.pushKV("size", (int)::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
+    result.pushKV("height", blockindex->nHeight);
+    result.pushKV("version", block.nVersion);
+    result.pushKV("versionHex", strprintf("%08x", block.nVersion));
+    result.pushKV("merkleroot", block.hashMerkleRoot.GetHex());
+    bool chainLock = llmq::chainLocksHandler->HasChainLock(blockindex->nHeight, blockindex->GetBlockHash());
+    result.Key("tx").BeginArray();
+    for(const auto& tx : block.vtx)
+    {
+        if(txDetails)
+        {
+            result.BeginObject();
+            TxToJSON(*tx, uint256(), result);
+            bool fLocked = llmq::quorumInstantSendManager->IsLocked(tx->GetHash());
+            result.pushKV("instantlock", fLocked || chainLock);
+            result.pushKV("instantlock_internal", fLocked);
+            result.EndObject();
+        }
+        else
+            result.Value(tx->GetHash().GetHex());
+    }
+    result.EndArray();
+    if (!block.vtx[0]->vExtraPayload.empty()) {
+        CCbTx cbTx;
+        if (GetTxPayload(block.vtx[0]->vExtraPayload, cbTx)) {
+            UniValue cbTxObj;
+            cbTx.ToJson(cbTxObj);
+            result.pushKV("cbTx", cbTxObj);
+        }
+    }
+    result.pushKV("time", block.GetBlockTime());
+    result.pushKV("mediantime", (int64_t)blockindex->GetMedianTimePast());
+    result.pushKV("nonce", (uint64_t)block.nNonce);
+    result.pushKV("bits", strprintf("%08x", block.nBits));
+    result.pushKV("difficulty", GetDifficulty(blockindex, miningAlgo));
+    result.pushKV("chainwork", blockindex->nChainWork.GetHex());
+
+    if (blockindex->pprev)
+        result.pushKV("previousblockhash", blockindex->pprev->GetBlockHash().GetHex());
+    CBlockIndex *pnext = chainActive.Next(blockindex);
+    if (pnext)
+        result.pushKV("nextblockhash", pnext->GetBlockHash().GetHex());
+
+    result.pushKV("chainlock", chainLock);
+    result.EndObject();
+}
+
 UniValue getblockcount(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 0)
@@ -476,7 +540,7 @@ UniValue mempoolToJSON(bool fVerbose)
     else
     {
         std::vector<uint256> vtxid;
-        mempool.queryHashes(vtxid);
+        mempool.queryHashesUnsorted(vtxid);
 
         UniValue a(UniValue::VARR);
         for (const uint256& hash : vtxid)
@@ -679,6 +743,56 @@ UniValue getmempoolentry(const JSONRPCRequest& request)
     return info;
 }
 
+void EnsureExplorerIndexSynced()
+{
+    if (!g_explorerindex || g_explorerindex->BlockUntilSyncedToCurrentChain()) {
+        return;
+    }
+    int nHeight;
+    {
+        LOCK(cs_main);
+        nHeight = chainActive.Height();
+    }
+    throw JSONRPCError(RPC_MISC_ERROR, strprintf("Index is being built, at height %d of %d. See getindexinfo.",
+                                                 g_explorerindex->GetBestHeight(), nHeight));
+}
+
+UniValue getindexinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getindexinfo\n"
+            "\nReturns the status of the additional indexes (-addressindex, -spentindex, -timestampindex).\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"name\" : {               (json object) Only enabled indexes are listed\n"
+            "    \"synced\" : true|false, (boolean) Whether the index caught up with the active chain\n"
+            "    \"best_block_height\" : n (numeric) The height up to which the index is built\n"
+            "  },\n"
+            "  ...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getindexinfo", "")
+            + HelpExampleRpc("getindexinfo", "")
+        );
+
+    UniValue result(UniValue::VOBJ);
+    if (!g_explorerindex) {
+        return result;
+    }
+
+    UniValue info(UniValue::VOBJ);
+    info.push_back(Pair("synced", g_explorerindex->IsSynced()));
+    info.push_back(Pair("best_block_height", g_explorerindex->GetBestHeight()));
+    if (fAddressIndex)
+        result.push_back(Pair("addressindex", info));
+    if (fSpentIndex)
+        result.push_back(Pair("spentindex", info));
+    if (fTimestampIndex)
+        result.push_back(Pair("timestampindex", info));
+    return result;
+}
+
 UniValue getblockhashes(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 2)
@@ -701,6 +815,8 @@ UniValue getblockhashes(const JSONRPCRequest& request)
     unsigned int low = request.params[1].get_int();
     std::vector<uint256> blockHashes;
 
+    EnsureExplorerIndexSynced();
+
     if (!GetTimestampIndex(high, low, blockHashes)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for block hashes");
     }
@@ -1066,6 +1182,27 @@ UniValue getblock(const JSONRPCRequest& request)
     return blockToJSON(block, pblockindex, verbosity >= 2);
 }
 
+// getblock with verbosity 2, written directly into the reply
+static bool getblockStream(const JSONRPCRequest& request, CJSONWriter& result)
+{
+    if (request.fHelp || request.params.size() != 2 || !request.params[1].isNum() || request.params[1].get_int() < 2)
+        return false;
+
+    LOCK(cs_main);
+
+    std::string strHash = request.params[0].get_str();
+    uint256 hash(uint256S(strHash));
+
+    if (mapBlockIndex.count(hash) == 0)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+    CBlockIndex* pblockindex = mapBlockIndex[hash];
+    const CBlock block = GetBlockChecked(pblockindex);
+
+    blockToJSON(block, pblockindex, true, result);
+    return true;
+}
+
 struct CCoinsStats
 {
     int nHeight;
@@ -1685,6 +1822,38 @@ UniValue getmempoolinfo(const JSONRPCRequest& request)
     return mempoolInfoToJSON();
 }
 
+UniValue getrecenttxpoolinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getrecenttxpoolinfo\n"
+            "\nReturns details on the pool of recently seen transactions which are not in the mempool (anymore)\n"
+            "and which are used as an additional source for compact block reconstruction.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"size\": xxxxx,                         (numeric) Current tx count\n"
+            "  \"usage\": xxxxx,                        (numeric) Total memory usage for the pool\n"
+            "  \"maxusage\": xxxxx,                     (numeric) Maximum memory usage for the pool\n"
+            "  \"added\": {                             (json object) Number of txs added per source\n"
+            "    \"instantsend\": xxxxx,                (numeric) InstantSend locked txs\n"
+            "    \"privatesend\": xxxxx,                (numeric) PrivateSend txs which were not accepted to the mempool\n"
+            "    \"mempool_eviction\": xxxxx            (numeric) Txs removed from the mempool for reasons other than block inclusion\n"
+            "  },\n"
+            "  \"evicted\": xxxxx,                      (numeric) Number of txs evicted from the pool due to the size limit\n"
+            "  \"blocks\": xxxxx,                       (numeric) Number of compact blocks reconstructed since startup\n"
+            "  \"txs_used\": xxxxx,                     (numeric) Number of block txs which were only found in this pool\n"
+            "  \"last_block_txs_used\": xxxxx,          (numeric) Same as txs_used, but for the last reconstructed block only\n"
+            "  \"roundtrips_saved\": xxxxx,             (numeric) Number of blocks which were fully reconstructed only thanks to this pool\n"
+            "  \"roundtrips_saved_per_block\": x.xxx    (numeric) roundtrips_saved divided by blocks\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getrecenttxpoolinfo", "")
+            + HelpExampleRpc("getrecenttxpoolinfo", "")
+        );
+
+    return recentTxPool.ToJson();
+}
+
 UniValue preciousblock(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -1798,6 +1967,164 @@ UniValue reconsiderblock(const JSONRPCRequest& request)
     return NullUniValue;
 }
 
+UniValue getblockconnectstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 2)
+        throw std::runtime_error(
+            "getblockconnectstats ( buckets reset )\n"
+            "\nReturns the timings of the stages of connecting blocks to the chain, including blocks which were only\n"
+            "checked (e.g. by getblocktemplate). All timings are in microseconds.\n"
+            "\nArguments:\n"
+            "1. buckets       (boolean, optional, default=false) Include the raw histogram buckets\n"
+            "2. reset         (boolean, optional, default=false) Reset the statistics after returning them\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"since\": ttt,            (numeric) The UNIX epoch time when collection started\n"
+            "  \"blocks\": n,             (numeric) The number of blocks connected to the chain since then\n"
+            "  \"stages\": {              (json object) Timings per stage, nested stages are prefixed with their parent\n"
+            "    \"read_from_disk\": {...},        (json object) Reading the block from disk, if it wasn't in memory\n"
+            "    \"prefetch_inputs\": {...},       (json object) Reading the inputs which weren't cached from the coins database\n"
+            "                                     in parallel, prefetch_inputs.reads is the sum of the times of all reads\n"
+            "    \"connect_total\": {...},         (json object) ConnectBlock, consisting of the following stages\n"
+            "    \"check\": {...},                 (json object) Sanity checks\n"
+            "    \"forks\": {...},                 (json object) Fork checks\n"
+            "    \"connect_txs\": {...},           (json object) Checking and updating the inputs of the transactions\n"
+            "    \"verify_scripts\": {...},        (json object) connect_txs plus waiting for the script checks\n"
+            "    \"xazab_specific\": {...},        (json object) The following Xazab specific stages\n"
+            "    \"is_filter\": {...},             (json object) Checking for conflicts with InstantSend locks\n"
+            "    \"subsidy\": {...},               (json object) Block subsidy calculation\n"
+            "    \"value_valid\": {...},           (json object) Block value checks\n"
+            "    \"payee_valid\": {...},           (json object) Block payee checks\n"
+            "    \"special_txs\": {...},           (json object) Special transaction processing, with the stages\n"
+            "                                     special_txs.loop, .quorums, .dmn and .merkle_roots, the latter with\n"
+            "                                     merkle_roots.payload, .mnlist and .quorums, which have the stages\n"
+            "                                     mnlist.build, .sml, .merkle and quorums.mined_and_active, .mined,\n"
+            "                                     .loop and .merkle\n"
+            "    \"index_writes\": {...},          (json object) Writing undo data and the transaction index\n"
+            "    \"callbacks\": {...},             (json object) Writing the best block hash to the EvoDB\n"
+            "    \"flush\": {...},                 (json object) Flushing the coins view and committing the EvoDB transaction\n"
+            "    \"write_chainstate\": {...},      (json object) Writing the chain state to disk, if needed\n"
+            "    \"post_connect\": {...},          (json object) Updating the mempool and the chain tip\n"
+            "    \"total\": {...}                  (json object) All of the above\n"
+            "  }\n"
+            "}\n"
+            "\nEach timing object contains \"count\", \"total_us\", \"last_us\", \"avg_us\", \"p50_us\", \"p90_us\",\n"
+            "\"p99_us\" and \"max_us\". Buckets are keyed by their exclusive upper bound.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getblockconnectstats", "")
+            + HelpExampleCli("getblockconnectstats", "true true")
+            + HelpExampleRpc("getblockconnectstats", "")
+        );
+
+    bool fBuckets = request.params.size() > 0 && !request.params[0].isNull() && request.params[0].get_bool();
+    bool fReset = request.params.size() > 1 && !request.params[1].isNull() && request.params[1].get_bool();
+
+    UniValue obj = blockConnectStats.ToJson(fBuckets);
+    if (fReset) {
+        blockConnectStats.Reset();
+    }
+    return obj;
+}
+
+UniValue getdbstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getdbstats ( \"name\" )\n"
+            "\nReturns the tuning and the internal statistics of the open LevelDB databases.\n"
+            "\nArguments:\n"
+            "1. \"name\"          (string, optional) Only return the database with this name (blockindex, chainstate,\n"
+            "                      evodb, explorer or llmq)\n"
+            "\nResult:\n"
+            "[\n"
+            "  {\n"
+            "    \"name\": \"xxxx\",             (string) The name of the database, as used by -dbtuning\n"
+            "    \"path\": \"xxxx\",             (string) The directory of the database\n"
+            "    \"memory\": true|false,       (boolean) Whether the database is only kept in memory\n"
+            "    \"cache_size\": n,            (numeric) The cache size in bytes\n"
+            "    \"tuning\": {                 (json object) The LevelDB options set by -dbtuning\n"
+            "      \"block_size\": n,          (numeric) The size of the table blocks in bytes\n"
+            "      \"bloom_bits\": n,          (numeric) The bits per key of the bloom filter\n"
+            "      \"write_buffer_size\": n,   (numeric) The size of a memtable in bytes\n"
+            "      \"max_file_size\": n,       (numeric) The size at which table files are split in bytes\n"
+            "      \"compression\": true|false, (boolean) Whether table blocks are compressed\n"
+            "      \"max_open_files\": n       (numeric) The number of table files kept open\n"
+            "    },\n"
+            "    \"compactions\": n,           (numeric) The number of compactions since the database was opened\n"
+            "    \"trivial_moves\": n,         (numeric) The number of tables moved to the next level without rewriting them\n"
+            "    \"memtable_flushes\": n,      (numeric) The number of memtables written to level 0\n"
+            "    \"write_stalls\": n,          (numeric) The number of times writes had to wait for a compaction\n"
+            "    \"memory_usage\": n,          (numeric) The memory used by the block cache and the memtables in bytes\n"
+            "    \"read_amplification\": n,    (numeric) The number of tables a read may have to look at\n"
+            "    \"levels\": [                 (json array) The levels which have tables or compaction stats\n"
+            "      {\n"
+            "        \"level\": n,             (numeric) The level\n"
+            "        \"files\": n,             (numeric) The number of table files\n"
+            "        \"size_mib\": x.x,        (numeric) The size of the tables in MiB\n"
+            "        \"compaction_secs\": x.x, (numeric) The time spent in compactions into this level\n"
+            "        \"read_mib\": x.x,        (numeric) The data read by these compactions in MiB\n"
+            "        \"write_mib\": x.x        (numeric) The data written by these compactions in MiB\n"
+            "      }, ...\n"
+            "    ]\n"
+            "  }, ...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getdbstats", "")
+            + HelpExampleCli("getdbstats", "\"evodb\"")
+            + HelpExampleRpc("getdbstats", "\"evodb\"")
+        );
+
+    std::string strName;
+    if (request.params.size() > 0 && !request.params[0].isNull()) {
+        strName = request.params[0].get_str();
+    }
+
+    UniValue result(UniValue::VARR);
+    for (const CDBStats& stats : GetDBStats()) {
+        if (!strName.empty() && stats.strName != strName) {
+            continue;
+        }
+        UniValue tuning(UniValue::VOBJ);
+        tuning.push_back(Pair("block_size", (uint64_t)stats.tuning.nBlockSize));
+        tuning.push_back(Pair("bloom_bits", stats.tuning.nBloomBits));
+        tuning.push_back(Pair("write_buffer_size", (uint64_t)stats.nWriteBufferSize));
+        tuning.push_back(Pair("max_file_size", (uint64_t)stats.tuning.nMaxFileSize));
+        tuning.push_back(Pair("compression", stats.tuning.fCompression));
+        tuning.push_back(Pair("max_open_files", stats.tuning.nMaxOpenFiles));
+
+        UniValue levels(UniValue::VARR);
+        for (const auto& level : stats.vLevels) {
+            UniValue objLevel(UniValue::VOBJ);
+            objLevel.push_back(Pair("level", level.nLevel));
+            objLevel.push_back(Pair("files", level.nFiles));
+            objLevel.push_back(Pair("size_mib", level.dSizeMiB));
+            objLevel.push_back(Pair("compaction_secs", level.dCompactionSecs));
+            objLevel.push_back(Pair("read_mib", level.dReadMiB));
+            objLevel.push_back(Pair("write_mib", level.dWriteMiB));
+            levels.push_back(objLevel);
+        }
+
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("name", stats.strName));
+        obj.push_back(Pair("path", stats.strPath));
+        obj.push_back(Pair("memory", stats.fMemory));
+        obj.push_back(Pair("cache_size", (uint64_t)stats.nCacheSize));
+        obj.push_back(Pair("tuning", tuning));
+        obj.push_back(Pair("compactions", stats.nCompactions));
+        obj.push_back(Pair("trivial_moves", stats.nTrivialMoves));
+        obj.push_back(Pair("memtable_flushes", stats.nMemtableFlushes));
+        obj.push_back(Pair("write_stalls", stats.nWriteStalls));
+        obj.push_back(Pair("memory_usage", (uint64_t)stats.nMemoryUsage));
+        obj.push_back(Pair("read_amplification", stats.nReadAmplification));
+        obj.push_back(Pair("levels", levels));
+        result.push_back(obj);
+    }
+    if (!strName.empty() && result.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("No open database named %s", strName));
+    }
+    return result;
+}
+
 UniValue getchaintxstats(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 2)
@@ -2222,11 +2549,14 @@ static const CRPCCommand commands[] =
   //  --------------------- ------------------------  -----------------------  ------ ----------
     { "blockchain",         "getblockchaininfo",      &getblockchaininfo,      true,  {} },
     { "blockchain",         "getchaintxstats",        &getchaintxstats,        true,  {"nblocks", "blockhash"} },
+    { "blockchain",         "getblockconnectstats",   &getblockconnectstats,   true,  {"buckets", "reset"} },
+    { "blockchain",         "getdbstats",             &getdbstats,             true,  {"name"} },
     { "blockchain",         "getblockstats",          &getblockstats,          true,  {"hash_or_height", "stats"} },
     { "blockchain",         "getbestblockhash",       &getbestblockhash,       true,  {} },
     { "blockchain",         "getbestchainlock",       &getbestchainlock,       true,  {} },
     { "blockchain",         "getblockcount",          &getblockcount,          true,  {} },
     { "blockchain",         "getblock",               &getblock,               true,  {"blockhash","verbosity|verbose"} },
+    { "blockchain",         "getindexinfo",           &getindexinfo,           true,  {} },
     { "blockchain",         "getblockhashes",         &getblockhashes,         true,  {"high","low"} },
     { "blockchain",         "getblockhash",           &getblockhash,           true,  {"height"} },
     { "blockchain",         "getblockheader",         &getblockheader,         true,  {"blockhash","verbose"} },
@@ -2238,6 +2568,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempooldescendants",  &getmempooldescendants,  true,  {"txid","verbose"} },
     { "blockchain",         "getmempoolentry",        &getmempoolentry,        true,  {"txid"} },
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         true,  {} },
+    { "blockchain",         "getrecenttxpoolinfo",    &getrecenttxpoolinfo,    true,  {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          true,  {"verbose"} },
     { "blockchain",         "getspecialtxes",         &getspecialtxes,         true,  {"blockhash", "type", "count", "skip", "verbosity"} },
     { "blockchain",         "gettxout",               &gettxout,               true,  {"txid","n","include_mempool"} },
@@ -2259,4 +2590,13 @@ void RegisterBlockchainRPCCommands(CRPCTable &t)
 {
     for (unsigned int vcidx = 0; vcidx < ARRAYLEN(commands); vcidx++)
         t.appendCommand(commands[vcidx].name, &commands[vcidx]);
+    t.appendStreamCommand("getblock", &getblockStream);
+    // independent calls of these can be executed in parallel in a JSON-RPC batch
+    for (const char* name : {
+        "getblockchaininfo", "getchaintxstats", "getblockstats", "getbestblockhash", "getbestchainlock",
+        "getblockcount", "getblock", "getindexinfo", "getblockhashes", "getblockhash", "getblockheader",
+        "getblockheaders", "getmerkleblocks", "getchaintips", "getdifficulty", "getmempoolancestors",
+        "getmempooldescendants", "getmempoolentry", "getmempoolinfo", "getrawmempool", "getspecialtxes",
+        "gettxout"})
+        t.appendReadOnlyCommand(name);
 }
@@ -7,6 +7,7 @@
 
 class CBlock;
 class CBlockIndex;
+class CJSONWriter;
 class UniValue;
 
 /**
@@ -23,6 +24,8 @@ void RPCNotifyBlockChange(bool ibd, const CBlockIndex *);
 
 /** Block description to JSON */
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails = false);
+/** Same as above, but writes the block object directly into a JSON writer */
+void blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool txDetails, CJSONWriter& result);
 
 /** Mempool information to JSON */
 UniValue mempoolInfoToJSON();
@@ -33,5 +36,8 @@ UniValue mempoolToJSON(bool fVerbose = false);
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* blockindex);
 
+/** Throws if -addressindex, -spentindex or -timestampindex are still being built */
+void EnsureExplorerIndexSynced();
+
 #endif
 
@@ -155,6 +155,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getmempooldescendants", 1, "verbose" },
     { "logging", 0, "include" },
     { "logging", 1, "exclude" },
+    { "getlockstats", 0, "count" },
+    { "setlockprofiling", 0, "enable" },
+    { "setlockprofiling", 1, "samplerate" },
     { "spork", 1, "value" },
     { "voteraw", 1, "tx_index" },
     { "voteraw", 5, "time" },
@@ -171,6 +174,15 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getspecialtxes", 3, "skip" },
     { "getspecialtxes", 4, "verbosity" },
     { "disconnectnode", 1, "nodeid" },
+    { "getnetmsgstats", 0, "nodeid" },
+    { "getnetmsgstats", 1, "buckets" },
+    { "getnetmsgstats", 2, "reset" },
+    { "getblockconnectstats", 0, "buckets" },
+    { "getblockconnectstats", 1, "reset" },
+    { "getrpcinfo", 0, "buckets" },
+    { "getrpcinfo", 1, "reset" },
+    { "getzmqreplay", 1, "sequence" },
+    { "getzmqreplay", 2, "count" },
     // Echo with conversion (For testing only)
     { "echojson", 0, "arg0" },
     { "echojson", 1, "arg1" },
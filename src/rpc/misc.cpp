@@ -8,12 +8,16 @@
 #include "chain.h"
 #include "clientversion.h"
 #include "core_io.h"
+#include "executor.h"
 #include "init.h"
 #include "httpserver.h"
 #include "net.h"
 #include "netbase.h"
 #include "rpc/blockchain.h"
 #include "rpc/server.h"
+#include "scheduler.h"
+#include "streams.h"
+#include "sync.h"
 #include "timedata.h"
 #include "txmempool.h"
 #include "util.h"
@@ -708,6 +712,131 @@ bool getAddressesFromParams(const UniValue& params, std::vector<std::pair<uint16
     return true;
 }
 
+static const int DEFAULT_ADDRESS_PAGE_LIMIT = 1000;
+static const int MAX_ADDRESS_PAGE_LIMIT = 50000;
+
+// Returns true if the request asks for a single page of results instead of all of them
+static bool getPageFromParams(const UniValue& params, int& limit, std::string& cursor)
+{
+    if (!params[0].isObject()) {
+        return false;
+    }
+    UniValue limitValue = find_value(params[0].get_obj(), "limit");
+    UniValue cursorValue = find_value(params[0].get_obj(), "cursor");
+    if (limitValue.isNull() && cursorValue.isNull()) {
+        return false;
+    }
+
+    limit = limitValue.isNull() ? DEFAULT_ADDRESS_PAGE_LIMIT : limitValue.get_int();
+    if (limit < 1 || limit > MAX_ADDRESS_PAGE_LIMIT) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("limit must be between 1 and %d", MAX_ADDRESS_PAGE_LIMIT));
+    }
+    cursor = cursorValue.isNull() ? "" : cursorValue.get_str();
+    return true;
+}
+
+// A cursor is the position of the address in the request and the index key to continue at
+template <typename Key>
+static void decodeCursor(const std::string& cursor, const std::vector<std::pair<uint160, int> >& addresses, size_t& nAddress, Key& key)
+{
+    if (!IsHex(cursor)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    std::vector<unsigned char> data(ParseHex(cursor));
+    CDataStream ss(data, SER_NETWORK, PROTOCOL_VERSION);
+    uint32_t n;
+    try {
+        ss >> n >> key;
+    } catch (const std::exception&) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    if (!ss.empty() || n >= addresses.size() || key.hashBytes != addresses[n].first || key.type != (unsigned int)addresses[n].second) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor doesn't match the requested addresses");
+    }
+    nAddress = n;
+}
+
+template <typename Key>
+static UniValue encodeCursor(size_t nAddress, const Key& key)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << (uint32_t)nAddress << key;
+    return HexStr(ss.begin(), ss.end());
+}
+
+// Reads one page of address index entries, address by address, and returns the cursor of the next page (or null).
+// If fWholeTxs is set, the next page starts after the last returned transaction, so that its txid isn't repeated.
+static UniValue getAddressIndexPage(const std::vector<std::pair<uint160, int> >& addresses, int start, int end,
+                                    int limit, const std::string& cursor, bool fWholeTxs,
+                                    std::vector<std::pair<CAddressIndexKey, CAmount> >& addressIndex)
+{
+    if (addresses.empty()) {
+        return NullUniValue;
+    }
+
+    size_t nAddress = 0;
+    CAddressIndexKey key(addresses[0].second, addresses[0].first, start, 0, uint256(), 0, false);
+    if (!cursor.empty()) {
+        decodeCursor(cursor, addresses, nAddress, key);
+    }
+
+    while (true) {
+        CAddressIndexKey nextKey;
+        bool fMore;
+        if (!GetAddressIndexPage(key, end, limit - addressIndex.size(), addressIndex, nextKey, fMore)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+        if (fMore) {
+            if (fWholeTxs && nextKey.txhash == addressIndex.back().first.txhash) {
+                // sorts after all entries of the tx
+                nextKey.index = std::numeric_limits<uint32_t>::max();
+                nextKey.spending = true;
+            }
+            return encodeCursor(nAddress, nextKey);
+        }
+        if (++nAddress == addresses.size()) {
+            return NullUniValue;
+        }
+        key = CAddressIndexKey(addresses[nAddress].second, addresses[nAddress].first, start, 0, uint256(), 0, false);
+        if (addressIndex.size() == (size_t)limit) {
+            return encodeCursor(nAddress, key);
+        }
+    }
+}
+
+// Same as getAddressIndexPage for the unspent outputs of the addresses
+static UniValue getAddressUnspentPage(const std::vector<std::pair<uint160, int> >& addresses, int limit, const std::string& cursor,
+                                      std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> >& unspentOutputs)
+{
+    if (addresses.empty()) {
+        return NullUniValue;
+    }
+
+    size_t nAddress = 0;
+    CAddressUnspentKey key(addresses[0].second, addresses[0].first, uint256(), 0);
+    if (!cursor.empty()) {
+        decodeCursor(cursor, addresses, nAddress, key);
+    }
+
+    while (true) {
+        CAddressUnspentKey nextKey;
+        bool fMore;
+        if (!GetAddressUnspentPage(key, limit - unspentOutputs.size(), unspentOutputs, nextKey, fMore)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+        }
+        if (fMore) {
+            return encodeCursor(nAddress, nextKey);
+        }
+        if (++nAddress == addresses.size()) {
+            return NullUniValue;
+        }
+        key = CAddressUnspentKey(addresses[nAddress].second, addresses[nAddress].first, uint256(), 0);
+        if (unspentOutputs.size() == (size_t)limit) {
+            return encodeCursor(nAddress, key);
+        }
+    }
+}
+
 bool heightSort(std::pair<CAddressUnspentKey, CAddressUnspentValue> a,
                 std::pair<CAddressUnspentKey, CAddressUnspentValue> b) {
     return a.second.blockHeight < b.second.blockHeight;
@@ -802,6 +931,8 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
             "      \"address\"  (string) The base58check encoded address\n"
             "      ,...\n"
             "    ]\n"
+            "  \"limit\" (number, optional) Return at most this many outputs (1 - 50000) and a cursor for the next page\n"
+            "  \"cursor\" (string, optional) The cursor returned with the previous page\n"
             "}\n"
             "\nResult:\n"
             "[\n"
@@ -814,11 +945,19 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
             "    \"height\"  (number) The block height\n"
             "  }\n"
             "]\n"
+            "\nResult (if limit or cursor is given):\n"
+            "{\n"
+            "  \"utxos\"  (array) The outputs of this page as above, ordered by address and txid instead of height\n"
+            "  \"cursor\"  (string) The cursor of the next page, null if this is the last page\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
+            + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"], \"limit\": 1000}'")
             + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
         );
 
+    EnsureExplorerIndexSynced();
+
     std::vector<std::pair<uint160, int> > addresses;
 
     if (!getAddressesFromParams(request.params, addresses)) {
@@ -827,13 +966,22 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > unspentOutputs;
 
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    int limit;
+    std::string cursor;
+    bool fPage = getPageFromParams(request.params, limit, cursor);
+    UniValue nextCursor;
+
+    if (fPage) {
+        nextCursor = getAddressUnspentPage(addresses, limit, cursor, unspentOutputs);
+    } else {
+        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (!GetAddressUnspent((*it).first, (*it).second, unspentOutputs)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
         }
-    }
 
-    std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+        std::sort(unspentOutputs.begin(), unspentOutputs.end(), heightSort);
+    }
 
     UniValue result(UniValue::VARR);
 
@@ -853,6 +1001,13 @@ UniValue getaddressutxos(const JSONRPCRequest& request)
         result.push_back(output);
     }
 
+    if (fPage) {
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("utxos", result));
+        page.push_back(Pair("cursor", nextCursor));
+        return page;
+    }
+
     return result;
 }
 
@@ -871,6 +1026,8 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
             "    ]\n"
             "  \"start\" (number) The start block height\n"
             "  \"end\" (number) The end block height\n"
+            "  \"limit\" (number, optional) Return at most this many deltas (1 - 50000) and a cursor for the next page\n"
+            "  \"cursor\" (string, optional) The cursor returned with the previous page\n"
             "}\n"
             "\nResult:\n"
             "[\n"
@@ -883,11 +1040,19 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
             "    \"address\"  (string) The base58check encoded address\n"
             "  }\n"
             "]\n"
+            "\nResult (if limit or cursor is given):\n"
+            "{\n"
+            "  \"deltas\"  (array) The deltas of this page as above\n"
+            "  \"cursor\"  (string) The cursor of the next page, null if this is the last page\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
+            + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"], \"limit\": 1000}'")
             + HelpExampleRpc("getaddressdeltas", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
         );
 
+    EnsureExplorerIndexSynced();
+
 
     UniValue startValue = find_value(request.params[0].get_obj(), "start");
     UniValue endValue = find_value(request.params[0].get_obj(), "end");
@@ -911,14 +1076,24 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (start > 0 && end > 0) {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-            }
-        } else {
-            if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    int limit;
+    std::string cursor;
+    bool fPage = getPageFromParams(request.params, limit, cursor);
+    UniValue nextCursor;
+
+    if (fPage) {
+        bool fRange = start > 0 && end > 0;
+        nextCursor = getAddressIndexPage(addresses, fRange ? start : 0, fRange ? end : 0, limit, cursor, false, addressIndex);
+    } else {
+        for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+            if (start > 0 && end > 0) {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
+            } else {
+                if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+                }
             }
         }
     }
@@ -941,6 +1116,13 @@ UniValue getaddressdeltas(const JSONRPCRequest& request)
         result.push_back(delta);
     }
 
+    if (fPage) {
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("deltas", result));
+        page.push_back(Pair("cursor", nextCursor));
+        return page;
+    }
+
     return result;
 }
 
@@ -962,39 +1144,43 @@ UniValue getaddressbalance(const JSONRPCRequest& request)
             "{\n"
             "  \"balance\"  (string) The current balance in duffs\n"
             "  \"received\"  (string) The total number of duffs received (including change)\n"
+            "  \"sent\"  (string) The total number of duffs sent (including change)\n"
+            "  \"txcount\"  (numeric) The number of transactions involving the address(es), summed per address\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressbalance", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
             + HelpExampleRpc("getaddressbalance", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
         );
 
+    EnsureExplorerIndexSynced();
+
     std::vector<std::pair<uint160, int> > addresses;
 
     if (!getAddressesFromParams(request.params, addresses)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        if (!GetAddressIndex((*it).first, (*it).second, addressIndex)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
-        }
-    }
-
     CAmount balance = 0;
     CAmount received = 0;
+    CAmount sent = 0;
+    uint64_t txCount = 0;
 
-    for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
-        if (it->second > 0) {
-            received += it->second;
+    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
+        CAddressBalanceValue value;
+        if (!GetAddressBalance((*it).first, (*it).second, value)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
         }
-        balance += it->second;
+        balance += value.balance;
+        received += value.received;
+        sent += value.sent;
+        txCount += value.txCount;
     }
 
     UniValue result(UniValue::VOBJ);
     result.push_back(Pair("balance", balance));
     result.push_back(Pair("received", received));
+    result.push_back(Pair("sent", sent));
+    result.push_back(Pair("txcount", txCount));
 
     return result;
 
@@ -1015,17 +1201,28 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
             "    ]\n"
             "  \"start\" (number) The start block height\n"
             "  \"end\" (number) The end block height\n"
+            "  \"limit\" (number, optional) Read at most this many index entries (1 - 50000) and return a cursor for the next page\n"
+            "  \"cursor\" (string, optional) The cursor returned with the previous page\n"
             "}\n"
             "\nResult:\n"
             "[\n"
             "  \"transactionid\"  (string) The transaction id\n"
             "  ,...\n"
             "]\n"
+            "\nResult (if limit or cursor is given):\n"
+            "{\n"
+            "  \"txids\"  (array) The txids of this page, ordered by address and height. A txid involving several\n"
+            "                   of the addresses can be repeated on a later page.\n"
+            "  \"cursor\"  (string) The cursor of the next page, null if this is the last page\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}'")
+            + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"], \"limit\": 1000}'")
             + HelpExampleRpc("getaddresstxids", "{\"addresses\": [\"XwnLY9Tf7Zsef8gMGL2fhWA9ZmMjt4KPwg\"]}")
         );
 
+    EnsureExplorerIndexSynced();
+
     std::vector<std::pair<uint160, int> > addresses;
 
     if (!getAddressesFromParams(request.params, addresses)) {
@@ -1045,6 +1242,26 @@ UniValue getaddresstxids(const JSONRPCRequest& request)
 
     std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
 
+    int limit;
+    std::string cursor;
+    if (getPageFromParams(request.params, limit, cursor)) {
+        bool fRange = start > 0 && end > 0;
+        UniValue nextCursor = getAddressIndexPage(addresses, fRange ? start : 0, fRange ? end : 0, limit, cursor, true, addressIndex);
+
+        std::set<uint256> setTxids;
+        UniValue txids(UniValue::VARR);
+        for (std::vector<std::pair<CAddressIndexKey, CAmount> >::const_iterator it=addressIndex.begin(); it!=addressIndex.end(); it++) {
+            if (setTxids.insert(it->first.txhash).second) {
+                txids.push_back(it->first.txhash.GetHex());
+            }
+        }
+
+        UniValue page(UniValue::VOBJ);
+        page.push_back(Pair("txids", txids));
+        page.push_back(Pair("cursor", nextCursor));
+        return page;
+    }
+
     for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
         if (start > 0 && end > 0) {
             if (!GetAddressIndex((*it).first, (*it).second, addressIndex, start, end)) {
@@ -1105,6 +1322,8 @@ UniValue getspentinfo(const JSONRPCRequest& request)
             + HelpExampleRpc("getspentinfo", "{\"txid\": \"0437cd7f8525ceed2324359c2d0ba26006d92d856a9c20fa0241106ee5a597c9\", \"index\": 0}")
         );
 
+    EnsureExplorerIndexSynced();
+
     UniValue txidValue = find_value(request.params[0].get_obj(), "txid");
     UniValue indexValue = find_value(request.params[0].get_obj(), "index");
 
@@ -1223,6 +1442,236 @@ uint64_t getCategoryMask(UniValue cats) {
     return mask;
 }
 
+UniValue getexecutorstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getexecutorstats\n"
+            "Returns statistics about the shared executor which runs the compute intensive work of the LLMQ subsystems.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"threads\": n,                 (numeric) Number of worker threads\n"
+            "  \"queued\": n,                  (numeric) Number of tasks waiting for a worker\n"
+            "  \"executed\": n,                (numeric) Number of tasks run since startup\n"
+            "  \"stolen\": n,                  (numeric) Number of tasks a worker took from the queue of another worker\n"
+            "  \"groups\": [                   (array) One entry per subsystem\n"
+            "    {\n"
+            "      \"name\": \"name\",           (string) The name of the subsystem\n"
+            "      \"priority\": \"priority\",   (string) The priority of its tasks (high, normal or low)\n"
+            "      \"maxconcurrency\": n,      (numeric) Maximum number of its tasks which are queued or run by the workers at the same time\n"
+            "      \"queued\": n,              (numeric) Number of its tasks which wait to be run\n"
+            "      \"running\": n,             (numeric) Number of its tasks which are running\n"
+            "      \"submitted\": n,           (numeric) Number of tasks submitted since startup\n"
+            "      \"completed\": n,           (numeric) Number of tasks completed since startup\n"
+            "      \"avgwait\": x.xxx,         (numeric) Average time in milliseconds between submitting and starting a task\n"
+            "      \"maxwait\": x.xxx,         (numeric) Maximum time in milliseconds between submitting and starting a task\n"
+            "      \"avgrun\": x.xxx,          (numeric) Average run time of a task in milliseconds\n"
+            "      \"maxrun\": x.xxx           (numeric) Maximum run time of a task in milliseconds\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getexecutorstats", "")
+            + HelpExampleRpc("getexecutorstats", "")
+        );
+
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("threads", g_executor.GetThreadCount()));
+    obj.push_back(Pair("queued", g_executor.GetQueuedCount()));
+    obj.push_back(Pair("executed", g_executor.GetExecutedCount()));
+    obj.push_back(Pair("stolen", g_executor.GetStolenCount()));
+
+    UniValue groups(UniValue::VARR);
+    for (const auto& stats : g_executor.GetGroupStats()) {
+        UniValue group(UniValue::VOBJ);
+        group.push_back(Pair("name", stats.strName));
+        group.push_back(Pair("priority", TaskPriorityToString(stats.priority)));
+        group.push_back(Pair("maxconcurrency", stats.nMaxConcurrency));
+        group.push_back(Pair("queued", (uint64_t)stats.nQueued));
+        group.push_back(Pair("running", (uint64_t)stats.nRunning));
+        group.push_back(Pair("submitted", stats.nSubmitted));
+        group.push_back(Pair("completed", stats.nCompleted));
+        uint64_t nStarted = stats.nCompleted + stats.nRunning;
+        group.push_back(Pair("avgwait", nStarted ? stats.nTotalWaitMicros * 0.001 / nStarted : 0.0));
+        group.push_back(Pair("maxwait", stats.nMaxWaitMicros * 0.001));
+        group.push_back(Pair("avgrun", stats.nCompleted ? stats.nTotalRunMicros * 0.001 / stats.nCompleted : 0.0));
+        group.push_back(Pair("maxrun", stats.nMaxRunMicros * 0.001));
+        groups.push_back(group);
+    }
+    obj.push_back(Pair("groups", groups));
+    return obj;
+}
+
+UniValue setlockprofiling(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "setlockprofiling enable ( samplerate )\n"
+            "Enables or disables the lock profiler. Enabling it clears the statistics reported by getlockstats.\n"
+            "\nArguments:\n"
+            "1. enable         (boolean, required) Whether to enable the profiler\n"
+            "2. samplerate     (numeric, optional, default=" + std::to_string(DEFAULT_LOCK_PROFILING_SAMPLE_RATE) + ") Time every <samplerate>th lock acquisition of each thread\n"
+            "\nExamples:\n"
+            + HelpExampleCli("setlockprofiling", "true 4")
+            + HelpExampleRpc("setlockprofiling", "true, 4")
+        );
+
+    bool fEnable = request.params[0].get_bool();
+    int nSampleRate = DEFAULT_LOCK_PROFILING_SAMPLE_RATE;
+    if (request.params.size() > 1) {
+        nSampleRate = request.params[1].get_int();
+        if (nSampleRate < 1) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "samplerate must be at least 1");
+        }
+    }
+    SetLockProfiling(fEnable, nSampleRate);
+    return NullUniValue;
+}
+
+UniValue getlockstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 2)
+        throw std::runtime_error(
+            "getlockstats ( count \"sortby\" )\n"
+            "Returns the wait and hold times of the locks per lock name and source location, as sampled by the lock profiler\n"
+            "(see setlockprofiling and -lockprofiling). Totals are estimated by multiplying the sampled values with the sample rate.\n"
+            "\nArguments:\n"
+            "1. count          (numeric, optional, default=20) Return the first <count> locations, 0 for all\n"
+            "2. \"sortby\"       (string, optional, default=\"wait\") Order of the locations: \"wait\" or \"hold\" (descending total time) or \"acquisitions\"\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"enabled\": true|false,          (boolean) Whether the profiler is enabled\n"
+            "  \"samplerate\": n,                (numeric) One in <samplerate> acquisitions of each thread is timed\n"
+            "  \"locations\": [\n"
+            "    {\n"
+            "      \"lock\": \"name\",               (string) The lock as named in the source, e.g. cs_main\n"
+            "      \"location\": \"file:line\",      (string) Where the lock was acquired\n"
+            "      \"acquisitions\": n,          (numeric) Estimated number of acquisitions\n"
+            "      \"samples\": n,               (numeric) Number of timed acquisitions\n"
+            "      \"contended\": n,             (numeric) Number of timed acquisitions which had to wait for the lock\n"
+            "      \"totalwait\": x.xxx,         (numeric) Estimated total time in milliseconds spent waiting for the lock\n"
+            "      \"avgwait\": x.xxx,           (numeric) Average wait time in milliseconds\n"
+            "      \"maxwait\": x.xxx,           (numeric) Maximum wait time in milliseconds\n"
+            "      \"totalhold\": x.xxx,         (numeric) Estimated total time in milliseconds the lock was held\n"
+            "      \"avghold\": x.xxx,           (numeric) Average hold time in milliseconds\n"
+            "      \"maxhold\": x.xxx            (numeric) Maximum hold time in milliseconds\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getlockstats", "")
+            + HelpExampleCli("getlockstats", "10 \"hold\"")
+            + HelpExampleRpc("getlockstats", "10, \"hold\"")
+        );
+
+    int nCount = 20;
+    if (request.params.size() > 0) {
+        nCount = request.params[0].get_int();
+        if (nCount < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "count must not be negative");
+        }
+    }
+    std::string strSortBy = request.params.size() > 1 ? request.params[1].get_str() : "wait";
+
+    std::vector<CLockSiteStats> vStats = GetLockSiteStats();
+    if (strSortBy == "wait") {
+        std::sort(vStats.begin(), vStats.end(), [](const CLockSiteStats& a, const CLockSiteStats& b) {
+            return a.nTotalWaitMicros > b.nTotalWaitMicros;
+        });
+    } else if (strSortBy == "hold") {
+        std::sort(vStats.begin(), vStats.end(), [](const CLockSiteStats& a, const CLockSiteStats& b) {
+            return a.nTotalHoldMicros > b.nTotalHoldMicros;
+        });
+    } else if (strSortBy == "acquisitions") {
+        std::sort(vStats.begin(), vStats.end(), [](const CLockSiteStats& a, const CLockSiteStats& b) {
+            return a.nSamples > b.nSamples;
+        });
+    } else {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "sortby must be wait, hold or acquisitions");
+    }
+    if (nCount > 0 && vStats.size() > (size_t)nCount) {
+        vStats.resize(nCount);
+    }
+
+    int nSampleRate = GetLockProfilingSampleRate();
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("enabled", fLockProfiling.load()));
+    obj.push_back(Pair("samplerate", nSampleRate));
+    UniValue locations(UniValue::VARR);
+    for (const auto& stats : vStats) {
+        UniValue location(UniValue::VOBJ);
+        location.push_back(Pair("lock", stats.strName));
+        location.push_back(Pair("location", strprintf("%s:%d", stats.strFile, stats.nLine)));
+        location.push_back(Pair("acquisitions", stats.nSamples * nSampleRate));
+        location.push_back(Pair("samples", stats.nSamples));
+        location.push_back(Pair("contended", stats.nContended));
+        location.push_back(Pair("totalwait", stats.nTotalWaitMicros * 0.001 * nSampleRate));
+        location.push_back(Pair("avgwait", stats.nTotalWaitMicros * 0.001 / stats.nSamples));
+        location.push_back(Pair("maxwait", stats.nMaxWaitMicros * 0.001));
+        location.push_back(Pair("totalhold", stats.nTotalHoldMicros * 0.001 * nSampleRate));
+        location.push_back(Pair("avghold", stats.nTotalHoldMicros * 0.001 / stats.nSamples));
+        location.push_back(Pair("maxhold", stats.nMaxHoldMicros * 0.001));
+        locations.push_back(location);
+    }
+    obj.push_back(Pair("locations", locations));
+    return obj;
+}
+
+UniValue getschedulerstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0)
+        throw std::runtime_error(
+            "getschedulerstats\n"
+            "Returns statistics about the scheduler which runs the periodic maintenance tasks, ordered by total run time.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"threads\": n,                 (numeric) Number of threads servicing the scheduler (see -schedulerthreads)\n"
+            "  \"queued\": n,                  (numeric) Number of tasks which are scheduled\n"
+            "  \"tasks\": [\n"
+            "    {\n"
+            "      \"name\": \"name\",           (string) The name of the task, unnamed tasks share one entry\n"
+            "      \"runs\": n,                (numeric) Number of runs since startup\n"
+            "      \"totalrun\": x.xxx,        (numeric) Total run time in milliseconds\n"
+            "      \"avgrun\": x.xxx,          (numeric) Average run time in milliseconds\n"
+            "      \"maxrun\": x.xxx,          (numeric) Maximum run time in milliseconds\n"
+            "      \"avglate\": x.xxx,         (numeric) Average time in milliseconds a run started after it was due\n"
+            "      \"maxlate\": x.xxx          (numeric) Maximum time in milliseconds a run started after it was due\n"
+            "    }, ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getschedulerstats", "")
+            + HelpExampleRpc("getschedulerstats", "")
+        );
+
+    if (!g_scheduler) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Scheduler is not running");
+    }
+
+    std::vector<CSchedulerTaskStats> vStats = g_scheduler->getTaskStats();
+    std::sort(vStats.begin(), vStats.end(), [](const CSchedulerTaskStats& a, const CSchedulerTaskStats& b) {
+        return a.nTotalRunMicros > b.nTotalRunMicros;
+    });
+
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("threads", g_scheduler->getThreadCount()));
+    obj.push_back(Pair("queued", (uint64_t)g_scheduler->getQueueSize()));
+    UniValue tasks(UniValue::VARR);
+    for (const auto& stats : vStats) {
+        UniValue task(UniValue::VOBJ);
+        task.push_back(Pair("name", stats.strName));
+        task.push_back(Pair("runs", stats.nRuns));
+        task.push_back(Pair("totalrun", stats.nTotalRunMicros * 0.001));
+        task.push_back(Pair("avgrun", stats.nTotalRunMicros * 0.001 / stats.nRuns));
+        task.push_back(Pair("maxrun", stats.nMaxRunMicros * 0.001));
+        task.push_back(Pair("avglate", stats.nTotalLateMicros * 0.001 / stats.nRuns));
+        task.push_back(Pair("maxlate", stats.nMaxLateMicros * 0.001));
+        tasks.push_back(task);
+    }
+    obj.push_back(Pair("tasks", tasks));
+    return obj;
+}
+
 UniValue logging(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() > 2) {
@@ -1317,6 +1766,10 @@ static const CRPCCommand commands[] =
     { "control",            "debug",                  &debug,                  true,  {} },
     { "control",            "getinfo",                &getinfo,                true,  {} }, /* uses wallet if enabled */
     { "control",            "getmemoryinfo",          &getmemoryinfo,          true,  {"mode"} },
+    { "control",            "getexecutorstats",       &getexecutorstats,       true,  {} },
+    { "control",            "getlockstats",           &getlockstats,           true,  {"count","sortby"} },
+    { "control",            "getschedulerstats",      &getschedulerstats,      true,  {} },
+    { "control",            "setlockprofiling",       &setlockprofiling,       true,  {"enable","samplerate"} },
     { "util",               "validateaddress",        &validateaddress,        true,  {"address"} }, /* uses wallet if enabled */
     { "util",               "createmultisig",         &createmultisig,         true,  {"nrequired","keys"} },
     { "util",               "verifymessage",          &verifymessage,          true,  {"address","signature","message"} },
@@ -1346,4 +1799,9 @@ void RegisterMiscRPCCommands(CRPCTable &t)
 {
     for (unsigned int vcidx = 0; vcidx < ARRAYLEN(commands); vcidx++)
         t.appendCommand(commands[vcidx].name, &commands[vcidx]);
+    // independent calls of these can be executed in parallel in a JSON-RPC batch
+    for (const char* name : {
+        "verifymessage", "getspentinfo", "getaddressmempool", "getaddressutxos", "getaddressdeltas",
+        "getaddresstxids", "getaddressbalance"})
+        t.appendReadOnlyCommand(name);
 }
@@ -400,6 +400,77 @@ UniValue getnettotals(const JSONRPCRequest& request)
     return obj;
 }
 
+UniValue getnetmsgstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 3)
+        throw std::runtime_error(
+            "getnetmsgstats ( nodeid buckets reset )\n"
+            "\nReturns per message type timings of the P2P message handler thread.\n"
+            "All timings are in microseconds.\n"
+            "\nArguments:\n"
+            "1. nodeid        (numeric, optional, default=-1) Only show timings of this peer (see getpeerinfo for node IDs),\n"
+            "                 -1 shows timings aggregated over all peers\n"
+            "2. buckets       (boolean, optional, default=false) Include the raw histogram buckets\n"
+            "3. reset         (boolean, optional, default=false) Reset the statistics after returning them\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"since\": ttt,            (numeric) The UNIX epoch time when collection started\n"
+            "  \"messages\": {            (json object) Timings per message type\n"
+            "    \"msgtype\": {\n"
+            "      \"queuewait\": {...},  (json object) Time between receipt and the start of processing\n"
+            "      \"handling\": {...},   (json object) Time spent processing the message\n"
+            "      \"cs_main\": {...}     (json object) Time spent holding cs_main while processing the message\n"
+            "    }, ...\n"
+            "  }\n"
+            "}\n"
+            "\nEach timing object contains \"count\", \"total_us\", \"last_us\", \"avg_us\", \"p50_us\", \"p90_us\",\n"
+            "\"p99_us\" and \"max_us\". Buckets are keyed by their exclusive upper bound.\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getnetmsgstats", "")
+            + HelpExampleCli("getnetmsgstats", "1 true")
+            + HelpExampleRpc("getnetmsgstats", "")
+        );
+
+    if(!g_connman)
+        throw JSONRPCError(RPC_CLIENT_P2P_DISABLED, "Error: Peer-to-peer functionality missing or disabled");
+
+    NodeId nodeid = request.params.size() > 0 && !request.params[0].isNull() ? (NodeId)request.params[0].get_int64() : -1;
+    bool fBuckets = request.params.size() > 1 && !request.params[1].isNull() && request.params[1].get_bool();
+    bool fReset = request.params.size() > 2 && !request.params[2].isNull() && request.params[2].get_bool();
+
+    mapMsgCmdProfile mapProfile;
+    int64_t nSince = 0;
+    if (nodeid == -1) {
+        mapProfile = netMsgProfiler.GetProfiles();
+        nSince = netMsgProfiler.GetStartTime();
+        if (fReset) {
+            netMsgProfiler.Reset();
+        }
+    } else {
+        bool fFound = g_connman->ForNode(nodeid, [&](CNode* pnode) {
+            mapProfile = pnode->msgProfiler.GetProfiles();
+            nSince = pnode->msgProfiler.GetStartTime();
+            if (fReset) {
+                pnode->msgProfiler.Reset();
+            }
+            return true;
+        });
+        if (!fFound) {
+            throw JSONRPCError(RPC_CLIENT_NODE_NOT_CONNECTED, "Node not found in connected nodes");
+        }
+    }
+
+    UniValue messages(UniValue::VOBJ);
+    for (const auto& p : mapProfile) {
+        messages.push_back(Pair(p.first, p.second.ToJson(fBuckets)));
+    }
+
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("since", nSince));
+    obj.push_back(Pair("messages", messages));
+    return obj;
+}
+
 static UniValue GetNetworksInfo()
 {
     UniValue networks(UniValue::VARR);
@@ -642,6 +713,7 @@ static const CRPCCommand commands[] =
     { "network",            "disconnectnode",         &disconnectnode,         true,  {"address", "nodeid"} },
     { "network",            "getaddednodeinfo",       &getaddednodeinfo,       true,  {"node"} },
     { "network",            "getnettotals",           &getnettotals,           true,  {} },
+    { "network",            "getnetmsgstats",         &getnetmsgstats,         true,  {"nodeid", "buckets", "reset"} },
     { "network",            "getnetworkinfo",         &getnetworkinfo,         true,  {} },
     { "network",            "setban",                 &setban,                 true,  {"subnet", "command", "bantime", "absolute"} },
     { "network",            "listbanned",             &listbanned,             true,  {} },
@@ -509,7 +509,6 @@ UniValue decoderawtransaction(const JSONRPCRequest& request)
             + HelpExampleRpc("decoderawtransaction", "\"hexstring\"")
         );
 
-    LOCK(cs_main);
     RPCTypeCheck(request.params, {UniValue::VSTR});
 
     CMutableTransaction mtx;
@@ -1013,4 +1012,8 @@ void RegisterRawTransactionRPCCommands(CRPCTable &t)
 {
     for (unsigned int vcidx = 0; vcidx < ARRAYLEN(commands); vcidx++)
         t.appendCommand(commands[vcidx].name, &commands[vcidx]);
+    // independent calls of these can be executed in parallel in a JSON-RPC batch
+    for (const char* name : {
+        "getrawtransaction", "decoderawtransaction", "decodescript", "gettxoutproof", "verifytxoutproof"})
+        t.appendReadOnlyCommand(name);
 }
@@ -8,6 +8,7 @@
 
 #include "base58.h"
 #include "fs.h"
+#include "httpserver.h"
 #include "init.h"
 #include "random.h"
 #include "sync.h"
@@ -24,6 +25,7 @@
 #include <boost/algorithm/string/split.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <memory> // for unique_ptr
 #include <unordered_map>
 
@@ -325,6 +327,72 @@ UniValue uptime(const JSONRPCRequest& jsonRequest)
     return GetTime() - GetStartupTime();
 }
 
+UniValue getrpcinfo(const JSONRPCRequest& jsonRequest)
+{
+    if (jsonRequest.fHelp || jsonRequest.params.size() > 2)
+        throw std::runtime_error(
+                "getrpcinfo ( buckets reset )\n"
+                        "\nReturns the state of the RPC work queue lanes and the timings of the RPC methods and REST\n"
+                        "paths they served. All timings are in microseconds.\n"
+                        "\nArguments:\n"
+                        "1. buckets       (boolean, optional, default=false) Include the raw histogram buckets\n"
+                        "2. reset         (boolean, optional, default=false) Reset the timings after returning them\n"
+                        "\nResult:\n"
+                        "{\n"
+                        "  \"lanes\": {               (json object) Work queue lanes, see -rpclane\n"
+                        "    \"lane\": {\n"
+                        "      \"threads\": n,        (numeric) Number of worker threads\n"
+                        "      \"depth\": n,          (numeric) Number of queued requests\n"
+                        "      \"maxdepth\": n,       (numeric) Maximum number of queued requests\n"
+                        "      \"rejected\": n        (numeric) Number of requests rejected because the queue was full\n"
+                        "    }, ...\n"
+                        "  },\n"
+                        "  \"methods\": {             (json object) Timings per RPC method or REST path\n"
+                        "    \"method\": {\n"
+                        "      \"lane\": \"xxxx\",       (string) The lane which serves the method, see -rpcmethodlane\n"
+                        "      \"rejected\": n,       (numeric) Number of requests rejected because the queue was full\n"
+                        "      \"queuewait\": {...},  (json object) Time between receipt and the start of execution\n"
+                        "      \"execution\": {...}   (json object) Time spent executing the request\n"
+                        "    }, ...\n"
+                        "  }\n"
+                        "}\n"
+                        "\nEach timing object contains \"count\", \"total_us\", \"last_us\", \"avg_us\", \"p50_us\", \"p90_us\",\n"
+                        "\"p99_us\" and \"max_us\". Buckets are keyed by their exclusive upper bound.\n"
+                        "\nExamples:\n"
+                + HelpExampleCli("getrpcinfo", "")
+                + HelpExampleCli("getrpcinfo", "true")
+                + HelpExampleRpc("getrpcinfo", "")
+        );
+
+    bool fBuckets = jsonRequest.params.size() > 0 && !jsonRequest.params[0].isNull() && jsonRequest.params[0].get_bool();
+    bool fReset = jsonRequest.params.size() > 1 && !jsonRequest.params[1].isNull() && jsonRequest.params[1].get_bool();
+
+    UniValue lanes(UniValue::VOBJ);
+    for (const auto& lane : GetHTTPLaneStats()) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("threads", lane.nThreads));
+        obj.push_back(Pair("depth", (uint64_t)lane.nDepth));
+        obj.push_back(Pair("maxdepth", (uint64_t)lane.nMaxDepth));
+        obj.push_back(Pair("rejected", lane.nRejected));
+        lanes.push_back(Pair(HTTPLaneName(lane.lane), obj));
+    }
+
+    UniValue methods(UniValue::VOBJ);
+    for (const auto& p : GetHTTPWorkStats(fReset)) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("lane", HTTPLaneName(p.second.lane)));
+        obj.push_back(Pair("rejected", p.second.nRejected));
+        obj.push_back(Pair("queuewait", p.second.queueWait.ToJson(fBuckets)));
+        obj.push_back(Pair("execution", p.second.execution.ToJson(fBuckets)));
+        methods.push_back(Pair(p.first, obj));
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("lanes", lanes));
+    ret.push_back(Pair("methods", methods));
+    return ret;
+}
+
 /**
  * Call Table
  */
@@ -335,6 +403,7 @@ static const CRPCCommand vRPCCommands[] =
     { "control",            "help",                   &help,                   true,  {"command"}  },
     { "control",            "stop",                   &stop,                   true,  {"wait"}  },
     { "control",            "uptime",                 &uptime,                 true,  {}  },
+    { "control",            "getrpcinfo",             &getrpcinfo,             true,  {"buckets","reset"}  },
 };
 
 CRPCTable::CRPCTable()
@@ -371,9 +440,130 @@ bool CRPCTable::appendCommand(const std::string& name, const CRPCCommand* pcmd)
     return true;
 }
 
+bool CRPCTable::appendStreamCommand(const std::string& name, rpcstreamfn_type fn)
+{
+    if (IsRPCRunning() || !mapCommands.count(name) || mapStreamCommands.count(name))
+        return false;
+
+    mapStreamCommands[name] = fn;
+    return true;
+}
+
+bool CRPCTable::appendReadOnlyCommand(const std::string& name)
+{
+    if (IsRPCRunning() || !mapCommands.count(name))
+        return false;
+
+    setReadOnlyCommands.insert(name);
+    return true;
+}
+
+bool CRPCTable::isReadOnly(const std::string& name) const
+{
+    return setReadOnlyCommands.count(name) != 0;
+}
+
+struct CRPCBatchExecutor::Job
+{
+    std::function<void(size_t)> func;
+    size_t nCount;
+    std::atomic<size_t> nNext{0};
+
+    std::mutex cs;
+    std::condition_variable cond;
+    size_t nDone{0};
+};
+
+CRPCBatchExecutor::CRPCBatchExecutor(int nThreads)
+{
+    for (int i = 0; i < nThreads; i++) {
+        threads.emplace_back(&CRPCBatchExecutor::ThreadMain, this);
+    }
+}
+
+CRPCBatchExecutor::~CRPCBatchExecutor()
+{
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        fInterrupted = true;
+        cond.notify_all();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void CRPCBatchExecutor::RunJob(Job& job)
+{
+    size_t nDone = 0;
+    for (size_t i = job.nNext++; i < job.nCount; i = job.nNext++) {
+        job.func(i);
+        nDone++;
+    }
+    if (nDone) {
+        std::unique_lock<std::mutex> lock(job.cs);
+        job.nDone += nDone;
+        if (job.nDone == job.nCount) {
+            job.cond.notify_all();
+        }
+    }
+}
+
+void CRPCBatchExecutor::ThreadMain()
+{
+    RenameThread("xazab-rpcbatch");
+    while (true) {
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            while (!fInterrupted && queue.empty()) {
+                cond.wait(lock);
+            }
+            if (fInterrupted) {
+                return;
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        // all items might have been claimed already, that's fine
+        RunJob(*job);
+    }
+}
+
+void CRPCBatchExecutor::ForEach(size_t nCount, const std::function<void(size_t)>& func)
+{
+    if (nCount == 0) {
+        return;
+    }
+    auto job = std::make_shared<Job>();
+    job->func = func;
+    job->nCount = nCount;
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        for (size_t i = 0; i < std::min(threads.size(), nCount - 1); i++) {
+            queue.push_back(job);
+        }
+        cond.notify_all();
+    }
+    RunJob(*job);
+
+    std::unique_lock<std::mutex> lock(job->cs);
+    while (job->nDone < job->nCount) {
+        job->cond.wait(lock);
+    }
+}
+
+// Shared, so that HTTP workers which are still executing a batch keep it alive after StopRPC(). Accessed with
+// std::atomic_load/std::atomic_store only.
+static std::shared_ptr<CRPCBatchExecutor> g_rpcBatchExecutor;
+
 bool StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
+    int nBatchThreads = std::max((int)gArgs.GetArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 0);
+    if (nBatchThreads > 0) {
+        std::atomic_store(&g_rpcBatchExecutor, std::make_shared<CRPCBatchExecutor>(nBatchThreads));
+    }
     fRPCRunning = true;
     g_rpcSignals.Started();
     return true;
@@ -390,6 +580,8 @@ void StopRPC()
 {
     LogPrint(BCLog::RPC, "Stopping RPC\n");
     deadlineTimers.clear();
+    // the last batch which is still running destroys it
+    std::atomic_store(&g_rpcBatchExecutor, std::shared_ptr<CRPCBatchExecutor>());
     DeleteAuthCookie();
     g_rpcSignals.Stopped();
 }
@@ -474,15 +666,60 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
-std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
+/** Whether a batch entry may be executed in parallel with its neighbours. Malformed entries only produce an error. */
+static bool IsReadOnlyRequest(const UniValue& req)
 {
+    if (!req.isObject())
+        return true;
+    const UniValue& method = find_value(req.get_obj(), "method");
+    if (!method.isStr())
+        return true;
+    return tableRPC.isReadOnly(method.get_str());
+}
+
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, CRPCBatchExecutor* executor)
+{
+    std::vector<UniValue> vResults(vReq.size());
+    size_t nStart = 0;
+    while (nStart < vReq.size()) {
+        size_t nEnd = nStart;
+        while (nEnd < vReq.size() && IsReadOnlyRequest(vReq[nEnd]))
+            nEnd++;
+        if (nEnd == nStart) {
+            // an entry with side effects, execute it on its own
+            vResults[nStart] = JSONRPCExecOne(jreq, vReq[nStart]);
+            nStart++;
+            continue;
+        }
+
+        if (executor && nEnd - nStart > 1) {
+            executor->ForEach(nEnd - nStart, [&](size_t i) {
+                try {
+                    vResults[nStart + i] = JSONRPCExecOne(jreq, vReq[nStart + i]);
+                } catch (...) {
+                    vResults[nStart + i] = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_INTERNAL_ERROR, "Internal error"), NullUniValue);
+                }
+            });
+        } else {
+            for (size_t i = nStart; i < nEnd; i++)
+                vResults[i] = JSONRPCExecOne(jreq, vReq[i]);
+        }
+        nStart = nEnd;
+    }
+
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    for (UniValue& result : vResults)
+        ret.push_back(std::move(result));
 
     return ret.write() + "\n";
 }
 
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
+{
+    std::shared_ptr<CRPCBatchExecutor> executor = std::atomic_load(&g_rpcBatchExecutor);
+    return JSONRPCExecBatch(jreq, vReq, executor.get());
+}
+
 /**
  * Process named arguments into a vector of positional arguments, based on the
  * passed-in specification for the RPC call's arguments.
@@ -564,6 +801,35 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
     }
 }
 
+bool CRPCTable::executeStream(const JSONRPCRequest &request, CJSONWriter& result) const
+{
+    auto it = mapStreamCommands.find(request.strMethod);
+    if (it == mapStreamCommands.end())
+        return false;
+
+    {
+        LOCK(cs_rpcWarmup);
+        if (fRPCInWarmup)
+            throw JSONRPCError(RPC_IN_WARMUP, rpcWarmupStatus);
+    }
+
+    const CRPCCommand *pcmd = tableRPC[request.strMethod];
+    g_rpcSignals.PreCommand(*pcmd);
+
+    try
+    {
+        if (request.params.isObject()) {
+            return it->second(transformNamedArguments(request, pcmd->argNames), result);
+        } else {
+            return it->second(request, result);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+}
+
 std::vector<std::string> CRPCTable::listCommands() const
 {
     std::vector<std::string> commandList;
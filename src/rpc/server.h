@@ -10,10 +10,18 @@
 #include "rpc/protocol.h"
 #include "uint256.h"
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <stdint.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <univalue.h>
 
@@ -27,6 +35,7 @@ namespace RPCServer
 }
 
 class CBlockIndex;
+class CJSONWriter;
 
 /** Wrapper for UniValue::VType, which includes typeAny:
  * Used to denote don't care type. Only used by RPCTypeCheckObj */
@@ -127,6 +136,8 @@ void RPCUnsetTimerInterface(RPCTimerInterface *iface);
 void RPCRunLater(const std::string& name, std::function<void(void)> func, int64_t nSeconds);
 
 typedef UniValue(*rpcfn_type)(const JSONRPCRequest& jsonRequest);
+/** Writes the result directly into a JSON writer, returns false to fall back to the rpcfn_type of the method */
+typedef bool(*rpcstreamfn_type)(const JSONRPCRequest& jsonRequest, CJSONWriter& result);
 
 class CRPCCommand
 {
@@ -145,6 +156,8 @@ class CRPCTable
 {
 private:
     std::map<std::string, const CRPCCommand*> mapCommands;
+    std::map<std::string, rpcstreamfn_type> mapStreamCommands;
+    std::set<std::string> setReadOnlyCommands;
 public:
     CRPCTable();
     const CRPCCommand* operator[](const std::string& name) const;
@@ -158,6 +171,16 @@ public:
      */
     UniValue execute(const JSONRPCRequest &request) const;
 
+    /**
+     * Execute a method which can write its result directly into a JSON writer, e.g. for replies with
+     * thousands of objects like getblock with verbosity 2.
+     * @returns false if the method has no such implementation or declined the request. execute() has
+     * to be used then.
+     * @throws an exception (UniValue) when an error happens. As long as nothing was flushed from the
+     * writer, the error can still be sent instead of the result.
+     */
+    bool executeStream(const JSONRPCRequest &request, CJSONWriter& result) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
@@ -170,6 +193,18 @@ public:
      * Commands cannot be overwritten (returns false).
      */
     bool appendCommand(const std::string& name, const CRPCCommand* pcmd);
+
+    /**
+     * Adds a direct-to-writer implementation to an already appended command (see executeStream).
+     */
+    bool appendStreamCommand(const std::string& name, rpcstreamfn_type fn);
+
+    /**
+     * Marks an already appended command as read-only, so calls of it in a JSON-RPC batch may be executed
+     * in parallel.
+     */
+    bool appendReadOnlyCommand(const std::string& name);
+    bool isReadOnly(const std::string& name) const;
 };
 
 extern CRPCTable tableRPC;
@@ -197,6 +232,45 @@ extern std::string HelpExampleRpc(const std::string& methodname, const std::stri
 bool StartRPC();
 void InterruptRPC();
 void StopRPC();
+
+static const int DEFAULT_RPC_BATCH_THREADS = 4;
+
+/** Pool of worker threads which execute the read-only entries of JSON-RPC batches in parallel */
+class CRPCBatchExecutor
+{
+private:
+    struct Job;
+
+    std::mutex cs;
+    std::condition_variable cond;
+    // one entry per worker thread which may help with a job
+    std::deque<std::shared_ptr<Job> > queue;
+    std::vector<std::thread> threads;
+    bool fInterrupted{false};
+
+    static void RunJob(Job& job);
+    void ThreadMain();
+
+public:
+    explicit CRPCBatchExecutor(int nThreads);
+    ~CRPCBatchExecutor();
+
+    size_t GetThreadCount() const { return threads.size(); }
+
+    /**
+     * Calls func(i) for every i in [0, nCount), in parallel on the worker threads and the calling thread.
+     * Returns once all calls returned. func must not throw.
+     */
+    void ForEach(size_t nCount, const std::function<void(size_t)>& func);
+};
+
+/**
+ * Executes a batch of JSON-RPC requests. Consecutive read-only requests are executed in parallel by the
+ * executor, all others on their own and in order, so the batch behaves as if it was executed sequentially.
+ * The results are in the order of the requests.
+ */
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq, CRPCBatchExecutor* executor);
+/** Executes a batch of JSON-RPC requests with the executor of the RPC server (-rpcbatchthreads) */
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq);
 
 #endif // BITCOIN_RPCSERVER_H
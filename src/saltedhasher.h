@@ -30,6 +30,15 @@ struct SaltedHasherImpl<std::pair<N, uint256>>
     }
 };
 
+template<typename N>
+struct SaltedHasherImpl<std::pair<uint160, N>>
+{
+    static std::size_t CalcHash(const std::pair<uint160, N>& v, uint64_t k0, uint64_t k1)
+    {
+        return CSipHasher(k0, k1).Write((uint64_t) v.second).Write(v.first.begin(), v.first.size()).Finalize();
+    }
+};
+
 template<>
 struct SaltedHasherImpl<uint256>
 {
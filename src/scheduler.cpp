@@ -4,14 +4,26 @@
 
 #include "scheduler.h"
 
+#include "crypto/common.h"
 #include "random.h"
 #include "reverselock.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <boost/bind.hpp>
+#include <limits>
 #include <utility>
 
-CScheduler::CScheduler() : nThreadsServicingQueue(0), stopRequested(false), stopWhenEmpty(false)
+CScheduler::CScheduler() :
+    epoch(std::chrono::steady_clock::now()),
+    nCurrentTick(0),
+    wheelOccupied(),
+    nTasks(0),
+    fSerialTaskRunning(false),
+    nMockOffsetMicros(0),
+    nThreadsServicingQueue(0),
+    stopRequested(false),
+    stopWhenEmpty(false)
 {
 }
 
@@ -20,15 +32,144 @@ CScheduler::~CScheduler()
     assert(nThreadsServicingQueue == 0);
 }
 
+std::chrono::steady_clock::time_point CScheduler::Now() const
+{
+    return std::chrono::steady_clock::now() + std::chrono::microseconds(nMockOffsetMicros.load());
+}
 
-#if BOOST_VERSION < 105000
-static boost::system_time toPosixTime(const boost::chrono::system_clock::time_point& t)
+void CScheduler::MockForward(std::chrono::steady_clock::duration delta)
 {
-    // Creating the posix_time using from_time_t loses sub-second precision. So rather than exporting the time_point to time_t,
-    // start with a posix_time at the epoch (0) and add the milliseconds that have passed since then.
-    return boost::posix_time::from_time_t(0) + boost::posix_time::milliseconds(boost::chrono::duration_cast<boost::chrono::milliseconds>(t.time_since_epoch()).count());
+    {
+        boost::unique_lock<boost::mutex> lock(newTaskMutex);
+        nMockOffsetMicros += std::chrono::duration_cast<std::chrono::microseconds>(delta).count();
+    }
+    // wake up the threads waiting for the tasks which are due now
+    newTaskScheduled.notify_all();
+}
+
+int64_t CScheduler::MicrosUntil(std::chrono::steady_clock::time_point t) const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(t - Now()).count();
+}
+
+int64_t CScheduler::TickFor(std::chrono::steady_clock::time_point t, bool fRoundUp) const
+{
+    // nanoseconds, so that rounding up never puts a task before its due time
+    int64_t nNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch).count();
+    int64_t nTickNanos = TICK_MICROS * 1000;
+    int64_t nTick = nNanos / nTickNanos;
+    // division truncates towards zero
+    if (fRoundUp && nNanos > 0 && nNanos % nTickNanos != 0) {
+        nTick++;
+    } else if (!fRoundUp && nNanos < 0 && nNanos % nTickNanos != 0) {
+        nTick--;
+    }
+    return nTick;
+}
+
+void CScheduler::InsertTask(Task&& task)
+{
+    int64_t nDelta = task.nDueTick - nCurrentTick;
+    if (nDelta < 0) {
+        readyTasks.emplace_back(std::move(task));
+        return;
+    }
+    // the lowest level whose slots can tell this tick from the current one
+    for (int nLevel = 0; nLevel < WHEEL_LEVELS; nLevel++) {
+        if (nDelta < (int64_t(1) << (WHEEL_BITS * (nLevel + 1)))) {
+            int nSlot = (task.nDueTick >> (WHEEL_BITS * nLevel)) & (WHEEL_SLOTS - 1);
+            wheel[nLevel][nSlot].emplace_back(std::move(task));
+            wheelOccupied[nLevel] |= uint64_t(1) << nSlot;
+            return;
+        }
+    }
+    overflowTasks.emplace_back(std::move(task));
+}
+
+void CScheduler::CascadeSlot(int nLevel, int nSlot)
+{
+    if (!(wheelOccupied[nLevel] & (uint64_t(1) << nSlot))) {
+        return;
+    }
+    std::list<Task> tasks;
+    tasks.swap(wheel[nLevel][nSlot]);
+    wheelOccupied[nLevel] &= ~(uint64_t(1) << nSlot);
+    // these are due within the region which starts now, so they move to lower levels
+    for (auto& task : tasks) {
+        InsertTask(std::move(task));
+    }
+}
+
+void CScheduler::ProcessTick()
+{
+    if (!overflowTasks.empty() && (nCurrentTick & ((int64_t(1) << (WHEEL_BITS * (WHEEL_LEVELS - 1))) - 1)) == 0) {
+        std::list<Task> tasks;
+        tasks.swap(overflowTasks);
+        for (auto& task : tasks) {
+            InsertTask(std::move(task));
+        }
+    }
+    // entering a new region of a level distributes the tasks of its slot over the lower levels
+    for (int nLevel = WHEEL_LEVELS - 1; nLevel > 0; nLevel--) {
+        if ((nCurrentTick & ((int64_t(1) << (WHEEL_BITS * nLevel)) - 1)) == 0) {
+            CascadeSlot(nLevel, (nCurrentTick >> (WHEEL_BITS * nLevel)) & (WHEEL_SLOTS - 1));
+        }
+    }
+    int nSlot = nCurrentTick & (WHEEL_SLOTS - 1);
+    if (wheelOccupied[0] & (uint64_t(1) << nSlot)) {
+        for (auto& task : wheel[0][nSlot]) {
+            readyTasks.emplace_back(std::move(task));
+        }
+        wheel[0][nSlot].clear();
+        wheelOccupied[0] &= ~(uint64_t(1) << nSlot);
+    }
+}
+
+int64_t CScheduler::NextEventTick() const
+{
+    int64_t nNextTick = std::numeric_limits<int64_t>::max();
+    if (wheelOccupied[0]) {
+        // first occupied slot at or after the current one
+        int nSlot = nCurrentTick & (WHEEL_SLOTS - 1);
+        uint64_t nRotated = (wheelOccupied[0] >> nSlot) | (nSlot ? wheelOccupied[0] << (WHEEL_SLOTS - nSlot) : 0);
+        nNextTick = nCurrentTick + CountBits(nRotated & (~nRotated + 1)) - 1;
+    }
+    // nothing can happen at the lower levels before the next region of the lowest occupied higher level starts
+    int nLevel = 1;
+    while (nLevel < WHEEL_LEVELS && !wheelOccupied[nLevel]) {
+        nLevel++;
+    }
+    if (nLevel == WHEEL_LEVELS && !overflowTasks.empty()) {
+        nLevel = WHEEL_LEVELS - 1;
+    }
+    if (nLevel < WHEEL_LEVELS) {
+        int64_t nMask = (int64_t(1) << (WHEEL_BITS * nLevel)) - 1;
+        int64_t nBoundary = (nCurrentTick & nMask) == 0 ? nCurrentTick : (nCurrentTick | nMask) + 1;
+        nNextTick = std::min(nNextTick, nBoundary);
+    }
+    return nNextTick;
+}
+
+void CScheduler::AdvanceTo(int64_t nTick)
+{
+    while (nCurrentTick <= nTick) {
+        // skip the ticks which have nothing to do
+        nCurrentTick = std::min(NextEventTick(), nTick + 1);
+        if (nCurrentTick > nTick) {
+            break;
+        }
+        ProcessTick();
+        nCurrentTick++;
+    }
+}
+
+std::deque<CScheduler::Task>::iterator CScheduler::NextRunnableTask()
+{
+    if (!fSerialTaskRunning) {
+        return readyTasks.begin();
+    }
+    return std::find_if(readyTasks.begin(), readyTasks.end(), [](const Task& task) { return !task.fSerial; });
 }
-#endif
 
 void CScheduler::serviceQueue()
 {
@@ -39,50 +180,82 @@ void CScheduler::serviceQueue()
     // when the thread is waiting or when the user's function
     // is called.
     while (!shouldStop()) {
+        bool fRunningSerial = false;
         try {
-            if (!shouldStop() && taskQueue.empty()) {
+            if (!shouldStop() && nTasks == 0) {
                 reverse_lock<boost::unique_lock<boost::mutex> > rlock(lock);
                 // Use this chance to get a tiny bit more entropy
                 RandAddSeedSleep();
             }
-            while (!shouldStop() && taskQueue.empty()) {
+            while (!shouldStop() && nTasks == 0) {
                 // Wait until there is something to do.
                 newTaskScheduled.wait(lock);
             }
 
-            // Wait until either there is a new task, or until
-            // the time of the first item on the queue:
-
-// wait_until needs boost 1.50 or later; older versions have timed_wait:
+            // Wait until either there is a new task, a serial task finished, or until
+            // the next tick of the wheel which has something to do:
+            std::deque<Task>::iterator itTask;
+            while (!shouldStop() && nTasks > 0) {
+                AdvanceTo(TickFor(Now(), false));
+                itTask = NextRunnableTask();
+                if (itTask != readyTasks.end()) {
+                    break;
+                }
+                int64_t nNextTick = NextEventTick();
+                if (nNextTick == std::numeric_limits<int64_t>::max()) {
+                    // only serial tasks are ready and the wheel is empty
+                    newTaskScheduled.wait(lock);
+                    continue;
+                }
+                int64_t nWaitMicros = MicrosUntil(epoch + std::chrono::microseconds(nNextTick * TICK_MICROS));
+                if (nWaitMicros <= 0) {
+                    continue;
+                }
+// wait_for needs boost 1.50 or later; older versions have timed_wait:
 #if BOOST_VERSION < 105000
-            while (!shouldStop() && !taskQueue.empty() &&
-                   newTaskScheduled.timed_wait(lock, toPosixTime(taskQueue.begin()->first))) {
-                // Keep waiting until timeout
-            }
+                newTaskScheduled.timed_wait(lock, boost::posix_time::microseconds(nWaitMicros));
 #else
-            // Some boost versions have a conflicting overload of wait_until that returns void.
-            // Explicitly use a template here to avoid hitting that overload.
-            while (!shouldStop() && !taskQueue.empty()) {
-                boost::chrono::system_clock::time_point timeToWaitFor = taskQueue.begin()->first;
-                if (newTaskScheduled.wait_until<>(lock, timeToWaitFor) == boost::cv_status::timeout)
-                    break; // Exit loop after timeout, it means we reached the time of the event
-            }
+                newTaskScheduled.wait_for(lock, boost::chrono::microseconds(nWaitMicros));
 #endif
+            }
             // If there are multiple threads, the queue can empty while we're waiting (another
             // thread may service the task we were waiting on).
-            if (shouldStop() || taskQueue.empty())
+            if (shouldStop() || nTasks == 0)
                 continue;
 
-            Function f = taskQueue.begin()->second;
-            taskQueue.erase(taskQueue.begin());
+            Task task = std::move(*itTask);
+            readyTasks.erase(itTask);
+            nTasks--;
+            fRunningSerial = task.fSerial;
+            if (fRunningSerial) {
+                fSerialTaskRunning = true;
+            }
 
+            int64_t nLateMicros = -MicrosUntil(task.due);
+            auto start = std::chrono::steady_clock::now();
             {
                 // Unlock before calling f, so it can reschedule itself or another task
                 // without deadlocking:
                 reverse_lock<boost::unique_lock<boost::mutex> > rlock(lock);
-                f();
+                task.f();
             }
+            int64_t nRunMicros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            if (fRunningSerial) {
+                fSerialTaskRunning = false;
+                // another thread might be waiting for a serial task
+                newTaskScheduled.notify_one();
+            }
+
+            CSchedulerTaskStats& stats = mapTaskStats[task.strName];
+            stats.nRuns++;
+            stats.nTotalRunMicros += nRunMicros;
+            stats.nMaxRunMicros = std::max(stats.nMaxRunMicros, nRunMicros);
+            stats.nTotalLateMicros += nLateMicros;
+            stats.nMaxLateMicros = std::max(stats.nMaxLateMicros, nLateMicros);
         } catch (...) {
+            if (fRunningSerial) {
+                fSerialTaskRunning = false;
+            }
             --nThreadsServicingQueue;
             throw;
         }
@@ -104,40 +277,76 @@ void CScheduler::stop(bool drain)
 }
 
 void CScheduler::schedule(CScheduler::Function f, boost::chrono::system_clock::time_point t)
+{
+    int64_t nMicros = boost::chrono::duration_cast<boost::chrono::microseconds>(t - boost::chrono::system_clock::now()).count();
+    schedule(f, Now() + std::chrono::microseconds(nMicros), "");
+}
+
+void CScheduler::schedule(CScheduler::Function f, std::chrono::steady_clock::time_point t, const std::string& strName, bool fSerial)
 {
     {
         boost::unique_lock<boost::mutex> lock(newTaskMutex);
-        taskQueue.insert(std::make_pair(t, f));
+        InsertTask(Task{std::move(f), strName, t, TickFor(t, true), fSerial});
+        nTasks++;
     }
     newTaskScheduled.notify_one();
 }
 
-void CScheduler::scheduleFromNow(CScheduler::Function f, int64_t deltaMilliSeconds)
+void CScheduler::scheduleFromNow(CScheduler::Function f, int64_t deltaMilliSeconds, const std::string& strName, bool fSerial)
 {
-    schedule(f, boost::chrono::system_clock::now() + boost::chrono::milliseconds(deltaMilliSeconds));
+    schedule(f, Now() + std::chrono::milliseconds(deltaMilliSeconds), strName, fSerial);
 }
 
-static void Repeat(CScheduler* s, CScheduler::Function f, int64_t deltaMilliSeconds)
+static void Repeat(CScheduler* s, CScheduler::Function f, int64_t deltaMilliSeconds, const std::string& strName)
 {
     f();
-    s->scheduleFromNow(boost::bind(&Repeat, s, f, deltaMilliSeconds), deltaMilliSeconds);
+    s->scheduleFromNow(boost::bind(&Repeat, s, f, deltaMilliSeconds, strName), deltaMilliSeconds, strName);
 }
 
-void CScheduler::scheduleEvery(CScheduler::Function f, int64_t deltaMilliSeconds)
+void CScheduler::scheduleEvery(CScheduler::Function f, int64_t deltaMilliSeconds, const std::string& strName)
 {
-    scheduleFromNow(boost::bind(&Repeat, this, f, deltaMilliSeconds), deltaMilliSeconds);
+    scheduleFromNow(boost::bind(&Repeat, this, f, deltaMilliSeconds, strName), deltaMilliSeconds, strName);
 }
 
 size_t CScheduler::getQueueInfo(boost::chrono::system_clock::time_point &first,
                              boost::chrono::system_clock::time_point &last) const
 {
     boost::unique_lock<boost::mutex> lock(newTaskMutex);
-    size_t result = taskQueue.size();
-    if (!taskQueue.empty()) {
-        first = taskQueue.begin()->first;
-        last = taskQueue.rbegin()->first;
+    if (nTasks == 0) {
+        return 0;
     }
-    return result;
+
+    // the wheel isn't sorted, so this has to look at all tasks
+    auto firstDue = std::chrono::steady_clock::time_point::max();
+    auto lastDue = std::chrono::steady_clock::time_point::min();
+    auto visit = [&](const Task& task) {
+        firstDue = std::min(firstDue, task.due);
+        lastDue = std::max(lastDue, task.due);
+    };
+    for (const auto& task : readyTasks) {
+        visit(task);
+    }
+    for (int nLevel = 0; nLevel < WHEEL_LEVELS; nLevel++) {
+        for (int nSlot = 0; nSlot < WHEEL_SLOTS; nSlot++) {
+            for (const auto& task : wheel[nLevel][nSlot]) {
+                visit(task);
+            }
+        }
+    }
+    for (const auto& task : overflowTasks) {
+        visit(task);
+    }
+
+    boost::chrono::system_clock::time_point now = boost::chrono::system_clock::now();
+    first = now + boost::chrono::microseconds(MicrosUntil(firstDue));
+    last = now + boost::chrono::microseconds(MicrosUntil(lastDue));
+    return nTasks;
+}
+
+size_t CScheduler::getQueueSize() const
+{
+    boost::unique_lock<boost::mutex> lock(newTaskMutex);
+    return nTasks;
 }
 
 bool CScheduler::AreThreadsServicingQueue() const {
@@ -145,6 +354,24 @@ bool CScheduler::AreThreadsServicingQueue() const {
     return nThreadsServicingQueue;
 }
 
+int CScheduler::getThreadCount() const
+{
+    boost::unique_lock<boost::mutex> lock(newTaskMutex);
+    return nThreadsServicingQueue;
+}
+
+std::vector<CSchedulerTaskStats> CScheduler::getTaskStats() const
+{
+    boost::unique_lock<boost::mutex> lock(newTaskMutex);
+    std::vector<CSchedulerTaskStats> ret;
+    ret.reserve(mapTaskStats.size());
+    for (const auto& p : mapTaskStats) {
+        ret.emplace_back(p.second);
+        ret.back().strName = p.first.empty() ? "unnamed" : p.first;
+    }
+    return ret;
+}
+
 
 void SingleThreadedSchedulerClient::MaybeScheduleProcessQueue() {
     {
@@ -155,7 +382,8 @@ void SingleThreadedSchedulerClient::MaybeScheduleProcessQueue() {
         if (m_are_callbacks_running) return;
         if (m_callbacks_pending.empty()) return;
     }
-    m_pscheduler->schedule(std::bind(&SingleThreadedSchedulerClient::ProcessQueue, this));
+    // the callbacks are serialized by this client, so they don't need to wait for the serial tasks
+    m_pscheduler->scheduleFromNow(std::bind(&SingleThreadedSchedulerClient::ProcessQueue, this), 0, "callbacks", false);
 }
 
 void SingleThreadedSchedulerClient::ProcessQueue() {
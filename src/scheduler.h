@@ -12,7 +12,13 @@
 //
 #include <boost/chrono/chrono.hpp>
 #include <boost/thread.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <list>
 #include <map>
+#include <string>
+#include <vector>
 
 #include "sync.h"
 
@@ -33,6 +39,29 @@
 // delete t;
 // delete s; // Must be done after thread is interrupted/joined.
 //
+// Tasks are kept in a hierarchical timer wheel which is driven by the steady
+// clock, so changes of the system time don't delay or hurry them. Tasks never
+// run early but might run up to one tick (1 ms) late.
+//
+// Serial tasks (the default) never run at the same time as each other, even
+// when several threads service the queue, as most of them were written for a
+// single scheduler thread. Only tasks which are scheduled with fSerial=false,
+// like the validation interface callbacks, can run in parallel to them.
+//
+
+//! -schedulerthreads default
+static const int DEFAULT_SCHEDULER_THREADS = 1;
+static const int MAX_SCHEDULER_THREADS = 16;
+
+struct CSchedulerTaskStats {
+    std::string strName;
+    uint64_t nRuns{0};
+    int64_t nTotalRunMicros{0};
+    int64_t nMaxRunMicros{0};
+    //! Time between the moment a task was due and the moment it was started
+    int64_t nTotalLateMicros{0};
+    int64_t nMaxLateMicros{0};
+};
 
 class CScheduler
 {
@@ -45,15 +74,19 @@ public:
     // Call func at/after time t
     void schedule(Function f, boost::chrono::system_clock::time_point t=boost::chrono::system_clock::now());
 
+    // Call func at/after steady time t, strName is used to report the task's
+    // statistics (all unnamed tasks share one entry)
+    void schedule(Function f, std::chrono::steady_clock::time_point t, const std::string& strName, bool fSerial = true);
+
     // Convenience method: call f once deltaSeconds from now
-    void scheduleFromNow(Function f, int64_t deltaMilliSeconds);
+    void scheduleFromNow(Function f, int64_t deltaMilliSeconds, const std::string& strName = "", bool fSerial = true);
 
     // Another convenience method: call f approximately
     // every deltaSeconds forever, starting deltaSeconds from now.
     // To be more precise: every time f is finished, it
     // is rescheduled to run deltaSeconds later. If you
     // need more accurate scheduling, don't use this method.
-    void scheduleEvery(Function f, int64_t deltaMilliSeconds);
+    void scheduleEvery(Function f, int64_t deltaMilliSeconds, const std::string& strName = "");
 
     // To keep things as simple as possible, there is no unschedule.
 
@@ -71,17 +104,72 @@ public:
     size_t getQueueInfo(boost::chrono::system_clock::time_point &first,
                         boost::chrono::system_clock::time_point &last) const;
 
+    // Returns number of tasks waiting to be serviced, without the
+    // scan over all tasks which getQueueInfo needs
+    size_t getQueueSize() const;
+
     // Returns true if there are threads actively running in serviceQueue()
     bool AreThreadsServicingQueue() const;
 
+    // Returns the number of threads running serviceQueue()
+    int getThreadCount() const;
+
+    // Returns the run time and lateness statistics of all tasks which ran so far
+    std::vector<CSchedulerTaskStats> getTaskStats() const;
+
+    // Returns the scheduler's clock: the steady clock plus everything
+    // MockForward added. Due times passed to schedule() are on this clock.
+    std::chrono::steady_clock::time_point Now() const;
+
+    // Moves the scheduler's clock forward by delta (for tests), tasks which
+    // became due run as if that time had passed
+    void MockForward(std::chrono::steady_clock::duration delta);
+
 private:
-    std::multimap<boost::chrono::system_clock::time_point, Function> taskQueue;
+    struct Task {
+        Function f;
+        std::string strName;
+        std::chrono::steady_clock::time_point due;
+        int64_t nDueTick;
+        bool fSerial;
+    };
+
+    // 4 levels of 64 slots, a slot of level n covers 64^n ticks
+    static const int WHEEL_BITS = 6;
+    static const int WHEEL_SLOTS = 1 << WHEEL_BITS;
+    static const int WHEEL_LEVELS = 4;
+    static const int64_t TICK_MICROS = 1000;
+
+    const std::chrono::steady_clock::time_point epoch;
+    // ticks before nCurrentTick were processed already, their tasks are in readyTasks
+    int64_t nCurrentTick;
+    std::list<Task> wheel[WHEEL_LEVELS][WHEEL_SLOTS];
+    uint64_t wheelOccupied[WHEEL_LEVELS];
+    // tasks which are due too far in the future for the wheel (more than ~4.6 hours)
+    std::list<Task> overflowTasks;
+    std::deque<Task> readyTasks;
+    size_t nTasks;
+    bool fSerialTaskRunning;
+    std::atomic<int64_t> nMockOffsetMicros;
+    std::map<std::string, CSchedulerTaskStats> mapTaskStats;
+
     boost::condition_variable newTaskScheduled;
     mutable boost::mutex newTaskMutex;
     int nThreadsServicingQueue;
     bool stopRequested;
     bool stopWhenEmpty;
-    bool shouldStop() { return stopRequested || (stopWhenEmpty && taskQueue.empty()); }
+    bool shouldStop() { return stopRequested || (stopWhenEmpty && nTasks == 0); }
+
+    // All of these require newTaskMutex to be held
+    int64_t TickFor(std::chrono::steady_clock::time_point t, bool fRoundUp) const;
+    void InsertTask(Task&& task);
+    void CascadeSlot(int nLevel, int nSlot);
+    void ProcessTick();
+    int64_t NextEventTick() const;
+    void AdvanceTo(int64_t nTick);
+    int64_t MicrosUntil(std::chrono::steady_clock::time_point t) const;
+    // the first ready task which may run now, readyTasks.end() if there is none
+    std::deque<Task>::iterator NextRunnableTask();
 };
 
 /**
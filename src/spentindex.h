@@ -241,6 +241,38 @@ struct CAddressUnspentValue {
     }
 };
 
+struct CAddressBalanceValue {
+    CAmount balance;
+    CAmount received;
+    CAmount sent;
+    uint64_t txCount;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(balance);
+        READWRITE(received);
+        READWRITE(sent);
+        READWRITE(txCount);
+    }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        balance = 0;
+        received = 0;
+        sent = 0;
+        txCount = 0;
+    }
+
+    bool IsNull() const {
+        return (txCount == 0 && received == 0 && sent == 0);
+    }
+};
+
 struct CAddressIndexKey {
     unsigned int type;
     uint160 hashBytes;
@@ -403,6 +403,48 @@ public:
 
 
 
+/** Minimal read-only stream over a memory range which is owned by someone else, e.g. a memory mapped file */
+class CMemoryReader
+{
+private:
+    const char* pos;
+    const char* end;
+    const int nType;
+    const int nVersion;
+
+public:
+    CMemoryReader(const char* begin, const char* endIn, int nTypeIn, int nVersionIn) :
+        pos(begin), end(endIn), nType(nTypeIn), nVersion(nVersionIn) {}
+
+    int GetType() const { return nType; }
+    int GetVersion() const { return nVersion; }
+    const char* GetPos() const { return pos; }
+
+    void read(char* pch, size_t nSize)
+    {
+        if (nSize > (size_t)(end - pos)) {
+            throw std::ios_base::failure("CMemoryReader::read(): end of data");
+        }
+        memcpy(pch, pos, nSize);
+        pos += nSize;
+    }
+
+    void ignore(size_t nSize)
+    {
+        if (nSize > (size_t)(end - pos)) {
+            throw std::ios_base::failure("CMemoryReader::ignore(): end of data");
+        }
+        pos += nSize;
+    }
+
+    template <typename T>
+    CMemoryReader& operator>>(T& obj)
+    {
+        ::Unserialize(*this, obj);
+        return *this;
+    }
+};
+
 /** Non-refcounted RAII wrapper for FILE*
  *
  * Will automatically close the file when it goes out of scope if not null.
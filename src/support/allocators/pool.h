@@ -0,0 +1,207 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_SUPPORT_ALLOCATORS_POOL_H
+#define XAZAB_SUPPORT_ALLOCATORS_POOL_H
+
+#include "memusage.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Memory resource for node based containers (e.g. std::unordered_map) which allocate lots of small objects of the
+ * same few sizes. Blocks of up to MAX_BLOCK_SIZE_BYTES are carved out of large chunks and freed blocks are kept in
+ * one free list per size, so nodes are allocated without malloc's per allocation overhead and end up close to each
+ * other in memory. Larger allocations (like the bucket array) are passed on to operator new.
+ *
+ * Memory of the chunks is only given back when the resource is destroyed. This is NOT thread safe.
+ */
+template <size_t MAX_BLOCK_SIZE_BYTES, size_t ALIGN_BYTES>
+class CPoolResource
+{
+    static_assert(ALIGN_BYTES > 0 && (ALIGN_BYTES & (ALIGN_BYTES - 1)) == 0, "ALIGN_BYTES must be a power of two");
+    static_assert(ALIGN_BYTES >= sizeof(void*) && ALIGN_BYTES >= alignof(void*), "free blocks must be able to hold a pointer");
+    static_assert(ALIGN_BYTES <= alignof(std::max_align_t), "chunks are only aligned to alignof(std::max_align_t)");
+
+public:
+    static const size_t DEFAULT_CHUNK_SIZE_BYTES = 256 * 1024;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // free list i holds blocks of i * ALIGN_BYTES bytes
+    static const size_t NUM_FREE_LISTS = (MAX_BLOCK_SIZE_BYTES + ALIGN_BYTES - 1) / ALIGN_BYTES + 1;
+
+    const size_t nChunkSize;
+    std::vector<char*> vChunks;
+    std::array<FreeBlock*, NUM_FREE_LISTS> freeLists{};
+    // the unused rest of the newest chunk
+    char* pChunkPos{nullptr};
+    char* pChunkEnd{nullptr};
+    size_t nFallbackUsage{0};
+
+    static size_t FreeListIndex(size_t bytes)
+    {
+        return std::max<size_t>(1, (bytes + ALIGN_BYTES - 1) / ALIGN_BYTES);
+    }
+
+    static bool IsPoolable(size_t bytes, size_t alignment)
+    {
+        return bytes <= MAX_BLOCK_SIZE_BYTES && alignment <= ALIGN_BYTES;
+    }
+
+    void PushFreeBlock(void* p, size_t nIndex)
+    {
+        freeLists[nIndex] = new (p) FreeBlock{freeLists[nIndex]};
+    }
+
+    void AllocateChunk()
+    {
+        // the rest of the current chunk is too small for the requested block, keep it for smaller ones
+        size_t nRest = pChunkEnd - pChunkPos;
+        if (nRest > 0) {
+            PushFreeBlock(pChunkPos, nRest / ALIGN_BYTES);
+        }
+        vChunks.reserve(vChunks.size() + 1);
+        pChunkPos = static_cast<char*>(::operator new(nChunkSize));
+        pChunkEnd = pChunkPos + nChunkSize;
+        vChunks.push_back(pChunkPos);
+    }
+
+public:
+    explicit CPoolResource(size_t nChunkSizeIn = DEFAULT_CHUNK_SIZE_BYTES) :
+        nChunkSize(std::max<size_t>(nChunkSizeIn / ALIGN_BYTES, NUM_FREE_LISTS) * ALIGN_BYTES)
+    {
+    }
+
+    ~CPoolResource()
+    {
+        for (char* chunk : vChunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    CPoolResource(const CPoolResource&) = delete;
+    CPoolResource& operator=(const CPoolResource&) = delete;
+
+    void* Allocate(size_t bytes, size_t alignment)
+    {
+        if (!IsPoolable(bytes, alignment)) {
+            nFallbackUsage += memusage::MallocUsage(bytes);
+            return ::operator new(bytes);
+        }
+        size_t nIndex = FreeListIndex(bytes);
+        if (freeLists[nIndex]) {
+            FreeBlock* block = freeLists[nIndex];
+            freeLists[nIndex] = block->next;
+            return block;
+        }
+        size_t nBlockSize = nIndex * ALIGN_BYTES;
+        if ((size_t)(pChunkEnd - pChunkPos) < nBlockSize) {
+            AllocateChunk();
+        }
+        void* p = pChunkPos;
+        pChunkPos += nBlockSize;
+        return p;
+    }
+
+    void Deallocate(void* p, size_t bytes, size_t alignment) noexcept
+    {
+        if (!IsPoolable(bytes, alignment)) {
+            nFallbackUsage -= memusage::MallocUsage(bytes);
+            ::operator delete(p);
+            return;
+        }
+        PushFreeBlock(p, FreeListIndex(bytes));
+    }
+
+    size_t GetChunkSize() const { return nChunkSize; }
+    size_t GetChunkCount() const { return vChunks.size(); }
+
+    /** Memory used by the chunks and by the allocations which were passed on to operator new */
+    size_t DynamicMemoryUsage() const
+    {
+        return memusage::MallocUsage(nChunkSize) * vChunks.size() + memusage::DynamicUsage(vChunks) + nFallbackUsage;
+    }
+};
+
+/**
+ * Allocator which allocates from a CPoolResource. Without a resource it behaves like std::allocator, so containers
+ * using it can still be default constructed and decide at runtime whether to use a pool.
+ */
+template <typename T, typename Resource>
+class CPoolAllocator
+{
+private:
+    Resource* resource;
+
+    template <typename U, typename R>
+    friend class CPoolAllocator;
+
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind {
+        typedef CPoolAllocator<U, Resource> other;
+    };
+
+    CPoolAllocator(Resource* resourceIn = nullptr) noexcept : resource(resourceIn) {}
+
+    template <typename U>
+    CPoolAllocator(const CPoolAllocator<U, Resource>& other) noexcept : resource(other.resource) {}
+
+    T* allocate(size_t n)
+    {
+        if (!resource) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(resource->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if (!resource) {
+            ::operator delete(p);
+            return;
+        }
+        resource->Deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    Resource* GetResource() const { return resource; }
+
+    template <typename U>
+    bool operator==(const CPoolAllocator<U, Resource>& other) const { return resource == other.resource; }
+    template <typename U>
+    bool operator!=(const CPoolAllocator<U, Resource>& other) const { return resource != other.resource; }
+};
+
+namespace memusage
+{
+
+template <typename X, typename Y, typename Z, typename E, typename R>
+static inline size_t DynamicUsage(const std::unordered_map<X, Y, Z, E, CPoolAllocator<std::pair<const X, Y>, R> >& m)
+{
+    const R* resource = m.get_allocator().GetResource();
+    if (resource) {
+        // nodes and buckets are all accounted for by the resource
+        return resource->DynamicMemoryUsage();
+    }
+    return MallocUsage(sizeof(unordered_node<std::pair<const X, Y> >)) * m.size() + MallocUsage(sizeof(void*) * m.bucket_count());
+}
+
+} // namespace memusage
+
+#endif // XAZAB_SUPPORT_ALLOCATORS_POOL_H
@@ -7,7 +7,10 @@
 #include "util.h"
 #include "utilstrencodings.h"
 
+#include <map>
+#include <mutex>
 #include <stdio.h>
+#include <tuple>
 
 #include <boost/thread.hpp>
 
@@ -18,6 +21,145 @@ void PrintLockContention(const char* pszName, const char* pszFile, int nLine)
 }
 #endif /* DEBUG_LOCKCONTENTION */
 
+std::atomic<void*> pHoldTimedLock{nullptr};
+
+static thread_local int nHoldTimedLockDepth = 0;
+static thread_local int64_t nHoldTimedLockStart = 0;
+static thread_local int64_t nHoldTimedLockTotal = 0;
+
+void SetHoldTimedLock(void* cs)
+{
+    // other threads might already be locking cs, a hold which started before this isn't timed
+    pHoldTimedLock = cs;
+}
+
+void HoldTimedLockEnter()
+{
+    if (nHoldTimedLockDepth++ == 0) {
+        nHoldTimedLockStart = GetTimeMicros();
+    }
+}
+
+void HoldTimedLockLeave()
+{
+    if (nHoldTimedLockDepth > 0 && --nHoldTimedLockDepth == 0) {
+        nHoldTimedLockTotal += GetTimeMicros() - nHoldTimedLockStart;
+    }
+}
+
+int64_t GetHoldTimedLockMicros()
+{
+    if (nHoldTimedLockDepth > 0) {
+        return nHoldTimedLockTotal + GetTimeMicros() - nHoldTimedLockStart;
+    }
+    return nHoldTimedLockTotal;
+}
+
+std::atomic<bool> fLockProfiling{false};
+static std::atomic<int> nLockProfilingSampleRate{DEFAULT_LOCK_PROFILING_SAMPLE_RATE};
+static thread_local unsigned int nLockProfilingCounter = 0;
+
+namespace {
+struct LockSiteKey {
+    // string literals, the same lock name and location can have multiple addresses (e.g. in headers)
+    const char* pszName;
+    const char* pszFile;
+    int nLine;
+    bool operator<(const LockSiteKey& other) const
+    {
+        return std::tie(pszFile, nLine, pszName) < std::tie(other.pszFile, other.nLine, other.pszName);
+    }
+};
+
+struct LockProfilerState {
+    std::mutex cs;
+    std::map<LockSiteKey, CLockSiteStats> mapSites;
+};
+} // namespace
+
+static LockProfilerState& GetLockProfilerState()
+{
+    // constructed on first use and never destroyed, locks are taken during static initialization and destruction
+    static LockProfilerState* state = new LockProfilerState();
+    return *state;
+}
+
+void SetLockProfiling(bool fEnable, int nSampleRate)
+{
+    LockProfilerState& state = GetLockProfilerState();
+    std::lock_guard<std::mutex> lock(state.cs);
+    if (fEnable) {
+        state.mapSites.clear();
+        nLockProfilingSampleRate = std::max(1, nSampleRate);
+    }
+    fLockProfiling = fEnable;
+}
+
+int GetLockProfilingSampleRate()
+{
+    return nLockProfilingSampleRate;
+}
+
+bool LockProfilingShouldSample()
+{
+    return ++nLockProfilingCounter % (unsigned int)nLockProfilingSampleRate.load(std::memory_order_relaxed) == 0;
+}
+
+void LockProfilingRecord(const CLockProfileSample& sample, int64_t nHoldMicros)
+{
+    LockProfilerState& state = GetLockProfilerState();
+    std::lock_guard<std::mutex> lock(state.cs);
+    if (!fLockProfiling) {
+        // disabled while the lock was held
+        return;
+    }
+    auto it = state.mapSites.emplace(LockSiteKey{sample.pszName, sample.pszFile, sample.nLine}, CLockSiteStats()).first;
+    CLockSiteStats& stats = it->second;
+    if (stats.nSamples == 0) {
+        stats.strName = sample.pszName;
+        stats.strFile = sample.pszFile;
+        stats.nLine = sample.nLine;
+    }
+    stats.nSamples++;
+    if (sample.fContended) {
+        stats.nContended++;
+    }
+    stats.nTotalWaitMicros += sample.nWaitMicros;
+    stats.nMaxWaitMicros = std::max(stats.nMaxWaitMicros, sample.nWaitMicros);
+    stats.nTotalHoldMicros += nHoldMicros;
+    stats.nMaxHoldMicros = std::max(stats.nMaxHoldMicros, nHoldMicros);
+}
+
+std::vector<CLockSiteStats> GetLockSiteStats()
+{
+    LockProfilerState& state = GetLockProfilerState();
+    std::lock_guard<std::mutex> lock(state.cs);
+
+    // merge the sites whose strings have different addresses
+    std::map<std::tuple<std::string, int, std::string>, CLockSiteStats> mapMerged;
+    for (const auto& p : state.mapSites) {
+        const CLockSiteStats& site = p.second;
+        auto it = mapMerged.emplace(std::make_tuple(site.strFile, site.nLine, site.strName), site);
+        if (it.second) {
+            continue;
+        }
+        CLockSiteStats& merged = it.first->second;
+        merged.nSamples += site.nSamples;
+        merged.nContended += site.nContended;
+        merged.nTotalWaitMicros += site.nTotalWaitMicros;
+        merged.nMaxWaitMicros = std::max(merged.nMaxWaitMicros, site.nMaxWaitMicros);
+        merged.nTotalHoldMicros += site.nTotalHoldMicros;
+        merged.nMaxHoldMicros = std::max(merged.nMaxHoldMicros, site.nMaxHoldMicros);
+    }
+
+    std::vector<CLockSiteStats> ret;
+    ret.reserve(mapMerged.size());
+    for (const auto& p : mapMerged) {
+        ret.emplace_back(p.second);
+    }
+    return ret;
+}
+
 #ifdef DEBUG_LOCKORDER
 //
 // Early deadlock detection.
@@ -7,6 +7,12 @@
 #define BITCOIN_SYNC_H
 
 #include "threadsafety.h"
+#include "utiltime.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
@@ -109,32 +115,121 @@ typedef boost::condition_variable CConditionVariable;
 void PrintLockContention(const char* pszName, const char* pszFile, int nLine);
 #endif
 
+/**
+ * Per-thread accounting of the time spent holding one designated lock (cs_main).
+ * Only the outermost acquisition of the (recursive) lock is timed.
+ */
+extern std::atomic<void*> pHoldTimedLock;
+void SetHoldTimedLock(void* cs);
+void HoldTimedLockEnter();
+void HoldTimedLockLeave();
+/** Total time the current thread has held the designated lock so far, including a currently open hold */
+int64_t GetHoldTimedLockMicros();
+
+/**
+ * Sampling lock profiler. While it is enabled, every nth acquisition of a lock by a thread is timed (how long it
+ * waited for the lock and how long it held it) and accounted to the lock's name and the source location which
+ * acquired it. While it is disabled, it costs one relaxed atomic load per acquisition.
+ */
+static const int DEFAULT_LOCK_PROFILING_SAMPLE_RATE = 16;
+
+extern std::atomic<bool> fLockProfiling;
+
+struct CLockProfileSample {
+    //! nullptr if the acquisition isn't sampled
+    const char* pszName{nullptr};
+    const char* pszFile{nullptr};
+    int nLine{0};
+    bool fContended{false};
+    int64_t nWaitMicros{0};
+    int64_t nLockedTime{0};
+};
+
+struct CLockSiteStats {
+    std::string strName;
+    std::string strFile;
+    int nLine;
+    uint64_t nSamples;
+    //! Sampled acquisitions which had to wait for the lock
+    uint64_t nContended;
+    int64_t nTotalWaitMicros;
+    int64_t nMaxWaitMicros;
+    int64_t nTotalHoldMicros;
+    int64_t nMaxHoldMicros;
+};
+
+/** Enables or disables the profiler, enabling it also clears the statistics */
+void SetLockProfiling(bool fEnable, int nSampleRate = DEFAULT_LOCK_PROFILING_SAMPLE_RATE);
+int GetLockProfilingSampleRate();
+/** Whether the current acquisition of the calling thread should be sampled */
+bool LockProfilingShouldSample();
+void LockProfilingRecord(const CLockProfileSample& sample, int64_t nHoldMicros);
+/** Statistics per lock name and source location */
+std::vector<CLockSiteStats> GetLockSiteStats();
+
 /** Wrapper around boost::unique_lock<Mutex> */
 template <typename Mutex>
 class SCOPED_LOCKABLE CMutexLock
 {
 private:
     boost::unique_lock<Mutex> lock;
+    CLockProfileSample sample;
 
-    void Enter(const char* pszName, const char* pszFile, int nLine)
+    void EnterSampled(const char* pszName, const char* pszFile, int nLine)
     {
-        EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()));
+        sample.pszName = pszName;
+        sample.pszFile = pszFile;
+        sample.nLine = nLine;
+        sample.fContended = !lock.try_lock();
+        if (sample.fContended) {
 #ifdef DEBUG_LOCKCONTENTION
-        if (!lock.try_lock()) {
             PrintLockContention(pszName, pszFile, nLine);
 #endif
+            int64_t nWaitStart = GetTimeMicros();
             lock.lock();
-#ifdef DEBUG_LOCKCONTENTION
+            sample.nLockedTime = GetTimeMicros();
+            sample.nWaitMicros = sample.nLockedTime - nWaitStart;
+        } else {
+            sample.nLockedTime = GetTimeMicros();
         }
+    }
+
+    void Enter(const char* pszName, const char* pszFile, int nLine)
+    {
+        EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()));
+        if (fLockProfiling.load(std::memory_order_relaxed) && LockProfilingShouldSample()) {
+            EnterSampled(pszName, pszFile, nLine);
+        } else {
+#ifdef DEBUG_LOCKCONTENTION
+            if (!lock.try_lock()) {
+                PrintLockContention(pszName, pszFile, nLine);
+#endif
+                lock.lock();
+#ifdef DEBUG_LOCKCONTENTION
+            }
 #endif
+        }
+        if ((void*)lock.mutex() == pHoldTimedLock.load(std::memory_order_relaxed))
+            HoldTimedLockEnter();
     }
 
     bool TryEnter(const char* pszName, const char* pszFile, int nLine)
     {
         EnterCritical(pszName, pszFile, nLine, (void*)(lock.mutex()), true);
         lock.try_lock();
-        if (!lock.owns_lock())
+        if (!lock.owns_lock()) {
             LeaveCritical();
+        } else {
+            if ((void*)lock.mutex() == pHoldTimedLock.load(std::memory_order_relaxed))
+                HoldTimedLockEnter();
+            if (fLockProfiling.load(std::memory_order_relaxed) && LockProfilingShouldSample()) {
+                // only the hold time is of interest, a failed try doesn't wait
+                sample.pszName = pszName;
+                sample.pszFile = pszFile;
+                sample.nLine = nLine;
+                sample.nLockedTime = GetTimeMicros();
+            }
+        }
         return lock.owns_lock();
     }
 
@@ -160,8 +255,17 @@ public:
 
     ~CMutexLock() UNLOCK_FUNCTION()
     {
-        if (lock.owns_lock())
+        if (lock.owns_lock()) {
+            if ((void*)lock.mutex() == pHoldTimedLock.load(std::memory_order_relaxed))
+                HoldTimedLockLeave();
+            if (sample.pszName) {
+                // record after unlocking, so the profiler's own work isn't accounted as hold time
+                int64_t nHoldMicros = GetTimeMicros() - sample.nLockedTime;
+                lock.unlock();
+                LockProfilingRecord(sample, nHoldMicros);
+            }
             LeaveCritical();
+        }
     }
 
     operator bool()
@@ -0,0 +1,112 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "addressindex.h"
+
+#include "test/test_xazab.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(addressindex_tests, BasicTestingSetup)
+
+static uint160 MakeAddressHash(unsigned char n)
+{
+    uint160 hash;
+    *hash.begin() = n;
+    return hash;
+}
+
+BOOST_AUTO_TEST_CASE(mempool_address_index)
+{
+    CMempoolAddressIndex index;
+    uint160 addr1 = MakeAddressHash(1), addr2 = MakeAddressHash(2);
+    uint256 tx1 = InsecureRand256(), tx2 = InsecureRand256(), tx3 = InsecureRand256();
+
+    // tx1 pays addr1 twice and addr2 once, tx2 spends from addr1, tx3 pays addr1 (as P2SH)
+    index.Add(CMempoolAddressDeltaKey(1, addr1, tx1, 0, 0), CMempoolAddressDelta(10, 100));
+    index.Add(CMempoolAddressDeltaKey(1, addr2, tx1, 1, 0), CMempoolAddressDelta(10, 200));
+    index.Add(CMempoolAddressDeltaKey(1, addr1, tx1, 2, 0), CMempoolAddressDelta(10, 300));
+    index.Add(CMempoolAddressDeltaKey(1, addr1, tx2, 0, 1), CMempoolAddressDelta(20, -100, tx1, 0));
+    index.Add(CMempoolAddressDeltaKey(2, addr1, tx3, 0, 0), CMempoolAddressDelta(30, 400));
+    BOOST_CHECK_EQUAL(index.Size(), 5);
+    BOOST_CHECK_EQUAL(index.AddressCount(), 3);
+
+    std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > results;
+    index.Get({{addr1, 1}}, results);
+    BOOST_CHECK_EQUAL(results.size(), 3);
+    // results are ordered like the keys of the old map based index
+    for (size_t i = 1; i < results.size(); i++) {
+        BOOST_CHECK(CMempoolAddressDeltaKeyCompare()(results[i - 1].first, results[i].first));
+    }
+
+    // removing tx1 moves entries of tx2 around, its back-references must still be valid
+    index.Remove(tx1);
+    BOOST_CHECK_EQUAL(index.Size(), 2);
+    BOOST_CHECK_EQUAL(index.AddressCount(), 2);
+    results.clear();
+    index.Get({{addr1, 1}, {addr2, 1}}, results);
+    BOOST_CHECK_EQUAL(results.size(), 1);
+    BOOST_CHECK(results[0].first.txhash == tx2);
+    BOOST_CHECK_EQUAL(results[0].first.spending, 1);
+    BOOST_CHECK_EQUAL(results[0].second.amount, -100);
+    BOOST_CHECK(results[0].second.prevhash == tx1);
+
+    index.Remove(tx2);
+    index.Remove(tx2);
+    results.clear();
+    index.Get({{addr1, 1}, {addr1, 2}}, results);
+    BOOST_CHECK_EQUAL(results.size(), 1);
+    BOOST_CHECK_EQUAL(results[0].first.type, 2);
+    BOOST_CHECK_EQUAL(results[0].second.amount, 400);
+
+    index.Clear();
+    BOOST_CHECK_EQUAL(index.Size(), 0);
+    BOOST_CHECK_EQUAL(index.AddressCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(mempool_address_index_random)
+{
+    // Remove transactions in random order and compare with a brute force count
+    CMempoolAddressIndex index;
+    std::vector<uint160> addrs;
+    for (int i = 0; i < 5; i++) {
+        addrs.emplace_back(MakeAddressHash(i + 1));
+    }
+    std::map<uint256, std::vector<CMempoolAddressDeltaKey> > mapTxKeys;
+    for (int i = 0; i < 200; i++) {
+        uint256 txhash = InsecureRand256();
+        int nOutputs = 1 + InsecureRandRange(4);
+        for (int j = 0; j < nOutputs; j++) {
+            CMempoolAddressDeltaKey key(1, addrs[InsecureRandRange(addrs.size())], txhash, j, 0);
+            index.Add(key, CMempoolAddressDelta(i, j));
+            mapTxKeys[txhash].push_back(key);
+        }
+    }
+
+    while (!mapTxKeys.empty()) {
+        auto it = mapTxKeys.begin();
+        std::advance(it, InsecureRandRange(mapTxKeys.size()));
+        index.Remove(it->first);
+        mapTxKeys.erase(it);
+
+        for (const auto& addr : addrs) {
+            size_t nExpected = 0;
+            for (const auto& p : mapTxKeys) {
+                for (const auto& key : p.second) {
+                    nExpected += key.addressBytes == addr;
+                }
+            }
+            std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > results;
+            index.Get({{addr, 1}}, results);
+            BOOST_CHECK_EQUAL(results.size(), nExpected);
+            for (const auto& r : results) {
+                BOOST_CHECK(mapTxKeys.count(r.first.txhash));
+            }
+        }
+    }
+    BOOST_CHECK_EQUAL(index.Size(), 0);
+    BOOST_CHECK_EQUAL(index.AddressCount(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
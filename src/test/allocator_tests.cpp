@@ -4,6 +4,7 @@
 
 #include "util.h"
 
+#include "support/allocators/pool.h"
 #include "support/allocators/secure.h"
 #include "test/test_xazab.h"
 
@@ -231,4 +232,70 @@ BOOST_AUTO_TEST_CASE(lockedpool_tests_live)
     BOOST_CHECK(pool.stats().used == initial.used);
 }
 
+BOOST_AUTO_TEST_CASE(pool_resource_tests)
+{
+    typedef CPoolResource<64, 8> Resource;
+    Resource resource(1024);
+    BOOST_CHECK_EQUAL(resource.GetChunkSize(), 1024);
+    BOOST_CHECK_EQUAL(resource.DynamicMemoryUsage(), 0);
+
+    // blocks of the same size class are handed out back to back and reused after being freed
+    void* a = resource.Allocate(20, 8);
+    void* b = resource.Allocate(24, 8);
+    BOOST_CHECK_EQUAL((char*)b - (char*)a, 24);
+    BOOST_CHECK_EQUAL(resource.GetChunkCount(), 1);
+    resource.Deallocate(a, 20, 8);
+    BOOST_CHECK(resource.Allocate(17, 8) == a);
+
+    // fill the chunk, the next one is only allocated once it is full
+    std::vector<void*> blocks;
+    for (int i = 0; i < 1024 / 64; i++) {
+        blocks.push_back(resource.Allocate(64, 8));
+    }
+    BOOST_CHECK_EQUAL(resource.GetChunkCount(), 2);
+    // the 16 bytes which were left of the first chunk end up in the free list of their size
+    void* rest = resource.Allocate(16, 8);
+    BOOST_CHECK((char*)rest >= (char*)a && (char*)rest < (char*)a + 1024);
+    size_t nChunksUsage = resource.DynamicMemoryUsage();
+
+    // larger blocks and stricter alignments are passed on to operator new
+    void* large = resource.Allocate(65, 8);
+    void* aligned = resource.Allocate(16, 16);
+    BOOST_CHECK_EQUAL(resource.GetChunkCount(), 2);
+    BOOST_CHECK(resource.DynamicMemoryUsage() >= nChunksUsage + 65 + 16);
+    resource.Deallocate(large, 65, 8);
+    resource.Deallocate(aligned, 16, 16);
+    BOOST_CHECK_EQUAL(resource.DynamicMemoryUsage(), nChunksUsage);
+}
+
+BOOST_AUTO_TEST_CASE(pool_allocator_tests)
+{
+    typedef CPoolResource<sizeof(std::pair<const int, uint64_t>) + sizeof(void*) * 4, alignof(void*)> Resource;
+    typedef std::unordered_map<int, uint64_t, std::hash<int>, std::equal_to<int>, CPoolAllocator<std::pair<const int, uint64_t>, Resource> > Map;
+
+    // without a resource the map behaves like one with the standard allocator
+    Map mapStd;
+    BOOST_CHECK(mapStd.get_allocator().GetResource() == nullptr);
+
+    Resource resource;
+    Map mapPool(0, std::hash<int>(), std::equal_to<int>(), Map::allocator_type(&resource));
+    for (Map* map : {&mapStd, &mapPool}) {
+        for (int i = 0; i < 10000; i++) {
+            (*map)[i] = i * 3;
+        }
+        for (int i = 0; i < 10000; i += 2) {
+            map->erase(i);
+        }
+        for (int i = 0; i < 10000; i += 4) {
+            (*map)[i] = i;
+        }
+    }
+    BOOST_CHECK(mapStd == mapPool);
+    BOOST_CHECK_EQUAL(mapPool.size(), 7500);
+    BOOST_CHECK(resource.GetChunkCount() > 0);
+    // nodes and buckets are accounted for by the resource
+    BOOST_CHECK_EQUAL(memusage::DynamicUsage(mapPool), resource.DynamicMemoryUsage());
+    BOOST_CHECK(memusage::DynamicUsage(mapPool) >= mapPool.size() * sizeof(std::pair<const int, uint64_t>));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 #include "consensus/merkle.h"
 #include "chainparams.h"
 #include "random.h"
+#include "recenttxpool.h"
 
 #include "test/test_xazab.h"
 
@@ -270,6 +271,49 @@ BOOST_AUTO_TEST_CASE(SufficientPreforwardRTTest)
     BOOST_CHECK_EQUAL(pool.mapTx.find(txhash)->GetSharedTx().use_count(), SHARED_TX_OFFSET + 0);
 }
 
+BOOST_AUTO_TEST_CASE(RecentTxPoolRoundTripTest)
+{
+    CTxMemPool pool;
+    CRecentTxPool recentPool;
+    TestMemPoolEntryHelper entry;
+    CBlock block(BuildBlockTestCase());
+
+    // vtx[1] is in the mempool, vtx[2] only got seen recently (e.g. it was evicted from the mempool)
+    pool.addUnchecked(block.vtx[1]->GetHash(), entry.FromTx(*block.vtx[1]));
+    recentPool.AddTransaction(block.vtx[2], CRecentTxPool::SOURCE_MEMPOOL_EVICTION);
+    BOOST_CHECK_EQUAL(recentPool.Size(), 1);
+
+    // adding the same tx twice must not duplicate it
+    recentPool.AddTransaction(block.vtx[2], CRecentTxPool::SOURCE_INSTANTSEND);
+    BOOST_CHECK_EQUAL(recentPool.Size(), 1);
+
+    CBlockHeaderAndShortTxIDs shortIDs(block);
+    {
+        // without the recent pool we need a round-trip
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_OK);
+        BOOST_CHECK(!partialBlock.IsTxAvailable(2));
+    }
+    {
+        PartiallyDownloadedBlock partialBlock(&pool, &recentPool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs, extra_txn) == READ_STATUS_OK);
+        BOOST_CHECK(partialBlock.IsTxAvailable(0));
+        BOOST_CHECK(partialBlock.IsTxAvailable(1));
+        BOOST_CHECK(partialBlock.IsTxAvailable(2));
+        BOOST_CHECK_EQUAL(partialBlock.GetRecentTxCount(), 1);
+
+        CBlock block2;
+        BOOST_CHECK(partialBlock.FillBlock(block2, {}) == READ_STATUS_OK);
+        BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+    }
+
+    // a zero limit evicts everything
+    recentPool.SetMaxUsage(0);
+    BOOST_CHECK_EQUAL(recentPool.Size(), 0);
+    recentPool.AddTransaction(block.vtx[2], CRecentTxPool::SOURCE_PRIVATESEND);
+    BOOST_CHECK_EQUAL(recentPool.Size(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
 {
     CTxMemPool pool;
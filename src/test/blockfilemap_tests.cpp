@@ -0,0 +1,67 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "blockfilemap.h"
+
+#include "core_memusage.h"
+#include "primitives/block.h"
+#include "test/test_xazab.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockfilemap_tests, BasicTestingSetup)
+
+static std::shared_ptr<const CBlock> CreateBlock(uint32_t nNonce)
+{
+    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
+    pblock->nNonce = nNonce;
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].scriptSig = CScript() << nNonce << OP_0;
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 50 * COIN;
+    pblock->vtx.emplace_back(MakeTransactionRef(tx));
+    return pblock;
+}
+
+BOOST_AUTO_TEST_CASE(blockreadcache_lru)
+{
+    std::vector<std::shared_ptr<const CBlock> > blocks;
+    for (uint32_t i = 0; i < 4; i++) {
+        blocks.emplace_back(CreateBlock(i));
+    }
+    // room for three of the blocks
+    size_t nBlockUsage = RecursiveDynamicUsage(*blocks[0]) + sizeof(CBlock);
+    CBlockReadCache cache(nBlockUsage * 3 + nBlockUsage / 2);
+
+    cache.Add(blocks[0]);
+    cache.Add(blocks[1]);
+    cache.Add(blocks[2]);
+    BOOST_CHECK(cache.Get(blocks[0]->GetHash()) == blocks[0]);
+
+    // blocks[1] is the least recently used one now
+    cache.Add(blocks[3]);
+    BOOST_CHECK(cache.Get(blocks[0]->GetHash()) == blocks[0]);
+    BOOST_CHECK(cache.Get(blocks[1]->GetHash()) == nullptr);
+    BOOST_CHECK(cache.Get(blocks[2]->GetHash()) == blocks[2]);
+    BOOST_CHECK(cache.Get(blocks[3]->GetHash()) == blocks[3]);
+
+    // adding a block twice doesn't account it twice
+    cache.Add(blocks[3]);
+    cache.Add(blocks[1]);
+    BOOST_CHECK(cache.Get(blocks[0]->GetHash()) == nullptr);
+    BOOST_CHECK(cache.Get(blocks[2]->GetHash()) == blocks[2]);
+    BOOST_CHECK(cache.Get(blocks[3]->GetHash()) == blocks[3]);
+    BOOST_CHECK(cache.Get(blocks[1]->GetHash()) == blocks[1]);
+
+    // blocks which are larger than the whole cache are not kept
+    CBlockReadCache small(nBlockUsage / 2);
+    small.Add(blocks[0]);
+    BOOST_CHECK(small.Get(blocks[0]->GetHash()) == nullptr);
+
+    cache.Clear();
+    BOOST_CHECK(cache.Get(blocks[1]->GetHash()) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
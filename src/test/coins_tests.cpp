@@ -8,6 +8,7 @@
 #include "undo.h"
 #include "utilstrencodings.h"
 #include "test/test_xazab.h"
+#include "txdb.h"
 #include "validation.h"
 #include "consensus/validation.h"
 
@@ -108,7 +109,7 @@ static const unsigned int NUM_SIMULATION_ITERATIONS = 40000;
 //
 // During the process, booleans are kept to make sure that the randomized
 // operation hits all branches.
-BOOST_AUTO_TEST_CASE(coins_cache_simulation_test)
+static void CoinsCacheSimulationTest()
 {
     // Various coverage trackers.
     bool removed_all_caches = false;
@@ -255,6 +256,19 @@ BOOST_AUTO_TEST_CASE(coins_cache_simulation_test)
     BOOST_CHECK(uncached_an_entry);
 }
 
+BOOST_AUTO_TEST_CASE(coins_cache_simulation_test)
+{
+    CoinsCacheSimulationTest();
+}
+
+BOOST_AUTO_TEST_CASE(coins_cache_pool_simulation_test)
+{
+    // same with the cache entries allocated from pools
+    fCoinsCachePool = true;
+    CoinsCacheSimulationTest();
+    fCoinsCachePool = DEFAULT_COINS_CACHE_POOL;
+}
+
 // Store of all necessary tx and undo data for next test
 typedef std::map<COutPoint, std::tuple<CTransaction,CTxUndo,Coin>> UtxoData;
 UtxoData utxoData;
@@ -656,6 +670,40 @@ BOOST_AUTO_TEST_CASE(ccoins_access)
     CheckAccessCoin(VALUE1, VALUE2, VALUE2, DIRTY|FRESH, DIRTY|FRESH);
 }
 
+void CheckAddFetchedCoin(CAmount base_value, CAmount cache_value, char cache_flags)
+{
+    // adding a coin which was read from the base ahead of time must leave the cache exactly as AccessCoin does
+    SingleEntryCacheTest testAccess(base_value, cache_value, cache_flags);
+    testAccess.cache.AccessCoin(OUTPOINT);
+    testAccess.cache.SelfTest();
+
+    SingleEntryCacheTest testFetched(base_value, cache_value, cache_flags);
+    Coin coin;
+    if (testFetched.base.GetCoin(OUTPOINT, coin)) {
+        testFetched.cache.AddFetchedCoin(OUTPOINT, std::move(coin));
+    }
+    testFetched.cache.SelfTest();
+
+    CAmount access_value, fetched_value;
+    char access_flags, fetched_flags;
+    GetCoinsMapEntry(testAccess.cache.map(), access_value, access_flags);
+    GetCoinsMapEntry(testFetched.cache.map(), fetched_value, fetched_flags);
+    BOOST_CHECK_EQUAL(fetched_value, access_value);
+    BOOST_CHECK_EQUAL(fetched_flags, access_flags);
+}
+
+BOOST_AUTO_TEST_CASE(ccoins_add_fetched)
+{
+    for (CAmount base_value : {ABSENT, PRUNED, VALUE1}) {
+        CheckAddFetchedCoin(base_value, ABSENT, NO_ENTRY);
+        for (CAmount cache_value : {PRUNED, VALUE2}) {
+            for (char cache_flags : FLAGS) {
+                CheckAddFetchedCoin(base_value, cache_value, cache_flags);
+            }
+        }
+    }
+}
+
 void CheckSpendCoins(CAmount base_value, CAmount cache_value, CAmount expected_value, char cache_flags, char expected_flags)
 {
     SingleEntryCacheTest test(base_value, cache_value, cache_flags);
@@ -855,4 +903,52 @@ BOOST_AUTO_TEST_CASE(ccoins_write)
                     CheckWriteCoins(parent_value, child_value, parent_value, parent_flags, child_flags, parent_flags);
 }
 
+BOOST_AUTO_TEST_CASE(coins_background_flush)
+{
+    CCoinsViewDB db(1 << 20, true);
+    CCoinsViewBackgroundFlush flusher(&db, true);
+    CCoinsViewCacheTest cache(&flusher);
+
+    std::vector<COutPoint> outpoints;
+    for (int i = 0; i < 1000; i++) {
+        outpoints.emplace_back(InsecureRand256(), InsecureRandBits(2));
+        Coin coin;
+        coin.out.nValue = i + 1;
+        coin.out.scriptPubKey.assign(InsecureRandBits(6), 0);
+        coin.nHeight = 1;
+        cache.AddCoin(outpoints.back(), std::move(coin), false);
+    }
+    uint256 hash1 = InsecureRand256();
+    cache.SetBestBlock(hash1);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0);
+
+    // the coins can be looked up while they are written, and the cache can be modified meanwhile
+    Coin coin;
+    for (size_t i = 0; i < outpoints.size(); i++) {
+        BOOST_CHECK(flusher.GetCoin(outpoints[i], coin));
+        BOOST_CHECK_EQUAL(coin.out.nValue, (CAmount)i + 1);
+        if (i % 2) {
+            BOOST_CHECK(cache.SpendCoin(outpoints[i]));
+        }
+    }
+    BOOST_CHECK(flusher.GetBestBlock() == hash1);
+
+    // the next flush waits for the first one
+    uint256 hash2 = InsecureRand256();
+    cache.SetBestBlock(hash2);
+    BOOST_CHECK(cache.Flush());
+    for (size_t i = 0; i < outpoints.size(); i++) {
+        BOOST_CHECK_EQUAL(flusher.HaveCoin(outpoints[i]), i % 2 == 0);
+    }
+
+    BOOST_CHECK(flusher.WaitForWrite());
+    BOOST_CHECK_EQUAL(flusher.DynamicMemoryUsage(), 0);
+    BOOST_CHECK(db.GetBestBlock() == hash2);
+    BOOST_CHECK(db.GetHeadBlocks().empty());
+    for (size_t i = 0; i < outpoints.size(); i++) {
+        BOOST_CHECK_EQUAL(db.GetCoin(outpoints[i], coin), i % 2 == 0);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -319,4 +319,89 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
 
 
 
+BOOST_AUTO_TEST_CASE(dbwrapper_tuning)
+{
+    CDBTuning tuning;
+    std::string strError;
+    BOOST_CHECK(GetDBTuning("test", tuning, strError));
+    BOOST_CHECK_EQUAL(tuning.nBlockSize, CDBTuning().nBlockSize);
+
+    gArgs.ForceSetMultiArgs("-dbtuning", {"test:profile=scan", "test:bloombits=0", "other:blocksize=8192"});
+    BOOST_CHECK(GetDBTuning("test", tuning, strError));
+    BOOST_CHECK_EQUAL(tuning.nBlockSize, 64 * 1024U);
+    BOOST_CHECK_EQUAL(tuning.nBloomBits, 0);
+    BOOST_CHECK(tuning.fCompression);
+    BOOST_CHECK(GetDBTuning("other", tuning, strError));
+    BOOST_CHECK_EQUAL(tuning.nBlockSize, 8192U);
+    BOOST_CHECK_EQUAL(tuning.nBloomBits, CDBTuning().nBloomBits);
+    // unnamed databases always use the defaults
+    BOOST_CHECK(GetDBTuning("", tuning, strError));
+    BOOST_CHECK_EQUAL(tuning.nBlockSize, CDBTuning().nBlockSize);
+
+    BOOST_CHECK(CheckDBTuningArgs({"test", "other"}, strError));
+    BOOST_CHECK(!CheckDBTuningArgs({"test"}, strError));
+
+    for (const std::string& strArg : {"test", "test:blocksize", "test:blocksize=abc", "test:blocksize=1", "test:compression=2",
+                                      "test:profile=none", "test:unknown=1", ":blocksize=8192"}) {
+        gArgs.ForceSetMultiArgs("-dbtuning", {strArg});
+        BOOST_CHECK_MESSAGE(!CheckDBTuningArgs({"test"}, strError), strArg);
+    }
+
+    // a database picks up its tuning when it is opened
+    gArgs.ForceSetMultiArgs("-dbtuning", {"test:blocksize=16384", "test:writebuffer=65536"});
+    {
+        fs::path ph = fs::temp_directory_path() / fs::unique_path();
+        CDBWrapper dbw(ph, (1 << 20), true, false, false, "test");
+        CDBStats stats = dbw.GetStats();
+        BOOST_CHECK_EQUAL(stats.strName, "test");
+        BOOST_CHECK_EQUAL(stats.tuning.nBlockSize, 16384U);
+        BOOST_CHECK_EQUAL(stats.nWriteBufferSize, 65536U);
+    }
+    gArgs.ForceRemoveArg("-dbtuning");
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_stats)
+{
+    fs::path ph = fs::temp_directory_path() / fs::unique_path();
+    CDBWrapper dbw(ph, (1 << 20), true, false, false, "stats");
+
+    auto findStats = [&]() {
+        for (const CDBStats& stats : GetDBStats()) {
+            if (stats.strName == "stats") {
+                return stats;
+            }
+        }
+        BOOST_ERROR("database not found");
+        return CDBStats();
+    };
+
+    CDBStats stats = findStats();
+    BOOST_CHECK_EQUAL(stats.nCacheSize, 1U << 20);
+    BOOST_CHECK(stats.fMemory);
+    BOOST_CHECK(stats.vLevels.empty());
+    BOOST_CHECK_EQUAL(stats.nReadAmplification, 0);
+    BOOST_CHECK_EQUAL(stats.nMemtableFlushes, 0U);
+
+    // several times the 256 KiB write buffer, and overwrite the keys so that the tables overlap and get compacted
+    for (int n = 0; n < 2; n++) {
+        for (int i = 0; i < 5000; i++) {
+            BOOST_CHECK(dbw.Write(i, InsecureRand256()));
+            BOOST_CHECK(dbw.Write(std::make_pair(i, 'x'), std::vector<unsigned char>(100, (unsigned char)i)));
+        }
+    }
+    dbw.CompactFull();
+
+    stats = findStats();
+    BOOST_CHECK(stats.nMemtableFlushes > 0);
+    BOOST_CHECK(stats.nCompactions > 0);
+    BOOST_CHECK(!stats.vLevels.empty());
+    BOOST_CHECK(stats.nReadAmplification > 0);
+    BOOST_CHECK(stats.nMemoryUsage > 0);
+    int nFiles = 0;
+    for (const auto& level : stats.vLevels) {
+        nFiles += level.nFiles;
+    }
+    BOOST_CHECK(nFiles > 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -421,6 +421,27 @@ BOOST_FIXTURE_TEST_CASE(dip3_protx, TestChainDIP3Setup)
     nHeight++;
 
     tx = CreateProUpServTx(utxos, dmnHashes[0], newOperatorKey, 100, CScript(), coinbaseKey);
+    // the signature checks are deferred when collected, a ProUpServTx signed by the old operator key must fail them
+    auto txOldKey = CreateProUpServTx(utxos, dmnHashes[0], operatorKeys[dmnHashes[0]], 101, CScript(), coinbaseKey);
+    std::vector<CSpecialTxSigCheck> vChecks;
+    BOOST_ASSERT(CheckSpecialTx(tx, chainActive.Tip(), dummyState, &vChecks));
+    BOOST_ASSERT(CheckSpecialTx(txOldKey, chainActive.Tip(), dummyState, &vChecks));
+    BOOST_ASSERT(vChecks.size() == 2);
+    BOOST_ASSERT(vChecks[0]());
+    BOOST_ASSERT(!vChecks[1]());
+    BOOST_ASSERT(!CheckSpecialTx(txOldKey, chainActive.Tip(), dummyState));
+    auto blockOldKey = std::make_shared<CBlock>(CreateBlock({txOldKey}, coinbaseKey));
+    ProcessNewBlock(Params(), blockOldKey, true, nullptr);
+    BOOST_ASSERT(chainActive.Height() == nHeight);
+    // the same must happen when the checks are run inline, i.e. without script check threads
+    auto txOldKey2 = CreateProUpServTx(utxos, dmnHashes[0], operatorKeys[dmnHashes[0]], 102, CScript(), coinbaseKey);
+    auto blockOldKey2 = std::make_shared<CBlock>(CreateBlock({txOldKey2}, coinbaseKey));
+    int nScriptCheckThreadsBackup = nScriptCheckThreads;
+    nScriptCheckThreads = 0;
+    ProcessNewBlock(Params(), blockOldKey2, true, nullptr);
+    nScriptCheckThreads = nScriptCheckThreadsBackup;
+    BOOST_ASSERT(chainActive.Height() == nHeight);
+    // now process the valid one
     CreateAndProcessBlock({tx}, coinbaseKey);
     deterministicMNManager->UpdatedBlockTip(chainActive.Tip());
     BOOST_ASSERT(chainActive.Height() == nHeight + 1);
@@ -0,0 +1,124 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "test/test_xazab.h"
+
+#include "evo/evodb.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(evo_evodb_tests, BasicTestingSetup)
+
+static CDataStream MakeKey(int i)
+{
+    CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+    ssKey << std::make_pair('k', i);
+    return ssKey;
+}
+
+BOOST_AUTO_TEST_CASE(evodb_committed_view)
+{
+    CDBWrapper db("", 1 << 20, true, true);
+    for (int i : {1, 2, 3}) {
+        db.Write(std::make_pair('k', i), i);
+    }
+
+    // older commit: overwrite 1, erase 2, add 4 and 5
+    // newer commit: erase 4, overwrite 5 again, add 6 and re-add 2
+    auto commit1 = std::make_shared<CEvoDBCommit>();
+    commit1->Write(MakeKey(1), 10);
+    commit1->Erase(MakeKey(2));
+    commit1->Write(MakeKey(4), 40);
+    commit1->Write(MakeKey(5), 50);
+    auto commit2 = std::make_shared<CEvoDBCommit>();
+    commit2->Erase(MakeKey(4));
+    commit2->Write(MakeKey(5), 55);
+    commit2->Write(MakeKey(6), 60);
+    BOOST_CHECK(commit1->GetMemoryUsage() > 0);
+
+    CEvoDBCommittedView view(db);
+    view.SetPending(std::make_shared<const CEvoDBCommittedView::CommitList>(CEvoDBCommittedView::CommitList{commit1, commit2}));
+
+    std::map<int, int> expected = {{1, 10}, {3, 3}, {5, 55}, {6, 60}};
+    for (int i = 0; i < 8; i++) {
+        int value;
+        BOOST_CHECK_EQUAL(view.Read(std::make_pair('k', i), value), expected.count(i) != 0);
+        BOOST_CHECK_EQUAL(view.Exists(std::make_pair('k', i)), expected.count(i) != 0);
+        if (expected.count(i)) {
+            BOOST_CHECK_EQUAL(value, expected[i]);
+        }
+    }
+
+    std::unique_ptr<CEvoDBCommittedIterator> it(view.NewIterator());
+    std::map<int, int> found;
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        std::pair<char, int> key;
+        int value;
+        BOOST_CHECK(it->GetKey(key));
+        BOOST_CHECK(it->GetValue(value));
+        BOOST_CHECK(found.emplace(key.second, value).second);
+    }
+    BOOST_CHECK(found == expected);
+
+    it->Seek(MakeKey(4));
+    std::pair<char, int> key;
+    BOOST_CHECK(it->GetKey(key) && key.second == 5);
+
+    // the iterator keeps its snapshot
+    view.SetPending(std::make_shared<const CEvoDBCommittedView::CommitList>());
+    it->Seek(MakeKey(2));
+    BOOST_CHECK(it->GetKey(key) && key.second == 3);
+    int value;
+    BOOST_CHECK(view.Read(std::make_pair('k', 2), value) && value == 2);
+}
+
+BOOST_AUTO_TEST_CASE(evodb_commit)
+{
+    for (bool fAsyncCommit : {false, true}) {
+        CEvoDB evoDb(1 << 20, true, true, fAsyncCommit);
+        int value;
+
+        for (int n = 0; n < 10; n++) {
+            auto dbTx = evoDb.BeginTransaction();
+            for (int i = 0; i < 100; i++) {
+                evoDb.Write(std::make_pair(n, i), n * 1000 + i);
+            }
+            if (n > 0) {
+                evoDb.Erase(std::make_pair(n - 1, 0));
+            }
+            dbTx->Commit();
+
+            // only visible in the root transaction until it is committed
+            BOOST_CHECK(evoDb.Read(std::make_pair(n, 1), value) && value == n * 1000 + 1);
+            BOOST_CHECK(!evoDb.ReadCommitted(std::make_pair(n, 1), value));
+
+            BOOST_CHECK(evoDb.CommitRootTransaction());
+            BOOST_CHECK(evoDb.ReadCommitted(std::make_pair(n, 1), value) && value == n * 1000 + 1);
+            BOOST_CHECK(evoDb.Exists(std::make_pair(n, 1)));
+            if (n > 0) {
+                BOOST_CHECK(!evoDb.Exists(std::make_pair(n - 1, 0)));
+                BOOST_CHECK(!evoDb.ExistsCommitted(std::make_pair(n - 1, 0)));
+            }
+        }
+
+        // uncommitted changes are iterated on top of the committed ones
+        evoDb.Write(std::make_pair(10, 0), 10000);
+        auto it = evoDb.GetCurTransaction().NewIteratorUniquePtr();
+        int nCount = 0;
+        for (it->SeekToFirst(); it->Valid(); it->Next()) {
+            nCount++;
+        }
+        BOOST_CHECK_EQUAL(nCount, 10 * 100 - 9 + 1);
+        evoDb.Erase(std::make_pair(10, 0));
+        BOOST_CHECK(evoDb.CommitRootTransaction());
+
+        BOOST_CHECK(evoDb.WaitForCommits());
+        BOOST_CHECK_EQUAL(evoDb.GetMemoryUsage(), 0U);
+        BOOST_CHECK(evoDb.GetRawDB().Read(std::make_pair(9, 99), value) && value == 9099);
+        BOOST_CHECK(!evoDb.GetRawDB().Exists(std::make_pair(8, 0)));
+        BOOST_CHECK(!evoDb.GetRawDB().Exists(std::make_pair(10, 0)));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,162 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "executor.h"
+
+#include "test/test_xazab.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(executor_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(executor_futures)
+{
+    CExecutor executor;
+    executor.Start(4);
+    CTaskGroup group(executor, "test", 4);
+
+    // Boost.Test isn't thread safe, the results are checked by the main thread
+    std::vector<std::future<std::pair<int, int> > > futures;
+    for (int i = 0; i < 1000; i++) {
+        futures.emplace_back(group.Push([](int nWorker, int x) {
+            return std::make_pair(nWorker, x * 2);
+        }, i));
+    }
+    for (int i = 0; i < 1000; i++) {
+        auto result = futures[i].get();
+        BOOST_CHECK(result.first >= 0 && result.first < 4);
+        BOOST_CHECK_EQUAL(result.second, i * 2);
+    }
+
+    // exceptions end up in the future
+    auto future = group.Push([](int nWorker) -> int { throw std::runtime_error("failed"); });
+    BOOST_CHECK_THROW(future.get(), std::runtime_error);
+
+    // tasks which are pushed by a task go to the worker's own queue
+    std::atomic<int> nDone{0};
+    std::vector<std::future<void> > innerFutures(100);
+    group.Push([&](int nWorker) {
+        for (auto& f : innerFutures) {
+            f = group.Push([&](int) { nDone++; });
+        }
+    }).get();
+    for (auto& f : innerFutures) {
+        f.get();
+    }
+    BOOST_CHECK_EQUAL(nDone, 100);
+
+    // the futures are ready before the bookkeeping after the task is done, stopping waits for it
+    group.Stop();
+    CTaskGroupStats stats = group.GetStats();
+    BOOST_CHECK_EQUAL(stats.nSubmitted, 1102U);
+    BOOST_CHECK_EQUAL(stats.nCompleted, 1102U);
+    BOOST_CHECK_EQUAL(stats.nQueued, 0U);
+    BOOST_CHECK_EQUAL(stats.nRunning, 0U);
+    executor.Stop();
+    BOOST_CHECK(!executor.IsRunning());
+    BOOST_CHECK_EQUAL(executor.GetExecutedCount(), 1102U);
+
+    // without running executor, tasks are run by the caller
+    CTaskGroup group2(executor, "test2", 1);
+    BOOST_CHECK_EQUAL(group2.Push([](int nWorker) { return nWorker; }).get(), -1);
+}
+
+BOOST_AUTO_TEST_CASE(executor_concurrency)
+{
+    CExecutor executor;
+    executor.Start(8);
+    CTaskGroup group(executor, "capped", 2);
+
+    std::mutex cs;
+    int nRunning = 0;
+    int nMaxRunning = 0;
+    std::vector<int> vOrder;
+    std::vector<std::future<void> > futures;
+    for (int i = 0; i < 200; i++) {
+        futures.emplace_back(group.Push([&, i](int) {
+            {
+                std::lock_guard<std::mutex> lock(cs);
+                nMaxRunning = std::max(nMaxRunning, ++nRunning);
+                vOrder.emplace_back(i);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            std::lock_guard<std::mutex> lock(cs);
+            nRunning--;
+        }));
+    }
+    for (auto& f : futures) {
+        f.get();
+    }
+    BOOST_CHECK(nMaxRunning >= 1 && nMaxRunning <= 2);
+    // with a cap of 2, a task can't start before all tasks pushed 2 or more before it started
+    for (size_t i = 0; i < vOrder.size(); i++) {
+        BOOST_CHECK(std::abs(vOrder[i] - (int)i) <= 1);
+    }
+
+    // the group is listed with its stats
+    auto vStats = executor.GetGroupStats();
+    BOOST_CHECK_EQUAL(vStats.size(), 1U);
+    BOOST_CHECK_EQUAL(vStats[0].strName, "capped");
+    BOOST_CHECK_EQUAL(vStats[0].nMaxConcurrency, 2);
+    BOOST_CHECK_EQUAL(vStats[0].nSubmitted, 200U);
+
+    // tasks in the backlog are dropped when stopping. Wait until the slots of the tasks above are free.
+    while (group.GetStats().nRunning != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::promise<void> blocker;
+    std::shared_future<void> blocked = blocker.get_future().share();
+    auto f1 = group.Push([blocked](int) { blocked.wait(); });
+    auto f2 = group.Push([blocked](int) { blocked.wait(); });
+    auto f3 = group.Push([](int) {});
+    std::thread stopper([&] { group.Stop(); });
+    while (group.GetStats().nQueued != 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    blocker.set_value();
+    stopper.join();
+    f1.get();
+    f2.get();
+    BOOST_CHECK_THROW(f3.get(), std::future_error);
+    CTaskGroupStats stats = group.GetStats();
+    BOOST_CHECK_EQUAL(stats.nSubmitted, 203U);
+    BOOST_CHECK_EQUAL(stats.nCompleted, 202U);
+    BOOST_CHECK(stats.nMaxRunMicros >= 100);
+    // and afterwards
+    BOOST_CHECK_THROW(group.Push([](int) {}).get(), std::future_error);
+}
+
+BOOST_AUTO_TEST_CASE(executor_priorities)
+{
+    CExecutor executor;
+    executor.Start(1);
+    CTaskGroup low(executor, "low", 100, TASK_PRIORITY_LOW);
+    CTaskGroup high(executor, "high", 100, TASK_PRIORITY_HIGH);
+
+    // keep the only worker busy until all tasks are queued
+    std::promise<void> blocker;
+    std::shared_future<void> blocked = blocker.get_future().share();
+    auto fBlock = low.Push([blocked](int) { blocked.wait(); });
+    while (low.GetStats().nRunning == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::mutex cs;
+    std::vector<std::string> vOrder;
+    std::vector<std::future<void> > futures;
+    for (int i = 0; i < 10; i++) {
+        futures.emplace_back(low.Push([&](int) { std::lock_guard<std::mutex> lock(cs); vOrder.emplace_back("low"); }));
+        futures.emplace_back(high.Push([&](int) { std::lock_guard<std::mutex> lock(cs); vOrder.emplace_back("high"); }));
+    }
+    blocker.set_value();
+    for (auto& f : futures) {
+        f.get();
+    }
+    BOOST_CHECK_EQUAL(vOrder.size(), 20U);
+    for (size_t i = 0; i < vOrder.size(); i++) {
+        BOOST_CHECK_EQUAL(vOrder[i], i < 10 ? "high" : "low");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
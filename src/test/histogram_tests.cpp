@@ -0,0 +1,60 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "histogram.h"
+
+#include "test/test_xazab.h"
+
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(histogram_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(histogram_basics)
+{
+    CLatencyHistogram h;
+    BOOST_CHECK_EQUAL(h.GetCount(), 0);
+    BOOST_CHECK_EQUAL(h.GetPercentileMicros(50), 0);
+
+    for (int i = 1; i <= 100; i++) {
+        h.Add(i);
+    }
+    BOOST_CHECK_EQUAL(h.GetCount(), 100);
+    BOOST_CHECK_EQUAL(h.GetTotalMicros(), 5050);
+    BOOST_CHECK_EQUAL(h.GetAverageMicros(), 50);
+    BOOST_CHECK_EQUAL(h.GetMaxMicros(), 100);
+    BOOST_CHECK_EQUAL(h.GetLastMicros(), 100);
+
+    // percentiles are reported as the upper bound of the matching bucket, capped by the max
+    BOOST_CHECK_EQUAL(h.GetPercentileMicros(50), 64);
+    BOOST_CHECK_EQUAL(h.GetPercentileMicros(99), 100);
+    BOOST_CHECK_EQUAL(h.GetPercentileMicros(1), 2);
+
+    // negative samples are clamped, huge samples land in the last bucket
+    h.Add(-5);
+    h.Add(std::numeric_limits<int64_t>::max() / 2);
+    BOOST_CHECK_EQUAL(h.GetCount(), 102);
+    BOOST_CHECK_EQUAL(h.GetPercentileMicros(100), std::numeric_limits<int64_t>::max() / 2);
+}
+
+BOOST_AUTO_TEST_CASE(histogram_merge)
+{
+    CLatencyHistogram a, b;
+    a.Add(10);
+    a.Add(20);
+    b.Add(1000);
+
+    a.Merge(b);
+    BOOST_CHECK_EQUAL(a.GetCount(), 3);
+    BOOST_CHECK_EQUAL(a.GetTotalMicros(), 1030);
+    BOOST_CHECK_EQUAL(a.GetMaxMicros(), 1000);
+    BOOST_CHECK_EQUAL(a.GetLastMicros(), 1000);
+
+    a.Clear();
+    BOOST_CHECK_EQUAL(a.GetCount(), 0);
+    BOOST_CHECK_EQUAL(a.GetMaxMicros(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,132 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "jsonwriter.h"
+
+#include "core_io.h"
+#include "key.h"
+#include "primitives/transaction.h"
+#include "script/standard.h"
+#include "test/test_xazab.h"
+
+#include <univalue.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(jsonwriter_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(jsonwriter_univalue)
+{
+    // the writer must produce exactly what UniValue::write() produces
+    std::string strEscapes = "quote\" backslash\\ \b\f\n\r\t \x01\x1f\x7f end";
+
+    UniValue inner(UniValue::VARR);
+    inner.push_back(strEscapes);
+    inner.push_back(UniValue(UniValue::VOBJ));
+    inner.push_back(UniValue(UniValue::VARR));
+    inner.push_back(NullUniValue);
+    UniValue uv(UniValue::VOBJ);
+    uv.pushKV("int", -42);
+    uv.pushKV("int64", (int64_t)-9000000000000000000LL);
+    uv.pushKV("uint64", (uint64_t)18000000000000000000ULL);
+    uv.pushKV("bool", UniValue(true));
+    uv.pushKV("double", 1234.56789);
+    uv.pushKV("amount", ValueFromAmount(-123456789));
+    uv.pushKV("esc\"key", inner);
+
+    CJSONWriter w;
+    w.BeginObject();
+    w.pushKV("int", -42);
+    w.pushKV("int64", (int64_t)-9000000000000000000LL);
+    w.pushKV("uint64", (uint64_t)18000000000000000000ULL);
+    w.pushKV("bool", true);
+    w.pushKV("double", 1234.56789);
+    w.Key("amount").ValueAmount(-123456789);
+    w.Key("esc\"key").BeginArray();
+    w.Value(strEscapes);
+    w.BeginObject().EndObject();
+    w.BeginArray().EndArray();
+    w.Null();
+    w.EndArray();
+    w.EndObject();
+
+    BOOST_CHECK_EQUAL(w.str(), uv.write());
+
+    // a UniValue can be embedded as is
+    CJSONWriter w2;
+    w2.BeginArray().Value(uv).Value(uv).EndArray();
+    BOOST_CHECK_EQUAL(w2.str(), "[" + uv.write() + "," + uv.write() + "]");
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_sink)
+{
+    std::string strOut;
+    size_t nFlushes = 0;
+    CJSONWriter w([&](const char* data, size_t len) {
+        strOut.append(data, len);
+        nFlushes++;
+    }, 100);
+
+    UniValue uv(UniValue::VARR);
+    w.BeginArray();
+    for (int i = 0; i < 1000; i++) {
+        uv.push_back(strprintf("element %d", i));
+        w.Value(strprintf("element %d", i));
+    }
+    w.EndArray();
+    BOOST_CHECK(nFlushes > 10);
+    BOOST_CHECK(w.str().size() < 100);
+    w.Flush();
+    BOOST_CHECK(w.str().empty());
+    BOOST_CHECK_EQUAL(strOut, uv.write());
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_tx)
+{
+    CKey key;
+    key.MakeNewKey(true);
+
+    CMutableTransaction mtx;
+    mtx.vin.resize(2);
+    mtx.vin[0].prevout = COutPoint(InsecureRand256(), 1);
+    mtx.vin[0].scriptSig = CScript() << std::vector<unsigned char>(71, 0x30) << ToByteVector(key.GetPubKey());
+    mtx.vin[1].prevout = COutPoint(InsecureRand256(), 0);
+    mtx.vout.resize(3);
+    mtx.vout[0].nValue = 12345678;
+    mtx.vout[0].scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+    mtx.vout[1].nValue = 1;
+    mtx.vout[1].scriptPubKey = GetScriptForRawPubKey(key.GetPubKey());
+    mtx.vout[2].nValue = 0;
+    mtx.vout[2].scriptPubKey = CScript() << OP_RETURN << std::vector<unsigned char>(10, 0x01);
+    mtx.nLockTime = 1234;
+    CTransaction tx(mtx);
+    uint256 hashBlock = InsecureRand256();
+
+    UniValue uv(UniValue::VOBJ);
+    TxToUniv(tx, hashBlock, uv);
+    CJSONWriter w;
+    w.BeginObject();
+    TxToJSON(tx, hashBlock, w);
+    w.EndObject();
+    BOOST_CHECK_EQUAL(w.str(), uv.write());
+
+    // coinbase
+    CMutableTransaction mcb;
+    mcb.vin.resize(1);
+    mcb.vin[0].scriptSig = CScript() << 100 << OP_0;
+    mcb.vout.resize(1);
+    mcb.vout[0].nValue = 50 * COIN;
+    mcb.vout[0].scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+    CTransaction cb(mcb);
+
+    UniValue uvcb(UniValue::VOBJ);
+    TxToUniv(cb, uint256(), uvcb);
+    CJSONWriter wcb;
+    wcb.BeginObject();
+    TxToJSON(cb, uint256(), wcb);
+    wcb.EndObject();
+    BOOST_CHECK_EQUAL(wcb.str(), uvcb.write());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -115,6 +115,66 @@ void CheckSort(CTxMemPool &pool, std::vector<std::string> &sortedOrder)
     }
 }
 
+BOOST_AUTO_TEST_CASE(MempoolReadIndexTest)
+{
+    TestMemPoolEntryHelper entry;
+    CTxMemPool pool;
+
+    CMutableTransaction tx1;
+    tx1.vin.resize(1);
+    tx1.vin[0].prevout = COutPoint(InsecureRand256(), 0);
+    tx1.vin[0].scriptSig = CScript() << OP_11;
+    tx1.vout.resize(1);
+    tx1.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    tx1.vout[0].nValue = 10 * COIN;
+
+    CMutableTransaction tx2;
+    tx2.vin.resize(1);
+    tx2.vin[0].prevout = COutPoint(tx1.GetHash(), 0);
+    tx2.vin[0].scriptSig = CScript() << OP_11;
+    tx2.vout.resize(1);
+    tx2.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+    tx2.vout[0].nValue = 9 * COIN;
+
+    pool.addUnchecked(tx1.GetHash(), entry.Fee(1000).Time(10).FromTx(tx1));
+    pool.addUnchecked(tx2.GetHash(), entry.Fee(2000).Time(20).FromTx(tx2));
+
+    BOOST_CHECK(pool.exists(tx1.GetHash()));
+    BOOST_CHECK(pool.get(tx2.GetHash())->GetHash() == tx2.GetHash());
+    BOOST_CHECK_EQUAL(pool.info(tx2.GetHash()).nTime, 20);
+
+    uint256 spenderHash;
+    BOOST_CHECK(pool.GetSpender(tx1.vin[0].prevout, spenderHash) && spenderHash == tx1.GetHash());
+    BOOST_CHECK(pool.GetSpender(tx2.vin[0].prevout, spenderHash) && spenderHash == tx2.GetHash());
+    BOOST_CHECK(!pool.GetSpender(COutPoint(tx2.GetHash(), 0), spenderHash));
+
+    std::vector<uint256> vtxidSorted, vtxidUnsorted;
+    pool.queryHashes(vtxidSorted);
+    pool.queryHashesUnsorted(vtxidUnsorted);
+    std::sort(vtxidSorted.begin(), vtxidSorted.end());
+    std::sort(vtxidUnsorted.begin(), vtxidUnsorted.end());
+    BOOST_CHECK(vtxidSorted == vtxidUnsorted);
+    BOOST_CHECK_EQUAL(pool.infoAllUnsorted().size(), 2);
+
+    // fee deltas are reflected without having to look at mapTx
+    pool.PrioritiseTransaction(tx1.GetHash(), 500);
+    BOOST_CHECK_EQUAL(pool.info(tx1.GetHash()).nFeeDelta, 500);
+
+    // removing a parent removes the child as well
+    pool.removeRecursive(tx1);
+    BOOST_CHECK(!pool.exists(tx1.GetHash()));
+    BOOST_CHECK(!pool.exists(tx2.GetHash()));
+    BOOST_CHECK(pool.get(tx2.GetHash()) == nullptr);
+    BOOST_CHECK(!pool.GetSpender(tx1.vin[0].prevout, spenderHash));
+    pool.queryHashesUnsorted(vtxidUnsorted);
+    BOOST_CHECK(vtxidUnsorted.empty());
+
+    pool.addUnchecked(tx1.GetHash(), entry.FromTx(tx1));
+    pool.clear();
+    BOOST_CHECK(!pool.exists(tx1.GetHash()));
+    BOOST_CHECK(pool.infoAllUnsorted().empty());
+}
+
 BOOST_AUTO_TEST_CASE(MempoolIndexingTest)
 {
     CTxMemPool pool;
@@ -7,6 +7,7 @@
 
 #include "base58.h"
 #include "core_io.h"
+#include "httprpc.h"
 #include "netbase.h"
 
 #include "test/test_xazab.h"
@@ -345,4 +346,18 @@ BOOST_AUTO_TEST_CASE(rpc_convert_values_generatetoaddress)
 }
 #endif // ENABLE_MINER
 
+BOOST_AUTO_TEST_CASE(rpc_peek_method)
+{
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("{\"method\": \"getblockcount\", \"params\": [], \"id\": 1}"), "getblockcount");
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("{\"id\":1,\"params\":[\"method\",{\"method\":\"stop\"}],\"method\" : \"echo\"}"), "echo");
+    // string values which look like the key
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("{\"id\":\"method\",\"method\":\"help\"}"), "help");
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("{\"params\":[\"a\\\"method\\\":\\\"stop\"],\"method\":\"help\"}"), "help");
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("[{\"method\":\"getblockcount\"},{\"method\":\"help\"}]"), "batch");
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("{\"params\":[],\"id\":1}"), "");
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("{\"method\":1}"), "");
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod("{\"method\":\"getbl"), "");
+    BOOST_CHECK_EQUAL(JSONRPCPeekMethod(""), "");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,8 @@
 
 #include "test/test_xazab.h"
 
+#include <atomic>
+
 #include <boost/bind.hpp>
 #include <boost/thread.hpp>
 #include <boost/test/unit_test.hpp>
@@ -112,4 +114,154 @@ BOOST_AUTO_TEST_CASE(manythreads)
     BOOST_CHECK_EQUAL(counterSum, 200);
 }
 
+BOOST_AUTO_TEST_CASE(wheel_order_and_stats)
+{
+    // Tasks due in the next 300 ms (spread over several regions of the wheel's second level)
+    // must run in the order they are due, never before they are due, and show up in the
+    // statistics of their name.
+    CScheduler scheduler;
+    FastRandomContext rng(42);
+
+    std::vector<std::pair<std::chrono::steady_clock::time_point, std::chrono::steady_clock::time_point> > vRuns;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (int i = 0; i < 200; i++) {
+        std::chrono::steady_clock::time_point due = now + std::chrono::microseconds(rng.randrange(300000));
+        scheduler.schedule([&vRuns, due]() { vRuns.emplace_back(due, std::chrono::steady_clock::now()); },
+                           due, i % 2 ? "odd" : "even");
+    }
+    // an overdue task runs right away
+    scheduler.schedule([]() {}, now - std::chrono::milliseconds(10), "overdue");
+
+    boost::chrono::system_clock::time_point first, last;
+    BOOST_CHECK_EQUAL(scheduler.getQueueInfo(first, last), 201U);
+    BOOST_CHECK_EQUAL(scheduler.getQueueSize(), 201U);
+    BOOST_CHECK(first < last);
+
+    boost::thread serviceThread(boost::bind(&CScheduler::serviceQueue, &scheduler));
+    scheduler.stop(true);
+    serviceThread.join();
+
+    BOOST_CHECK_EQUAL(scheduler.getQueueInfo(first, last), 0U);
+    BOOST_REQUIRE_EQUAL(vRuns.size(), 200U);
+    for (size_t i = 0; i < vRuns.size(); i++) {
+        BOOST_CHECK(vRuns[i].second >= vRuns[i].first);
+        // tasks of the same tick (1 ms) might run in any order
+        if (i > 0) {
+            BOOST_CHECK(vRuns[i - 1].first <= vRuns[i].first + std::chrono::milliseconds(1));
+        }
+    }
+
+    auto vStats = scheduler.getTaskStats();
+    BOOST_REQUIRE_EQUAL(vStats.size(), 3U);
+    std::sort(vStats.begin(), vStats.end(), [](const CSchedulerTaskStats& a, const CSchedulerTaskStats& b) { return a.strName < b.strName; });
+    BOOST_CHECK_EQUAL(vStats[0].strName, "even");
+    BOOST_CHECK_EQUAL(vStats[0].nRuns, 100U);
+    BOOST_CHECK_EQUAL(vStats[1].strName, "odd");
+    BOOST_CHECK_EQUAL(vStats[1].nRuns, 100U);
+    BOOST_CHECK_EQUAL(vStats[2].strName, "overdue");
+    BOOST_CHECK_EQUAL(vStats[2].nRuns, 1U);
+    BOOST_CHECK(vStats[2].nMaxLateMicros >= 10000);
+    for (const auto& stats : vStats) {
+        BOOST_CHECK(stats.nTotalLateMicros >= 0);
+        BOOST_CHECK(stats.nMaxRunMicros <= stats.nTotalRunMicros);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(serial_tasks)
+{
+    // Serial tasks never overlap, even with several threads, but tasks scheduled
+    // with fSerial=false run in parallel to them.
+    CScheduler scheduler;
+    std::atomic<int> nRunning{0};
+    std::atomic<int> nMaxRunning{0};
+    std::atomic<bool> fParallelRan{false};
+    bool fBlockingSawParallel = false;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    // holds the serial slot until the parallel task ran
+    scheduler.schedule([&]() {
+        for (int i = 0; i < 1000 && !fParallelRan; i++) {
+            MicroSleep(1000);
+        }
+        fBlockingSawParallel = fParallelRan;
+    }, now, "blocking");
+    scheduler.schedule([&]() { fParallelRan = true; }, now + std::chrono::milliseconds(5), "parallel", false);
+    for (int i = 0; i < 20; i++) {
+        scheduler.schedule([&]() {
+            int n = ++nRunning;
+            nMaxRunning = std::max(nMaxRunning.load(), n);
+            MicroSleep(1000);
+            nRunning--;
+        }, now, "serial");
+    }
+
+    boost::thread_group threads;
+    for (int i = 0; i < 4; i++) {
+        threads.create_thread(boost::bind(&CScheduler::serviceQueue, &scheduler));
+    }
+    scheduler.stop(true);
+    threads.join_all();
+
+    BOOST_CHECK_EQUAL(nMaxRunning, 1);
+    BOOST_CHECK(fBlockingSawParallel);
+    BOOST_CHECK_EQUAL(scheduler.getQueueSize(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(wheel_levels_and_overflow)
+{
+    // Tasks on every level of the wheel and beyond it, which only become due by mocking the
+    // scheduler's clock forward. They must cascade down to the lowest level and run once they
+    // are due, but not before.
+    CScheduler scheduler;
+    const std::vector<std::chrono::seconds> vDelays = {
+        std::chrono::seconds(2),         // level 1
+        std::chrono::seconds(100),       // level 2
+        std::chrono::hours(1),           // level 3
+        std::chrono::hours(10),          // overflow list
+        std::chrono::hours(30),          // overflow list, stays there when it is redistributed
+    };
+
+    boost::mutex mutex;
+    std::vector<std::chrono::steady_clock::time_point> vRunTimes(vDelays.size());
+    std::atomic<int> nRuns{0};
+    std::chrono::steady_clock::time_point start = scheduler.Now();
+    for (size_t i = 0; i < vDelays.size(); i++) {
+        scheduler.schedule([&, i]() {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            vRunTimes[i] = scheduler.Now();
+            nRuns++;
+        }, start + vDelays[i], "mocked");
+    }
+    BOOST_CHECK_EQUAL(scheduler.getQueueSize(), vDelays.size());
+
+    boost::thread serviceThread(boost::bind(&CScheduler::serviceQueue, &scheduler));
+    auto waitForRuns = [&](int n) {
+        for (int i = 0; i < 5000 && nRuns < n; i++) {
+            MicroSleep(1000);
+        }
+        // give the service thread a chance to (wrongly) run more
+        MicroSleep(10000);
+        return nRuns.load();
+    };
+
+    std::chrono::steady_clock::duration mocked(0);
+    for (size_t i = 0; i < vDelays.size(); i++) {
+        // just before the task is due nothing happens, one second later it ran
+        scheduler.MockForward(vDelays[i] - std::chrono::seconds(1) - mocked);
+        BOOST_CHECK_EQUAL(waitForRuns(i), (int)i);
+        scheduler.MockForward(std::chrono::seconds(1));
+        BOOST_CHECK_EQUAL(waitForRuns(i + 1), (int)i + 1);
+        mocked = vDelays[i];
+    }
+
+    // don't drain, a task which is stuck in the wheel must fail the checks instead of hanging
+    scheduler.stop();
+    serviceThread.join();
+
+    BOOST_CHECK_EQUAL(scheduler.getQueueSize(), 0U);
+    for (size_t i = 0; i < vDelays.size(); i++) {
+        BOOST_CHECK(vRunTimes[i] >= start + vDelays[i]);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
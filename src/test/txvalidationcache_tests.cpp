@@ -296,4 +296,95 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, TestChain100Setup)
     // TODO: add tests for remaining script flags
 }
 
+BOOST_FIXTURE_TEST_CASE(tx_mempool_batch, TestChain100Setup)
+{
+    CScript scriptPubKey = CScript() <<  ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    auto sign = [&](CMutableTransaction& tx) {
+        for (unsigned int i = 0; i < tx.vin.size(); i++) {
+            std::vector<unsigned char> vchSig;
+            uint256 hash = SignatureHash(scriptPubKey, tx, i, SIGHASH_ALL, 0, SIGVERSION_BASE);
+            BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+            vchSig.push_back((unsigned char)SIGHASH_ALL);
+            tx.vin[i].scriptSig = CScript() << vchSig;
+        }
+    };
+    auto spend = [&](const CMutableTransaction& txFrom, uint32_t n, CAmount nValue) {
+        CMutableTransaction tx;
+        tx.nVersion = 1;
+        tx.vin.resize(1);
+        tx.vin[0].prevout = COutPoint(txFrom.GetHash(), n);
+        tx.vout.resize(1);
+        tx.vout[0].nValue = nValue;
+        tx.vout[0].scriptPubKey = scriptPubKey;
+        sign(tx);
+        return tx;
+    };
+
+    // parent with a few outputs, the batch below spends them
+    CMutableTransaction parent = spend(coinbaseTxns[0], 0, 11*CENT);
+    CTxOut txout = parent.vout[0];
+    parent.vout.resize(3, txout);
+    sign(parent);
+    BOOST_CHECK(ToMemPool(parent));
+
+    std::vector<CMutableTransaction> txs;
+    txs.emplace_back(spend(parent, 0, 10*CENT));
+    txs.emplace_back(spend(parent, 1, 10*CENT));
+    // invalid signature
+    txs.emplace_back(spend(parent, 2, 10*CENT));
+    txs.back().vout[0].nValue = 9*CENT;
+    // double spend of a previous batch tx
+    txs.emplace_back(spend(parent, 1, 9*CENT));
+    // spends a previous batch tx, so it's missing inputs when the batch is prevalidated
+    txs.emplace_back(spend(txs[0], 0, 9*CENT));
+
+    std::vector<CTransactionRef> vtx;
+    for (const auto& tx : txs) {
+        vtx.emplace_back(MakeTransactionRef(tx));
+    }
+
+    // the double spend conflicts with txs[1] and isn't verified
+    BOOST_CHECK_EQUAL(PrevalidateTransactionScripts(mempool, vtx), 3);
+
+    std::vector<CValidationState> vState;
+    std::vector<bool> vAccepted;
+    BOOST_CHECK_EQUAL(AcceptToMemoryPoolBatch(mempool, vtx, false, vState, vAccepted), 3);
+    BOOST_CHECK_EQUAL(vState.size(), vtx.size());
+    BOOST_CHECK(vAccepted[0] && vAccepted[1] && vAccepted[4]);
+    BOOST_CHECK(!vAccepted[2] && !vAccepted[3]);
+    BOOST_CHECK(vState[2].GetRejectReason().find("mandatory-script-verify-flag-failed") == 0);
+    BOOST_CHECK_EQUAL(vState[3].GetRejectReason(), "txn-mempool-conflict");
+    BOOST_CHECK(mempool.exists(txs[4].GetHash()));
+
+    // neither are transactions which conflict with the mempool
+    std::vector<CTransactionRef> vtxConflict{MakeTransactionRef(spend(parent, 0, 9*CENT))};
+    BOOST_CHECK_EQUAL(PrevalidateTransactionScripts(mempool, vtxConflict), 0);
+
+    // coins which had to be read from disk are uncached again, unless the caller wants to keep them for AcceptToMemoryPool
+    COutPoint confirmedOutpoint(coinbaseTxns[1].GetHash(), 0);
+    std::vector<CTransactionRef> vtxConfirmed{MakeTransactionRef(spend(coinbaseTxns[1], 0, 11*CENT))};
+    {
+        LOCK(cs_main);
+        pcoinsTip->Flush();
+        pcoinsTip->Uncache(confirmedOutpoint);
+        BOOST_CHECK(!pcoinsTip->HaveCoinInCache(confirmedOutpoint));
+    }
+    std::vector<std::vector<COutPoint> > vCoinsToUncache;
+    BOOST_CHECK_EQUAL(PrevalidateTransactionScripts(mempool, vtxConfirmed, &vCoinsToUncache), 1);
+    BOOST_REQUIRE_EQUAL(vCoinsToUncache.size(), 1);
+    BOOST_CHECK(vCoinsToUncache[0] == std::vector<COutPoint>{confirmedOutpoint});
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(pcoinsTip->HaveCoinInCache(confirmedOutpoint));
+        pcoinsTip->Uncache(confirmedOutpoint);
+    }
+    BOOST_CHECK_EQUAL(PrevalidateTransactionScripts(mempool, vtxConfirmed), 1);
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(!pcoinsTip->HaveCoinInCache(confirmedOutpoint));
+    }
+    mempool.clear();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -9,10 +9,12 @@
 #include "coins.h"
 #include "dbwrapper.h"
 #include "chain.h"
-#include "spentindex.h"
 
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -26,6 +28,8 @@ static constexpr int MAX_BLOCK_COINSDB_USAGE = 10;
 static const int64_t nDefaultDbCache = 300;
 //! -dbbatchsize default (bytes)
 static const int64_t nDefaultDbBatchSize = 16 << 20;
+//! -backgroundflush default
+static const bool DEFAULT_BACKGROUND_FLUSH = false;
 //! max. -dbcache (MiB)
 static const int64_t nMaxDbCache = sizeof(void*) > 4 ? 16384 : 1024;
 //! min. -dbcache (MiB)
@@ -80,9 +84,60 @@ public:
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
 
+    //! Like BatchWrite, but leaves mapCoins untouched, so it can be read by other threads while it is written
+    bool WriteCoins(CCoinsMap &mapCoins, const uint256 &hashBlock);
+
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
     size_t EstimateSize() const override;
+
+private:
+    bool WriteCoinsBatched(CCoinsMap &mapCoins, const uint256 &hashBlock, bool fErase);
+};
+
+/**
+ * Sits between pcoinsTip and the coin database and, if enabled, writes the flushes of pcoinsTip to the database
+ * on a background thread, so cs_main isn't held for the duration of the write. The dirty coins of a flush are
+ * moved out of pcoinsTip into mapWriting, which serves lookups until all of them are written. They are written
+ * in batches of -dbbatchsize, with the database marked as being in transition by DB_HEAD_BLOCKS in the meantime,
+ * so an interrupted background write is completed by ReplayBlocks like an interrupted synchronous one.
+ */
+class CCoinsViewBackgroundFlush : public CCoinsViewBacked
+{
+private:
+    CCoinsViewDB* db;
+
+    mutable std::mutex cs;
+    std::condition_variable cond;
+    // only modified by BatchWrite while fBusy is false, and cleared by the thread after it was written
+    CCoinsMap mapWriting;
+    size_t nWritingUsage{0};
+    uint256 hashWriting;
+    // lookups have to consult mapWriting, i.e. its coins aren't all written yet
+    bool fWriting{false};
+    // the thread owns mapWriting
+    bool fBusy{false};
+    bool fFailed{false};
+    bool fStop{false};
+    std::thread thread;
+
+    void ThreadWrite();
+
+public:
+    CCoinsViewBackgroundFlush(CCoinsViewDB* dbIn, bool fBackground);
+    ~CCoinsViewBackgroundFlush();
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    uint256 GetBestBlock() const override;
+    //! Hands the dirty coins over to the background thread, after waiting for the previous write to finish
+    bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
+
+    //! Waits until the coins of the last BatchWrite are written, returns false if writing them failed
+    bool WaitForWrite();
+    bool HasFailed() const;
+    //! Memory used by the coins which are still being written
+    size_t DynamicMemoryUsage() const;
 };
 
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
@@ -124,18 +179,6 @@ public:
     bool HasTxIndex(const uint256 &txid);
     bool ReadTxIndex(const uint256 &txid, CDiskTxPos &pos);
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &list);
-    bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
-    bool UpdateSpentIndex(const std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> >&vect);
-    bool UpdateAddressUnspentIndex(const std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue > >&vect);
-    bool ReadAddressUnspentIndex(uint160 addressHash, int type,
-                                 std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &vect);
-    bool WriteAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool EraseAddressIndex(const std::vector<std::pair<CAddressIndexKey, CAmount> > &vect);
-    bool ReadAddressIndex(uint160 addressHash, int type,
-                          std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
-                          int start = 0, int end = 0);
-    bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
-    bool ReadTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &vect);
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
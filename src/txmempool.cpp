@@ -364,6 +364,10 @@ void CTxMemPool::AddTransactionsUpdated(unsigned int n)
     nTransactionsUpdated += n;
 }
 
+static TxMempoolInfo GetInfo(CTxMemPool::indexed_transaction_set::const_iterator it) {
+    return TxMempoolInfo{it->GetSharedTx(), it->GetTime(), CFeeRate(it->GetFee(), it->GetTxSize()), it->GetModifiedFee() - it->GetFee()};
+}
+
 bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry, setEntries &setAncestors, bool validFeeEstimate)
 {
     NotifyEntryAdded(entry.GetSharedTx());
@@ -420,6 +424,8 @@ bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry,
     vTxHashes.emplace_back(hash, newit);
     newit->vTxHashesIdx = vTxHashes.size() - 1;
 
+    readIndex.Add(GetInfo(newit));
+
     // Invalid ProTxes should never get this far because transactions should be
     // fully checked by AcceptToMemoryPool() at this point, so we just assume that
     // everything is fine here.
@@ -474,7 +480,6 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
 {
     LOCK(cs);
     const CTransaction& tx = entry.GetTx();
-    std::vector<CMempoolAddressDeltaKey> inserted;
 
     uint256 txhash = tx.GetHash();
     for (unsigned int j = 0; j < tx.vin.size(); j++) {
@@ -485,20 +490,17 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
             std::vector<unsigned char> hashBytes(prevout.scriptPubKey.begin()+2, prevout.scriptPubKey.begin()+22);
             CMempoolAddressDeltaKey key(2, uint160(hashBytes), txhash, j, 1);
             CMempoolAddressDelta delta(entry.GetTime(), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-            mapAddress.insert(std::make_pair(key, delta));
-            inserted.push_back(key);
+            addressIndex.Add(key, delta);
         } else if (prevout.scriptPubKey.IsPayToPublicKeyHash()) {
             std::vector<unsigned char> hashBytes(prevout.scriptPubKey.begin()+3, prevout.scriptPubKey.begin()+23);
             CMempoolAddressDeltaKey key(1, uint160(hashBytes), txhash, j, 1);
             CMempoolAddressDelta delta(entry.GetTime(), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-            mapAddress.insert(std::make_pair(key, delta));
-            inserted.push_back(key);
+            addressIndex.Add(key, delta);
         } else if (prevout.scriptPubKey.IsPayToPublicKey()) {
             uint160 hashBytes(Hash160(prevout.scriptPubKey.begin()+1, prevout.scriptPubKey.end()-1));
             CMempoolAddressDeltaKey key(1, hashBytes, txhash, j, 1);
             CMempoolAddressDelta delta(entry.GetTime(), prevout.nValue * -1, input.prevout.hash, input.prevout.n);
-            mapAddress.insert(std::make_pair(key, delta));
-            inserted.push_back(key);
+            addressIndex.Add(key, delta);
         }
     }
 
@@ -507,53 +509,31 @@ void CTxMemPool::addAddressIndex(const CTxMemPoolEntry &entry, const CCoinsViewC
         if (out.scriptPubKey.IsPayToScriptHash()) {
             std::vector<unsigned char> hashBytes(out.scriptPubKey.begin()+2, out.scriptPubKey.begin()+22);
             CMempoolAddressDeltaKey key(2, uint160(hashBytes), txhash, k, 0);
-            mapAddress.insert(std::make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
-            inserted.push_back(key);
+            addressIndex.Add(key, CMempoolAddressDelta(entry.GetTime(), out.nValue));
         } else if (out.scriptPubKey.IsPayToPublicKeyHash()) {
             std::vector<unsigned char> hashBytes(out.scriptPubKey.begin()+3, out.scriptPubKey.begin()+23);
-            std::pair<addressDeltaMap::iterator,bool> ret;
             CMempoolAddressDeltaKey key(1, uint160(hashBytes), txhash, k, 0);
-            mapAddress.insert(std::make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
-            inserted.push_back(key);
+            addressIndex.Add(key, CMempoolAddressDelta(entry.GetTime(), out.nValue));
         } else if (out.scriptPubKey.IsPayToPublicKey()) {
             uint160 hashBytes(Hash160(out.scriptPubKey.begin()+1, out.scriptPubKey.end()-1));
-            std::pair<addressDeltaMap::iterator,bool> ret;
             CMempoolAddressDeltaKey key(1, hashBytes, txhash, k, 0);
-            mapAddress.insert(std::make_pair(key, CMempoolAddressDelta(entry.GetTime(), out.nValue)));
-            inserted.push_back(key);
+            addressIndex.Add(key, CMempoolAddressDelta(entry.GetTime(), out.nValue));
         }
     }
-
-    mapAddressInserted.insert(std::make_pair(txhash, inserted));
 }
 
 bool CTxMemPool::getAddressIndex(std::vector<std::pair<uint160, int> > &addresses,
                                  std::vector<std::pair<CMempoolAddressDeltaKey, CMempoolAddressDelta> > &results)
 {
     LOCK(cs);
-    for (std::vector<std::pair<uint160, int> >::iterator it = addresses.begin(); it != addresses.end(); it++) {
-        addressDeltaMap::iterator ait = mapAddress.lower_bound(CMempoolAddressDeltaKey((*it).second, (*it).first));
-        while (ait != mapAddress.end() && (*ait).first.addressBytes == (*it).first && (*ait).first.type == (*it).second) {
-            results.push_back(*ait);
-            ait++;
-        }
-    }
+    addressIndex.Get(addresses, results);
     return true;
 }
 
 bool CTxMemPool::removeAddressIndex(const uint256 txhash)
 {
     LOCK(cs);
-    addressDeltaMapInserted::iterator it = mapAddressInserted.find(txhash);
-
-    if (it != mapAddressInserted.end()) {
-        std::vector<CMempoolAddressDeltaKey> keys = (*it).second;
-        for (std::vector<CMempoolAddressDeltaKey>::iterator mit = keys.begin(); mit != keys.end(); mit++) {
-            mapAddress.erase(*mit);
-        }
-        mapAddressInserted.erase(it);
-    }
-
+    addressIndex.Remove(txhash);
     return true;
 }
 
@@ -632,6 +612,7 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
     const uint256 hash = it->GetTx().GetHash();
     for (const CTxIn& txin : it->GetTx().vin)
         mapNextTx.erase(txin.prevout);
+    readIndex.Remove(it->GetTx());
 
     if (vTxHashes.size() > 1) {
         vTxHashes[it->vTxHashesIdx] = std::move(vTxHashes.back());
@@ -992,6 +973,8 @@ void CTxMemPool::_clear()
     mapNextTx.clear();
     mapProTxAddresses.clear();
     mapProTxPubKeyIDs.clear();
+    readIndex.Clear();
+    addressIndex.Clear();
     totalTxSize = 0;
     cachedInnerUsage = 0;
     lastRollingFeeUpdate = GetTime();
@@ -1195,8 +1178,9 @@ void CTxMemPool::queryHashes(std::vector<uint256>& vtxid)
     }
 }
 
-static TxMempoolInfo GetInfo(CTxMemPool::indexed_transaction_set::const_iterator it) {
-    return TxMempoolInfo{it->GetSharedTx(), it->GetTime(), CFeeRate(it->GetFee(), it->GetTxSize()), it->GetModifiedFee() - it->GetFee()};
+void CTxMemPool::queryHashesUnsorted(std::vector<uint256>& vtxid) const
+{
+    vtxid = readIndex.GetHashes();
 }
 
 std::vector<TxMempoolInfo> CTxMemPool::infoAll() const
@@ -1213,22 +1197,30 @@ std::vector<TxMempoolInfo> CTxMemPool::infoAll() const
     return ret;
 }
 
+std::vector<TxMempoolInfo> CTxMemPool::infoAllUnsorted() const
+{
+    return readIndex.GetAll();
+}
+
 CTransactionRef CTxMemPool::get(const uint256& hash) const
 {
-    LOCK(cs);
-    indexed_transaction_set::const_iterator i = mapTx.find(hash);
-    if (i == mapTx.end())
+    TxMempoolInfo info;
+    if (!readIndex.Get(hash, info))
         return nullptr;
-    return i->GetSharedTx();
+    return info.tx;
 }
 
 TxMempoolInfo CTxMemPool::info(const uint256& hash) const
 {
-    LOCK(cs);
-    indexed_transaction_set::const_iterator i = mapTx.find(hash);
-    if (i == mapTx.end())
+    TxMempoolInfo info;
+    if (!readIndex.Get(hash, info))
         return TxMempoolInfo();
-    return GetInfo(i);
+    return info;
+}
+
+bool CTxMemPool::GetSpender(const COutPoint& outpoint, uint256& spenderHashRet) const
+{
+    return readIndex.GetSpender(outpoint, spenderHashRet);
 }
 
 bool CTxMemPool::existsProviderTxConflict(const CTransaction &tx) const {
@@ -1328,6 +1320,7 @@ void CTxMemPool::PrioritiseTransaction(const uint256& hash, const CAmount& nFeeD
         txiter it = mapTx.find(hash);
         if (it != mapTx.end()) {
             mapTx.modify(it, update_fee_delta(delta));
+            readIndex.UpdateFeeDelta(hash, it->GetModifiedFee() - it->GetFee());
             // Now update all ancestors' modified fees with descendants
             setEntries setAncestors;
             uint64_t nNoLimit = std::numeric_limits<uint64_t>::max();
@@ -1554,4 +1547,120 @@ bool CTxMemPool::TransactionWithinChainLimit(const uint256& txid, size_t chainLi
        it->GetCountWithDescendants() < chainLimit);
 }
 
+void CTxMemPoolReadIndex::Add(const TxMempoolInfo& info)
+{
+    const uint256& hash = info.tx->GetHash();
+    {
+        Shard& shard = GetShard(hash);
+        std::lock_guard<std::mutex> lock(shard.cs);
+        if (!shard.mapInfo.emplace(hash, info).second) {
+            return;
+        }
+    }
+    for (const CTxIn& txin : info.tx->vin) {
+        Shard& shard = GetShard(txin.prevout);
+        std::lock_guard<std::mutex> lock(shard.cs);
+        shard.mapSpenders[txin.prevout] = hash;
+    }
+    nSize++;
+}
+
+void CTxMemPoolReadIndex::Remove(const CTransaction& tx)
+{
+    const uint256& hash = tx.GetHash();
+    {
+        Shard& shard = GetShard(hash);
+        std::lock_guard<std::mutex> lock(shard.cs);
+        if (shard.mapInfo.erase(hash) == 0) {
+            return;
+        }
+    }
+    for (const CTxIn& txin : tx.vin) {
+        Shard& shard = GetShard(txin.prevout);
+        std::lock_guard<std::mutex> lock(shard.cs);
+        auto it = shard.mapSpenders.find(txin.prevout);
+        if (it != shard.mapSpenders.end() && it->second == hash) {
+            shard.mapSpenders.erase(it);
+        }
+    }
+    nSize--;
+}
+
+void CTxMemPoolReadIndex::UpdateFeeDelta(const uint256& hash, int64_t nFeeDelta)
+{
+    Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.cs);
+    auto it = shard.mapInfo.find(hash);
+    if (it != shard.mapInfo.end()) {
+        it->second.nFeeDelta = nFeeDelta;
+    }
+}
+
+void CTxMemPoolReadIndex::Clear()
+{
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.cs);
+        shard.mapInfo.clear();
+        shard.mapSpenders.clear();
+    }
+    nSize = 0;
+}
+
+bool CTxMemPoolReadIndex::Exists(const uint256& hash) const
+{
+    const Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.cs);
+    return shard.mapInfo.count(hash) != 0;
+}
+
+bool CTxMemPoolReadIndex::Get(const uint256& hash, TxMempoolInfo& infoRet) const
+{
+    const Shard& shard = GetShard(hash);
+    std::lock_guard<std::mutex> lock(shard.cs);
+    auto it = shard.mapInfo.find(hash);
+    if (it == shard.mapInfo.end()) {
+        return false;
+    }
+    infoRet = it->second;
+    return true;
+}
+
+bool CTxMemPoolReadIndex::GetSpender(const COutPoint& outpoint, uint256& spenderHashRet) const
+{
+    const Shard& shard = GetShard(outpoint);
+    std::lock_guard<std::mutex> lock(shard.cs);
+    auto it = shard.mapSpenders.find(outpoint);
+    if (it == shard.mapSpenders.end()) {
+        return false;
+    }
+    spenderHashRet = it->second;
+    return true;
+}
+
+std::vector<uint256> CTxMemPoolReadIndex::GetHashes() const
+{
+    std::vector<uint256> ret;
+    ret.reserve(nSize);
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.cs);
+        for (const auto& p : shard.mapInfo) {
+            ret.emplace_back(p.first);
+        }
+    }
+    return ret;
+}
+
+std::vector<TxMempoolInfo> CTxMemPoolReadIndex::GetAll() const
+{
+    std::vector<TxMempoolInfo> ret;
+    ret.reserve(nSize);
+    for (const Shard& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.cs);
+        for (const auto& p : shard.mapInfo) {
+            ret.emplace_back(p.second);
+        }
+    }
+    return ret;
+}
+
 SaltedTxidHasher::SaltedTxidHasher() : k0(GetRand(std::numeric_limits<uint64_t>::max())), k1(GetRand(std::numeric_limits<uint64_t>::max())) {}
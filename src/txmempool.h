@@ -6,9 +6,12 @@
 #ifndef BITCOIN_TXMEMPOOL_H
 #define BITCOIN_TXMEMPOOL_H
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 #include <string>
@@ -23,6 +26,7 @@
 #include "sync.h"
 #include "random.h"
 #include "netaddress.h"
+#include "saltedhasher.h"
 #include "bls/bls.h"
 #include "pubkey.h"
 
@@ -347,6 +351,53 @@ public:
     }
 };
 
+/**
+ * Sharded read index of the mempool, used to serve txid and spent outpoint lookups
+ * without taking CTxMemPool::cs.
+ *
+ * The index is updated by CTxMemPool while holding cs, so callers holding cs always see
+ * a state consistent with mapTx. Callers not holding cs only lock a single shard for the
+ * duration of a hash map lookup, which keeps RPC and P2P queries from queueing up behind
+ * AcceptToMemoryPool and block connection.
+ * Full listings walk the shards one after another and are thus not an atomic snapshot
+ * of the whole mempool, which is fine for the RPC and P2P callers.
+ */
+class CTxMemPoolReadIndex
+{
+public:
+    static const size_t SHARDS = 16;
+
+private:
+    struct Shard {
+        mutable std::mutex cs;
+        std::unordered_map<uint256, TxMempoolInfo, StaticSaltedHasher> mapInfo;
+        std::unordered_map<COutPoint, uint256, SaltedOutpointHasher> mapSpenders;
+    };
+
+    Shard shards[SHARDS];
+    std::atomic<size_t> nSize{0};
+
+    Shard& GetShard(const uint256& hash) { return shards[hash.GetCheapHash() % SHARDS]; }
+    const Shard& GetShard(const uint256& hash) const { return shards[hash.GetCheapHash() % SHARDS]; }
+    Shard& GetShard(const COutPoint& outpoint) { return shards[(outpoint.hash.GetCheapHash() + outpoint.n) % SHARDS]; }
+    const Shard& GetShard(const COutPoint& outpoint) const { return shards[(outpoint.hash.GetCheapHash() + outpoint.n) % SHARDS]; }
+
+public:
+    void Add(const TxMempoolInfo& info);
+    void Remove(const CTransaction& tx);
+    void UpdateFeeDelta(const uint256& hash, int64_t nFeeDelta);
+    void Clear();
+
+    bool Exists(const uint256& hash) const;
+    bool Get(const uint256& hash, TxMempoolInfo& infoRet) const;
+    /** Returns true and the hash of the spending mempool transaction if outpoint is spent in the mempool */
+    bool GetSpender(const COutPoint& outpoint, uint256& spenderHashRet) const;
+    /** Unordered listings */
+    std::vector<uint256> GetHashes() const;
+    std::vector<TxMempoolInfo> GetAll() const;
+    size_t Size() const { return nSize; }
+};
+
 /**
  * CTxMemPool stores valid-according-to-the-current-best-chain transactions
  * that may be included in the next block.
@@ -496,11 +547,7 @@ private:
     typedef std::map<txiter, TxLinks, CompareIteratorByHash> txlinksMap;
     txlinksMap mapLinks;
 
-    typedef std::map<CMempoolAddressDeltaKey, CMempoolAddressDelta, CMempoolAddressDeltaKeyCompare> addressDeltaMap;
-    addressDeltaMap mapAddress;
-
-    typedef std::map<uint256, std::vector<CMempoolAddressDeltaKey> > addressDeltaMapInserted;
-    addressDeltaMapInserted mapAddressInserted;
+    CMempoolAddressIndex addressIndex;
 
     typedef std::map<CSpentIndexKey, CSpentIndexValue, CSpentIndexKeyCompare> mapSpentIndex;
     mapSpentIndex mapSpent;
@@ -514,6 +561,9 @@ private:
     std::map<uint256, uint256> mapProTxBlsPubKeyHashes;
     std::map<COutPoint, uint256> mapProTxCollaterals;
 
+    //! Lookup structures which can be queried without holding cs, see CTxMemPoolReadIndex
+    CTxMemPoolReadIndex readIndex;
+
     void UpdateParent(txiter entry, txiter parent, bool add);
     void UpdateChild(txiter entry, txiter child, bool add);
 
@@ -567,6 +617,8 @@ public:
     void _clear(); //lock free
     bool CompareDepthAndScore(const uint256& hasha, const uint256& hashb);
     void queryHashes(std::vector<uint256>& vtxid);
+    /** Same as queryHashes, but in no particular order and without taking cs */
+    void queryHashesUnsorted(std::vector<uint256>& vtxid) const;
     bool isSpent(const COutPoint& outpoint);
     unsigned int GetTransactionsUpdated() const;
     void AddTransactionsUpdated(unsigned int n);
@@ -651,15 +703,18 @@ public:
         return totalTxSize;
     }
 
+    // exists(), get(), info() and GetSpender() don't take cs, see CTxMemPoolReadIndex
     bool exists(uint256 hash) const
     {
-        LOCK(cs);
-        return (mapTx.count(hash) != 0);
+        return readIndex.Exists(hash);
     }
 
     CTransactionRef get(const uint256& hash) const;
     TxMempoolInfo info(const uint256& hash) const;
     std::vector<TxMempoolInfo> infoAll() const;
+    /** Same as infoAll, but in no particular order and without taking cs */
+    std::vector<TxMempoolInfo> infoAllUnsorted() const;
+    bool GetSpender(const COutPoint& outpoint, uint256& spenderHashRet) const;
 
     bool existsProviderTxConflict(const CTransaction &tx) const;
 
@@ -138,6 +138,7 @@ namespace BCLog {
         MNSYNC      = ((uint64_t)1 << 40),
         PRIVATESEND = ((uint64_t)1 << 41),
         SPORK       = ((uint64_t)1 << 42),
+        NETPROF     = ((uint64_t)1 << 43),
         //End Xazab
 
         ALL         = ~(uint64_t)0,
@@ -347,11 +348,6 @@ int GetNumCores();
 void RenameThread(const char* name);
 std::string GetThreadName();
 
-namespace ctpl {
-    class thread_pool;
-}
-void RenameThreadPool(ctpl::thread_pool& tp, const char* baseName);
-
 /**
  * .. and a wrapper that just calls func once
  */
@@ -7,7 +7,9 @@
 #include "validation.h"
 
 #include "arith_uint256.h"
+#include "blockconnectstats.h"
 #include "blockencodings.h"
+#include "blockfilemap.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "checkpoints.h"
@@ -17,6 +19,7 @@
 #include "consensus/tx_verify.h"
 #include "consensus/validation.h"
 #include "cuckoocache.h"
+#include "explorerindex.h"
 #include "fs.h"
 #include "hash.h"
 #include "init.h"
@@ -26,6 +29,7 @@
 #include "primitives/block.h"
 #include "primitives/transaction.h"
 #include "reverse_iterator.h"
+#include "saltedhasher.h"
 #include "script/script.h"
 #include "script/sigcache.h"
 #include "script/standard.h"
@@ -55,6 +59,7 @@
 
 #include <atomic>
 #include <sstream>
+#include <unordered_set>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/join.hpp>
@@ -97,6 +102,7 @@ bool fRequireStandard = true;
 unsigned int nBytesPerSigOp = DEFAULT_BYTES_PER_SIGOP;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
+bool fPrefetchInputs = DEFAULT_PREFETCH_INPUTS;
 size_t nCoinCacheUsage = 5000 * 300;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
@@ -221,6 +227,7 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 }
 
 CCoinsViewDB *pcoinsdbview = nullptr;
+CCoinsViewBackgroundFlush *pcoinsflusher = nullptr;
 CCoinsViewCache *pcoinsTip = nullptr;
 CBlockTreeDB *pblocktree = nullptr;
 
@@ -820,10 +827,10 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransa
 
 bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::vector<uint256> &hashes)
 {
-    if (!fTimestampIndex)
+    if (!fTimestampIndex || !g_explorerindex)
         return error("Timestamp index not enabled");
 
-    if (!pblocktree->ReadTimestampIndex(high, low, hashes))
+    if (!g_explorerindex->GetDB().ReadTimestampIndex(high, low, hashes))
         return error("Unable to get hashes for timestamps");
 
     return true;
@@ -831,13 +838,13 @@ bool GetTimestampIndex(const unsigned int &high, const unsigned int &low, std::v
 
 bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
 {
-    if (!fSpentIndex)
+    if (!fSpentIndex || !g_explorerindex)
         return false;
 
     if (mempool.getSpentIndex(key, value))
         return true;
 
-    if (!pblocktree->ReadSpentIndex(key, value))
+    if (!g_explorerindex->GetDB().ReadSpentIndex(key, value))
         return false;
 
     return true;
@@ -846,22 +853,59 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
 bool GetAddressIndex(uint160 addressHash, int type,
                      std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex, int start, int end)
 {
-    if (!fAddressIndex)
+    if (!fAddressIndex || !g_explorerindex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end))
+    if (!g_explorerindex->GetDB().ReadAddressIndex(addressHash, type, addressIndex, start, end))
         return error("unable to get txids for address");
 
     return true;
 }
 
+bool GetAddressBalance(uint160 addressHash, int type, CAddressBalanceValue &value)
+{
+    if (!fAddressIndex || !g_explorerindex)
+        return error("address index not enabled");
+
+    if (!g_explorerindex->GetDB().ReadAddressBalance(addressHash, type, value))
+        return error("unable to get balance for address");
+
+    return true;
+}
+
 bool GetAddressUnspent(uint160 addressHash, int type,
                        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs)
 {
-    if (!fAddressIndex)
+    if (!fAddressIndex || !g_explorerindex)
+        return error("address index not enabled");
+
+    if (!g_explorerindex->GetDB().ReadAddressUnspentIndex(addressHash, type, unspentOutputs))
+        return error("unable to get txids for address");
+
+    return true;
+}
+
+bool GetAddressIndexPage(const CAddressIndexKey &startKey, int end, size_t nLimit,
+                         std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                         CAddressIndexKey &nextKey, bool &fMore)
+{
+    if (!fAddressIndex || !g_explorerindex)
+        return error("address index not enabled");
+
+    if (!g_explorerindex->GetDB().ReadAddressIndexPage(startKey, end, nLimit, addressIndex, nextKey, fMore))
+        return error("unable to get txids for address");
+
+    return true;
+}
+
+bool GetAddressUnspentPage(const CAddressUnspentKey &startKey, size_t nLimit,
+                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                           CAddressUnspentKey &nextKey, bool &fMore)
+{
+    if (!fAddressIndex || !g_explorerindex)
         return error("address index not enabled");
 
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs))
+    if (!g_explorerindex->GetDB().ReadAddressUnspentIndexPage(startKey, nLimit, unspentOutputs, nextKey, fMore))
         return error("unable to get txids for address");
 
     return true;
@@ -961,17 +1005,30 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 {
     block.SetNull();
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
+    unsigned int nSize;
+    auto file = blockFileMap.GetRecord(pos, Params().MessageStart(), MaxBlockSize(true), 0, nSize);
+    if (file) {
+        // Read block from the memory mapped block file
+        CMemoryReader reader(file->Data() + pos.nPos, file->Data() + pos.nPos + nSize, SER_DISK, CLIENT_VERSION);
+        try {
+            reader >> block;
+        }
+        catch (const std::exception& e) {
+            return error("%s: Deserialize error - %s at %s", __func__, e.what(), pos.ToString());
+        }
+    } else {
+        // Open history file to read
+        CAutoFile filein(OpenBlockFile(pos, true), SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull())
+            return error("ReadBlockFromDisk: OpenBlockFile failed for %s", pos.ToString());
 
-    // Read block
-    try {
-        filein >> block;
-    }
-    catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        // Read block
+        try {
+            filein >> block;
+        }
+        catch (const std::exception& e) {
+            return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        }
     }
 
     // Check the header
@@ -983,11 +1040,19 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
+    // Copying a cached block only copies the transaction pointers
+    std::shared_ptr<const CBlock> pblockCached = blockReadCache.Get(pindex->GetBlockHash());
+    if (pblockCached) {
+        block = *pblockCached;
+        return true;
+    }
+
     if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), consensusParams))
         return false;
     if (block.GetHash() != pindex->GetBlockHash())
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
                 pindex->ToString(), pindex->GetBlockPos().ToString());
+    blockReadCache.Add(std::make_shared<const CBlock>(block));
     return true;
 }
 
@@ -1418,6 +1483,54 @@ bool CheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsVi
     return true;
 }
 
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashBlock)
+{
+    unsigned int nSize;
+    auto file = undoFileMap.GetRecord(pos, Params().MessageStart(), MAX_SIZE, sizeof(uint256), nSize);
+    if (file) {
+        // Read undo data and its checksum from the memory mapped undo file
+        CMemoryReader reader(file->Data() + pos.nPos, file->Data() + pos.nPos + nSize + sizeof(uint256), SER_DISK, CLIENT_VERSION);
+        uint256 hashChecksum;
+        CHashVerifier<CMemoryReader> verifier(&reader);
+        try {
+            verifier << hashBlock;
+            verifier >> blockundo;
+            reader >> hashChecksum;
+        }
+        catch (const std::exception& e) {
+            return error("%s: Deserialize error - %s", __func__, e.what());
+        }
+
+        if (hashChecksum != verifier.GetHash())
+            return error("%s: Checksum mismatch", __func__);
+
+        return true;
+    }
+
+    // Open history file to read
+    CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: OpenUndoFile failed", __func__);
+
+    // Read block
+    uint256 hashChecksum;
+    CHashVerifier<CAutoFile> verifier(&filein); // We need a CHashVerifier as reserializing may lose data
+    try {
+        verifier << hashBlock;
+        verifier >> blockundo;
+        filein >> hashChecksum;
+    }
+    catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
+    }
+
+    // Verify checksum
+    if (hashChecksum != verifier.GetHash())
+        return error("%s: Checksum mismatch", __func__);
+
+    return true;
+}
+
 namespace {
 
 bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint256& hashBlock, const CMessageHeader::MessageStartChars& messageStart)
@@ -1447,32 +1560,6 @@ bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint
     return true;
 }
 
-bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashBlock)
-{
-    // Open history file to read
-    CAutoFile filein(OpenUndoFile(pos, true), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("%s: OpenUndoFile failed", __func__);
-
-    // Read block
-    uint256 hashChecksum;
-    CHashVerifier<CAutoFile> verifier(&filein); // We need a CHashVerifier as reserializing may lose data
-    try {
-        verifier << hashBlock;
-        verifier >> blockundo;
-        filein >> hashChecksum;
-    }
-    catch (const std::exception& e) {
-        return error("%s: Deserialize or I/O error - %s", __func__, e.what());
-    }
-
-    // Verify checksum
-    if (hashChecksum != verifier.GetHash())
-        return error("%s: Checksum mismatch", __func__);
-
-    return true;
-}
-
 /** Abort with a message */
 bool AbortNode(const std::string& strMessage, const std::string& userMessage="")
 {
@@ -1563,10 +1650,6 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
         return DISCONNECT_FAILED;
     }
 
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
-
     if (!UndoSpecialTxsInBlock(block, pindex)) {
         return DISCONNECT_FAILED;
     }
@@ -1577,41 +1660,6 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
         uint256 hash = tx.GetHash();
         bool is_coinbase = tx.IsCoinBase();
 
-        if (fAddressIndex) {
-
-            for (unsigned int k = tx.vout.size(); k-- > 0;) {
-                const CTxOut &out = tx.vout[k];
-
-                if (out.scriptPubKey.IsPayToScriptHash()) {
-                    std::vector<unsigned char> hashBytes(out.scriptPubKey.begin()+2, out.scriptPubKey.begin()+22);
-
-                    // undo receiving activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(2, uint160(hashBytes), pindex->nHeight, i, hash, k, false), out.nValue));
-
-                    // undo unspent index
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(2, uint160(hashBytes), hash, k), CAddressUnspentValue()));
-
-                } else if (out.scriptPubKey.IsPayToPublicKeyHash()) {
-                    std::vector<unsigned char> hashBytes(out.scriptPubKey.begin()+3, out.scriptPubKey.begin()+23);
-
-                    // undo receiving activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(1, uint160(hashBytes), pindex->nHeight, i, hash, k, false), out.nValue));
-
-                    // undo unspent index
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, uint160(hashBytes), hash, k), CAddressUnspentValue()));
-
-                } else if (out.scriptPubKey.IsPayToPublicKey()) {
-                    uint160 hashBytes(Hash160(out.scriptPubKey.begin()+1, out.scriptPubKey.end()-1));
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(1, hashBytes, pindex->nHeight, i, hash, k, false), out.nValue));
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, hashBytes, hash, k), CAddressUnspentValue()));
-                } else {
-                    continue;
-                }
-
-            }
-
-        }
-
         // Check that all outputs are available and match the outputs in the block itself
         // exactly.
         for (size_t o = 0; o < tx.vout.size(); o++) {
@@ -1634,49 +1682,9 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
             }
             for (unsigned int j = tx.vin.size(); j-- > 0;) {
                 const COutPoint &out = tx.vin[j].prevout;
-                int undoHeight = txundo.vprevout[j].nHeight;
                 int res = ApplyTxInUndo(std::move(txundo.vprevout[j]), view, out);
                 if (res == DISCONNECT_FAILED) return DISCONNECT_FAILED;
                 fClean = fClean && res != DISCONNECT_UNCLEAN;
-
-                const CTxIn input = tx.vin[j];
-
-                if (fSpentIndex) {
-                    // undo and delete the spent index
-                    spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue()));
-                }
-
-                if (fAddressIndex) {
-                    const Coin &coin = view.AccessCoin(tx.vin[j].prevout);
-                    const CTxOut &prevout = coin.out;
-                    if (prevout.scriptPubKey.IsPayToScriptHash()) {
-                        std::vector<unsigned char> hashBytes(prevout.scriptPubKey.begin()+2, prevout.scriptPubKey.begin()+22);
-
-                        // undo spending activity
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(2, uint160(hashBytes), pindex->nHeight, i, hash, j, true), prevout.nValue * -1));
-
-                        // restore unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(2, uint160(hashBytes), input.prevout.hash, input.prevout.n), CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undoHeight)));
-
-
-                    } else if (prevout.scriptPubKey.IsPayToPublicKeyHash()) {
-                        std::vector<unsigned char> hashBytes(prevout.scriptPubKey.begin()+3, prevout.scriptPubKey.begin()+23);
-
-                        // undo spending activity
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(1, uint160(hashBytes), pindex->nHeight, i, hash, j, true), prevout.nValue * -1));
-
-                        // restore unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, uint160(hashBytes), input.prevout.hash, input.prevout.n), CAddressUnspentValue(prevout.nValue, prevout.scriptPubKey, undoHeight)));
-
-                    } else if (prevout.scriptPubKey.IsPayToPublicKey()) {
-                        uint160 hashBytes(Hash160(prevout.scriptPubKey.begin()+1, prevout.scriptPubKey.end()-1));
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(1, hashBytes, pindex->nHeight, i, hash, j, false), prevout.nValue));
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, hashBytes, hash, j), CAddressUnspentValue()));
-                    } else {
-                        continue;
-                    }
-                }
-
             }
             // At this point, all of txundo.vprevout should have been moved out.
         }
@@ -1685,24 +1693,6 @@ static DisconnectResult DisconnectBlock(const CBlock& block, const CBlockIndex*
     // move best block pointer to prevout block
     view.SetBestBlock(pindex->pprev->GetBlockHash());
 
-    if (fSpentIndex) {
-        if (!pblocktree->UpdateSpentIndex(spentIndex)) {
-            AbortNode("Failed to delete spent index");
-            return DISCONNECT_FAILED;
-        }
-    }
-
-    if (fAddressIndex) {
-        if (!pblocktree->EraseAddressIndex(addressIndex)) {
-            AbortNode("Failed to delete address index");
-            return DISCONNECT_FAILED;
-        }
-        if (!pblocktree->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            AbortNode("Failed to write address unspent index");
-            return DISCONNECT_FAILED;
-        }
-    }
-
     evoDb->WriteBestBlock(pindex->pprev->GetBlockHash());
 
     return fClean ? DISCONNECT_OK : DISCONNECT_UNCLEAN;
@@ -1740,6 +1730,280 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+namespace {
+
+struct CCoinPrefetchResult
+{
+    Coin coin;
+    bool fFound{false};
+    int64_t nMicros{0};
+};
+
+/** Reads one coin from the coins database, for PrefetchBlockInputs */
+class CCoinPrefetch
+{
+private:
+    const CCoinsView* view{nullptr};
+    COutPoint outpoint;
+    CCoinPrefetchResult* result{nullptr};
+
+public:
+    CCoinPrefetch() {}
+    CCoinPrefetch(const CCoinsView* viewIn, const COutPoint& outpointIn, CCoinPrefetchResult* resultIn) :
+        view(viewIn), outpoint(outpointIn), result(resultIn) {}
+
+    bool operator()()
+    {
+        int64_t nStart = GetTimeMicros();
+        try {
+            result->fFound = view->GetCoin(outpoint, result->coin);
+        } catch (const std::exception& e) {
+            // ConnectBlock will run into the same error and handle it
+            return false;
+        }
+        result->nMicros = GetTimeMicros() - nStart;
+        return true;
+    }
+
+    void swap(CCoinPrefetch& check)
+    {
+        std::swap(view, check.view);
+        std::swap(outpoint, check.outpoint);
+        std::swap(result, check.result);
+    }
+};
+
+} // namespace
+
+static CCheckQueue<CCoinPrefetch> prefetchqueue(16);
+
+void ThreadPrefetchInputs() {
+    RenameThread("xazab-prefetch");
+    prefetchqueue.Thread();
+}
+
+/**
+ * Reads the inputs of block which aren't cached by pcoinsTip from the coins database on the prefetch threads
+ * and adds them to pcoinsTip, so ConnectBlock doesn't have to read them one by one. Returns the number of
+ * coins read and sets nReadMicrosRet to the sum of the times of the reads.
+ */
+static size_t PrefetchBlockInputs(const CBlock& block, int64_t& nReadMicrosRet)
+{
+    AssertLockHeld(cs_main);
+    nReadMicrosRet = 0;
+
+    std::unordered_set<uint256, StaticSaltedHasher> setBlockTxids;
+    std::vector<COutPoint> vOutpoints;
+    for (const auto& tx : block.vtx) {
+        if (!tx->IsCoinBase()) {
+            for (const auto& txin : tx->vin) {
+                // outputs created earlier in the same block can't be in the database. Coins which were spent in
+                // pcoinsTip are read for nothing, AddFetchedCoin keeps the cached entry.
+                if (!setBlockTxids.count(txin.prevout.hash) && !pcoinsTip->HaveCoinInCache(txin.prevout)) {
+                    vOutpoints.emplace_back(txin.prevout);
+                }
+            }
+        }
+        setBlockTxids.emplace(tx->GetHash());
+    }
+    if (vOutpoints.empty()) {
+        return 0;
+    }
+
+    std::vector<CCoinPrefetchResult> vResults(vOutpoints.size());
+    std::vector<CCoinPrefetch> vChecks;
+    vChecks.reserve(vOutpoints.size());
+    for (size_t i = 0; i < vOutpoints.size(); i++) {
+        // read through pcoinsflusher, the database lacks the coins which are still being written
+        vChecks.emplace_back(pcoinsflusher ? (CCoinsView*)pcoinsflusher : pcoinsdbview, vOutpoints[i], &vResults[i]);
+    }
+    CCheckQueueControl<CCoinPrefetch> control(&prefetchqueue);
+    control.Add(vChecks);
+    if (!control.Wait()) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < vOutpoints.size(); i++) {
+        nReadMicrosRet += vResults[i].nMicros;
+        if (vResults[i].fFound) {
+            pcoinsTip->AddFetchedCoin(vOutpoints[i], std::move(vResults[i].coin));
+        }
+    }
+    return vOutpoints.size();
+}
+
+bool CheckInputsParallel(const std::vector<CTransactionRef>& vtx, const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore)
+{
+    // CScriptCheck keeps a pointer to the precomputed data, so don't let the vector reallocate
+    std::vector<PrecomputedTransactionData> vTxData;
+    vTxData.reserve(vtx.size());
+
+    CCheckQueueControl<CScriptCheck> control(nScriptCheckThreads ? &scriptcheckqueue : nullptr);
+    std::vector<CScriptCheck> vChecks;
+    for (const auto& tx : vtx) {
+        vTxData.emplace_back(*tx);
+        vChecks.clear();
+        vChecks.reserve(tx->vin.size());
+        for (unsigned int i = 0; i < tx->vin.size(); i++) {
+            const Coin& coin = inputs.AccessCoin(tx->vin[i].prevout);
+            assert(!coin.IsSpent());
+            vChecks.emplace_back(coin.out.scriptPubKey, coin.out.nValue, *tx, i, flags, cacheSigStore, &vTxData.back());
+        }
+        if (!nScriptCheckThreads) {
+            for (auto& check : vChecks) {
+                if (!check()) {
+                    return false;
+                }
+            }
+            continue;
+        }
+        control.Add(vChecks);
+    }
+    return control.Wait();
+}
+
+size_t PrevalidateTransactionScripts(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, std::vector<std::vector<COutPoint> >* pvCoinsToUncache)
+{
+    int64_t nTimeStart = GetTimeMicros();
+
+    CCoinsView dummy;
+    CCoinsViewCache view(&dummy);
+    std::vector<CTransactionRef> vtxToCheck;
+    vtxToCheck.reserve(vtx.size());
+    {
+        LOCK2(cs_main, pool.cs);
+        CCoinsViewMemPool viewMemPool(pcoinsTip, pool);
+        view.SetBackend(viewMemPool);
+
+        // Coins we bring into pcoinsTip, per transaction. AcceptToMemoryPool only uncaches the coins it brought in
+        // itself, so these have to be uncached for the transactions which don't make it into the mempool.
+        std::vector<std::vector<COutPoint> > vCoinsToUncache(vtx.size());
+        // Outpoints spent by earlier transactions of the batch, AcceptToMemoryPool rejects later spends of them
+        // as conflicts just like spends of outpoints in pool.mapNextTx
+        std::set<COutPoint> setSpentInBatch;
+        for (size_t i = 0; i < vtx.size(); i++) {
+            const CTransactionRef& tx = vtx[i];
+            CValidationState state;
+            std::string reason;
+            if (!CheckTransaction(*tx, state) || tx->IsCoinBase() || pool.exists(tx->GetHash()) ||
+                (fRequireStandard && !IsStandardTx(*tx, reason))) {
+                continue;
+            }
+            bool fConflict = false;
+            for (const CTxIn& txin : tx->vin) {
+                if (pool.mapNextTx.count(txin.prevout) || setSpentInBatch.count(txin.prevout)) {
+                    fConflict = true;
+                    break;
+                }
+            }
+            if (fConflict) {
+                continue;
+            }
+            for (const CTxIn& txin : tx->vin) {
+                setSpentInBatch.insert(txin.prevout);
+            }
+            bool fHaveInputs = true;
+            for (const CTxIn& txin : tx->vin) {
+                if (!pcoinsTip->HaveCoinInCache(txin.prevout)) {
+                    vCoinsToUncache[i].push_back(txin.prevout);
+                }
+                if (!view.HaveCoin(txin.prevout)) {
+                    fHaveInputs = false;
+                    break;
+                }
+            }
+            if (fHaveInputs) {
+                vtxToCheck.emplace_back(tx);
+            }
+        }
+        view.GetBestBlock();
+        view.SetBackend(dummy);
+
+        if (pvCoinsToUncache) {
+            pvCoinsToUncache->swap(vCoinsToUncache);
+        } else {
+            for (const auto& vCoins : vCoinsToUncache) {
+                for (const COutPoint& outpoint : vCoins) {
+                    pcoinsTip->Uncache(outpoint);
+                }
+            }
+        }
+
+        // Same cheap checks as in AcceptToMemoryPoolWorker, so that peers can't make us verify scripts
+        // of transactions which would be rejected before script verification anyway
+        auto itEnd = std::remove_if(vtxToCheck.begin(), vtxToCheck.end(), [&](const CTransactionRef& tx) {
+            CValidationState state;
+            CAmount nFees = 0;
+            if (!Consensus::CheckTxInputs(*tx, state, view, GetSpendHeight(view), nFees)) {
+                return true;
+            }
+            if (fRequireStandard && !AreInputsStandard(*tx, view)) {
+                return true;
+            }
+            unsigned int nSize = ::GetSerializeSize(*tx, SER_NETWORK, PROTOCOL_VERSION);
+            unsigned int nSigOps = GetTransactionSigOpCount(*tx, view, STANDARD_SCRIPT_VERIFY_FLAGS);
+            if ((nSigOps > MAX_STANDARD_TX_SIGOPS) || (nBytesPerSigOp && nSigOps > nSize / nBytesPerSigOp)) {
+                return true;
+            }
+            CAmount nModifiedFees = nFees;
+            pool.ApplyDelta(tx->GetHash(), nModifiedFees);
+            return nModifiedFees < ::minRelayTxFee.GetFee(nSize);
+        });
+        vtxToCheck.erase(itEnd, vtxToCheck.end());
+    }
+
+    if (vtxToCheck.empty()) {
+        return 0;
+    }
+
+    // The result doesn't matter here, AcceptToMemoryPool will find out which transaction failed and why
+    bool fOk = CheckInputsParallel(vtxToCheck, view, STANDARD_SCRIPT_VERIFY_FLAGS, true);
+
+    LogPrint(BCLog::MEMPOOL, "%s: verified scripts of %d/%d txs in %.2fms (ok=%d)\n", __func__,
+        vtxToCheck.size(), vtx.size(), (GetTimeMicros() - nTimeStart) * 0.001, fOk);
+    return vtxToCheck.size();
+}
+
+size_t AcceptToMemoryPoolBatch(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, bool fLimitFree,
+                               std::vector<CValidationState>& vState, std::vector<bool>& vAccepted,
+                               const std::vector<int64_t>* pvAcceptTime)
+{
+    assert(!pvAcceptTime || pvAcceptTime->size() == vtx.size());
+    const CChainParams& chainparams = Params();
+    int64_t nTimeStart = GetTimeMicros();
+
+    vState.assign(vtx.size(), CValidationState());
+    vAccepted.assign(vtx.size(), false);
+
+    std::vector<std::vector<COutPoint> > vCoinsToUncache;
+    size_t nPrevalidated = PrevalidateTransactionScripts(pool, vtx, &vCoinsToUncache);
+
+    size_t nAccepted = 0;
+    {
+        LOCK(cs_main);
+        int64_t nNow = GetTime();
+        for (size_t i = 0; i < vtx.size(); i++) {
+            int64_t nAcceptTime = pvAcceptTime ? (*pvAcceptTime)[i] : nNow;
+            vAccepted[i] = AcceptToMemoryPoolWithTime(chainparams, pool, vState[i], vtx[i], fLimitFree, nullptr, nAcceptTime, false, 0, false);
+            if (vAccepted[i]) {
+                nAccepted++;
+            }
+        }
+        for (size_t i = 0; i < vtx.size(); i++) {
+            if (!vAccepted[i]) {
+                for (const COutPoint& outpoint : vCoinsToUncache[i]) {
+                    pcoinsTip->Uncache(outpoint);
+                }
+            }
+        }
+    }
+
+    int64_t nTime = GetTimeMicros() - nTimeStart;
+    LogPrint(BCLog::MEMPOOL, "%s: accepted %d/%d txs (%d prevalidated) in %.2fms (%.0f txs/s)\n", __func__,
+        nAccepted, vtx.size(), nPrevalidated, nTime * 0.001, nTime ? nAccepted * 1000000.0 / nTime : 0.0);
+    return nAccepted;
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -1871,20 +2135,6 @@ static unsigned int GetBlockScriptFlags(const CBlockIndex* pindex, const Consens
 
 
 
-static int64_t nTimeCheck = 0;
-static int64_t nTimeForks = 0;
-static int64_t nTimeVerify = 0;
-static int64_t nTimeISFilter = 0;
-static int64_t nTimeSubsidy = 0;
-static int64_t nTimeValueValid = 0;
-static int64_t nTimePayeeValid = 0;
-static int64_t nTimeProcessSpecial = 0;
-static int64_t nTimeXazabSpecific = 0;
-static int64_t nTimeConnect = 0;
-static int64_t nTimeIndex = 0;
-static int64_t nTimeCallbacks = 0;
-static int64_t nTimeTotal = 0;
-
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
@@ -1952,7 +2202,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         }
     }
 
-    int64_t nTime1 = GetTimeMicros(); nTimeCheck += nTime1 - nTimeStart;
+    int64_t nTime1 = GetTimeMicros(); int64_t nTimeCheck = blockConnectStats.Record(BLOCK_STAGE_CHECK, nTime1 - nTimeStart, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "    - Sanity checks: %.2fms [%.2fs]\n", 0.001 * (nTime1 - nTimeStart), nTimeCheck * 0.000001);
 
     // Do not allow blocks that contain transactions which 'overwrite' older transactions,
@@ -2012,7 +2262,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     // Get the script flags for this block
     unsigned int flags = GetBlockScriptFlags(pindex, chainparams.GetConsensus());
 
-    int64_t nTime2 = GetTimeMicros(); nTimeForks += nTime2 - nTime1;
+    int64_t nTime2 = GetTimeMicros(); int64_t nTimeForks = blockConnectStats.Record(BLOCK_STAGE_FORKS, nTime2 - nTime1, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "    - Fork checks: %.2fms [%.2fs]\n", 0.001 * (nTime2 - nTime1), nTimeForks * 0.000001);
 
     CBlockUndo blockundo;
@@ -2027,9 +2277,6 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     std::vector<std::pair<uint256, CDiskTxPos> > vPos;
     vPos.reserve(block.vtx.size());
     blockundo.vtxundo.reserve(block.vtx.size() - 1);
-    std::vector<std::pair<CAddressIndexKey, CAmount> > addressIndex;
-    std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > addressUnspentIndex;
-    std::vector<std::pair<CSpentIndexKey, CSpentIndexValue> > spentIndex;
 
     std::vector<PrecomputedTransactionData> txdata;
     txdata.reserve(block.vtx.size()); // Required so that pointers to individual PrecomputedTransactionData don't get invalidated
@@ -2039,7 +2286,6 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     for (unsigned int i = 0; i < block.vtx.size(); i++)
     {
         const CTransaction &tx = *(block.vtx[i]);
-        const uint256 txhash = tx.GetHash();
 
         nInputs += tx.vin.size();
 
@@ -2067,47 +2313,6 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                 return state.DoS(100, error("%s: contains a non-BIP68-final transaction", __func__),
                                  REJECT_INVALID, "bad-txns-nonfinal");
             }
-
-            if (fAddressIndex || fSpentIndex)
-            {
-                for (size_t j = 0; j < tx.vin.size(); j++) {
-                    const CTxIn input = tx.vin[j];
-                    const Coin& coin = view.AccessCoin(tx.vin[j].prevout);
-                    const CTxOut &prevout = coin.out;
-                    uint160 hashBytes;
-                    int addressType;
-
-                    if (prevout.scriptPubKey.IsPayToScriptHash()) {
-                        hashBytes = uint160(std::vector<unsigned char>(prevout.scriptPubKey.begin()+2, prevout.scriptPubKey.begin()+22));
-                        addressType = 2;
-                    } else if (prevout.scriptPubKey.IsPayToPublicKeyHash()) {
-                        hashBytes = uint160(std::vector<unsigned char>(prevout.scriptPubKey.begin()+3, prevout.scriptPubKey.begin()+23));
-                        addressType = 1;
-                    } else if (prevout.scriptPubKey.IsPayToPublicKey()) {
-                        hashBytes = Hash160(prevout.scriptPubKey.begin()+1, prevout.scriptPubKey.end()-1);
-                        addressType = 1;
-                    } else {
-                        hashBytes.SetNull();
-                        addressType = 0;
-                    }
-
-                    if (fAddressIndex && addressType > 0) {
-                        // record spending activity
-                        addressIndex.push_back(std::make_pair(CAddressIndexKey(addressType, hashBytes, pindex->nHeight, i, txhash, j, true), prevout.nValue * -1));
-
-                        // remove address from unspent index
-                        addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(addressType, hashBytes, input.prevout.hash, input.prevout.n), CAddressUnspentValue()));
-                    }
-
-                    if (fSpentIndex) {
-                        // add the spent index to determine the txid and input that spent an output
-                        // and to find the amount and address from an input
-                        spentIndex.push_back(std::make_pair(CSpentIndexKey(input.prevout.hash, input.prevout.n), CSpentIndexValue(txhash, j, pindex->nHeight, prevout.nValue, addressType, hashBytes)));
-                    }
-                }
-
-            }
-
         }
 
         // GetTransactionSigOpCount counts 2 types of sigops:
@@ -2130,39 +2335,6 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
             control.Add(vChecks);
         }
 
-        if (fAddressIndex) {
-            for (unsigned int k = 0; k < tx.vout.size(); k++) {
-                const CTxOut &out = tx.vout[k];
-
-                if (out.scriptPubKey.IsPayToScriptHash()) {
-                    std::vector<unsigned char> hashBytes(out.scriptPubKey.begin()+2, out.scriptPubKey.begin()+22);
-
-                    // record receiving activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(2, uint160(hashBytes), pindex->nHeight, i, txhash, k, false), out.nValue));
-
-                    // record unspent output
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(2, uint160(hashBytes), txhash, k), CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
-
-                } else if (out.scriptPubKey.IsPayToPublicKeyHash()) {
-                    std::vector<unsigned char> hashBytes(out.scriptPubKey.begin()+3, out.scriptPubKey.begin()+23);
-
-                    // record receiving activity
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(1, uint160(hashBytes), pindex->nHeight, i, txhash, k, false), out.nValue));
-
-                    // record unspent output
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, uint160(hashBytes), txhash, k), CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
-
-                } else if (out.scriptPubKey.IsPayToPublicKey()) {
-                    uint160 hashBytes(Hash160(out.scriptPubKey.begin()+1, out.scriptPubKey.end()-1));
-                    addressIndex.push_back(std::make_pair(CAddressIndexKey(1, hashBytes, pindex->nHeight, i, txhash, k, false), out.nValue));
-                    addressUnspentIndex.push_back(std::make_pair(CAddressUnspentKey(1, hashBytes, txhash, k), CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
-                } else {
-                    continue;
-                }
-
-            }
-        }
-
         CTxUndo undoDummy;
         if (i > 0) {
             blockundo.vtxundo.push_back(CTxUndo());
@@ -2172,12 +2344,12 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         vPos.push_back(std::make_pair(tx.GetHash(), pos));
         pos.nTxOffset += ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
     }
-    int64_t nTime3 = GetTimeMicros(); nTimeConnect += nTime3 - nTime2;
+    int64_t nTime3 = GetTimeMicros(); int64_t nTimeConnect = blockConnectStats.Record(BLOCK_STAGE_CONNECT_TXS, nTime3 - nTime2, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "      - Connect %u transactions: %.2fms (%.3fms/tx, %.3fms/txin) [%.2fs]\n", (unsigned)block.vtx.size(), 0.001 * (nTime3 - nTime2), 0.001 * (nTime3 - nTime2) / block.vtx.size(), nInputs <= 1 ? 0 : 0.001 * (nTime3 - nTime2) / (nInputs-1), nTimeConnect * 0.000001);
 
     if (!control.Wait())
         return state.DoS(100, error("%s: CheckQueue failed", __func__), REJECT_INVALID, "block-validation-failed");
-    int64_t nTime4 = GetTimeMicros(); nTimeVerify += nTime4 - nTime2;
+    int64_t nTime4 = GetTimeMicros(); int64_t nTimeVerify = blockConnectStats.Record(BLOCK_STAGE_VERIFY_SCRIPTS, nTime4 - nTime2, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "    - Verify %u txins: %.2fms (%.3fms/txin) [%.2fs]\n", nInputs - 1, 0.001 * (nTime4 - nTime2), nInputs <= 1 ? 0 : 0.001 * (nTime4 - nTime2) / (nInputs-1), nTimeVerify * 0.000001);
 
 
@@ -2215,7 +2387,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         LogPrintf("ConnectBlock(XAZAB): spork is off, skipping transaction locking checks\n");
     }
 
-    int64_t nTime5_1 = GetTimeMicros(); nTimeISFilter += nTime5_1 - nTime4;
+    int64_t nTime5_1 = GetTimeMicros(); int64_t nTimeISFilter = blockConnectStats.Record(BLOCK_STAGE_IS_FILTER, nTime5_1 - nTime4, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "      - IS filter: %.2fms [%.2fs]\n", 0.001 * (nTime5_1 - nTime4), nTimeISFilter * 0.000001);
 
     // XAZAB : MODIFIED TO CHECK MASTERNODE PAYMENTS AND SUPERBLOCKS
@@ -2224,14 +2396,14 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     CAmount blockReward = nFees + GetBlockSubsidy(pindex->pprev->nBits, pindex->pprev->nHeight, chainparams.GetConsensus());
     std::string strError = "";
 
-    int64_t nTime5_2 = GetTimeMicros(); nTimeSubsidy += nTime5_2 - nTime5_1;
+    int64_t nTime5_2 = GetTimeMicros(); int64_t nTimeSubsidy = blockConnectStats.Record(BLOCK_STAGE_SUBSIDY, nTime5_2 - nTime5_1, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "      - GetBlockSubsidy: %.2fms [%.2fs]\n", 0.001 * (nTime5_2 - nTime5_1), nTimeSubsidy * 0.000001);
 
     if (!IsBlockValueValid(block, pindex->nHeight, blockReward, strError)) {
         return state.DoS(0, error("ConnectBlock(XAZAB): %s", strError), REJECT_INVALID, "bad-cb-amount");
     }
 
-    int64_t nTime5_3 = GetTimeMicros(); nTimeValueValid += nTime5_3 - nTime5_2;
+    int64_t nTime5_3 = GetTimeMicros(); int64_t nTimeValueValid = blockConnectStats.Record(BLOCK_STAGE_VALUE_VALID, nTime5_3 - nTime5_2, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "      - IsBlockValueValid: %.2fms [%.2fs]\n", 0.001 * (nTime5_3 - nTime5_2), nTimeValueValid * 0.000001);
 
     if (!IsBlockPayeeValid(*block.vtx[0], pindex->nHeight, blockReward)) {
@@ -2239,7 +2411,7 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                                 REJECT_INVALID, "bad-cb-payee");
     }
 
-    int64_t nTime5_4 = GetTimeMicros(); nTimePayeeValid += nTime5_4 - nTime5_3;
+    int64_t nTime5_4 = GetTimeMicros(); int64_t nTimePayeeValid = blockConnectStats.Record(BLOCK_STAGE_PAYEE_VALID, nTime5_4 - nTime5_3, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "      - IsBlockPayeeValid: %.2fms [%.2fs]\n", 0.001 * (nTime5_4 - nTime5_3), nTimePayeeValid * 0.000001);
 
     if (!ProcessSpecialTxsInBlock(block, pindex, state, fJustCheck, fScriptChecks)) {
@@ -2247,10 +2419,10 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
                      pindex->GetBlockHash().ToString(), FormatStateMessage(state));
     }
 
-    int64_t nTime5_5 = GetTimeMicros(); nTimeProcessSpecial += nTime5_5 - nTime5_4;
+    int64_t nTime5_5 = GetTimeMicros(); int64_t nTimeProcessSpecial = blockConnectStats.Record(BLOCK_STAGE_SPECIAL_TXS, nTime5_5 - nTime5_4, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "      - ProcessSpecialTxsInBlock: %.2fms [%.2fs]\n", 0.001 * (nTime5_5 - nTime5_4), nTimeProcessSpecial * 0.000001);
 
-    int64_t nTime5 = GetTimeMicros(); nTimeXazabSpecific += nTime5 - nTime4;
+    int64_t nTime5 = GetTimeMicros(); int64_t nTimeXazabSpecific = blockConnectStats.Record(BLOCK_STAGE_XAZAB_SPECIFIC, nTime5 - nTime4, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "    - Xazab specific: %.2fms [%.2fs]\n", 0.001 * (nTime5 - nTime4), nTimeXazabSpecific * 0.000001);
 
     // END XAZAB
@@ -2281,33 +2453,15 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         if (!pblocktree->WriteTxIndex(vPos))
             return AbortNode(state, "Failed to write transaction index");
 
-    if (fAddressIndex) {
-        if (!pblocktree->WriteAddressIndex(addressIndex)) {
-            return AbortNode(state, "Failed to write address index");
-        }
-
-        if (!pblocktree->UpdateAddressUnspentIndex(addressUnspentIndex)) {
-            return AbortNode(state, "Failed to write address unspent index");
-        }
-    }
-
-    if (fSpentIndex)
-        if (!pblocktree->UpdateSpentIndex(spentIndex))
-            return AbortNode(state, "Failed to write transaction index");
-
-    if (fTimestampIndex)
-        if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(pindex->nTime, pindex->GetBlockHash())))
-            return AbortNode(state, "Failed to write timestamp index");
-
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
 
-    int64_t nTime6 = GetTimeMicros(); nTimeIndex += nTime6 - nTime5;
+    int64_t nTime6 = GetTimeMicros(); int64_t nTimeIndex = blockConnectStats.Record(BLOCK_STAGE_INDEX_WRITES, nTime6 - nTime5, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "    - Index writing: %.2fms [%.2fs]\n", 0.001 * (nTime6 - nTime5), nTimeIndex * 0.000001);
 
     evoDb->WriteBestBlock(pindex->GetBlockHash());
 
-    int64_t nTime7 = GetTimeMicros(); nTimeCallbacks += nTime7 - nTime6;
+    int64_t nTime7 = GetTimeMicros(); int64_t nTimeCallbacks = blockConnectStats.Record(BLOCK_STAGE_CALLBACKS, nTime7 - nTime6, !fJustCheck);
     LogPrint(BCLog::BENCHMARK, "    - Callbacks: %.2fms [%.2fs]\n", 0.001 * (nTime7 - nTime6), nTimeCallbacks * 0.000001);
 
     return true;
@@ -2330,6 +2484,9 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
     bool fDoFullFlush = false;
     int64_t nNow = 0;
     try {
+    if (pcoinsflusher && pcoinsflusher->HasFailed()) {
+        return AbortNode(state, "Failed to write to coin database");
+    }
     {
         LOCK(cs_LastBlockFile);
         if (fPruneMode && (fCheckForPruning || nManualPruneHeight > 0) && !fReindex) {
@@ -2361,6 +2518,10 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
         int64_t nMempoolSizeMax = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
         int64_t cacheSize = pcoinsTip->DynamicMemoryUsage();
     cacheSize += evoDb->GetMemoryUsage();
+        if (pcoinsflusher) {
+            // the coins of the last flush count until they are written
+            cacheSize += pcoinsflusher->DynamicMemoryUsage();
+        }
         int64_t nTotalSpace = nCoinCacheUsage + std::max<int64_t>(nMempoolSizeMax - nMempoolUsage, 0);
         // The cache is large and we're within 10% and 10 MiB of the limit, but we have time now (not in the middle of a block processing).
         bool fCacheLarge = mode == FLUSH_STATE_PERIODIC && cacheSize > std::max((9 * nTotalSpace) / 10, nTotalSpace - MAX_BLOCK_COINSDB_USAGE * 1024 * 1024);
@@ -2398,8 +2559,15 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
                 }
             }
             // Finally remove any pruned files
-            if (fFlushForPrune)
+            if (fFlushForPrune) {
+                // With -backgroundflush the previous chainstate write might still be running. Until it is done,
+                // a crash would leave a chainstate which has to be replayed from the blocks which are removed here.
+                if (pcoinsflusher && !pcoinsflusher->WaitForWrite())
+                    return AbortNode(state, "Failed to write to coin database");
+                if (!evoDb->WaitForCommits())
+                    return AbortNode(state, "Failed to commit EvoDB");
                 UnlinkPrunedFiles(setFilesToPrune);
+            }
             nLastWrite = nNow;
         }
         // Flush best chain related state. This can only be done if the blocks / block index write was also done.
@@ -2411,11 +2579,17 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
             // overwrite one. Still, use a conservative safety factor of 2.
             if (!CheckDiskSpace(48 * 2 * 2 * pcoinsTip->GetCacheSize()))
                 return state.Error("out of disk space");
-            // Flush the chainstate (which may refer to block index entries).
+            // Flush the chainstate (which may refer to block index entries). With -backgroundflush it is written
+            // by pcoinsflusher's thread, only a full flush waits for it.
             if (!pcoinsTip->Flush())
                 return AbortNode(state, "Failed to write to coin database");
+            if (mode == FLUSH_STATE_ALWAYS && pcoinsflusher && !pcoinsflusher->WaitForWrite())
+                return AbortNode(state, "Failed to write to coin database");
         if (!evoDb->CommitRootTransaction()) {
             return AbortNode(state, "Failed to commit EvoDB");
+        }
+        if (mode == FLUSH_STATE_ALWAYS && !evoDb->WaitForCommits()) {
+            return AbortNode(state, "Failed to commit EvoDB");
         }
             nLastFlush = nNow;
         }
@@ -2568,11 +2742,6 @@ bool static DisconnectTip(CValidationState& state, const CChainParams& chainpara
     return true;
 }
 
-static int64_t nTimeReadFromDisk = 0;
-static int64_t nTimeConnectTotal = 0;
-static int64_t nTimeFlush = 0;
-static int64_t nTimeChainState = 0;
-static int64_t nTimePostConnect = 0;
 
 struct PerBlockConnectTrace {
     CBlockIndex* pindex = nullptr;
@@ -2661,9 +2830,19 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     }
     const CBlock& blockConnecting = *pthisBlock;
     // Apply the block atomically to the chain state.
-    int64_t nTime2 = GetTimeMicros(); nTimeReadFromDisk += nTime2 - nTime1;
+    int64_t nTime2 = GetTimeMicros(); int64_t nTimeReadFromDisk = blockConnectStats.Record(BLOCK_STAGE_READ_FROM_DISK, nTime2 - nTime1);
     int64_t nTime3;
     LogPrint(BCLog::BENCHMARK, "  - Load block from disk: %.2fms [%.2fs]\n", (nTime2 - nTime1) * 0.001, nTimeReadFromDisk * 0.000001);
+    if (fPrefetchInputs && nScriptCheckThreads) {
+        int64_t nReadMicros;
+        size_t nPrefetched = PrefetchBlockInputs(blockConnecting, nReadMicros);
+        int64_t nTimePrefetched = GetTimeMicros();
+        int64_t nTimePrefetch = blockConnectStats.Record(BLOCK_STAGE_PREFETCH_INPUTS, nTimePrefetched - nTime2);
+        int64_t nTimePrefetchReads = blockConnectStats.Record(BLOCK_STAGE_PREFETCH_INPUTS_READS, nReadMicros);
+        LogPrint(BCLog::BENCHMARK, "  - Prefetch %u inputs: %.2fms, reads %.2fms [%.2fs, reads %.2fs]\n", nPrefetched,
+                 (nTimePrefetched - nTime2) * 0.001, nReadMicros * 0.001, nTimePrefetch * 0.000001, nTimePrefetchReads * 0.000001);
+        nTime2 = nTimePrefetched;
+    }
     {
         auto dbTx = evoDb->BeginTransaction();
 
@@ -2675,18 +2854,18 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
                 InvalidBlockFound(pindexNew, state);
             return error("ConnectTip(): ConnectBlock %s failed with %s", pindexNew->GetBlockHash().ToString(), FormatStateMessage(state));
         }
-        nTime3 = GetTimeMicros(); nTimeConnectTotal += nTime3 - nTime2;
+        nTime3 = GetTimeMicros(); int64_t nTimeConnectTotal = blockConnectStats.Record(BLOCK_STAGE_CONNECT_TOTAL, nTime3 - nTime2);
         LogPrint(BCLog::BENCHMARK, "  - Connect total: %.2fms [%.2fs]\n", (nTime3 - nTime2) * 0.001, nTimeConnectTotal * 0.000001);
         bool flushed = view.Flush();
         assert(flushed);
         dbTx->Commit();
     }
-    int64_t nTime4 = GetTimeMicros(); nTimeFlush += nTime4 - nTime3;
+    int64_t nTime4 = GetTimeMicros(); int64_t nTimeFlush = blockConnectStats.Record(BLOCK_STAGE_FLUSH, nTime4 - nTime3);
     LogPrint(BCLog::BENCHMARK, "  - Flush: %.2fms [%.2fs]\n", (nTime4 - nTime3) * 0.001, nTimeFlush * 0.000001);
     // Write the chain state to disk, if necessary.
     if (!FlushStateToDisk(chainparams, state, FLUSH_STATE_IF_NEEDED))
         return false;
-    int64_t nTime5 = GetTimeMicros(); nTimeChainState += nTime5 - nTime4;
+    int64_t nTime5 = GetTimeMicros(); int64_t nTimeChainState = blockConnectStats.Record(BLOCK_STAGE_WRITE_CHAINSTATE, nTime5 - nTime4);
     LogPrint(BCLog::BENCHMARK, "  - Writing chainstate: %.2fms [%.2fs]\n", (nTime5 - nTime4) * 0.001, nTimeChainState * 0.000001);
     // Remove conflicting transactions from the mempool.;
     mempool.removeForBlock(blockConnecting.vtx, pindexNew->nHeight);
@@ -2694,10 +2873,13 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
 
-    int64_t nTime6 = GetTimeMicros(); nTimePostConnect += nTime6 - nTime5; nTimeTotal += nTime6 - nTime1;
+    int64_t nTime6 = GetTimeMicros(); int64_t nTimePostConnect = blockConnectStats.Record(BLOCK_STAGE_POST_CONNECT, nTime6 - nTime5);
+    int64_t nTimeTotal = blockConnectStats.Record(BLOCK_STAGE_TOTAL, nTime6 - nTime1);
     LogPrint(BCLog::BENCHMARK, "  - Connect postprocess: %.2fms [%.2fs]\n", (nTime6 - nTime5) * 0.001, nTimePostConnect * 0.000001);
     LogPrint(BCLog::BENCHMARK, "- Connect block: %.2fms [%.2fs]\n", (nTime6 - nTime1) * 0.001, nTimeTotal * 0.000001);
 
+    // Blocks which were just connected are the ones most likely to be read again
+    blockReadCache.Add(pthisBlock);
     connectTrace.BlockConnected(pindexNew, std::move(pthisBlock));
     return true;
 }
@@ -3790,6 +3972,8 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune)
 {
     for (std::set<int>::iterator it = setFilesToPrune.begin(); it != setFilesToPrune.end(); ++it) {
         CDiskBlockPos pos(*it, 0);
+        blockFileMap.Remove(*it);
+        undoFileMap.Remove(*it);
         fs::remove(GetBlockPosFilename(pos, "blk"));
         fs::remove(GetBlockPosFilename(pos, "rev"));
         LogPrintf("Prune: %s deleted blk/rev (%05u)\n", __func__, *it);
@@ -4059,18 +4243,6 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     pblocktree->ReadFlag("txindex", fTxIndex);
     LogPrintf("%s: transaction index %s\n", __func__, fTxIndex ? "enabled" : "disabled");
 
-    // Check whether we have an address index
-    pblocktree->ReadFlag("addressindex", fAddressIndex);
-    LogPrintf("%s: address index %s\n", __func__, fAddressIndex ? "enabled" : "disabled");
-
-    // Check whether we have a timestamp index
-    pblocktree->ReadFlag("timestampindex", fTimestampIndex);
-    LogPrintf("%s: timestamp index %s\n", __func__, fTimestampIndex ? "enabled" : "disabled");
-
-    // Check whether we have a spent index
-    pblocktree->ReadFlag("spentindex", fSpentIndex);
-    LogPrintf("%s: spent index %s\n", __func__, fSpentIndex ? "enabled" : "disabled");
-
     return true;
 }
 
@@ -4349,17 +4521,6 @@ bool LoadBlockIndex(const CChainParams& chainparams)
         fTxIndex = gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX);
         pblocktree->WriteFlag("txindex", fTxIndex);
 
-        // Use the provided setting for -addressindex in the new database
-        fAddressIndex = gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX);
-        pblocktree->WriteFlag("addressindex", fAddressIndex);
-
-        // Use the provided setting for -timestampindex in the new database
-        fTimestampIndex = gArgs.GetBoolArg("-timestampindex", DEFAULT_TIMESTAMPINDEX);
-        pblocktree->WriteFlag("timestampindex", fTimestampIndex);
-
-        // Use the provided setting for -spentindex in the new database
-        fSpentIndex = gArgs.GetBoolArg("-spentindex", DEFAULT_SPENTINDEX);
-        pblocktree->WriteFlag("spentindex", fSpentIndex);
     }
     return true;
 }
@@ -4745,7 +4906,6 @@ static const uint64_t MEMPOOL_DUMP_VERSION = 1;
 
 bool LoadMempool(void)
 {
-    const CChainParams& chainparams = Params();
     int64_t nExpiryTimeout = gArgs.GetArg("-mempoolexpiry", DEFAULT_MEMPOOL_EXPIRY) * 60 * 60;
     FILE* filestr = fsbridge::fopen(GetDataDir() / "mempool.dat", "rb");
     CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
@@ -4767,6 +4927,25 @@ bool LoadMempool(void)
         }
         uint64_t num;
         file >> num;
+
+        // Transactions are accepted in batches so that their scripts can be verified in parallel
+        std::vector<CTransactionRef> vtx;
+        std::vector<int64_t> vAcceptTime;
+        std::vector<CValidationState> vState;
+        std::vector<bool> vAccepted;
+        auto acceptBatch = [&]() {
+            AcceptToMemoryPoolBatch(mempool, vtx, true, vState, vAccepted, &vAcceptTime);
+            for (const auto& state : vState) {
+                if (state.IsValid()) {
+                    ++count;
+                } else {
+                    ++failed;
+                }
+            }
+            vtx.clear();
+            vAcceptTime.clear();
+        };
+
         while (num--) {
             CTransactionRef tx;
             int64_t nTime;
@@ -4779,14 +4958,11 @@ bool LoadMempool(void)
             if (amountdelta) {
                 mempool.PrioritiseTransaction(tx->GetHash(), amountdelta);
             }
-            CValidationState state;
             if (nTime + nExpiryTimeout > nNow) {
-                LOCK(cs_main);
-                AcceptToMemoryPoolWithTime(chainparams, mempool, state, tx, true, nullptr, nTime, false, 0, false);
-                if (state.IsValid()) {
-                    ++count;
-                } else {
-                    ++failed;
+                vtx.emplace_back(tx);
+                vAcceptTime.emplace_back(nTime);
+                if (vtx.size() >= DEFAULT_TX_BATCH_SIZE) {
+                    acceptBatch();
                 }
             } else {
                 ++skipped;
@@ -4794,6 +4970,9 @@ bool LoadMempool(void)
             if (ShutdownRequested())
                 return false;
         }
+        if (!vtx.empty()) {
+            acceptBatch();
+        }
         std::map<uint256, CAmount> mapDeltas;
         file >> mapDeltas;
 
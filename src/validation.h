@@ -34,7 +34,9 @@
 
 class CBlockIndex;
 class CBlockTreeDB;
+class CBlockUndo;
 class CChainParams;
+class CCoinsViewBackgroundFlush;
 class CCoinsViewDB;
 class CInv;
 class CConnman;
@@ -78,6 +80,8 @@ static const unsigned int BLOCKFILE_CHUNK_SIZE = 0x1000000; // 16 MiB
 /** The pre-allocation chunk size for rev?????.dat files (since 0.8) */
 static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 
+/** Default for -txbatchsize, maximum number of queued transactions which are script-checked in parallel */
+static const unsigned int DEFAULT_TX_BATCH_SIZE = 100;
 /** Maximum number of script-checking threads allowed */
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
@@ -134,6 +138,8 @@ static const int64_t MAX_FEE_ESTIMATION_TIP_AGE = 3 * 60 * 60;
 static const bool DEFAULT_PERMIT_BAREMULTISIG = true;
 static const unsigned int DEFAULT_BYTES_PER_SIGOP = 20;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
+/** Default for -prefetchinputs */
+static const bool DEFAULT_PREFETCH_INPUTS = true;
 static const bool DEFAULT_TXINDEX = true;
 static const bool DEFAULT_ADDRESSINDEX = false;
 static const bool DEFAULT_TIMESTAMPINDEX = false;
@@ -185,6 +191,7 @@ extern bool fRequireStandard;
 extern unsigned int nBytesPerSigOp;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
+extern bool fPrefetchInputs;
 extern size_t nCoinCacheUsage;
 /** A fee rate smaller than this is considered zero fee (for relaying, mining and transaction creation) */
 extern CFeeRate minRelayTxFee;
@@ -286,6 +293,8 @@ bool LoadChainTip(const CChainParams& chainparams);
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the thread which reads the inputs of the block being connected ahead of time */
+void ThreadPrefetchInputs();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
@@ -324,6 +333,37 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransa
                         bool* pfMissingInputs, bool fOverrideMempoolLimit=false,
                         const CAmount nAbsurdFee=0, bool fDryRun=false);
 
+/**
+ * Run the script checks of all inputs of the given transactions, in parallel on the script check threads
+ * if there are any. All inputs have to be available in inputs. Returns false if any of the checks failed.
+ */
+bool CheckInputsParallel(const std::vector<CTransactionRef>& vtx, const CCoinsViewCache& inputs, unsigned int flags, bool cacheSigStore);
+
+/**
+ * Verify the scripts of a batch of transactions in parallel on the script check threads, without holding
+ * cs_main while doing so. Successful signature checks are stored in the signature cache, so that the following
+ * AcceptToMemoryPool calls for the same transactions don't have to verify signatures while holding cs_main.
+ * Transactions which fail the cheap policy checks, which conflict with the mempool or an earlier transaction
+ * of the batch, or which have missing inputs (orphans and transactions spending other transactions of the same
+ * batch) are skipped and left to AcceptToMemoryPool.
+ * The spent coins which had to be read from disk are uncached again, unless pvCoinsToUncache is set. It then
+ * receives them per transaction, so that AcceptToMemoryPool finds them in the cache and the caller can uncache
+ * the coins of the transactions which were not accepted.
+ * Returns the number of transactions for which the scripts were verified.
+ */
+size_t PrevalidateTransactionScripts(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, std::vector<std::vector<COutPoint> >* pvCoinsToUncache = nullptr);
+
+/**
+ * (try to) add a batch of transactions to memory pool. Scripts of the whole batch are verified in
+ * parallel first (see PrevalidateTransactionScripts), the results are then committed one after another
+ * in the given order. vState and vAccepted are resized to vtx.size() and hold the individual results.
+ * If pvAcceptTime is set, it holds the acceptance time of each transaction.
+ * Returns the number of accepted transactions.
+ */
+size_t AcceptToMemoryPoolBatch(CTxMemPool& pool, const std::vector<CTransactionRef>& vtx, bool fLimitFree,
+                               std::vector<CValidationState>& vState, std::vector<bool>& vAccepted,
+                               const std::vector<int64_t>* pvAcceptTime = nullptr);
+
 bool GetUTXOCoin(const COutPoint& outpoint, Coin& coin);
 int GetUTXOHeight(const COutPoint& outpoint);
 int GetUTXOConfirmations(const COutPoint& outpoint);
@@ -415,8 +455,15 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
 bool GetAddressIndex(uint160 addressHash, int type,
                      std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
                      int start = 0, int end = 0);
+bool GetAddressBalance(uint160 addressHash, int type, CAddressBalanceValue &value);
 bool GetAddressUnspent(uint160 addressHash, int type,
                        std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs);
+bool GetAddressIndexPage(const CAddressIndexKey &startKey, int end, size_t nLimit,
+                         std::vector<std::pair<CAddressIndexKey, CAmount> > &addressIndex,
+                         CAddressIndexKey &nextKey, bool &fMore);
+bool GetAddressUnspentPage(const CAddressUnspentKey &startKey, size_t nLimit,
+                           std::vector<std::pair<CAddressUnspentKey, CAddressUnspentValue> > &unspentOutputs,
+                           CAddressUnspentKey &nextKey, bool &fMore);
 /** Initializes the script-execution cache */
 void InitScriptExecutionCache();
 
@@ -424,6 +471,7 @@ void InitScriptExecutionCache();
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uint256& hashBlock);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -466,6 +514,9 @@ extern CChain chainActive;
 /** Global variable that points to the coins database (protected by cs_main) */
 extern CCoinsViewDB *pcoinsdbview;
 
+/** Global variable that points to the layer between pcoinsTip and pcoinsdbview, which may still be writing a flush (protected by cs_main) */
+extern CCoinsViewBackgroundFlush *pcoinsflusher;
+
 /** Global variable that points to the active CCoinsView (protected by cs_main) */
 extern CCoinsViewCache *pcoinsTip;
 
@@ -7,6 +7,9 @@
 
 #include "zmqconfig.h"
 
+#include <atomic>
+#include <vector>
+
 class CBlockIndex;
 class CGovernanceObject;
 class CGovernanceVote;
@@ -22,7 +25,9 @@ typedef CZMQAbstractNotifier* (*CZMQNotifierFactory)();
 class CZMQAbstractNotifier
 {
 public:
-    CZMQAbstractNotifier() : psocket(0) { }
+    static const int DEFAULT_ZMQ_SNDHWM = 1000;
+
+    CZMQAbstractNotifier() : psocket(0), outbound_message_high_water_mark(DEFAULT_ZMQ_SNDHWM), nBatchSize(1) { }
     virtual ~CZMQAbstractNotifier();
 
     template <typename T>
@@ -35,6 +40,35 @@ public:
     void SetType(const std::string &t) { type = t; }
     std::string GetAddress() const { return address; }
     void SetAddress(const std::string &a) { address = a; }
+    /** Maximum number of messages which may be queued for sending, further messages are dropped */
+    int GetOutboundMessageHighWaterMark() const { return outbound_message_high_water_mark; }
+    void SetOutboundMessageHighWaterMark(const int sndhwm) {
+        if (sndhwm >= 0) {
+            outbound_message_high_water_mark = sndhwm;
+        }
+    }
+    /** Maximum number of queued messages which are sent together in one multipart message */
+    int GetBatchSize() const { return nBatchSize; }
+    void SetBatchSize(const int n) {
+        if (n >= 1) {
+            nBatchSize = n;
+        }
+    }
+
+    /** Memory usage of the recent messages which are kept for GetReplayMessages(), 0 to keep none */
+    size_t GetReplayBufferSize() const { return nReplayBufferSize; }
+    void SetReplayBufferSize(const size_t n) { nReplayBufferSize = n; }
+    /**
+     * Appends up to nMaxCount kept messages with a sequence number of at least nFromSequence to vRet, and sets
+     * nFirstRet and nNextRet to the oldest kept and the next sequence number. Returns false if the notifier
+     * doesn't keep messages.
+     */
+    virtual bool GetReplayMessages(uint32_t nFromSequence, size_t nMaxCount, std::vector<std::pair<uint32_t, std::vector<unsigned char> > >& vRet,
+                                   uint32_t& nFirstRet, uint32_t& nNextRet) const { return false; }
+
+    uint64_t GetSentCount() const { return nSent; }
+    uint64_t GetDroppedCount() const { return nDropped; }
+    virtual size_t GetQueuedCount() const { return 0; }
 
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
@@ -52,6 +86,11 @@ protected:
     void *psocket;
     std::string type;
     std::string address;
+    int outbound_message_high_water_mark; // aka SNDHWM
+    int nBatchSize;
+    size_t nReplayBufferSize{0};
+    std::atomic<uint64_t> nSent{0};
+    std::atomic<uint64_t> nDropped{0};
 };
 
 #endif // BITCOIN_ZMQ_ZMQABSTRACTNOTIFIER_H
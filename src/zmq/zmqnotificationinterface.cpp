@@ -15,6 +15,8 @@ void zmqError(const char *str)
     LogPrint(BCLog::ZMQ, "zmq: Error: %s, errno=%s\n", str, zmq_strerror(errno));
 }
 
+CZMQNotificationInterface* g_zmq_notification_interface = nullptr;
+
 CZMQNotificationInterface::CZMQNotificationInterface() : pcontext(nullptr)
 {
 }
@@ -62,6 +64,9 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
             CZMQAbstractNotifier *notifier = factory();
             notifier->SetType(i->first);
             notifier->SetAddress(address);
+            notifier->SetOutboundMessageHighWaterMark(gArgs.GetArg(arg + "hwm", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM));
+            notifier->SetBatchSize(gArgs.GetArg(arg + "batch", 1));
+            notifier->SetReplayBufferSize(std::max<int64_t>(0, gArgs.GetArg(arg + "replay", 0)) * 1024);
             notifiers.push_back(notifier);
         }
     }
@@ -81,6 +86,15 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     return notificationInterface;
 }
 
+std::list<const CZMQAbstractNotifier*> CZMQNotificationInterface::GetActiveNotifiers() const
+{
+    std::list<const CZMQAbstractNotifier*> result;
+    for (const auto* n : notifiers) {
+        result.push_back(n);
+    }
+    return result;
+}
+
 // Called at startup to conditionally set up ZMQ socket(s)
 bool CZMQNotificationInterface::Initialize()
 {
@@ -115,6 +129,8 @@ bool CZMQNotificationInterface::Initialize()
         return false;
     }
 
+    StartZMQPublishThread();
+
     return true;
 }
 
@@ -124,6 +140,9 @@ void CZMQNotificationInterface::Shutdown()
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
     if (pcontext)
     {
+        // send what is still queued before the sockets are closed
+        StopZMQPublishThread();
+
         for (std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin(); i!=notifiers.end(); ++i)
         {
             CZMQAbstractNotifier *notifier = *i;
@@ -4,11 +4,17 @@
 
 #include "chain.h"
 #include "chainparams.h"
+#include "memusage.h"
 #include "streams.h"
 #include "zmqpublishnotifier.h"
 #include "validation.h"
 #include "util.h"
 
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
 static const char *MSG_HASHBLOCK     = "hashblock";
@@ -29,46 +35,170 @@ static const char *MSG_RAWGOBJ       = "rawgovernanceobject";
 static const char *MSG_RAWISCON      = "rawinstantsenddoublespend";
 
 // Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
+static int zmq_send_multipart(void *sock, const std::vector<std::pair<const void*, size_t> >& parts)
 {
-    va_list args;
-    va_start(args, size);
-
-    while (1)
+    for (size_t i = 0; i < parts.size(); i++)
     {
         zmq_msg_t msg;
 
-        int rc = zmq_msg_init_size(&msg, size);
+        int rc = zmq_msg_init_size(&msg, parts[i].second);
         if (rc != 0)
         {
             zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
             return -1;
         }
 
         void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
-
-        data = va_arg(args, const void*);
+        memcpy(buf, parts[i].first, parts[i].second);
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
+        rc = zmq_msg_send(&msg, sock, i + 1 < parts.size() ? ZMQ_SNDMORE : 0);
         if (rc == -1)
         {
             zmqError("Unable to send ZMQ msg");
             zmq_msg_close(&msg);
-            va_end(args);
             return -1;
         }
 
         zmq_msg_close(&msg);
+    }
+    return 0;
+}
 
-        if (!data)
-            break;
+/**
+ * Messages of all publish notifiers are sent by a dedicated thread, so the validation interface callbacks
+ * only serialize their data and don't wait for zmq. Each notifier may have up to its high water mark of
+ * messages queued, further messages are dropped and counted.
+ */
+class CZMQPublishQueue
+{
+private:
+    struct Message
+    {
+        CZMQAbstractPublishNotifier* notifier;
+        const char* command;
+        std::vector<unsigned char> data;
+    };
+
+    std::mutex cs;
+    std::condition_variable cond;
+    std::list<Message> queue;
+    bool fRunning{false};
+    bool fStop{false};
+    std::thread thread;
+    //! held while sending, so a notifier can't close its socket meanwhile
+    std::mutex csSend;
+
+    void ThreadMain()
+    {
+        RenameThread("xazab-zmqpub");
+        while (true) {
+            CZMQAbstractPublishNotifier* notifier;
+            const char* command;
+            std::vector<std::vector<unsigned char> > vData;
+            std::unique_lock<std::mutex> lockSend(csSend, std::defer_lock);
+            {
+                std::unique_lock<std::mutex> lock(cs);
+                while (!fStop && queue.empty()) {
+                    cond.wait(lock);
+                }
+                if (queue.empty()) {
+                    return;
+                }
+                notifier = queue.front().notifier;
+                command = queue.front().command;
+                // batch the directly following messages of the same notifier. Messages are never sent ahead of
+                // earlier messages of other notifiers, subscribers of multiple topics rely on their order.
+                while (!queue.empty() && queue.front().notifier == notifier && queue.front().command == command &&
+                       (int)vData.size() < notifier->GetBatchSize()) {
+                    vData.emplace_back(std::move(queue.front().data));
+                    queue.pop_front();
+                }
+                notifier->nQueued -= vData.size();
+                // taken before releasing cs, so Remove() can't return before this send is done
+                lockSend.lock();
+            }
+
+            if (!notifier->SendMultipart(command, vData)) {
+                notifier->nDropped += vData.size();
+            }
+        }
+    }
 
-        size = va_arg(args, size_t);
+public:
+    void Start()
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        if (fRunning) {
+            return;
+        }
+        fRunning = true;
+        fStop = false;
+        thread = std::thread(&CZMQPublishQueue::ThreadMain, this);
     }
-    va_end(args);
-    return 0;
+
+    void Stop()
+    {
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            if (!fRunning) {
+                return;
+            }
+            fStop = true;
+            cond.notify_all();
+        }
+        thread.join();
+        std::unique_lock<std::mutex> lock(cs);
+        fRunning = false;
+    }
+
+    bool Push(CZMQAbstractPublishNotifier* notifier, const char* command, const void* data, size_t size)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        int nHighWaterMark = notifier->GetOutboundMessageHighWaterMark();
+        // like for zmq itself, a high water mark of 0 means no limit
+        if (!fRunning || fStop || (nHighWaterMark > 0 && notifier->nQueued >= (size_t)nHighWaterMark)) {
+            return false;
+        }
+        queue.push_back(Message{notifier, command, std::vector<unsigned char>((const unsigned char*)data, (const unsigned char*)data + size)});
+        notifier->nQueued++;
+        cond.notify_one();
+        return true;
+    }
+
+    /** Drops the queued messages of a notifier which is shut down and waits for a running send to finish */
+    void Remove(CZMQAbstractPublishNotifier* notifier)
+    {
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            for (auto it = queue.begin(); it != queue.end(); ) {
+                if (it->notifier == notifier) {
+                    it = queue.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            notifier->nQueued = 0;
+        }
+        std::lock_guard<std::mutex> lockSend(csSend);
+    }
+
+    size_t GetQueuedCount(const CZMQAbstractPublishNotifier* notifier)
+    {
+        std::unique_lock<std::mutex> lock(cs);
+        return notifier->nQueued;
+    }
+};
+
+static CZMQPublishQueue publishQueue;
+
+void StartZMQPublishThread()
+{
+    publishQueue.Start();
+}
+
+void StopZMQPublishThread()
+{
+    publishQueue.Stop();
 }
 
 bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
@@ -87,7 +217,17 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
             return false;
         }
 
-        int rc = zmq_bind(psocket, address.c_str());
+        LogPrint(BCLog::ZMQ, "zmq: Outbound message high water mark for %s at %s is %d\n", type, address, outbound_message_high_water_mark);
+
+        int rc = zmq_setsockopt(psocket, ZMQ_SNDHWM, &outbound_message_high_water_mark, sizeof(outbound_message_high_water_mark));
+        if (rc != 0)
+        {
+            zmqError("Failed to set outbound message high water mark");
+            zmq_close(psocket);
+            return false;
+        }
+
+        rc = zmq_bind(psocket, address.c_str());
         if (rc!=0)
         {
             zmqError("Failed to bind address");
@@ -114,6 +254,8 @@ void CZMQAbstractPublishNotifier::Shutdown()
 {
     assert(psocket);
 
+    publishQueue.Remove(this);
+
     int count = mapPublishNotifiers.count(address);
 
     // remove this notifier from the list of publishers using this address
@@ -144,16 +286,84 @@ bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* d
 {
     assert(psocket);
 
-    /* send three parts, command & data & a LE 4byte sequence number */
+    if (!publishQueue.Push(this, command, data, size)) {
+        LogPrint(BCLog::ZMQ, "zmq: Dropped %s message, %d messages are queued already\n", command, outbound_message_high_water_mark);
+        nDropped++;
+    }
+    // dropping a message doesn't disable the notifier
+    return true;
+}
+
+bool CZMQAbstractPublishNotifier::SendMultipart(const char *command, const std::vector<std::vector<unsigned char> >& vData)
+{
+    assert(psocket);
+
+    /* send command & data & a LE 4byte sequence number */
     unsigned char msgseq[sizeof(uint32_t)];
     WriteLE32(&msgseq[0], nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), (void*)0);
+    std::vector<std::pair<const void*, size_t> > parts;
+    parts.emplace_back(command, strlen(command));
+    for (const auto& data : vData)
+        parts.emplace_back(data.data(), data.size());
+    parts.emplace_back(msgseq, sizeof(msgseq));
+    int rc = zmq_send_multipart(psocket, parts);
     if (rc == -1)
         return false;
 
-    /* increment memory only sequence number after sending */
-    nSequence++;
+    if (nReplayBufferSize > 0) {
+        std::lock_guard<std::mutex> lock(csReplay);
+        for (size_t i = 0; i < vData.size(); i++) {
+            replayBuffer.emplace_back(nSequence + i, vData[i]);
+            nReplayUsage += memusage::DynamicUsage(replayBuffer.back().second) + sizeof(replayBuffer.back());
+        }
+        while (nReplayUsage > nReplayBufferSize && !replayBuffer.empty()) {
+            nReplayUsage -= memusage::DynamicUsage(replayBuffer.front().second) + sizeof(replayBuffer.front());
+            replayBuffer.pop_front();
+        }
+        nReplayNext = nSequence + vData.size();
+    }
+
+    /* increment memory only sequence number after sending, once per message */
+    nSequence += vData.size();
+    nSent += vData.size();
+
+    return true;
+}
+
+size_t CZMQAbstractPublishNotifier::GetQueuedCount() const
+{
+    return publishQueue.GetQueuedCount(this);
+}
+
+bool CZMQAbstractPublishNotifier::GetReplayMessages(uint32_t nFromSequence, size_t nMaxCount, std::vector<std::pair<uint32_t, std::vector<unsigned char> > >& vRet,
+                                                    uint32_t& nFirstRet, uint32_t& nNextRet) const
+{
+    if (nReplayBufferSize == 0) {
+        return false;
+    }
 
+    std::lock_guard<std::mutex> lock(csReplay);
+    nNextRet = nReplayNext;
+    if (replayBuffer.empty()) {
+        nFirstRet = nNextRet;
+        return true;
+    }
+    nFirstRet = replayBuffer.front().first;
+
+    // the sequence numbers wrap around, so compare their distances
+    size_t nStart;
+    uint32_t nOffset = nFromSequence - nFirstRet;
+    if (nOffset <= replayBuffer.size()) {
+        nStart = nOffset;
+    } else if ((uint32_t)(nFirstRet - nFromSequence) < 0x80000000) {
+        // older than the oldest kept message
+        nStart = 0;
+    } else {
+        nStart = replayBuffer.size();
+    }
+    for (size_t i = nStart; i < replayBuffer.size() && vRet.size() < nMaxCount; i++) {
+        vRet.push_back(replayBuffer[i]);
+    }
     return true;
 }
 
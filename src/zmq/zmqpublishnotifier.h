@@ -7,6 +7,9 @@
 
 #include "zmqabstractnotifier.h"
 
+#include <deque>
+#include <mutex>
+
 class CBlockIndex;
 class CGovernanceVote;
 class CGovernanceObject;
@@ -14,22 +17,43 @@ class CGovernanceObject;
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
 private:
-    uint32_t nSequence; //!< upcounting per message sequence number
+    uint32_t nSequence{0}; //!< upcounting per message sequence number, only used by the publish thread
+    size_t nQueued{0}; //!< number of messages waiting in the publish queue, guarded by its lock
 
-public:
+    mutable std::mutex csReplay;
+    //! the most recently sent messages with consecutive sequence numbers, oldest first
+    std::deque<std::pair<uint32_t, std::vector<unsigned char> > > replayBuffer;
+    size_t nReplayUsage{0};
+    uint32_t nReplayNext{0}; //!< copy of nSequence guarded by csReplay
+
+    friend class CZMQPublishQueue;
 
     /* send zmq multipart message
        parts:
           * command
-          * data
-          * message sequence number
+          * data (one part per message if several messages are batched)
+          * message sequence number of the first message
     */
+    bool SendMultipart(const char *command, const std::vector<std::vector<unsigned char> >& vData);
+
+public:
+
+    /* queue a message for the publish thread, it is dropped if the high water mark is reached */
     bool SendMessage(const char *command, const void* data, size_t size);
 
+    size_t GetQueuedCount() const override;
+    bool GetReplayMessages(uint32_t nFromSequence, size_t nMaxCount, std::vector<std::pair<uint32_t, std::vector<unsigned char> > >& vRet,
+                           uint32_t& nFirstRet, uint32_t& nNextRet) const override;
+
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
 };
 
+/** Start the thread which sends the messages of all publish notifiers, after they were initialized */
+void StartZMQPublishThread();
+/** Send the remaining messages and stop the publish thread, before the notifiers are shut down */
+void StopZMQPublishThread();
+
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -0,0 +1,152 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "zmq/zmqrpc.h"
+
+#include "rpc/server.h"
+#include "utilstrencodings.h"
+#include "zmq/zmqabstractnotifier.h"
+#include "zmq/zmqnotificationinterface.h"
+
+#include <univalue.h>
+
+namespace {
+
+UniValue getzmqnotifications(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 0) {
+        throw std::runtime_error(
+            "getzmqnotifications\n"
+            "\nReturns information about the active ZeroMQ notifications.\n"
+            "\nResult:\n"
+            "[\n"
+            "  {                        (json object)\n"
+            "    \"type\": \"pubhashtx\",   (string) Type of notification\n"
+            "    \"address\": \"...\",      (string) Address of the publisher\n"
+            "    \"hwm\": n,              (numeric) Maximum number of queued messages, further messages are dropped\n"
+            "    \"batch\": n,            (numeric) Maximum number of messages sent in one multipart message\n"
+            "    \"queued\": n,           (numeric) Number of messages waiting to be sent\n"
+            "    \"sent\": n,             (numeric) Number of messages sent\n"
+            "    \"dropped\": n           (numeric) Number of messages dropped because the queue was full or sending failed\n"
+            "  },\n"
+            "  ...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getzmqnotifications", "")
+            + HelpExampleRpc("getzmqnotifications", "")
+        );
+    }
+
+    UniValue result(UniValue::VARR);
+    if (g_zmq_notification_interface != nullptr) {
+        for (const auto* n : g_zmq_notification_interface->GetActiveNotifiers()) {
+            UniValue obj(UniValue::VOBJ);
+            obj.push_back(Pair("type", n->GetType()));
+            obj.push_back(Pair("address", n->GetAddress()));
+            obj.push_back(Pair("hwm", n->GetOutboundMessageHighWaterMark()));
+            obj.push_back(Pair("batch", n->GetBatchSize()));
+            obj.push_back(Pair("queued", (uint64_t)n->GetQueuedCount()));
+            obj.push_back(Pair("sent", n->GetSentCount()));
+            obj.push_back(Pair("dropped", n->GetDroppedCount()));
+            result.push_back(obj);
+        }
+    }
+
+    return result;
+}
+
+UniValue getzmqreplay(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 2 || request.params.size() > 3) {
+        throw std::runtime_error(
+            "getzmqreplay \"type\" sequence ( count )\n"
+            "\nReturns the recently published messages of a ZeroMQ notification, starting at the given sequence number.\n"
+            "Subscribers can use it to catch up on the messages they missed while they were disconnected.\n"
+            "Only available for notifications with -zmqpub<type>replay=<n>.\n"
+            "\nArguments:\n"
+            "1. \"type\"        (string, required) Type of notification, e.g. pubhashtxlock\n"
+            "2. sequence      (numeric, required) Sequence number of the first message to return\n"
+            "3. count         (numeric, optional, default=" + std::to_string(DEFAULT_ZMQ_REPLAY_COUNT) + ") Maximum number of messages to return\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"first\": n,             (numeric) Sequence number of the oldest message which is kept, messages before it are lost\n"
+            "  \"next\": n,              (numeric) Sequence number of the next message to be published\n"
+            "  \"messages\": [\n"
+            "    {\n"
+            "      \"sequence\": n,      (numeric) Sequence number of the message\n"
+            "      \"data\": \"hex\"       (string) The published data\n"
+            "    },\n"
+            "    ...\n"
+            "  ]\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getzmqreplay", "\"pubhashtxlock\" 100")
+            + HelpExampleRpc("getzmqreplay", "\"pubhashtxlock\", 100")
+        );
+    }
+
+    std::string strType = request.params[0].get_str();
+    int64_t nSequence = request.params[1].get_int64();
+    if (nSequence < 0 || nSequence > std::numeric_limits<uint32_t>::max()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid sequence number");
+    }
+    int nCount = DEFAULT_ZMQ_REPLAY_COUNT;
+    if (!request.params[2].isNull()) {
+        nCount = request.params[2].get_int();
+        if (nCount <= 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid count");
+        }
+    }
+
+    const CZMQAbstractNotifier* notifier = nullptr;
+    if (g_zmq_notification_interface != nullptr) {
+        for (const auto* n : g_zmq_notification_interface->GetActiveNotifiers()) {
+            if (n->GetType() == strType) {
+                notifier = n;
+                break;
+            }
+        }
+    }
+    if (notifier == nullptr) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Notification %s is not active", strType));
+    }
+
+    std::vector<std::pair<uint32_t, std::vector<unsigned char> > > vMessages;
+    uint32_t nFirst, nNext;
+    if (!notifier->GetReplayMessages((uint32_t)nSequence, nCount, vMessages, nFirst, nNext)) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Notification %s doesn't keep messages for replay, see -zmq%sreplay", strType, strType));
+    }
+
+    UniValue messages(UniValue::VARR);
+    for (const auto& msg : vMessages) {
+        UniValue obj(UniValue::VOBJ);
+        obj.push_back(Pair("sequence", (int64_t)msg.first));
+        obj.push_back(Pair("data", HexStr(msg.second)));
+        messages.push_back(obj);
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("first", (int64_t)nFirst));
+    result.push_back(Pair("next", (int64_t)nNext));
+    result.push_back(Pair("messages", messages));
+    return result;
+}
+
+const CRPCCommand commands[] =
+{ //  category              name                      actor (function)         okSafeMode
+  //  --------------------- ------------------------  -----------------------  ----------
+    { "zmq",                "getzmqnotifications",    &getzmqnotifications,    true,  {} },
+    { "zmq",                "getzmqreplay",           &getzmqreplay,           true,  {"type","sequence","count"} },
+};
+
+} // anonymous namespace
+
+void RegisterZMQRPCCommands(CRPCTable& t)
+{
+    for (const auto& c : commands) {
+        t.appendCommand(c.name, &c);
+    }
+    t.appendReadOnlyCommand("getzmqnotifications");
+    t.appendReadOnlyCommand("getzmqreplay");
+}
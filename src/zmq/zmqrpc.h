@@ -0,0 +1,15 @@
+// Copyright (c) 2020 The Dash Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef XAZAB_ZMQ_ZMQRPC_H
+#define XAZAB_ZMQ_ZMQRPC_H
+
+class CRPCTable;
+
+//! Maximum number of messages returned by one getzmqreplay call by default
+static const int DEFAULT_ZMQ_REPLAY_COUNT = 1000;
+
+void RegisterZMQRPCCommands(CRPCTable& t);
+
+#endif // XAZAB_ZMQ_ZMQRPC_H
@@ -35,17 +35,18 @@ class AddressIndexTest(BitcoinTestFramework):
         self.sync_all()
 
     def run_test(self):
-        self.log.info("Test that settings can't be changed without -reindex...")
+        self.log.info("Test that the index can be switched off and on without -reindex...")
         self.stop_node(1)
-        self.assert_start_raises_init_error(1, ["-addressindex=0"], 'You need to rebuild the database using -reindex to change -addressindex')
-        self.start_node(1, ["-addressindex=0", "-reindex"])
+        self.start_node(1, ["-addressindex=0"])
         connect_nodes(self.nodes[0], 1)
         self.sync_all()
+        assert_equal(self.nodes[1].getindexinfo(), {})
         self.stop_node(1)
-        self.assert_start_raises_init_error(1, ["-addressindex"], 'You need to rebuild the database using -reindex to change -addressindex')
-        self.start_node(1, ["-addressindex", "-reindex"])
+        self.start_node(1, ["-addressindex"])
         connect_nodes(self.nodes[0], 1)
         self.sync_all()
+        wait_until(lambda: self.nodes[1].getindexinfo()["addressindex"]["synced"], timeout=60)
+        assert_equal(self.nodes[1].getindexinfo()["addressindex"]["best_block_height"], self.nodes[1].getblockcount())
 
         self.log.info("Mining blocks...")
         self.nodes[0].generate(105)
@@ -166,6 +167,7 @@ class AddressIndexTest(BitcoinTestFramework):
         self.sync_all()
         balance1 = self.nodes[1].getaddressbalance(address2)
         assert_equal(balance1["balance"], amount)
+        assert_equal(balance1["txcount"], 1)
 
         tx = CTransaction()
         tx.vin = [CTxIn(COutPoint(int(spending_txid, 16), 0))]
@@ -181,6 +183,9 @@ class AddressIndexTest(BitcoinTestFramework):
 
         balance2 = self.nodes[1].getaddressbalance(address2)
         assert_equal(balance2["balance"], change_amount)
+        assert_equal(balance2["received"], amount + change_amount)
+        assert_equal(balance2["sent"], amount)
+        assert_equal(balance2["txcount"], 2)
 
         # Check that deltas are returned correctly
         deltas = self.nodes[1].getaddressdeltas({"addresses": [address2], "start": 0, "end": 200})
@@ -195,6 +200,23 @@ class AddressIndexTest(BitcoinTestFramework):
         deltasAll = self.nodes[1].getaddressdeltas({"addresses": [address2]})
         assert_equal(len(deltasAll), len(deltas))
 
+        # Check that deltas can be paged through with a cursor
+        pagedDeltas = []
+        cursor = None
+        while True:
+            params = {"addresses": [address2], "limit": 1}
+            if cursor is not None:
+                params["cursor"] = cursor
+            page = self.nodes[1].getaddressdeltas(params)
+            pagedDeltas += page["deltas"]
+            cursor = page["cursor"]
+            if cursor is None:
+                break
+        assert_equal(pagedDeltas, deltasAll)
+        txidsPage = self.nodes[1].getaddresstxids({"addresses": [address2], "limit": 1})
+        assert_equal(txidsPage["txids"], [deltasAll[0]["txid"]])
+        assert_raises_rpc_error(-8, "Invalid cursor", self.nodes[1].getaddresstxids, {"addresses": [address2], "cursor": "00"})
+
         # Check that deltas can be returned from range of block heights
         deltas = self.nodes[1].getaddressdeltas({"addresses": [address2], "start": 113, "end": 113})
         assert_equal(len(deltas), 1)
@@ -339,6 +361,24 @@ class AddressIndexTest(BitcoinTestFramework):
         mempool_deltas = self.nodes[2].getaddressmempool({"addresses": [address1]})
         assert_equal(len(mempool_deltas), 2)
 
+        self.log.info("Testing that the index continues after a crash...")
+        self.nodes[0].generate(3)
+        self.sync_all()
+        wait_until(lambda: self.nodes[3].getindexinfo()["addressindex"]["best_block_height"] == self.nodes[3].getblockcount(), timeout=60)
+        balance_before = self.nodes[3].getaddressbalance("yMNJePdcKvXtWWQnFYHNeJ5u8TF2v1dfK4")
+        self.nodes[3].process.kill()
+        self.nodes[3].process.wait()
+        self.nodes[3].running = False
+        self.nodes[3].process = None
+        self.nodes[3].rpc_connected = False
+        self.nodes[3].rpc = None
+        self.start_node(3, ["-addressindex"])
+        connect_nodes(self.nodes[0], 3)
+        sync_blocks(self.nodes)
+        wait_until(lambda: self.nodes[3].getindexinfo()["addressindex"]["best_block_height"] == self.nodes[3].getblockcount(), timeout=60)
+        # blocks which are indexed again after the crash must not be counted twice
+        assert_equal(self.nodes[3].getaddressbalance("yMNJePdcKvXtWWQnFYHNeJ5u8TF2v1dfK4"), balance_before)
+
         self.log.info("Passed")
 
 
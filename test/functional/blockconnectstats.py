@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Dash Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test getblockconnectstats.
+
+Test corresponds to code in blockconnectstats.cpp.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than_or_equal
+
+
+class BlockConnectStatsTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        # the inputs are only prefetched when there are script check threads
+        self.extra_args = [["-par=2"]]
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.getblockconnectstats(False, True)
+        stats = node.getblockconnectstats()
+        assert_equal(stats["blocks"], 0)
+        assert_equal(stats["stages"]["total"]["count"], 0)
+
+        node.generate(3)
+        stats = node.getblockconnectstats()
+        assert_equal(stats["blocks"], 3)
+        stages = stats["stages"]
+        for name in ["read_from_disk", "prefetch_inputs", "prefetch_inputs.reads", "connect_total", "flush", "write_chainstate", "post_connect", "total"]:
+            assert_equal(stages[name]["count"], 3)
+        # blocks are also connected by TestBlockValidity when they are created
+        for name in ["check", "forks", "connect_txs", "verify_scripts", "special_txs", "special_txs.loop"]:
+            assert_greater_than_or_equal(stages[name]["count"], 3)
+        assert_equal(stages["index_writes"]["count"], 3)
+        total = stages["total"]
+        assert_greater_than_or_equal(total["total_us"], total["last_us"])
+        assert_greater_than_or_equal(total["max_us"], total["last_us"])
+        assert "buckets" not in total
+
+        # raw buckets and reset
+        stats = node.getblockconnectstats(True, True)
+        assert_equal(sum(stats["stages"]["total"]["buckets"].values()), 3)
+        stats = node.getblockconnectstats()
+        assert_equal(stats["blocks"], 0)
+        assert_equal(stats["stages"]["total"]["total_us"], 0)
+
+
+if __name__ == '__main__':
+    BlockConnectStatsTest().main()
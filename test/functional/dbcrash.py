@@ -55,7 +55,8 @@ class ChainstateWriteCrashTest(BitcoinTestFramework):
         # -dbcache goes to pcoinsTip.
         self.node0_args = ["-dbcrashratio=8", "-dbcache=4", "-dbbatchsize=200000"] + self.base_args
         self.node1_args = ["-dbcrashratio=16", "-dbcache=8", "-dbbatchsize=200000"] + self.base_args
-        self.node2_args = ["-dbcrashratio=24", "-dbcache=16", "-dbbatchsize=200000"] + self.base_args
+        # Node2 writes its flushes in the background, so it also crashes while validation continues
+        self.node2_args = ["-dbcrashratio=24", "-dbcache=16", "-dbbatchsize=200000", "-backgroundflush"] + self.base_args
 
         # Node3 is a normal node with default args, except will mine full blocks
         self.node3_args = ["-blockmaxweight=4000000"]
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Dash Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test -dbtuning and getdbstats.
+
+Test corresponds to code in dbwrapper.cpp.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than, assert_raises_rpc_error
+
+
+class DBStatsTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.extra_args = [["-dbtuning=evodb:profile=randomread", "-dbtuning=llmq:blocksize=16384", "-dbtuning=llmq:compression=1"]]
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.generate(10)
+
+        stats = {db["name"]: db for db in node.getdbstats()}
+        for name in ["blockindex", "chainstate", "evodb", "llmq"]:
+            assert name in stats
+            assert_equal(stats[name]["memory"], False)
+            assert_greater_than(stats[name]["cache_size"], 0)
+        assert_equal(stats["chainstate"]["tuning"]["block_size"], 4096)
+        assert_equal(stats["chainstate"]["tuning"]["bloom_bits"], 10)
+        assert_equal(stats["evodb"]["tuning"]["bloom_bits"], 16)
+        assert_equal(stats["llmq"]["tuning"]["block_size"], 16384)
+        assert_equal(stats["llmq"]["tuning"]["compression"], True)
+
+        # the log of the previous run is turned into a level 0 table when the database is opened again
+        self.stop_node(0)
+        self.start_node(0)
+        stats = node.getdbstats("blockindex")
+        assert_equal(len(stats), 1)
+        assert_equal(stats[0]["name"], "blockindex")
+        assert_equal(stats[0]["tuning"]["bloom_bits"], 10)
+        assert_greater_than(stats[0]["memory_usage"], 0)
+        assert_greater_than(stats[0]["memtable_flushes"], 0)
+        assert_greater_than(sum(level["files"] for level in stats[0]["levels"]), 0)
+        assert_greater_than(stats[0]["read_amplification"], 0)
+        assert_raises_rpc_error(-8, "No open database named unknown", node.getdbstats, "unknown")
+
+        self.stop_node(0)
+        self.assert_start_raises_init_error(0, ["-dbtuning=mempool:blocksize=8192"], "Unknown database mempool")
+        self.assert_start_raises_init_error(0, ["-dbtuning=evodb:blocksize=abc"], "Invalid -dbtuning option or value")
+        self.assert_start_raises_init_error(0, ["-dbtuning=evodb"], "Invalid -dbtuning argument")
+
+
+if __name__ == '__main__':
+    DBStatsTest().main()
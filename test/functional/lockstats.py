@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Dash Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test -lockprofiling, setlockprofiling and getlockstats.
+
+Test corresponds to code in sync.cpp.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than, assert_raises_rpc_error
+
+
+class LockStatsTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [["-lockprofiling=1"], []]
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.generate(10)
+        self.sync_all()
+
+        stats = node.getlockstats(0)
+        assert_equal(stats["enabled"], True)
+        assert_equal(stats["samplerate"], 1)
+        locations = stats["locations"]
+        assert "cs_main" in [location["lock"] for location in locations]
+        for location in locations:
+            assert_equal(location["acquisitions"], location["samples"])
+            assert location["contended"] <= location["samples"]
+            assert location["maxwait"] <= location["totalwait"]
+            assert location["maxhold"] <= location["totalhold"]
+        assert_equal(len(node.getlockstats(2)["locations"]), 2)
+        by_hold = node.getlockstats(0, "hold")["locations"]
+        assert_equal([location["totalhold"] for location in by_hold], sorted([location["totalhold"] for location in by_hold], reverse=True))
+        assert_raises_rpc_error(-8, "sortby must be wait, hold or acquisitions", node.getlockstats, 0, "name")
+
+        # disabled by default, enabling clears the statistics
+        stats = self.nodes[1].getlockstats()
+        assert_equal(stats["enabled"], False)
+        assert_equal(stats["locations"], [])
+        self.nodes[1].setlockprofiling(True, 4)
+        self.nodes[1].generate(10)
+        stats = self.nodes[1].getlockstats(0, "acquisitions")
+        assert_equal(stats["samplerate"], 4)
+        assert_greater_than(len(stats["locations"]), 0)
+        for location in stats["locations"]:
+            assert_equal(location["acquisitions"], location["samples"] * 4)
+
+        node.setlockprofiling(False)
+        assert_equal(node.getlockstats()["enabled"], False)
+        node.setlockprofiling(True)
+        stats = node.getlockstats(0)
+        assert_equal(stats["samplerate"], 16)
+        assert_raises_rpc_error(-8, "samplerate must be at least 1", node.setlockprofiling, True, 0)
+
+
+if __name__ == '__main__':
+    LockStatsTest().main()
@@ -315,6 +315,32 @@ class RESTTest (BitcoinTestFramework):
         for tx in txs:
             assert_equal(tx in json_obj['tx'], True)
 
+        # get all 3 txs with one request, in the requested order
+        response = http_post_call(url.hostname, url.port, '/rest/txs'+self.FORMAT_SEPARATOR+'hex', json.dumps(txs), True)
+        assert_equal(response.status, 200)
+        assert_equal(response.read().decode('utf-8').split(), [self.nodes[0].getrawtransaction(txid) for txid in txs])
+        response = http_post_call(url.hostname, url.port, '/rest/txs'+self.FORMAT_SEPARATOR+'bin', json.dumps(txs[::-1]), True)
+        assert_equal(response.status, 200)
+        assert_equal(response.read(), b''.join(hex_str_to_bytes(self.nodes[0].getrawtransaction(txid)) for txid in txs[::-1]))
+        # a single unknown tx fails the whole request
+        response = http_post_call(url.hostname, url.port, '/rest/txs'+self.FORMAT_SEPARATOR+'hex', json.dumps(txs + ['00' * 32]), True)
+        assert_equal(response.status, 404)
+
+        # get the last blocks by height, the range is cut at the tip
+        height = self.nodes[0].getblockcount()
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/%d/5%shex' % (height - 1, self.FORMAT_SEPARATOR), True)
+        assert_equal(response.status, 200)
+        assert_equal(response.read().decode('utf-8').split(), [self.nodes[0].getblock(self.nodes[0].getblockhash(h), 0) for h in [height - 1, height]])
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/%d/2%sbin' % (height - 1, self.FORMAT_SEPARATOR), True)
+        assert_equal(response.status, 200)
+        assert_equal(response.read(), b''.join(hex_str_to_bytes(self.nodes[0].getblock(self.nodes[0].getblockhash(h), 0)) for h in [height - 1, height]))
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/%d/1%sbin' % (height + 1, self.FORMAT_SEPARATOR), True)
+        assert_equal(response.status, 404)
+        # the count must be a plain number
+        for count in ['abc', '2x', '0', '']:
+            response = http_get_call(url.hostname, url.port, '/rest/blocks/%d/%s%sbin' % (height - 1, count, self.FORMAT_SEPARATOR), True)
+            assert_equal(response.status, 400)
+
         #test rest bestblock
         bb_hash = self.nodes[0].getbestblockhash()
 
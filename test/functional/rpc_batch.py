@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Dash Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test JSON-RPC batches with parallel execution of read-only calls.
+
+Test corresponds to code in rpc/server.cpp.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+
+
+class RPCBatchTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [[], ["-rpcbatchthreads=0"]]
+
+    def run_test(self):
+        for node in self.nodes:
+            self.test_batch(node)
+
+    def test_batch(self, node):
+        height = node.getblockcount()
+        hashes = [node.getblockhash(h) for h in range(height + 1)]
+
+        # results are in the order of the requests
+        requests = [node.getblockhash.get_request(h) for h in range(height + 1)] * 4
+        results = node.batch(requests)
+        assert_equal(len(results), len(requests))
+        for request, result in zip(requests, results):
+            assert_equal(result["id"], request["id"])
+            assert_equal(result["error"], None)
+            assert_equal(result["result"], hashes[request["params"][0]])
+
+        # calls with side effects separate the read-only calls before and after them
+        tip = hashes[-1]
+        results = node.batch([
+            node.getblockcount.get_request(),
+            node.getbestblockhash.get_request(),
+            node.invalidateblock.get_request(tip),
+            node.getblockcount.get_request(),
+            node.getbestblockhash.get_request(),
+            node.reconsiderblock.get_request(tip),
+            node.getblockcount.get_request(),
+            node.getbestblockhash.get_request(),
+        ])
+        assert_equal([r["result"] for r in results], [height, tip, None, height - 1, hashes[-2], None, height, tip])
+
+        # errors of single entries don't affect the others
+        results = node.batch([
+            node.getblockhash.get_request(0),
+            node.getblockhash.get_request(height + 1),
+            {"method": "doesnotexist", "id": 1},
+            "notanobject",
+            node.getblockhash.get_request(1),
+        ])
+        assert_equal(results[0]["result"], hashes[0])
+        assert_equal(results[1]["error"]["code"], -8)
+        assert_equal(results[2]["error"]["code"], -32601)
+        assert_equal(results[3]["error"]["code"], -32600)
+        assert_equal(results[4]["result"], hashes[1])
+
+
+if __name__ == '__main__':
+    RPCBatchTest().main()
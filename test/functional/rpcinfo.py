@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Dash Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the RPC work queue lanes and getrpcinfo.
+
+Test corresponds to code in httpserver.cpp and rpc/server.cpp.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than
+
+
+class RPCInfoTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [[], ["-rpclane=high:0:1", "-rpclane=low:3:5", "-rpcmethodlane=getblockcount:low"]]
+
+    def run_test(self):
+        # default lanes, start with a clean slate as the test framework already called some methods
+        node = self.nodes[0]
+        node.getrpcinfo(False, True)
+        node.getblockcount()
+        node.getblockcount()
+        node.getchaintips()
+        info = node.getrpcinfo()
+        assert_equal(sorted(info["lanes"].keys()), ["default", "high", "low"])
+        assert_equal(info["lanes"]["low"]["threads"], 1)
+        assert_equal(info["lanes"]["low"]["maxdepth"], 16)
+        methods = info["methods"]
+        assert_equal(methods["getblockcount"]["lane"], "high")
+        assert_equal(methods["getblockcount"]["execution"]["count"], 2)
+        assert_equal(methods["getblockcount"]["queuewait"]["count"], 2)
+        assert_equal(methods["getchaintips"]["lane"], "default")
+        assert_equal(methods["getchaintips"]["execution"]["count"], 1)
+        # getrpcinfo is accounted once it returned, so the reset above didn't clear its own call
+        assert_equal(methods["getrpcinfo"]["execution"]["count"], 1)
+
+        # raw buckets and reset
+        info = node.getrpcinfo(True, True)
+        assert "buckets" in info["methods"]["getblockcount"]["execution"]
+        assert_equal(info["methods"]["getrpcinfo"]["execution"]["count"], 2)
+        info = node.getrpcinfo()
+        assert_equal(list(info["methods"].keys()), ["getrpcinfo"])
+
+        # configured lanes, methods of a disabled lane are served by the default lane
+        node = self.nodes[1]
+        node.getblockcount()
+        node.getbestblockhash()
+        info = node.getrpcinfo()
+        assert_equal(sorted(info["lanes"].keys()), ["default", "low"])
+        assert_equal(info["lanes"]["low"]["threads"], 3)
+        assert_equal(info["lanes"]["low"]["maxdepth"], 5)
+        assert_equal(info["methods"]["getblockcount"]["lane"], "low")
+        assert_equal(info["methods"]["getbestblockhash"]["lane"], "default")
+        assert_greater_than(info["methods"]["getblockcount"]["execution"]["count"], 0)
+
+        # unknown methods are accounted by path
+        try:
+            node.doesnotexist()
+        except Exception:
+            pass
+        assert "doesnotexist" not in node.getrpcinfo()["methods"]
+        assert_equal(node.getrpcinfo()["methods"]["/"]["lane"], "default")
+
+
+if __name__ == '__main__':
+    RPCInfoTest().main()
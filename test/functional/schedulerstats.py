@@ -0,0 +1,42 @@
+#!/usr/bin/env python3
+# Copyright (c) 2020 The Dash Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test -schedulerthreads and getschedulerstats.
+
+Test corresponds to code in scheduler.cpp.
+"""
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than, wait_until
+
+
+class SchedulerStatsTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        self.extra_args = [["-schedulerthreads=3"], []]
+
+    def run_test(self):
+        node = self.nodes[0]
+        node.generate(10)
+        self.sync_all()
+
+        # the masternode maintenance task runs every second
+        wait_until(lambda: "mnutils" in [task["name"] for task in node.getschedulerstats()["tasks"]], timeout=10)
+
+        stats = node.getschedulerstats()
+        assert_equal(stats["threads"], 3)
+        assert_greater_than(stats["queued"], 0)
+        tasks = stats["tasks"]
+        assert_equal([task["totalrun"] for task in tasks], sorted([task["totalrun"] for task in tasks], reverse=True))
+        for task in tasks:
+            assert_greater_than(task["runs"], 0)
+            assert task["maxrun"] <= task["totalrun"]
+            assert task["avgrun"] <= task["maxrun"]
+            assert task["avglate"] <= task["maxlate"]
+
+        assert_equal(self.nodes[1].getschedulerstats()["threads"], 1)
+
+
+if __name__ == '__main__':
+    SchedulerStatsTest().main()
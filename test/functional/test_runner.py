@@ -135,6 +135,12 @@ BASE_SCRIPTS= [
     'bipdersig-p2p.py',
     'bip65-cltv-p2p.py',
     'uptime.py',
+    'rpcinfo.py',
+    'rpc_batch.py',
+    'blockconnectstats.py',
+    'dbstats.py',
+    'lockstats.py',
+    'schedulerstats.py',
     'resendwallettransactions.py',
     'minchainwork.py',
     'p2p-acceptblock.py', # NOTE: needs xazab_hash to pass
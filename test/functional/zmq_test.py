@@ -12,8 +12,10 @@ from codecs import encode
 from test_framework.mininode import xazabhash
 from test_framework.test_framework import BitcoinTestFramework, SkipTest
 from test_framework.util import (assert_equal,
+                                 assert_raises_rpc_error,
                                  bytes_to_hex_str,
                                  hash256,
+                                 wait_until,
                                 )
 
 def xazabhash_helper(b):
@@ -49,7 +51,8 @@ class ZMQTest (BitcoinTestFramework):
         ip_address = "tcp://127.0.0.1:28332"
         self.zmqSubSocket.connect(ip_address)
         self.extra_args = [['-zmqpubhashblock=%s' % ip_address, '-zmqpubhashtx=%s' % ip_address,
-                       '-zmqpubrawblock=%s' % ip_address, '-zmqpubrawtx=%s' % ip_address], []]
+                       '-zmqpubrawblock=%s' % ip_address, '-zmqpubrawtx=%s' % ip_address,
+                           '-zmqpubhashtxreplay=64'], []]
         self.add_nodes(self.num_nodes, self.extra_args)
         self.start_nodes()
 
@@ -155,5 +158,33 @@ class ZMQTest (BitcoinTestFramework):
         assert_equal(hashRPC, hashZMQ)  # txid from sendtoaddress must be equal to the hash received over zmq
         assert_equal(hashRPC, hashedZMQ)
 
+        self.log.info("Check getzmqnotifications")
+        notifications = {n["type"]: n for n in self.nodes[0].getzmqnotifications()}
+        assert_equal(sorted(notifications.keys()), ["pubhashblock", "pubhashtx", "pubrawblock", "pubrawtx"])
+        for notification in notifications.values():
+            assert_equal(notification["address"], "tcp://127.0.0.1:28332")
+            assert_equal(notification["hwm"], 1000)
+            assert_equal(notification["batch"], 1)
+            assert_equal(notification["dropped"], 0)
+        # the counters are raised after the send returned, which might be after the message was received
+        def sent(notification_type):
+            return {n["type"]: n["sent"] for n in self.nodes[0].getzmqnotifications()}[notification_type]
+        wait_until(lambda: sent("pubhashblock") == n + 1, timeout=10)
+        wait_until(lambda: sent("pubhashtx") == blockcount + 2, timeout=10)
+        assert_equal(self.nodes[1].getzmqnotifications(), [])
+
+        self.log.info("Replay missed messages")
+        replay = self.nodes[0].getzmqreplay("pubhashtx", 0)
+        assert_equal(replay["first"], 0)
+        assert_equal(replay["next"], blockcount + 2)
+        assert_equal([m["sequence"] for m in replay["messages"]], list(range(blockcount + 2)))
+        assert_equal(replay["messages"][-1]["data"], hashZMQ)
+        replay = self.nodes[0].getzmqreplay("pubhashtx", blockcount, 1)
+        assert_equal(len(replay["messages"]), 1)
+        assert_equal(replay["messages"][0]["sequence"], blockcount)
+        assert_equal(self.nodes[0].getzmqreplay("pubhashtx", blockcount + 2)["messages"], [])
+        assert_raises_rpc_error(-1, "doesn't keep messages", self.nodes[0].getzmqreplay, "pubhashblock", 0)
+        assert_raises_rpc_error(-8, "is not active", self.nodes[0].getzmqreplay, "pubhashtxlock", 0)
+
 if __name__ == '__main__':
     ZMQTest().main()